@@ -0,0 +1,459 @@
+#!/usr/bin/env python3
+#
+# Copyright 2011-2014 Blender Foundation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License
+#
+
+# Benchmark and render regression runner for the Cycles standalone application.
+#
+# Writes a set of deterministic XML benchmark scenes, renders each of them
+# with "cycles --background --report", and collects the per stage timings
+# and memory usage into one JSON report. When a baseline report is given,
+# timings and memory are compared against it, and the rendered images are
+# compared by checksum, so both performance and output changes are caught.
+#
+# Example:
+#
+#   cycles_benchmark.py --cycles ./bin/cycles --output report.json
+#   cycles_benchmark.py --cycles ./bin/cycles --baseline report.json
+
+import argparse
+import hashlib
+import json
+import math
+import os
+import random
+import subprocess
+import sys
+import time
+
+# -----------------------------------------------------------------------------
+# Scene generation
+#
+# Scenes are generated from a fixed random seed, so the same XML is written on
+# every run and on every platform.
+
+
+def fmt(values):
+    return " ".join("%.6g" % v for v in values)
+
+
+def scene_header(width, height):
+    return [
+        '<cycles>',
+        '<integrator seed="0" max_bounce="6" transparent_max_bounce="8" />',
+        '<film filter_width="1.5" />',
+        '<transform translate="0 2 -9" rotate="10 1 0 0">',
+        '\t<camera type="perspective" fov="40" width="%d" height="%d" />' % (width, height),
+        '</transform>',
+        '<background>',
+        '\t<background name="bg" strength="0.5" color="0.6 0.7 0.9" />',
+        '\t<connect from="bg background" to="output surface" />',
+        '</background>',
+        '<shader name="ground">',
+        '\t<diffuse_bsdf name="d" color="0.5 0.5 0.5" />',
+        '\t<connect from="d bsdf" to="output surface" />',
+        '</shader>',
+        '<shader name="light">',
+        '\t<emission name="e" color="1 1 1" strength="100" />',
+        '\t<connect from="e emission" to="output surface" />',
+        '</shader>',
+        '<state shader="light">',
+        '\t<light type="0" P="3 6 -3" size="0.5" />',
+        '</state>',
+        '<state shader="ground">',
+        '\t<mesh P="-20 0 -20  20 0 -20  20 0 20  -20 0 20" nverts="4" verts="0 1 2 3" />',
+        '</state>',
+    ]
+
+
+def scene_footer():
+    return ['</cycles>']
+
+
+def grid_mesh(res, size):
+    P = []
+    verts = []
+
+    for j in range(res + 1):
+        for i in range(res + 1):
+            P += [size * (i / res - 0.5), 0.0, size * (j / res - 0.5)]
+
+    for j in range(res):
+        for i in range(res):
+            v = j * (res + 1) + i
+            verts += [v, v + 1, v + res + 2, v + res + 1]
+
+    return P, [4] * (res * res), verts
+
+
+def sphere_mesh(rings, segments, radius):
+    P = []
+    verts = []
+    nverts = []
+
+    for j in range(rings + 1):
+        theta = math.pi * j / rings
+        for i in range(segments):
+            phi = 2.0 * math.pi * i / segments
+            P += [radius * math.sin(theta) * math.cos(phi),
+                  radius * math.cos(theta),
+                  radius * math.sin(theta) * math.sin(phi)]
+
+    for j in range(rings):
+        for i in range(segments):
+            a = j * segments + i
+            b = j * segments + (i + 1) % segments
+            verts += [a, b, b + segments, a + segments]
+            nverts.append(4)
+
+    return P, nverts, verts
+
+
+def mesh_xml(P, nverts, verts, extra=""):
+    return '<mesh %sP="%s" nverts="%s" verts="%s" />' % (
+        extra, fmt(P), fmt(nverts), fmt(verts))
+
+
+def scene_hair(rng, width, height):
+    lines = scene_header(width, height)
+    lines += [
+        '<shader name="hair">',
+        '\t<hair_bsdf name="h" color="0.4 0.25 0.1" />',
+        '\t<connect from="h bsdf" to="output surface" />',
+        '</shader>',
+    ]
+
+    num_curves = 20000
+    num_keys = 5
+    P = []
+
+    for c in range(num_curves):
+        x = rng.uniform(-3.0, 3.0)
+        z = rng.uniform(-3.0, 3.0)
+        bend_x = rng.uniform(-0.3, 0.3)
+        bend_z = rng.uniform(-0.3, 0.3)
+        length = rng.uniform(0.5, 1.0)
+
+        for k in range(num_keys):
+            t = k / (num_keys - 1)
+            P += [x + bend_x * t * t, length * t, z + bend_z * t * t]
+
+    lines += [
+        '<state shader="hair">',
+        '\t<curves P="%s" nkeys="%s" radius="0.004" />' % (fmt(P), fmt([num_keys] * num_curves)),
+        '</state>',
+    ]
+
+    return lines + scene_footer()
+
+
+def scene_volumes(rng, width, height):
+    lines = scene_header(width, height)
+    lines += [
+        '<shader name="smoke">',
+        '\t<scatter_volume name="s" color="0.8 0.8 0.8" density="1.5" />',
+        '\t<absorption_volume name="a" color="0.9 0.6 0.3" density="0.5" />',
+        '\t<add_closure name="add" />',
+        '\t<connect from="s volume" to="add closure1" />',
+        '\t<connect from="a volume" to="add closure2" />',
+        '\t<connect from="add closure" to="output volume" />',
+        '</shader>',
+    ]
+
+    lines.append('<state shader="smoke">')
+
+    for i in range(8):
+        P, nverts, verts = sphere_mesh(16, 32, rng.uniform(0.5, 1.2))
+        translate = [rng.uniform(-3.0, 3.0), rng.uniform(0.8, 2.0), rng.uniform(-2.0, 3.0)]
+        lines.append('\t<transform translate="%s">' % fmt(translate))
+        lines.append('\t\t' + mesh_xml(P, nverts, verts))
+        lines.append('\t</transform>')
+
+    lines.append('</state>')
+
+    return lines + scene_footer()
+
+
+def scene_instancing(rng, width, height):
+    lines = scene_header(width, height)
+    lines += [
+        '<shader name="rock">',
+        '\t<noise_texture name="n" scale="4" />',
+        '\t<diffuse_bsdf name="d" />',
+        '\t<connect from="n color" to="d color" />',
+        '\t<connect from="d bsdf" to="output surface" />',
+        '</shader>',
+    ]
+
+    P, nverts, verts = sphere_mesh(24, 48, 0.1)
+    lines.append('<state shader="rock" interpolation="smooth">')
+    lines.append('\t<transform translate="0 -10 0">')
+    lines.append('\t\t' + mesh_xml(P, nverts, verts, 'name="rock" '))
+    lines.append('\t</transform>')
+
+    for i in range(5000):
+        translate = [rng.uniform(-6.0, 6.0), 0.05, rng.uniform(-4.0, 8.0)]
+        scale = rng.uniform(0.3, 1.5)
+        angle = rng.uniform(0.0, 360.0)
+        lines.append('\t<transform translate="%s" rotate="%s" scale="%s"><instance mesh="rock" /></transform>' % (
+            fmt(translate), fmt([angle, 0.0, 1.0, 0.0]), fmt([scale, scale * 0.6, scale])))
+
+    lines.append('</state>')
+
+    return lines + scene_footer()
+
+
+def scene_lights(rng, width, height):
+    lines = scene_header(width, height)
+
+    num_lights = 500
+
+    for i in range(num_lights):
+        color = [rng.uniform(0.2, 1.0) for c in range(3)]
+        lines += [
+            '<shader name="light%d">' % i,
+            '\t<emission name="e" color="%s" strength="%s" />' % (fmt(color), fmt([rng.uniform(1.0, 10.0)])),
+            '\t<connect from="e emission" to="output surface" />',
+            '</shader>',
+        ]
+
+    P, nverts, verts = grid_mesh(1, 1.0)
+    lines.append('<state shader="ground">')
+
+    for i in range(64):
+        translate = [rng.uniform(-5.0, 5.0), rng.uniform(0.0, 2.0), rng.uniform(-3.0, 6.0)]
+        lines.append('\t<transform translate="%s" rotate="%s">%s</transform>' % (
+            fmt(translate), fmt([rng.uniform(0.0, 90.0), 1.0, 0.0, 0.0]), mesh_xml(P, nverts, verts)))
+
+    lines.append('</state>')
+
+    for i in range(num_lights):
+        co = [rng.uniform(-8.0, 8.0), rng.uniform(0.2, 4.0), rng.uniform(-4.0, 10.0)]
+        lines.append('<state shader="light%d"><light type="0" P="%s" size="0.05" /></state>' % (i, fmt(co)))
+
+    return lines + scene_footer()
+
+
+def scene_displacement(rng, width, height):
+    lines = scene_header(width, height)
+    lines += [
+        '<shader name="terrain">',
+        '\t<noise_texture name="n" scale="2" detail="6" />',
+        '\t<math name="m" type="Multiply" value2="0.5" />',
+        '\t<diffuse_bsdf name="d" color="0.4 0.5 0.3" />',
+        '\t<connect from="n fac" to="m value1" />',
+        '\t<connect from="m value" to="output displacement" />',
+        '\t<connect from="d bsdf" to="output surface" />',
+        '</shader>',
+    ]
+
+    P, nverts, verts = grid_mesh(8, 10.0)
+    lines += [
+        '<state shader="terrain" displacement_method="true" interpolation="smooth">',
+        '\t' + mesh_xml(P, nverts, verts, 'subdivision="catmull-clark" dicing_rate="0.02" '),
+        '</state>',
+    ]
+
+    return lines + scene_footer()
+
+
+SCENES = (
+    ("hair", scene_hair),
+    ("volumes", scene_volumes),
+    ("instancing", scene_instancing),
+    ("lights", scene_lights),
+    ("displacement", scene_displacement),
+)
+
+
+def write_scenes(directory, names, width, height):
+    os.makedirs(directory, exist_ok=True)
+    paths = []
+
+    for name, generate in SCENES:
+        if names and name not in names:
+            continue
+
+        rng = random.Random(name)
+        path = os.path.join(directory, name + ".xml")
+
+        with open(path, "w") as f:
+            f.write("\n".join(generate(rng, width, height)))
+            f.write("\n")
+
+        paths.append((name, path))
+
+    return paths
+
+
+# -----------------------------------------------------------------------------
+# Running and comparing
+
+# metrics compared against the baseline, and whether higher is better
+METRICS = (
+    ("time_load", False),
+    ("time_sync", False),
+    ("time_bvh", False),
+    ("time_render", False),
+    ("samples_per_second", True),
+    ("memory_device_peak", False),
+    ("memory_process_peak", False),
+)
+
+
+def file_md5(path):
+    md5 = hashlib.md5()
+
+    with open(path, "rb") as f:
+        md5.update(f.read())
+
+    return md5.hexdigest()
+
+
+def render_scene(args, name, path):
+    report_path = os.path.join(args.workdir, name + ".json")
+    image_path = os.path.join(args.workdir, name + ".png")
+
+    command = [
+        args.cycles,
+        "--background",
+        "--quiet",
+        "--samples", str(args.samples),
+        "--threads", str(args.threads),
+        "--output", image_path,
+        "--report", report_path,
+        path,
+    ]
+
+    start = time.time()
+    result = subprocess.call(command)
+    wall_time = time.time() - start
+
+    if result != 0 or not os.path.exists(report_path):
+        print("%s: render failed (exit code %d)" % (name, result))
+        return None
+
+    with open(report_path, "r") as f:
+        report = json.load(f)
+
+    report["time_wall"] = wall_time
+
+    if os.path.exists(image_path):
+        report["image_md5"] = file_md5(image_path)
+
+    return report
+
+
+def compare(name, report, baseline, tolerance):
+    """ Compare one scene against its baseline, returning a list of regressions. """
+    regressions = []
+
+    for metric, higher_is_better in METRICS:
+        value = report.get(metric)
+        base = baseline.get(metric)
+
+        if value is None or base is None or base <= 0:
+            continue
+
+        change = (value - base) / base
+        worse = -change if higher_is_better else change
+        status = "REGRESSION" if worse > tolerance else ""
+
+        print("  %-22s %14.4f %14.4f %+7.1f%% %s" % (metric, base, value, change * 100.0, status))
+
+        if status:
+            regressions.append("%s %s" % (name, metric))
+
+    if "image_md5" in report and "image_md5" in baseline:
+        if report["image_md5"] != baseline["image_md5"]:
+            print("  image differs from baseline")
+            regressions.append("%s image" % name)
+
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Cycles standalone benchmark and regression runner")
+    parser.add_argument("--cycles", required=True, help="Path to the cycles standalone executable")
+    parser.add_argument("--workdir", default="cycles_benchmark", help="Directory for generated scenes, images and reports")
+    parser.add_argument("--scenes", nargs="*", default=[], help="Names of scenes to run, all by default")
+    parser.add_argument("--samples", type=int, default=16, help="Samples per pixel")
+    parser.add_argument("--threads", type=int, default=0, help="Render threads, 0 for automatic")
+    parser.add_argument("--width", type=int, default=640, help="Image width")
+    parser.add_argument("--height", type=int, default=360, help="Image height")
+    parser.add_argument("--output", help="Write the combined report to this JSON file")
+    parser.add_argument("--baseline", help="Compare against this previously written report")
+    parser.add_argument("--tolerance", type=float, default=0.1,
+                        help="Relative change counted as regression (default 0.1)")
+    args = parser.parse_args()
+
+    scenes = write_scenes(os.path.join(args.workdir, "scenes"), args.scenes, args.width, args.height)
+
+    reports = {}
+    failed = []
+
+    for name, path in scenes:
+        print("Rendering %s" % name)
+        report = render_scene(args, name, path)
+
+        if report:
+            reports[name] = report
+        else:
+            failed.append(name)
+
+    combined = {
+        "samples": args.samples,
+        "threads": args.threads,
+        "width": args.width,
+        "height": args.height,
+        "scenes": reports,
+    }
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(combined, f, indent=2, sort_keys=True)
+
+    regressions = []
+
+    if args.baseline:
+        with open(args.baseline, "r") as f:
+            baseline = json.load(f)
+
+        for key in ("samples", "width", "height"):
+            if baseline.get(key) != combined[key]:
+                print("Warning: baseline was rendered with different %s" % key)
+
+        for name in sorted(reports):
+            if name in baseline["scenes"]:
+                print("%s:" % name)
+                print("  %-22s %14s %14s" % ("", "baseline", "current"))
+                regressions += compare(name, reports[name], baseline["scenes"][name], args.tolerance)
+    else:
+        for name in sorted(reports):
+            report = reports[name]
+            print("%-14s sync %8.3fs  bvh %8.3fs  render %8.3fs  %8.2f samples/s  peak %6.1f MB" % (
+                name, report["time_sync"], report["time_bvh"], report["time_render"],
+                report["samples_per_second"], report["memory_process_peak"] / (1024.0 * 1024.0)))
+
+    if failed:
+        print("Failed: %s" % ", ".join(failed))
+    if regressions:
+        print("Regressions: %s" % ", ".join(regressions))
+
+    return 1 if (failed or regressions) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
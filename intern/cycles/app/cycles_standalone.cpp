@@ -22,12 +22,16 @@
 #include "scene.h"
 #include "session.h"
 
+#include "mesh.h"
+
 #include "util_args.h"
 #include "util_foreach.h"
 #include "util_function.h"
 #include "util_path.h"
 #include "util_progress.h"
 #include "util_string.h"
+#include "util_system.h"
+#include "util_task.h"
 #include "util_time.h"
 #include "util_transform.h"
 
@@ -48,8 +52,21 @@ struct Options {
 	SessionParams session_params;
 	bool quiet;
 	bool show_help, interactive, pause;
+	string report_path;
 } options;
 
+/* Statistics gathered for the --report option */
+
+struct RenderReport {
+	double load_time;
+	double render_start_time;
+	double total_time;
+	double bvh_time;
+	SceneUpdateTimes update_times;
+	size_t device_mem_peak;
+	vector<pair<size_t, string> > device_mem_categories;
+} report;
+
 static void session_print(const string& str)
 {
 	/* print with carriage return to overwrite previous */
@@ -110,6 +127,7 @@ static void session_init()
 		options.session->progress.set_update_callback(function_bind(&view_redraw));
 #endif
 
+	report.render_start_time = time_dt();
 	options.session->start();
 
 	options.scene = NULL;
@@ -120,7 +138,10 @@ static void scene_init()
 	options.scene = new Scene(options.scene_params, options.session_params.device);
 
 	/* Read XML */
-	xml_read_file(options.scene, options.filepath.c_str());
+	{
+		scoped_timer timer(&report.load_time);
+		xml_read_file(options.scene, options.filepath.c_str());
+	}
 
 	/* Camera width/height override? */
 	if (!(options.width == 0 || options.height == 0)) {
@@ -136,6 +157,95 @@ static void scene_init()
 	options.scene->camera->compute_auto_viewplane();
 }
 
+static void report_gather()
+{
+	Scene *scene = options.session->scene;
+
+	report.total_time = time_dt() - report.render_start_time;
+	report.update_times = scene->update_times;
+	report.bvh_time = scene->mesh_manager->bvh_build_time;
+	report.device_mem_peak = options.session->stats.mem_peak;
+	options.session->stats.mem_categories(report.device_mem_categories);
+
+	if(!options.quiet)
+		printf("%s", options.session->stats.mem_report().c_str());
+}
+
+/* escape a string for use inside a JSON string literal */
+static string report_json_escape(const string& str)
+{
+	string result;
+
+	for(size_t i = 0; i < str.size(); i++) {
+		unsigned char c = str[i];
+
+		if(c == '"' || c == '\\') {
+			result += '\\';
+			result += c;
+		}
+		else if(c < 0x20)
+			result += string_printf("\\u%04x", c);
+		else
+			result += c;
+	}
+
+	return result;
+}
+
+static void report_write()
+{
+	FILE *f = fopen(options.report_path.c_str(), "w");
+
+	if(!f) {
+		fprintf(stderr, "Failed to open report file %s\n", options.report_path.c_str());
+		return;
+	}
+
+	double sync_time = report.update_times.total();
+	double render_time = max(report.total_time - sync_time, 1e-6);
+	int samples = options.session_params.samples;
+	double pixel_samples = (double)options.width * (double)options.height * (double)samples;
+
+	fprintf(f, "{\n");
+	fprintf(f, "  \"file\": \"%s\",\n", report_json_escape(path_filename(options.filepath)).c_str());
+	fprintf(f, "  \"device\": \"%s\",\n", report_json_escape(options.session_params.device.description).c_str());
+	fprintf(f, "  \"threads\": %d,\n", TaskScheduler::num_threads());
+	fprintf(f, "  \"width\": %d,\n", options.width);
+	fprintf(f, "  \"height\": %d,\n", options.height);
+	fprintf(f, "  \"samples\": %d,\n", samples);
+	fprintf(f, "  \"time_load\": %f,\n", report.load_time);
+	fprintf(f, "  \"time_sync\": %f,\n", sync_time);
+	fprintf(f, "  \"time_bvh\": %f,\n", report.bvh_time);
+	fprintf(f, "  \"time_render\": %f,\n", render_time);
+	fprintf(f, "  \"time_total\": %f,\n", report.load_time + report.total_time);
+	fprintf(f, "  \"samples_per_second\": %f,\n", samples / render_time);
+	fprintf(f, "  \"pixel_samples_per_second\": %f,\n", pixel_samples / render_time);
+	fprintf(f, "  \"memory_device_peak\": %lu,\n", (unsigned long)report.device_mem_peak);
+	fprintf(f, "  \"memory_process_peak\": %lu,\n", (unsigned long)system_process_peak_memory());
+	fprintf(f, "  \"memory_budget\": %lu,\n", (unsigned long)options.session_params.memory_budget);
+	fprintf(f, "  \"memory_device_categories\": {");
+
+	for(size_t i = 0; i < report.device_mem_categories.size(); i++) {
+		fprintf(f, "%s\n    \"%s\": %lu", (i == 0)? "": ",",
+			report_json_escape(report.device_mem_categories[i].second).c_str(),
+			(unsigned long)report.device_mem_categories[i].first);
+	}
+
+	fprintf(f, "\n  },\n");
+	fprintf(f, "  \"time_sync_stages\": {");
+
+	for(size_t i = 0; i < report.update_times.stages.size(); i++) {
+		fprintf(f, "%s\n    \"%s\": %f", (i == 0)? "": ",",
+			report_json_escape(report.update_times.stages[i].first).c_str(),
+			report.update_times.stages[i].second);
+	}
+
+	fprintf(f, "\n  }\n");
+	fprintf(f, "}\n");
+
+	fclose(f);
+}
+
 static void session_exit()
 {
 	if(options.session) {
@@ -329,6 +439,9 @@ static void options_parse(int argc, const char **argv)
 	/* shading system */
 	string ssname = "svm";
 
+	/* device memory budget in megabytes */
+	int memory_budget = 0;
+
 	/* parse options */
 	ArgParse ap;
 	bool help = false;
@@ -344,6 +457,8 @@ static void options_parse(int argc, const char **argv)
 		"--samples %d", &options.session_params.samples, "Number of samples to render",
 		"--output %s", &options.session_params.output_path, "File path to write output image",
 		"--threads %d", &options.session_params.threads, "CPU Rendering Threads",
+		"--memory-budget %d", &memory_budget, "Device memory budget in MB, images are downscaled to fit and rendering stops if the scene does not fit",
+		"--report %s", &options.report_path, "In background mode, write timing and memory statistics as JSON to this file",
 		"--width  %d", &options.width, "Window width in pixel",
 		"--height %d", &options.height, "Window height in pixel",
 		"--list-devices", &list, "List information about all available devices",
@@ -421,6 +536,12 @@ static void options_parse(int argc, const char **argv)
 		fprintf(stderr, "No file path specified\n");
 		exit(EXIT_FAILURE);
 	}
+	else if(memory_budget < 0) {
+		fprintf(stderr, "Invalid memory budget: %d\n", memory_budget);
+		exit(EXIT_FAILURE);
+	}
+
+	options.session_params.memory_budget = (size_t)memory_budget * 1024 * 1024;
 
 	/* For smoother Viewport */
 	options.session_params.start_resolution = 64;
@@ -443,7 +564,14 @@ int main(int argc, const char **argv)
 #endif
 		session_init();
 		options.session->wait();
+
+		if(options.report_path != "")
+			report_gather();
+
 		session_exit();
+
+		if(options.report_path != "")
+			report_write();
 #ifdef WITH_CYCLES_STANDALONE_GUI
 	}
 	else {
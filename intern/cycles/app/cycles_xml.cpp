@@ -843,6 +843,9 @@ static void xml_read_mesh(const XMLReadState& state, pugi::xml_node node)
 	Mesh *mesh = xml_add_mesh(state.scene, state.tfm);
 	mesh->used_shaders.push_back(state.shader);
 
+	/* name, for instancing */
+	xml_read_ustring(&mesh->name, node, "name");
+
 	/* read state */
 	int shader = state.shader;
 	bool smooth = state.smooth;
@@ -928,6 +931,81 @@ static void xml_read_mesh(const XMLReadState& state, pugi::xml_node node)
 	mesh->attributes.remove(ATTR_STD_VERTEX_NORMAL);
 }
 
+/* Instance */
+
+static void xml_read_instance(const XMLReadState& state, pugi::xml_node node)
+{
+	/* add an object sharing the mesh data of a previously named mesh */
+	ustring meshname;
+
+	if(!xml_read_ustring(&meshname, node, "mesh")) {
+		fprintf(stderr, "Instance without mesh name.\n");
+		return;
+	}
+
+	foreach(Mesh *mesh, state.scene->meshes) {
+		if(mesh->name == meshname) {
+			Object *object = new Object();
+			object->mesh = mesh;
+			object->tfm = state.tfm;
+			state.scene->objects.push_back(object);
+			return;
+		}
+	}
+
+	fprintf(stderr, "Unknown mesh \"%s\".\n", meshname.c_str());
+}
+
+/* Curves */
+
+static void xml_read_curves(const XMLReadState& state, pugi::xml_node node)
+{
+	/* add mesh */
+	Mesh *mesh = xml_add_mesh(state.scene, state.tfm);
+	mesh->used_shaders.push_back(state.shader);
+
+	xml_read_ustring(&mesh->name, node, "name");
+
+	/* read keys and number of keys per curve, with either a radius per
+	 * key or a single radius for all keys */
+	vector<float3> P;
+	vector<float> radius;
+	vector<int> nkeys;
+
+	xml_read_float3_array(P, node, "P");
+	xml_read_float_array(radius, node, "radius");
+	xml_read_int_array(nkeys, node, "nkeys");
+
+	if(radius.size() != 1 && radius.size() != P.size()) {
+		fprintf(stderr, "Invalid number of radius values for curves.\n");
+		return;
+	}
+
+	foreach(int n, nkeys) {
+		if(n < 0) {
+			fprintf(stderr, "Invalid number of keys for curves.\n");
+			return;
+		}
+	}
+
+	mesh->reserve(0, 0, nkeys.size(), P.size());
+
+	for(size_t i = 0; i < P.size(); i++)
+		mesh->add_curve_key(P[i], (radius.size() == 1)? radius[0]: radius[i]);
+
+	int key_offset = 0;
+
+	for(size_t i = 0; i < nkeys.size(); i++) {
+		if(key_offset + nkeys[i] > (int)P.size()) {
+			fprintf(stderr, "Invalid number of keys for curves.\n");
+			break;
+		}
+
+		mesh->add_curve(key_offset, nkeys[i], state.shader);
+		key_offset += nkeys[i];
+	}
+}
+
 /* Patch */
 
 static void xml_read_patch(const XMLReadState& state, pugi::xml_node node)
@@ -1117,6 +1195,12 @@ static void xml_read_scene(const XMLReadState& state, pugi::xml_node scene_node)
 		else if(string_iequals(node.name(), "mesh")) {
 			xml_read_mesh(state, node);
 		}
+		else if(string_iequals(node.name(), "instance")) {
+			xml_read_instance(state, node);
+		}
+		else if(string_iequals(node.name(), "curves")) {
+			xml_read_curves(state, node);
+		}
 		else if(string_iequals(node.name(), "patch")) {
 			xml_read_patch(state, node);
 		}
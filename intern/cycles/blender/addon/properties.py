@@ -456,6 +456,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
                 description="Use BVH spatial splits: longer builder time, faster render",
                 default=False,
                 )
+        cls.debug_use_temporal_splits = BoolProperty(
+                name="Use Temporal Splits",
+                description="Split motion blurred geometry in time in the BVH: longer builder time, "
+                            "faster render with deformation motion blur",
+                default=False,
+                )
         cls.use_cache = BoolProperty(
                 name="Cache BVH",
                 description="Cache last built BVH to disk for faster re-render if no geometry changed",
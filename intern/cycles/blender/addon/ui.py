@@ -320,6 +320,7 @@ class CyclesRender_PT_performance(CyclesButtonsPanel, Panel):
 
         col.label(text="Acceleration structure:")
         col.prop(cscene, "debug_use_spatial_splits")
+        col.prop(cscene, "debug_use_temporal_splits")
 
 
 class CyclesRender_PT_layer_options(CyclesButtonsPanel, Panel):
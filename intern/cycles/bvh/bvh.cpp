@@ -106,6 +106,7 @@ bool BVH::cache_read(CacheData& key)
 		if(!(value.read(pack.root_index) &&
 		     value.read(pack.SAH) &&
 		     value.read(pack.nodes) &&
+		     value.read(pack.node_times) &&
 		     value.read(pack.object_node) &&
 		     value.read(pack.tri_woop) &&
 		     value.read(pack.prim_type) &&
@@ -118,6 +119,7 @@ bool BVH::cache_read(CacheData& key)
 			pack.root_index = 0;
 			pack.SAH = 0.0f;
 			pack.nodes.clear();
+			pack.node_times.clear();
 			pack.object_node.clear();
 			pack.tri_woop.clear();
 			pack.prim_type.clear();
@@ -141,6 +143,7 @@ void BVH::cache_write(CacheData& key)
 	value.add(pack.SAH);
 
 	value.add(pack.nodes);
+	value.add(pack.node_times);
 	value.add(pack.object_node);
 	value.add(pack.tri_woop);
 	value.add(pack.prim_type);
@@ -435,12 +438,16 @@ void BVH::pack_instances(size_t nodes_size)
 	pack.nodes.resize(nodes_size);
 	pack.object_node.resize(objects.size());
 
+	if(params.use_temporal_split)
+		pack.node_times.resize(nodes_size/nsize);
+
 	int *pack_prim_index = (pack.prim_index.size())? &pack.prim_index[0]: NULL;
 	int *pack_prim_type = (pack.prim_type.size())? &pack.prim_type[0]: NULL;
 	int *pack_prim_object = (pack.prim_object.size())? &pack.prim_object[0]: NULL;
 	uint *pack_prim_visibility = (pack.prim_visibility.size())? &pack.prim_visibility[0]: NULL;
 	float4 *pack_tri_woop = (pack.tri_woop.size())? &pack.tri_woop[0]: NULL;
 	int4 *pack_nodes = (pack.nodes.size())? &pack.nodes[0]: NULL;
+	float4 *pack_node_times = (pack.node_times.size())? &pack.node_times[0]: NULL;
 
 	/* merge */
 	foreach(Object *ob, objects) {
@@ -536,6 +543,14 @@ void BVH::pack_instances(size_t nodes_size)
 				if(use_qbvh)
 					pack_nodes[pack_nodes_offset + nsize_bbox+1] = bvh_nodes[i + nsize_bbox+1];
 
+				/* node time intervals, full shutter for BVH's without temporal splits */
+				if(pack_node_times) {
+					if(bvh->pack.node_times.size())
+						pack_node_times[pack_nodes_offset/nsize] = bvh->pack.node_times[j];
+					else
+						pack_node_times[pack_nodes_offset/nsize] = make_float4(-FLT_MAX, FLT_MAX, -FLT_MAX, FLT_MAX);
+				}
+
 				pack_nodes_offset += nsize;
 			}
 		}
@@ -560,11 +575,14 @@ void RegularBVH::pack_leaf(const BVHStackEntry& e, const LeafNode *leaf)
 	else
 		/* triangle */
 		pack_node(e.idx, leaf->m_bounds, leaf->m_bounds, leaf->m_lo, leaf->m_hi, leaf->m_visibility, leaf->m_visibility);
+
+	pack_node_times(e.idx, leaf, leaf);
 }
 
 void RegularBVH::pack_inner(const BVHStackEntry& e, const BVHStackEntry& e0, const BVHStackEntry& e1)
 {
 	pack_node(e.idx, e0.node->m_bounds, e1.node->m_bounds, e0.encodeIdx(), e1.encodeIdx(), e0.node->m_visibility, e1.node->m_visibility);
+	pack_node_times(e.idx, e0.node, e1.node);
 }
 
 void RegularBVH::pack_node(int idx, const BoundBox& b0, const BoundBox& b1, int c0, int c1, uint visibility0, uint visibility1)
@@ -580,21 +598,40 @@ void RegularBVH::pack_node(int idx, const BoundBox& b0, const BoundBox& b1, int
 	memcpy(&pack.nodes[idx * BVH_NODE_SIZE], data, sizeof(int4)*BVH_NODE_SIZE);
 }
 
+void RegularBVH::pack_node_times(int idx, const BVHNode *n0, const BVHNode *n1)
+{
+	if(!params.use_temporal_split)
+		return;
+
+	/* time intervals are half open, except that the shutter ends are
+	 * extended so rays at exactly time 0 or 1 are never lost */
+	pack.node_times[idx] = make_float4(
+		(n0->m_time_from <= 0.0f)? -FLT_MAX: n0->m_time_from,
+		(n0->m_time_to >= 1.0f)? FLT_MAX: n0->m_time_to,
+		(n1->m_time_from <= 0.0f)? -FLT_MAX: n1->m_time_from,
+		(n1->m_time_to >= 1.0f)? FLT_MAX: n1->m_time_to);
+}
+
 void RegularBVH::pack_nodes(const array<int>& prims, const BVHNode *root)
 {
 	size_t node_size = root->getSubtreeSize(BVH_STAT_NODE_COUNT);
 
 	/* resize arrays */
 	pack.nodes.clear();
+	pack.node_times.clear();
 	pack.is_leaf.clear();
 	pack.is_leaf.resize(node_size);
 
 	/* for top level BVH, first merge existing BVH's so we know the offsets */
 	if(params.top_level)
 		pack_instances(node_size*BVH_NODE_SIZE);
-	else
+	else {
 		pack.nodes.resize(node_size*BVH_NODE_SIZE);
 
+		if(params.use_temporal_split)
+			pack.node_times.resize(node_size);
+	}
+
 	int nextNodeIdx = 0;
 
 	vector<BVHStackEntry> stack;
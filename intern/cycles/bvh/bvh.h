@@ -48,6 +48,9 @@ struct PackedBVH {
 	/* BVH nodes storage, one node is 4x int4, and contains two bounding boxes,
 	 * and child, triangle or object indexes depending on the node type */
 	array<int4> nodes; 
+	/* time intervals of the two children of each node, only with temporal
+	 * splits. one float4 per node: child 0 from/to, child 1 from/to */
+	array<float4> node_times;
 	/* object index to BVH node index mapping for instances */
 	array<int> object_node; 
 	/* precomputed triangle intersection data, one triangle is 4x float4 */
@@ -131,6 +134,7 @@ protected:
 	void pack_leaf(const BVHStackEntry& e, const LeafNode *leaf);
 	void pack_inner(const BVHStackEntry& e, const BVHStackEntry& e0, const BVHStackEntry& e1);
 	void pack_node(int idx, const BoundBox& b0, const BoundBox& b1, int c0, int c1, uint visibility0, uint visibility1);
+	void pack_node_times(int idx, const BVHNode *n0, const BVHNode *n1);
 
 	/* refit */
 	void refit_nodes();
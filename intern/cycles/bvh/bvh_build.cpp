@@ -235,8 +235,8 @@ BVHNode* BVHBuild::run()
 	/* build recursively */
 	BVHNode *rootnode;
 
-	if(params.use_spatial_split) {
-		/* singlethreaded spatial split build */
+	if(params.use_spatial_split || params.use_temporal_split) {
+		/* singlethreaded spatial and temporal split build */
 		rootnode = build_node(root, 0);
 	}
 	else {
@@ -252,7 +252,7 @@ BVHNode* BVHBuild::run()
 			rootnode->deleteSubtree();
 			rootnode = NULL;
 		}
-		else if(!params.use_spatial_split) {
+		else if(!(params.use_spatial_split || params.use_temporal_split)) {
 			/*rotate(rootnode, 4, 5);*/
 			rootnode->update_visibility();
 		}
@@ -415,7 +415,7 @@ BVHNode *BVHBuild::create_object_leaf_nodes(const BVHReference *ref, int start,
 	}
 	else if(num == 1) {
 		if(start == prim_index.size()) {
-			assert(params.use_spatial_split);
+			assert(params.use_spatial_split || params.use_temporal_split);
 
 			prim_type.push_back(ref->prim_type());
 			prim_index.push_back(ref->prim_index());
@@ -428,7 +428,12 @@ BVHNode *BVHBuild::create_object_leaf_nodes(const BVHReference *ref, int start,
 		}
 
 		uint visibility = objects[ref->prim_object()]->visibility;
-		return new LeafNode(ref->bounds(), visibility, start, start+1);
+		LeafNode *leaf = new LeafNode(ref->bounds(), visibility, start, start+1);
+
+		leaf->m_time_from = ref->time_from();
+		leaf->m_time_to = ref->time_to();
+
+		return leaf;
 	}
 	else {
 		int mid = num/2;
@@ -451,13 +456,14 @@ BVHNode* BVHBuild::create_leaf_node(const BVHRange& range)
 	BoundBox bounds = BoundBox::empty;
 	int num = 0, ob_num = 0;
 	uint visibility = 0;
+	float time_from = 1.0f, time_to = 0.0f;
 
 	for(int i = 0; i < range.size(); i++) {
 		BVHReference& ref = references[range.start() + i];
 
 		if(ref.prim_index() != -1) {
 			if(range.start() + num == prim_index.size()) {
-				assert(params.use_spatial_split);
+				assert(params.use_spatial_split || params.use_temporal_split);
 
 				p_type.push_back(ref.prim_type());
 				p_index.push_back(ref.prim_index());
@@ -471,6 +477,8 @@ BVHNode* BVHBuild::create_leaf_node(const BVHRange& range)
 
 			bounds.grow(ref.bounds());
 			visibility |= objects[ref.prim_object()]->visibility;
+			time_from = min(time_from, ref.time_from());
+			time_to = max(time_to, ref.time_to());
 			num++;
 		}
 		else {
@@ -484,6 +492,8 @@ BVHNode* BVHBuild::create_leaf_node(const BVHRange& range)
 	
 	if(num > 0) {
 		leaf = new LeafNode(bounds, visibility, range.start(), range.start() + num);
+		leaf->m_time_from = time_from;
+		leaf->m_time_to = time_to;
 
 		if(num == range.size())
 			return leaf;
@@ -57,6 +57,7 @@ protected:
 	friend class BVHMixedSplit;
 	friend class BVHObjectSplit;
 	friend class BVHSpatialSplit;
+	friend class BVHTemporalSplit;
 	friend class BVHBuildTask;
 
 	/* adding references */
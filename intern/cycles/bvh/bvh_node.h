@@ -38,7 +38,7 @@ class BVHParams;
 class BVHNode
 {
 public:
-	BVHNode()
+	BVHNode() : m_time_from(0.0f), m_time_to(1.0f)
 	{
 	}
 
@@ -52,6 +52,11 @@ public:
 	BoundBox m_bounds;
 	uint m_visibility;
 
+	/* time interval covered by the node, less than the full shutter only
+	 * with temporal splits */
+	float m_time_from;
+	float m_time_to;
+
 	// Subtree functions
 	int getSubtreeSize(BVH_STAT stat=BVH_STAT_NODE_COUNT) const;
 	float computeSubtreeSAHCost(const BVHParams& p, float probability = 1.0f) const;
@@ -69,8 +74,11 @@ public:
 		children[0] = child0;
 		children[1] = child1;
 
-		if(child0 && child1)
+		if(child0 && child1) {
 			m_visibility = child0->m_visibility|child1->m_visibility;
+			m_time_from = min(child0->m_time_from, child1->m_time_from);
+			m_time_to = max(child0->m_time_to, child1->m_time_to);
+		}
 		else
 			m_visibility = 0; /* happens on build cancel */
 	}
@@ -31,6 +31,10 @@ public:
 	int use_spatial_split;
 	float spatial_split_alpha;
 
+	/* split motion blurred primitives in time as well as space, so nodes
+	 * bound a time interval and traversal can skip them by ray time */
+	int use_temporal_split;
+
 	/* SAH costs */
 	float sah_node_cost;
 	float sah_primitive_cost;
@@ -55,7 +59,9 @@ public:
 	enum {
 		MAX_DEPTH = 64,
 		MAX_SPATIAL_DEPTH = 48,
-		NUM_SPATIAL_BINS = 32
+		NUM_SPATIAL_BINS = 32,
+		/* shortest time interval is 1/2^MAX_TEMPORAL_DEPTH of the shutter */
+		MAX_TEMPORAL_DEPTH = 4
 	};
 
 	BVHParams()
@@ -63,6 +69,8 @@ public:
 		use_spatial_split = true;
 		spatial_split_alpha = 1e-5f;
 
+		use_temporal_split = false;
+
 		/* todo: see if splitting up primitive cost to be separate for triangles
 		 * and curves can help. so far in tests it doesn't help, but why? */
 		sah_node_cost = 1.0f;
@@ -95,29 +103,37 @@ public:
 /* BVH Reference
  *
  * Reference to a primitive. Primitive index and object are sneakily packed
- * into BoundBox to reduce memory usage and align nicely */
+ * into BoundBox to reduce memory usage and align nicely. The time interval
+ * fits in the padding, and is only less than the full shutter after
+ * temporal splits. */
 
 class BVHReference
 {
 public:
 	__forceinline BVHReference() {}
 
-	__forceinline BVHReference(const BoundBox& bounds_, int prim_index_, int prim_object_, int prim_type)
+	__forceinline BVHReference(const BoundBox& bounds_, int prim_index_, int prim_object_, int prim_type,
+	                           float time_from_ = 0.0f, float time_to_ = 1.0f)
 	: rbounds(bounds_)
 	{
 		rbounds.min.w = __int_as_float(prim_index_);
 		rbounds.max.w = __int_as_float(prim_object_);
 		type = prim_type;
+		ttime_from = time_from_;
+		ttime_to = time_to_;
 	}
 
 	__forceinline const BoundBox& bounds() const { return rbounds; }
 	__forceinline int prim_index() const { return __float_as_int(rbounds.min.w); }
 	__forceinline int prim_object() const { return __float_as_int(rbounds.max.w); }
 	__forceinline int prim_type() const { return type; }
+	__forceinline float time_from() const { return ttime_from; }
+	__forceinline float time_to() const { return ttime_to; }
 
 protected:
 	BoundBox rbounds;
 	uint type;
+	float ttime_from, ttime_to;
 };
 
 /* BVH Range
@@ -253,7 +253,13 @@ void BVHSpatialSplit::split_reference(BVHBuild *builder, BVHReference& left, BVH
 	Object *ob = builder->objects[ref.prim_object()];
 	const Mesh *mesh = ob->mesh;
 
-	if (ref.prim_type() & PRIMITIVE_ALL_TRIANGLE) {
+	if(ref.prim_type() & PRIMITIVE_ALL_MOTION) {
+		/* motion primitives move through the whole reference bounds, the
+		 * center step vertices alone would give bounds that are too small */
+		left_bounds = ref.bounds();
+		right_bounds = ref.bounds();
+	}
+	else if (ref.prim_type() & PRIMITIVE_ALL_TRIANGLE) {
 		const int *inds = mesh->triangles[ref.prim_index()].v;
 		const float3 *verts = &mesh->verts[0];
 		const float3* v1 = &verts[inds[2]];
@@ -320,8 +326,184 @@ void BVHSpatialSplit::split_reference(BVHBuild *builder, BVHReference& left, BVH
 	right_bounds.intersect(ref.bounds());
 
 	/* set references */
-	left = BVHReference(left_bounds, ref.prim_index(), ref.prim_object(), ref.prim_type());
-	right = BVHReference(right_bounds, ref.prim_index(), ref.prim_object(), ref.prim_type());
+	left = BVHReference(left_bounds, ref.prim_index(), ref.prim_object(), ref.prim_type(), ref.time_from(), ref.time_to());
+	right = BVHReference(right_bounds, ref.prim_index(), ref.prim_object(), ref.prim_type(), ref.time_from(), ref.time_to());
+}
+
+/* Temporal Split */
+
+static const float3 *motion_step_verts(const Mesh *mesh, const Attribute *attr_mP, int step)
+{
+	/* center step is not stored in the attribute */
+	int center_step = (mesh->motion_steps - 1)/2;
+
+	if(step == center_step)
+		return &mesh->verts[0];
+	else if(step > center_step)
+		step--;
+
+	return attr_mP->data_float3() + step*mesh->verts.size();
+}
+
+static void motion_triangle_grow_at_time(const Mesh *mesh, const Attribute *attr_mP, int prim, float time, BoundBox& bounds)
+{
+	int max_step = mesh->motion_steps - 1;
+	float fstep = clamp(time, 0.0f, 1.0f) * max_step;
+	int step = min((int)fstep, max_step - 1);
+	float t = fstep - step;
+
+	const int *inds = mesh->triangles[prim].v;
+	const float3 *verts = motion_step_verts(mesh, attr_mP, step);
+	const float3 *next_verts = motion_step_verts(mesh, attr_mP, step + 1);
+
+	for(int i = 0; i < 3; i++)
+		bounds.grow((1.0f - t)*verts[inds[i]] + t*next_verts[inds[i]]);
+}
+
+static void motion_triangle_bounds(const Mesh *mesh, const Attribute *attr_mP, int prim, float time_from, float time_to, BoundBox& bounds)
+{
+	/* positions are linearly interpolated between steps, so the bounds over a
+	 * time interval are those of the interval ends and the steps in between */
+	int max_step = mesh->motion_steps - 1;
+
+	motion_triangle_grow_at_time(mesh, attr_mP, prim, time_from, bounds);
+	motion_triangle_grow_at_time(mesh, attr_mP, prim, time_to, bounds);
+
+	for(int step = 1; step < max_step; step++) {
+		float step_time = (float)step/(float)max_step;
+
+		if(step_time > time_from && step_time < time_to)
+			mesh->triangles[prim].bounds_grow(motion_step_verts(mesh, attr_mP, step), bounds);
+	}
+}
+
+BVHTemporalSplit::BVHTemporalSplit(BVHBuild *builder, const BVHRange& range, float nodeSAH)
+: sah(FLT_MAX), time(0.0f)
+{
+	/* find time interval of the node, only worth splitting with motion triangles */
+	float time_from = 1.0f, time_to = 0.0f;
+	bool have_motion = false;
+
+	for(int i = range.start(); i < range.end(); i++) {
+		const BVHReference& ref = builder->references[i];
+
+		time_from = min(time_from, ref.time_from());
+		time_to = max(time_to, ref.time_to());
+
+		if(ref.prim_type() == PRIMITIVE_MOTION_TRIANGLE)
+			have_motion = true;
+	}
+
+	float min_span = 1.0f/(float)(1 << BVHParams::MAX_TEMPORAL_DEPTH);
+
+	if(!have_motion || time_to - time_from < 2.0f*min_span)
+		return;
+
+	this->time = 0.5f*(time_from + time_to);
+
+	/* bounds and primitive counts of both halves */
+	BoundBox left_bounds = BoundBox::empty;
+	BoundBox right_bounds = BoundBox::empty;
+	int num_left = 0, num_right = 0;
+
+	for(int i = range.start(); i < range.end(); i++) {
+		const BVHReference& ref = builder->references[i];
+
+		if(ref.time_to() <= this->time) {
+			left_bounds.grow(ref.bounds());
+			num_left++;
+		}
+		else if(ref.time_from() >= this->time) {
+			right_bounds.grow(ref.bounds());
+			num_right++;
+		}
+		else {
+			BVHReference lref, rref;
+
+			split_reference(builder, lref, rref, ref, this->time);
+			left_bounds.grow(lref.bounds());
+			right_bounds.grow(rref.bounds());
+			num_left++;
+			num_right++;
+		}
+	}
+
+	/* each child is only traversed by rays with a time in its half */
+	this->sah = nodeSAH + 0.5f * (
+		left_bounds.safe_area() * builder->params.primitive_cost(num_left) +
+		right_bounds.safe_area() * builder->params.primitive_cost(num_right));
+}
+
+void BVHTemporalSplit::split(BVHBuild *builder, BVHRange& left, BVHRange& right, const BVHRange& range)
+{
+	/* Categorize references and compute bounds, same layout as spatial split.
+	 *
+	 * Left-hand side:			[left_start, left_end[
+	 * Spanning split time:		[left_end, right_start[
+	 * Right-hand side:			[right_start, refs.size()[ */
+
+	vector<BVHReference>& refs = builder->references;
+	int left_start = range.start();
+	int left_end = left_start;
+	int right_start = range.end();
+	int right_end = range.end();
+	BoundBox left_bounds = BoundBox::empty;
+	BoundBox right_bounds = BoundBox::empty;
+
+	for(int i = left_end; i < right_start; i++) {
+		if(refs[i].time_to() <= this->time) {
+			left_bounds.grow(refs[i].bounds());
+			swap(refs[i], refs[left_end++]);
+		}
+		else if(refs[i].time_from() >= this->time) {
+			right_bounds.grow(refs[i].bounds());
+			swap(refs[i--], refs[--right_start]);
+		}
+	}
+
+	/* references spanning the split time are always duplicated, otherwise
+	 * rays with a time in the other half would miss them */
+	while(left_end < right_start) {
+		BVHReference lref, rref;
+
+		split_reference(builder, lref, rref, refs[left_end], this->time);
+
+		left_bounds.grow(lref.bounds());
+		right_bounds.grow(rref.bounds());
+
+		refs[left_end++] = lref;
+		refs.insert(refs.begin() + right_end, rref);
+		right_end++;
+	}
+
+	left = BVHRange(left_bounds, left_start, left_end - left_start);
+	right = BVHRange(right_bounds, right_start, right_end - right_start);
+}
+
+void BVHTemporalSplit::split_reference(BVHBuild *builder, BVHReference& left, BVHReference& right, const BVHReference& ref, float time)
+{
+	BoundBox left_bounds = ref.bounds();
+	BoundBox right_bounds = ref.bounds();
+
+	if(ref.prim_type() == PRIMITIVE_MOTION_TRIANGLE) {
+		Mesh *mesh = builder->objects[ref.prim_object()]->mesh;
+		Attribute *attr_mP = mesh->attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
+
+		if(attr_mP) {
+			left_bounds = BoundBox::empty;
+			right_bounds = BoundBox::empty;
+
+			motion_triangle_bounds(mesh, attr_mP, ref.prim_index(), ref.time_from(), time, left_bounds);
+			motion_triangle_bounds(mesh, attr_mP, ref.prim_index(), time, ref.time_to(), right_bounds);
+
+			/* reference may already be clipped by a spatial split */
+			left_bounds.intersect(ref.bounds());
+			right_bounds.intersect(ref.bounds());
+		}
+	}
+
+	left = BVHReference(left_bounds, ref.prim_index(), ref.prim_object(), ref.prim_type(), ref.time_from(), time);
+	right = BVHReference(right_bounds, ref.prim_index(), ref.prim_object(), ref.prim_type(), time, ref.time_to());
 }
 
 CCL_NAMESPACE_END
@@ -58,13 +58,33 @@ public:
 	void split_reference(BVHBuild *builder, BVHReference& left, BVHReference& right, const BVHReference& ref, int dim, float pos);
 };
 
-/* Mixed Object-Spatial Split */
+/* Temporal Split
+ *
+ * Splits the time interval of the node in half. Motion triangles spanning the
+ * split time are duplicated with bounds for each half, other primitives are
+ * duplicated as is. Rays only traverse the child matching their time. */
+
+class BVHTemporalSplit
+{
+public:
+	float sah;
+	float time;
+
+	BVHTemporalSplit() : sah(FLT_MAX), time(0.0f) {}
+	BVHTemporalSplit(BVHBuild *builder, const BVHRange& range, float nodeSAH);
+
+	void split(BVHBuild *builder, BVHRange& left, BVHRange& right, const BVHRange& range);
+	void split_reference(BVHBuild *builder, BVHReference& left, BVHReference& right, const BVHReference& ref, float time);
+};
+
+/* Mixed Object-Spatial-Temporal Split */
 
 class BVHMixedSplit
 {
 public:
 	BVHObjectSplit object;
 	BVHSpatialSplit spatial;
+	BVHTemporalSplit temporal;
 
 	float leafSAH;
 	float nodeSAH;
@@ -90,14 +110,19 @@ public:
 				spatial = BVHSpatialSplit(builder, range, nodeSAH);
 		}
 
+		if(builder->params.use_temporal_split)
+			temporal = BVHTemporalSplit(builder, range, nodeSAH);
+
 		/* leaf SAH is the lowest => create leaf. */
-		minSAH = min(min(leafSAH, object.sah), spatial.sah);
+		minSAH = min(min(min(leafSAH, object.sah), spatial.sah), temporal.sah);
 		no_split = (minSAH == leafSAH && builder->range_within_max_leaf_size(range));
 	}
 
 	__forceinline void split(BVHBuild *builder, BVHRange& left, BVHRange& right, const BVHRange& range)
 	{
-		if(builder->params.use_spatial_split && minSAH == spatial.sah)
+		if(builder->params.use_temporal_split && temporal.sah != FLT_MAX && minSAH == temporal.sah)
+			temporal.split(builder, left, right, range);
+		else if(builder->params.use_spatial_split && minSAH == spatial.sah)
 			spatial.split(builder, left, right, range);
 		if(!left.size() || !right.size())
 			object.split(builder, left, right, range);
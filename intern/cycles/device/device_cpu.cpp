@@ -61,6 +61,8 @@ public:
 #ifdef WITH_OSL
 		kernel_globals.osl = &osl_globals;
 #endif
+		kernel_globals.transparent_shadow_intersections = NULL;
+		kernel_globals.shadow_occluder_prim = PRIM_NONE;
 
 		/* do now to avoid thread issues */
 		system_cpu_support_sse2();
@@ -79,7 +81,7 @@ public:
 	{
 		mem.device_pointer = mem.data_pointer;
 		mem.device_size = mem.memory_size();
-		stats.mem_alloc(mem.device_size);
+		stats.mem_alloc(mem.device_size, mem.name);
 	}
 
 	void mem_copy_to(device_memory& mem)
@@ -101,7 +103,7 @@ public:
 	{
 		if(mem.device_pointer) {
 			mem.device_pointer = 0;
-			stats.mem_free(mem.device_size);
+			stats.mem_free(mem.device_size, mem.name);
 			mem.device_size = 0;
 		}
 	}
@@ -113,17 +115,20 @@ public:
 
 	void tex_alloc(const char *name, device_memory& mem, InterpolationType interpolation, bool periodic)
 	{
+		if(mem.name.empty())
+			mem.name = name;
+
 		kernel_tex_copy(&kernel_globals, name, mem.data_pointer, mem.data_width, mem.data_height, mem.data_depth, interpolation);
 		mem.device_pointer = mem.data_pointer;
 		mem.device_size = mem.memory_size();
-		stats.mem_alloc(mem.device_size);
+		stats.mem_alloc(mem.device_size, mem.name);
 	}
 
 	void tex_free(device_memory& mem)
 	{
 		if(mem.device_pointer) {
 			mem.device_pointer = 0;
-			stats.mem_free(mem.device_size);
+			stats.mem_free(mem.device_size, mem.name);
 			mem.device_size = 0;
 		}
 	}
@@ -156,6 +161,12 @@ public:
 		}
 	};
 
+	void thread_kernel_globals_free(KernelGlobals *kg)
+	{
+		if(kg->transparent_shadow_intersections != NULL)
+			free(kg->transparent_shadow_intersections);
+	}
+
 	void thread_path_trace(DeviceTask& task)
 	{
 		if(task_pool.canceled()) {
@@ -236,6 +247,8 @@ public:
 #ifdef WITH_OSL
 		OSLShader::thread_free(&kg);
 #endif
+
+		thread_kernel_globals_free(&kg);
 	}
 
 	void thread_film_convert(DeviceTask& task)
@@ -243,7 +256,7 @@ public:
 		float sample_scale = 1.0f/(task.sample + 1);
 
 		if(task.rgba_half) {
-			void(*convert_to_half_float_kernel)(KernelGlobals *, uchar4 *, float *, float, int, int, int, int);
+			void(*convert_to_half_float_kernel)(KernelGlobals *, uchar4 *, float *, float, int, int, int, int, int);
 #ifdef WITH_CYCLES_OPTIMIZED_KERNEL_AVX2
 			if(system_cpu_support_avx2())
 				convert_to_half_float_kernel = kernel_cpu_avx2_convert_to_half_float;
@@ -251,7 +264,6 @@ public:
 #endif
 #ifdef WITH_CYCLES_OPTIMIZED_KERNEL_AVX
 			if(system_cpu_support_avx())
-				for(int y = task.y; y < task.y + task.h; y++)
 				convert_to_half_float_kernel = kernel_cpu_avx_convert_to_half_float;
 			else
 #endif	
@@ -272,13 +284,13 @@ public:
 #endif
 				convert_to_half_float_kernel = kernel_cpu_convert_to_half_float;
 
+			/* kernels convert a full row per call */
 			for(int y = task.y; y < task.y + task.h; y++)
-				for(int x = task.x; x < task.x + task.w; x++)
-					convert_to_half_float_kernel(&kernel_globals, (uchar4*)task.rgba_half, (float*)task.buffer,
-						sample_scale, x, y, task.offset, task.stride);
+				convert_to_half_float_kernel(&kernel_globals, (uchar4*)task.rgba_half, (float*)task.buffer,
+					sample_scale, task.x, y, task.w, task.offset, task.stride);
 		}
 		else {
-			void(*convert_to_byte_kernel)(KernelGlobals *, uchar4 *, float *, float, int, int, int, int);
+			void(*convert_to_byte_kernel)(KernelGlobals *, uchar4 *, float *, float, int, int, int, int, int);
 #ifdef WITH_CYCLES_OPTIMIZED_KERNEL_AVX2
 			if(system_cpu_support_avx2())
 				convert_to_byte_kernel = kernel_cpu_avx2_convert_to_byte;
@@ -307,10 +319,8 @@ public:
 				convert_to_byte_kernel = kernel_cpu_convert_to_byte;
 
 			for(int y = task.y; y < task.y + task.h; y++)
-				for(int x = task.x; x < task.x + task.w; x++)
-					convert_to_byte_kernel(&kernel_globals, (uchar4*)task.rgba_byte, (float*)task.buffer,
-						sample_scale, x, y, task.offset, task.stride);
-
+				convert_to_byte_kernel(&kernel_globals, (uchar4*)task.rgba_byte, (float*)task.buffer,
+					sample_scale, task.x, y, task.w, task.offset, task.stride);
 		}
 	}
 
@@ -365,6 +375,8 @@ public:
 #ifdef WITH_OSL
 		OSLShader::thread_free(&kg);
 #endif
+
+		thread_kernel_globals_free(&kg);
 	}
 
 	int get_split_task_count(DeviceTask& task)
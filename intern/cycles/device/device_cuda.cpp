@@ -355,7 +355,7 @@ public:
 		cuda_assert(cuMemAlloc(&device_pointer, size));
 		mem.device_pointer = (device_ptr)device_pointer;
 		mem.device_size = size;
-		stats.mem_alloc(size);
+		stats.mem_alloc(size, mem.name);
 		cuda_pop_context();
 	}
 
@@ -402,7 +402,7 @@ public:
 
 			mem.device_pointer = 0;
 
-			stats.mem_free(mem.device_size);
+			stats.mem_free(mem.device_size, mem.name);
 			mem.device_size = 0;
 		}
 	}
@@ -421,6 +421,9 @@ public:
 
 	void tex_alloc(const char *name, device_memory& mem, InterpolationType interpolation, bool periodic)
 	{
+		if(mem.name.empty())
+			mem.name = name;
+
 		/* todo: support 3D textures, only CPU for now */
 
 		/* determine format */
@@ -497,7 +500,7 @@ public:
 				mem.device_pointer = (device_ptr)handle;
 				mem.device_size = size;
 
-				stats.mem_alloc(size);
+				stats.mem_alloc(size, mem.name);
 			}
 			else {
 				cuda_pop_context();
@@ -563,7 +566,7 @@ public:
 				tex_interp_map.erase(tex_interp_map.find(mem.device_pointer));
 				mem.device_pointer = 0;
 
-				stats.mem_free(mem.device_size);
+				stats.mem_free(mem.device_size, mem.name);
 				mem.device_size = 0;
 			}
 			else {
@@ -815,7 +818,7 @@ public:
 				pixel_mem_map[mem.device_pointer] = pmem;
 
 				mem.device_size = mem.memory_size();
-				stats.mem_alloc(mem.device_size);
+				stats.mem_alloc(mem.device_size, mem.name);
 
 				return;
 			}
@@ -872,7 +875,7 @@ public:
 				pixel_mem_map.erase(pixel_mem_map.find(mem.device_pointer));
 				mem.device_pointer = 0;
 
-				stats.mem_free(mem.device_size);
+				stats.mem_free(mem.device_size, mem.name);
 				mem.device_size = 0;
 
 				return;
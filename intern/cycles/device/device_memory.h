@@ -30,6 +30,7 @@
 
 #include "util_debug.h"
 #include "util_half.h"
+#include "util_string.h"
 #include "util_types.h"
 #include "util_vector.h"
 
@@ -175,6 +176,10 @@ public:
 	/* device pointer */
 	device_ptr device_pointer;
 
+	/* name for memory statistics, set to the texture name by tex_alloc
+	 * unless the owner already named the memory */
+	string name;
+
 protected:
 	device_memory() {}
 	virtual ~device_memory() { assert(!device_pointer); }
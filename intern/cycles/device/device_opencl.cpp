@@ -797,7 +797,7 @@ public:
 
 		opencl_assert_err(ciErr, "clCreateBuffer");
 
-		stats.mem_alloc(size);
+		stats.mem_alloc(size, mem.name);
 		mem.device_size = size;
 	}
 
@@ -830,7 +830,7 @@ public:
 			opencl_assert(clReleaseMemObject(CL_MEM_PTR(mem.device_pointer)));
 			mem.device_pointer = 0;
 
-			stats.mem_free(mem.device_size);
+			stats.mem_free(mem.device_size, mem.name);
 			mem.device_size = 0;
 		}
 	}
@@ -856,6 +856,9 @@ public:
 
 	void tex_alloc(const char *name, device_memory& mem, InterpolationType interpolation, bool periodic)
 	{
+		if(mem.name.empty())
+			mem.name = name;
+
 		mem_alloc(mem, MEM_READ_ONLY);
 		mem_copy_to(mem);
 		assert(mem_map.find(name) == mem_map.end());
@@ -155,6 +155,16 @@ ccl_device uint BVH_FUNCTION_NAME(KernelGlobals *kg, const Ray *ray, Intersectio
 #endif
 #endif // __KERNEL_SSE2__
 
+#if FEATURE(BVH_MOTION)
+				/* with temporal splits, skip children not containing the ray time */
+				if(kernel_data.bvh.have_time_splits) {
+					float4 times = kernel_tex_fetch(__bvh_node_times, nodeAddr);
+
+					traverseChild0 = traverseChild0 && (ray->time >= times.x) && (ray->time < times.y);
+					traverseChild1 = traverseChild1 && (ray->time >= times.z) && (ray->time < times.w);
+				}
+#endif
+
 				nodeAddr = __float_as_int(cnodes.x);
 				nodeAddrChild1 = __float_as_int(cnodes.y);
 
@@ -37,9 +37,9 @@ void kernel_tex_copy(KernelGlobals *kg, const char *name, device_ptr mem, size_t
 void kernel_cpu_path_trace(KernelGlobals *kg, float *buffer, unsigned int *rng_state,
 	int sample, int x, int y, int offset, int stride);
 void kernel_cpu_convert_to_byte(KernelGlobals *kg, uchar4 *rgba, float *buffer,
-	float sample_scale, int x, int y, int offset, int stride);
+	float sample_scale, int x, int y, int w, int offset, int stride);
 void kernel_cpu_convert_to_half_float(KernelGlobals *kg, uchar4 *rgba, float *buffer,
-	float sample_scale, int x, int y, int offset, int stride);
+	float sample_scale, int x, int y, int w, int offset, int stride);
 void kernel_cpu_shader(KernelGlobals *kg, uint4 *input, float4 *output,
 	int type, int i, int offset, int sample);
 
@@ -47,9 +47,9 @@ void kernel_cpu_shader(KernelGlobals *kg, uint4 *input, float4 *output,
 void kernel_cpu_sse2_path_trace(KernelGlobals *kg, float *buffer, unsigned int *rng_state,
 	int sample, int x, int y, int offset, int stride);
 void kernel_cpu_sse2_convert_to_byte(KernelGlobals *kg, uchar4 *rgba, float *buffer,
-	float sample_scale, int x, int y, int offset, int stride);
+	float sample_scale, int x, int y, int w, int offset, int stride);
 void kernel_cpu_sse2_convert_to_half_float(KernelGlobals *kg, uchar4 *rgba, float *buffer,
-	float sample_scale, int x, int y, int offset, int stride);
+	float sample_scale, int x, int y, int w, int offset, int stride);
 void kernel_cpu_sse2_shader(KernelGlobals *kg, uint4 *input, float4 *output,
 	int type, int i, int offset, int sample);
 #endif
@@ -58,9 +58,9 @@ void kernel_cpu_sse2_shader(KernelGlobals *kg, uint4 *input, float4 *output,
 void kernel_cpu_sse3_path_trace(KernelGlobals *kg, float *buffer, unsigned int *rng_state,
 	int sample, int x, int y, int offset, int stride);
 void kernel_cpu_sse3_convert_to_byte(KernelGlobals *kg, uchar4 *rgba, float *buffer,
-	float sample_scale, int x, int y, int offset, int stride);
+	float sample_scale, int x, int y, int w, int offset, int stride);
 void kernel_cpu_sse3_convert_to_half_float(KernelGlobals *kg, uchar4 *rgba, float *buffer,
-	float sample_scale, int x, int y, int offset, int stride);
+	float sample_scale, int x, int y, int w, int offset, int stride);
 void kernel_cpu_sse3_shader(KernelGlobals *kg, uint4 *input, float4 *output,
 	int type, int i, int offset, int sample);
 #endif
@@ -69,9 +69,9 @@ void kernel_cpu_sse3_shader(KernelGlobals *kg, uint4 *input, float4 *output,
 void kernel_cpu_sse41_path_trace(KernelGlobals *kg, float *buffer, unsigned int *rng_state,
 	int sample, int x, int y, int offset, int stride);
 void kernel_cpu_sse41_convert_to_byte(KernelGlobals *kg, uchar4 *rgba, float *buffer,
-	float sample_scale, int x, int y, int offset, int stride);
+	float sample_scale, int x, int y, int w, int offset, int stride);
 void kernel_cpu_sse41_convert_to_half_float(KernelGlobals *kg, uchar4 *rgba, float *buffer,
-	float sample_scale, int x, int y, int offset, int stride);
+	float sample_scale, int x, int y, int w, int offset, int stride);
 void kernel_cpu_sse41_shader(KernelGlobals *kg, uint4 *input, float4 *output,
 	int type, int i, int offset, int sample);
 #endif
@@ -80,9 +80,9 @@ void kernel_cpu_sse41_shader(KernelGlobals *kg, uint4 *input, float4 *output,
 void kernel_cpu_avx_path_trace(KernelGlobals *kg, float *buffer, unsigned int *rng_state,
 	int sample, int x, int y, int offset, int stride);
 void kernel_cpu_avx_convert_to_byte(KernelGlobals *kg, uchar4 *rgba, float *buffer,
-	float sample_scale, int x, int y, int offset, int stride);
+	float sample_scale, int x, int y, int w, int offset, int stride);
 void kernel_cpu_avx_convert_to_half_float(KernelGlobals *kg, uchar4 *rgba, float *buffer,
-	float sample_scale, int x, int y, int offset, int stride);
+	float sample_scale, int x, int y, int w, int offset, int stride);
 void kernel_cpu_avx_shader(KernelGlobals *kg, uint4 *input, float4 *output,
 	int type, int i, int offset, int sample);
 #endif
@@ -91,9 +91,9 @@ void kernel_cpu_avx_shader(KernelGlobals *kg, uint4 *input, float4 *output,
 void kernel_cpu_avx2_path_trace(KernelGlobals *kg, float *buffer, unsigned int *rng_state,
 	int sample, int x, int y, int offset, int stride);
 void kernel_cpu_avx2_convert_to_byte(KernelGlobals *kg, uchar4 *rgba, float *buffer,
-	float sample_scale, int x, int y, int offset, int stride);
+	float sample_scale, int x, int y, int w, int offset, int stride);
 void kernel_cpu_avx2_convert_to_half_float(KernelGlobals *kg, uchar4 *rgba, float *buffer,
-	float sample_scale, int x, int y, int offset, int stride);
+	float sample_scale, int x, int y, int w, int offset, int stride);
 void kernel_cpu_avx2_shader(KernelGlobals *kg, uint4 *input, float4 *output,
 	int type, int i, int offset, int sample);
 #endif
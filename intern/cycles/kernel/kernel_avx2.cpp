@@ -57,14 +57,14 @@ void kernel_cpu_avx2_path_trace(KernelGlobals *kg, float *buffer, unsigned int *
 
 /* Film */
 
-void kernel_cpu_avx2_convert_to_byte(KernelGlobals *kg, uchar4 *rgba, float *buffer, float sample_scale, int x, int y, int offset, int stride)
+void kernel_cpu_avx2_convert_to_byte(KernelGlobals *kg, uchar4 *rgba, float *buffer, float sample_scale, int x, int y, int w, int offset, int stride)
 {
-	kernel_film_convert_to_byte(kg, rgba, buffer, sample_scale, x, y, offset, stride);
+	kernel_film_convert_to_byte_row(kg, rgba, buffer, sample_scale, x, y, w, offset, stride);
 }
 
-void kernel_cpu_avx2_convert_to_half_float(KernelGlobals *kg, uchar4 *rgba, float *buffer, float sample_scale, int x, int y, int offset, int stride)
+void kernel_cpu_avx2_convert_to_half_float(KernelGlobals *kg, uchar4 *rgba, float *buffer, float sample_scale, int x, int y, int w, int offset, int stride)
 {
-	kernel_film_convert_to_half_float(kg, rgba, buffer, sample_scale, x, y, offset, stride);
+	kernel_film_convert_to_half_float_row(kg, rgba, buffer, sample_scale, x, y, w, offset, stride);
 }
 
 /* Shader Evaluate */
@@ -86,5 +86,86 @@ ccl_device void kernel_film_convert_to_half_float(KernelGlobals *kg,
 	float4_store_half(out, rgba_in, sample_scale);
 }
 
+#ifdef __KERNEL_CPU__
+
+/* Row variants of the above, converting w pixels starting at x. Used by the
+ * CPU device so the exposure and scale setup happens once per row, and with
+ * SSE all four channels of a pixel are mapped in a single pass. */
+
+ccl_device void kernel_film_convert_to_byte_row(KernelGlobals *kg,
+	uchar4 *rgba, float *buffer,
+	float sample_scale, int x, int y, int w, int offset, int stride)
+{
+	/* buffer offset */
+	int index = offset + x + y*stride;
+	int pass_stride = kernel_data.film.pass_stride;
+
+	rgba += index;
+	buffer += index*pass_stride;
+
+#ifdef __KERNEL_SSE2__
+	float exposure_scale = kernel_data.film.exposure*sample_scale;
+	const ssef scale = ssef(exposure_scale, exposure_scale, exposure_scale, sample_scale);
+	const sseb alpha_mask = sseb(false, false, false, true);
+
+	for(int i = 0; i < w; i++, buffer += pass_stride) {
+		ssef irradiance = load4f(buffer) * scale;
+
+		/* conversion to srgb, alpha is only clamped */
+		ssef result = select(alpha_mask,
+			min(max(irradiance, ssef(0.0f)), ssef(1.0f)),
+			color_scene_linear_to_srgb_clamped(irradiance));
+
+		/* truncate like film_float_to_byte, then pack 4x int32 into 4x uint8 */
+		__m128i ri = _mm_cvttps_epi32(result * ssef(255.0f));
+		ri = _mm_packs_epi32(ri, ri);
+		ri = _mm_packus_epi16(ri, ri);
+
+		*(int*)(rgba + i) = _mm_cvtsi128_si32(ri);
+	}
+#else
+	for(int i = 0; i < w; i++, buffer += pass_stride) {
+		float4 irradiance = *((float4*)buffer);
+		float4 float_result = film_map(kg, irradiance, sample_scale);
+		rgba[i] = film_float_to_byte(float_result);
+	}
+#endif
+}
+
+ccl_device void kernel_film_convert_to_half_float_row(KernelGlobals *kg,
+	uchar4 *rgba, float *buffer,
+	float sample_scale, int x, int y, int w, int offset, int stride)
+{
+	/* buffer offset */
+	int index = offset + x + y*stride;
+	int pass_stride = kernel_data.film.pass_stride;
+
+	float4 *in = (float4*)(buffer + index*pass_stride);
+	half *out = (half*)rgba + index*4;
+
+	float exposure = kernel_data.film.exposure;
+
+	if(exposure == 1.0f) {
+		for(int i = 0; i < w; i++, out += 4) {
+			float4_store_half(out, *in, sample_scale);
+			in = (float4*)((float*)in + pass_stride);
+		}
+	}
+	else {
+		for(int i = 0; i < w; i++, out += 4) {
+			float4 rgba_in = *in;
+
+			rgba_in.x *= exposure;
+			rgba_in.y *= exposure;
+			rgba_in.z *= exposure;
+
+			float4_store_half(out, rgba_in, sample_scale);
+			in = (float4*)((float*)in + pass_stride);
+		}
+	}
+}
+
+#endif
+
 CCL_NAMESPACE_END
 
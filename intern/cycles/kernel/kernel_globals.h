@@ -52,6 +52,15 @@ typedef struct KernelGlobals {
 	OSLThreadData *osl_tdata;
 #endif
 
+	/* Per thread storage for transparent shadow intersections when they do
+	 * not fit on the stack, allocated on first use and freed by the device. */
+	Intersection *transparent_shadow_intersections;
+
+	/* Last opaque primitive that blocked a shadow ray in this thread, tested
+	 * first since neighbouring shadow rays are often blocked by the same
+	 * primitive. PRIM_NONE when empty. */
+	int shadow_occluder_prim;
+
 } KernelGlobals;
 
 #endif
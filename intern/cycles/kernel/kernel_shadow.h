@@ -37,7 +37,8 @@ CCL_NAMESPACE_BEGIN
  * two rays with transparent shadows.
  *
  * This is CPU only because of qsort, and malloc or high stack space usage to
- * record all these intersections. */
+ * record all these intersections. The same applies to the last occluder cache,
+ * which needs per thread storage in KernelGlobals. */
 
 ccl_device_noinline int shadow_intersections_compare(const void *a, const void *b)
 {
@@ -53,6 +54,64 @@ ccl_device_noinline int shadow_intersections_compare(const void *a, const void *
 }
 
 #define STACK_MAX_HITS 64
+#define SORT_MAX_INSERTION 16
+
+/* Sort hits front to back. Usually there are only a few, for which an
+ * insertion sort is faster than going through qsort. */
+ccl_device_inline void shadow_intersections_sort(Intersection *hits, uint num_hits)
+{
+	if(num_hits > SORT_MAX_INSERTION) {
+		qsort(hits, num_hits, sizeof(Intersection), shadow_intersections_compare);
+		return;
+	}
+
+	for(uint i = 1; i < num_hits; i++) {
+		Intersection isect = hits[i];
+		uint j = i;
+
+		for(; j > 0 && hits[j-1].t > isect.t; j--)
+			hits[j] = hits[j-1];
+
+		hits[j] = isect;
+	}
+}
+
+/* Last occluder cache. Shadow rays from neighbouring pixels towards the same
+ * light are often blocked by the same primitive, so we test the primitive
+ * that blocked the previous shadow ray in this thread before traversing the
+ * BVH. Only triangles stored in world space are cached, instanced or moving
+ * triangles would need the object transform or ray time. */
+
+ccl_device_inline bool shadow_occluder_cache_test(KernelGlobals *kg, const Ray *ray, uint visibility)
+{
+	int prim = kg->shadow_occluder_prim;
+
+	if(prim == PRIM_NONE)
+		return false;
+
+	Intersection isect;
+	isect.t = ray->t;
+
+	return triangle_intersect(kg, &isect, ray->P, ray->D, visibility, OBJECT_NONE, prim);
+}
+
+ccl_device_inline void shadow_occluder_cache_store(KernelGlobals *kg, const Intersection *isect)
+{
+	if(isect->object != OBJECT_NONE || isect->type != PRIMITIVE_TRIANGLE)
+		return;
+
+	/* only surfaces without transparent shadows block all light */
+	if(kernel_data.integrator.transparent_shadows) {
+		int prim = kernel_tex_fetch(__prim_index, isect->prim);
+		int shader = kernel_tex_fetch(__tri_shader, prim);
+		int flag = kernel_tex_fetch(__shader_flag, (shader & SHADER_MASK)*2);
+
+		if(flag & SD_HAS_TRANSPARENT_SHADOW)
+			return;
+	}
+
+	kg->shadow_occluder_prim = isect->prim;
+}
 
 ccl_device_inline bool shadow_blocked(KernelGlobals *kg, PathState *state, Ray *ray, float3 *shadow)
 {
@@ -69,21 +128,34 @@ ccl_device_inline bool shadow_blocked(KernelGlobals *kg, PathState *state, Ray *
 		if(state->transparent_bounce >= kernel_data.integrator.transparent_max_bounce)
 			return true;
 
+		if(shadow_occluder_cache_test(kg, ray, PATH_RAY_SHADOW))
+			return true;
+
 		/* intersect to find an opaque surface, or record all transparent surface hits */
 		Intersection hits_stack[STACK_MAX_HITS];
 		Intersection *hits = hits_stack;
 		uint max_hits = kernel_data.integrator.transparent_max_bounce - state->transparent_bounce - 1;
 
-		/* prefer to use stack but use dynamic allocation if too deep max hits
+		/* prefer to use stack but use per thread storage if too deep max hits
 		 * we need max_hits + 1 storage space due to the logic in
 		 * scene_intersect_shadow_all which will first store and then check if
 		 * the limit is exceeded */
-		if(max_hits + 1 > STACK_MAX_HITS)
-			hits = (Intersection*)malloc(sizeof(Intersection)*(max_hits + 1));
+		if(max_hits + 1 > STACK_MAX_HITS) {
+			if(kg->transparent_shadow_intersections == NULL) {
+				kg->transparent_shadow_intersections =
+					(Intersection*)malloc(sizeof(Intersection)*kernel_data.integrator.transparent_max_bounce);
+			}
+
+			hits = kg->transparent_shadow_intersections;
+		}
 
 		uint num_hits;
 		blocked = scene_intersect_shadow_all(kg, ray, hits, max_hits, &num_hits);
 
+		/* the blocking hit is stored after the recorded transparent hits */
+		if(blocked)
+			shadow_occluder_cache_store(kg, &hits[num_hits]);
+
 		/* if no opaque surface found but we did find transparent hits, shade them */
 		if(!blocked && num_hits > 0) {
 			float3 throughput = make_float3(1.0f, 1.0f, 1.0f);
@@ -95,7 +167,7 @@ ccl_device_inline bool shadow_blocked(KernelGlobals *kg, PathState *state, Ray *
 			PathState ps = *state;
 #endif
 
-			qsort(hits, num_hits, sizeof(Intersection), shadow_intersections_compare);
+			shadow_intersections_sort(hits, num_hits);
 
 			for(int hit = 0; hit < num_hits; hit++, isect++) {
 				/* adjust intersection distance for moving ray forward */
@@ -129,12 +201,8 @@ ccl_device_inline bool shadow_blocked(KernelGlobals *kg, PathState *state, Ray *
 				}
 
 				/* stop if all light is blocked */
-				if(is_zero(throughput)) {
-					/* free dynamic storage */
-					if(hits != hits_stack)
-						free(hits);
+				if(is_zero(throughput))
 					return true;
-				}
 
 				/* move ray forward */
 				ray->P = sd.P;
@@ -157,18 +225,18 @@ ccl_device_inline bool shadow_blocked(KernelGlobals *kg, PathState *state, Ray *
 
 			*shadow = throughput;
 
-			if(hits != hits_stack)
-				free(hits);
 			return is_zero(throughput);
 		}
-
-		/* free dynamic storage */
-		if(hits != hits_stack)
-			free(hits);
 	}
 	else {
+		if(shadow_occluder_cache_test(kg, ray, PATH_RAY_SHADOW_OPAQUE))
+			return true;
+
 		Intersection isect;
 		blocked = scene_intersect(kg, ray, PATH_RAY_SHADOW_OPAQUE, &isect, NULL, 0.0f, 0.0f);
+
+		if(blocked)
+			shadow_occluder_cache_store(kg, &isect);
 	}
 
 #ifdef __VOLUME__
@@ -182,6 +250,7 @@ ccl_device_inline bool shadow_blocked(KernelGlobals *kg, PathState *state, Ray *
 }
 
 #undef STACK_MAX_HITS
+#undef SORT_MAX_INSERTION
 
 #else
 
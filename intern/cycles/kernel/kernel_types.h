@@ -955,8 +955,9 @@ typedef struct KernelBVH {
 	int have_motion;
 	int have_curves;
 	int have_instancing;
+	int have_time_splits;
 
-	int pad1, pad2, pad3;
+	int pad1, pad2;
 } KernelBVH;
 
 typedef enum CurveFlag {
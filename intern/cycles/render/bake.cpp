@@ -170,6 +170,9 @@ bool BakeManager::bake(Device *device, DeviceScene *dscene, Scene *scene, Progre
 		/* needs to be up to data for attribute access */
 		device->const_copy_to("__data", &dscene->data, sizeof(dscene->data));
 
+		d_input.name = "shader_eval_input bake";
+		d_output.name = "shader_eval_output bake";
+
 		device->mem_alloc(d_input, MEM_READ_ONLY);
 		device->mem_copy_to(d_input);
 		device->mem_alloc(d_output, MEM_WRITE_ONLY);
@@ -129,6 +129,7 @@ void RenderBuffers::reset(Device *device, BufferParams& params_)
 	
 	/* allocate buffer */
 	buffer.resize(params.width*params.height*params.get_passes_size());
+	buffer.name = "render_buffer";
 	device->mem_alloc(buffer, MEM_READ_WRITE);
 	device->mem_zero(buffer);
 
@@ -142,6 +143,7 @@ void RenderBuffers::reset(Device *device, BufferParams& params_)
 		for(y = 0; y < height; y++)
 			init_state[x + y*width] = hash_int_2d(params.full_x+x, params.full_y+y);
 
+	rng_state.name = "rng_state";
 	device->mem_alloc(rng_state, MEM_READ_WRITE);
 	device->mem_copy_to(rng_state);
 }
@@ -350,10 +352,12 @@ void DisplayBuffer::reset(Device *device, BufferParams& params_)
 	/* allocate display pixels */
 	if(half_float) {
 		rgba_half.resize(params.width, params.height);
+		rgba_half.name = "display_buffer";
 		device->pixels_alloc(rgba_half);
 	}
 	else {
 		rgba_byte.resize(params.width, params.height);
+		rgba_byte.name = "display_buffer";
 		device->pixels_alloc(rgba_byte);
 	}
 }
@@ -33,6 +33,7 @@ ImageManager::ImageManager()
 {
 	need_update = true;
 	pack_images = false;
+	pack_reserved = 0;
 	osl_texture_system = NULL;
 	animation_frame = 0;
 
@@ -612,6 +613,77 @@ bool ImageManager::file_load_float_image(Image *img, device_vector<float4>& tex_
 	return true;
 }
 
+/* Halve the resolution of a 2D image with a box filter, used to fit images in
+ * the device memory budget. C is the component type of the pixel type T. */
+template<typename T, typename C>
+static void image_downscale_half(device_vector<T>& tex_img, float rounding)
+{
+	int width = tex_img.data_width;
+	int height = tex_img.data_height;
+	int new_width = max(width/2, 1);
+	int new_height = max(height/2, 1);
+
+	vector<T> pixels(tex_img.size());
+	memcpy(&pixels[0], (void*)tex_img.data_pointer, tex_img.memory_size());
+
+	C *in = (C*)&pixels[0];
+	C *out = (C*)tex_img.resize(new_width, new_height);
+
+	for(int y = 0; y < new_height; y++) {
+		int y0 = min(y*2, height - 1), y1 = min(y*2 + 1, height - 1);
+
+		for(int x = 0; x < new_width; x++) {
+			int x0 = min(x*2, width - 1), x1 = min(x*2 + 1, width - 1);
+
+			for(int c = 0; c < 4; c++) {
+				float sum = (float)in[(x0 + y0*width)*4 + c] + (float)in[(x1 + y0*width)*4 + c] +
+				            (float)in[(x0 + y1*width)*4 + c] + (float)in[(x1 + y1*width)*4 + c];
+				out[(x + y*new_width)*4 + c] = (C)(sum*0.25f + rounding);
+			}
+		}
+	}
+}
+
+/* While loading the image would exceed the device memory budget, halve its
+ * resolution, then allocate it. Only 2D images are handled, 3D textures are
+ * left as is. Images load in parallel, so the budget check and the allocation
+ * happen under the same lock. When images are packed they are allocated later
+ * in one texture, then their size is added to pack_reserved instead. */
+template<typename T, typename C>
+static void image_fit_budget_alloc(Device *device, thread_mutex& device_mutex, size_t *pack_reserved,
+                                   device_vector<T>& tex_img, const string& name, InterpolationType interpolation,
+                                   const string& filename, Progress *progress, float rounding)
+{
+	size_t width = tex_img.data_width;
+
+	while(true) {
+		{
+			thread_scoped_lock device_lock(device_mutex);
+
+			size_t reserved = (pack_reserved)? *pack_reserved: 0;
+			bool fits = (tex_img.data_depth > 1) ||
+			            (tex_img.data_width <= 1 && tex_img.data_height <= 1) ||
+			            !device->stats.mem_over_budget(reserved + tex_img.memory_size());
+
+			if(fits) {
+				if(pack_reserved)
+					*pack_reserved += tex_img.memory_size();
+				else
+					device->tex_alloc(name.c_str(), tex_img, interpolation, true);
+				break;
+			}
+		}
+
+		/* downscale outside of the lock, other images can load meanwhile */
+		image_downscale_half<T, C>(tex_img, rounding);
+	}
+
+	if(tex_img.data_width != width) {
+		progress->set_status("Updating Images", string_printf("Downscaled %s to %dx%d to fit memory budget",
+			filename.c_str(), (int)tex_img.data_width, (int)tex_img.data_height));
+	}
+}
+
 void ImageManager::device_load_image(Device *device, DeviceScene *dscene, int slot, Progress *progress)
 {
 	if(progress->get_cancel())
@@ -659,10 +731,11 @@ void ImageManager::device_load_image(Device *device, DeviceScene *dscene, int sl
 		else if(slot >= 10) name = string_printf("__tex_image_float_0%d", slot);
 		else name = string_printf("__tex_image_float_00%d", slot);
 
-		if(!pack_images) {
-			thread_scoped_lock device_lock(device_mutex);
-			device->tex_alloc(name.c_str(), tex_img, img->interpolation, true);
-		}
+		/* name memory statistics after the image file */
+		tex_img.name = name + " " + filename;
+
+		image_fit_budget_alloc<float4, float>(device, device_mutex, (pack_images)? &pack_reserved: NULL,
+			tex_img, name, img->interpolation, filename, progress, 0.0f);
 	}
 	else {
 		string filename = path_filename(images[slot - tex_image_byte_start]->filename);
@@ -691,10 +764,11 @@ void ImageManager::device_load_image(Device *device, DeviceScene *dscene, int sl
 		else if(slot >= 10) name = string_printf("__tex_image_0%d", slot);
 		else name = string_printf("__tex_image_00%d", slot);
 
-		if(!pack_images) {
-			thread_scoped_lock device_lock(device_mutex);
-			device->tex_alloc(name.c_str(), tex_img, img->interpolation, true);
-		}
+		/* name memory statistics after the image file */
+		tex_img.name = name + " " + filename;
+
+		image_fit_budget_alloc<uchar4, uchar>(device, device_mutex, (pack_images)? &pack_reserved: NULL,
+			tex_img, name, img->interpolation, filename, progress, 0.5f);
 	}
 
 	img->need_load = false;
@@ -757,6 +831,8 @@ void ImageManager::device_update(Device *device, DeviceScene *dscene, Progress&
 
 	TaskPool pool;
 
+	pack_reserved = 0;
+
 	for(size_t slot = 0; slot < images.size(); slot++) {
 		if(!images[slot])
 			continue;
@@ -101,6 +101,8 @@ private:
 	vector<Image*> float_images;
 	void *osl_texture_system;
 	bool pack_images;
+	/* size of images loaded for packing in this update, protected by device_mutex */
+	size_t pack_reserved;
 
 	bool file_load_image(Image *img, device_vector<uchar4>& tex_img);
 	bool file_load_float_image(Image *img, device_vector<float4>& tex_img);
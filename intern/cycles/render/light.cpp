@@ -56,6 +56,9 @@ static void shade_background_pixels(Device *device, DeviceScene *dscene, int res
 
 	device->const_copy_to("__data", &dscene->data, sizeof(dscene->data));
 
+	d_input.name = "shader_eval_input background";
+	d_output.name = "shader_eval_output background";
+
 	device->mem_alloc(d_input, MEM_READ_ONLY);
 	device->mem_copy_to(d_input);
 	device->mem_alloc(d_output, MEM_WRITE_ONLY);
@@ -32,6 +32,7 @@
 #include "util_foreach.h"
 #include "util_progress.h"
 #include "util_set.h"
+#include "util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -512,6 +513,7 @@ void Mesh::compute_bvh(SceneParams *params, Progress *progress, int n, int total
 			BVHParams bparams;
 			bparams.use_cache = params->use_bvh_cache;
 			bparams.use_spatial_split = params->use_bvh_spatial_split;
+			bparams.use_temporal_split = params->use_bvh_temporal_split && !params->use_qbvh;
 			bparams.use_qbvh = params->use_qbvh;
 
 			delete bvh;
@@ -555,6 +557,7 @@ MeshManager::MeshManager()
 {
 	bvh = NULL;
 	need_update = true;
+	bvh_build_time = 0.0;
 }
 
 MeshManager::~MeshManager()
@@ -984,6 +987,7 @@ void MeshManager::device_update_bvh(Device *device, DeviceScene *dscene, Scene *
 	bparams.top_level = true;
 	bparams.use_qbvh = scene->params.use_qbvh;
 	bparams.use_spatial_split = scene->params.use_bvh_spatial_split;
+	bparams.use_temporal_split = scene->params.use_bvh_temporal_split && !scene->params.use_qbvh;
 	bparams.use_cache = scene->params.use_bvh_cache;
 
 	delete bvh;
@@ -1001,6 +1005,10 @@ void MeshManager::device_update_bvh(Device *device, DeviceScene *dscene, Scene *
 		dscene->bvh_nodes.reference((float4*)&pack.nodes[0], pack.nodes.size());
 		device->tex_alloc("__bvh_nodes", dscene->bvh_nodes);
 	}
+	if(pack.node_times.size()) {
+		dscene->bvh_node_times.reference(&pack.node_times[0], pack.node_times.size());
+		device->tex_alloc("__bvh_node_times", dscene->bvh_node_times);
+	}
 	if(pack.object_node.size()) {
 		dscene->object_node.reference((uint*)&pack.object_node[0], pack.object_node.size());
 		device->tex_alloc("__object_node", dscene->object_node);
@@ -1027,13 +1035,17 @@ void MeshManager::device_update_bvh(Device *device, DeviceScene *dscene, Scene *
 	}
 
 	dscene->data.bvh.root = pack.root_index;
+	dscene->data.bvh.have_time_splits = (pack.node_times.size() != 0);
 }
 
 void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress)
 {
+	/* keep the build time of the last update when nothing changed */
 	if(!need_update)
 		return;
 
+	bvh_build_time = 0.0;
+
 	/* update normals and flags */
 	foreach(Mesh *mesh, scene->meshes) {
 		mesh->has_volume = false;
@@ -1084,6 +1096,7 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 	}
 
 	/* update bvh */
+	double bvh_start = time_dt();
 	size_t i = 0, num_bvh = 0;
 
 	foreach(Mesh *mesh, scene->meshes)
@@ -1120,12 +1133,15 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 
 	device_update_bvh(device, dscene, scene, progress);
 
+	bvh_build_time = time_dt() - bvh_start;
+
 	need_update = false;
 }
 
 void MeshManager::device_free(Device *device, DeviceScene *dscene)
 {
 	device->tex_free(dscene->bvh_nodes);
+	device->tex_free(dscene->bvh_node_times);
 	device->tex_free(dscene->object_node);
 	device->tex_free(dscene->tri_woop);
 	device->tex_free(dscene->prim_type);
@@ -1144,6 +1160,7 @@ void MeshManager::device_free(Device *device, DeviceScene *dscene)
 	device->tex_free(dscene->attributes_uchar4);
 
 	dscene->bvh_nodes.clear();
+	dscene->bvh_node_times.clear();
 	dscene->object_node.clear();
 	dscene->tri_woop.clear();
 	dscene->prim_type.clear();
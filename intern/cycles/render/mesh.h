@@ -146,6 +146,9 @@ public:
 
 	bool need_update;
 
+	/* time in seconds spent building mesh and scene BVHs in the last update */
+	double bvh_build_time;
+
 	MeshManager();
 	~MeshManager();
 
@@ -35,6 +35,7 @@
 
 #include "util_foreach.h"
 #include "util_progress.h"
+#include "util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -148,86 +149,146 @@ void Scene::device_update(Device *device_, Progress& progress)
 	 * - Lookup tables are done a second time to handle film tables
 	 */
 	
+	update_times.clear();
+	double stage_start = time_dt();
+
 	image_manager->set_pack_images(device->info.pack_images);
 
 	progress.set_status("Updating Shaders");
 	shader_manager->device_update(device, &dscene, this, progress);
+	update_stage_done("shaders", stage_start);
 
 	if(progress.get_cancel()) return;
 
 	progress.set_status("Updating Images");
 	image_manager->device_update(device, &dscene, progress);
+	update_stage_done("images", stage_start);
 
 	if(progress.get_cancel()) return;
 
 	progress.set_status("Updating Background");
 	background->device_update(device, &dscene, this);
+	update_stage_done("background", stage_start);
 
 	if(progress.get_cancel()) return;
 
 	progress.set_status("Updating Objects");
 	object_manager->device_update(device, &dscene, this, progress);
+	update_stage_done("objects", stage_start);
 
 	if(progress.get_cancel()) return;
 
 	progress.set_status("Updating Meshes");
 	mesh_manager->device_update(device, &dscene, this, progress);
+	update_stage_done("meshes", stage_start);
 
 	if(progress.get_cancel()) return;
 
 	progress.set_status("Updating Objects Flags");
 	object_manager->device_update_flags(device, &dscene, this, progress);
+	update_stage_done("object_flags", stage_start);
 
 	if(progress.get_cancel()) return;
 
 	progress.set_status("Updating Hair Systems");
 	curve_system_manager->device_update(device, &dscene, this, progress);
+	update_stage_done("hair", stage_start);
 
 	if(progress.get_cancel()) return;
 
 	progress.set_status("Updating Lookup Tables");
 	lookup_tables->device_update(device, &dscene);
+	update_stage_done("tables", stage_start);
 
 	if(progress.get_cancel()) return;
 
 	/* TODO(sergey): Make sure camera is not needed above. */
 	progress.set_status("Updating Camera");
 	camera->device_update(device, &dscene, this);
+	update_stage_done("camera", stage_start);
 
 	if(progress.get_cancel()) return;
 
 	progress.set_status("Updating Lights");
 	light_manager->device_update(device, &dscene, this, progress);
+	update_stage_done("lights", stage_start);
 
 	if(progress.get_cancel()) return;
 
 	progress.set_status("Updating Particle Systems");
 	particle_system_manager->device_update(device, &dscene, this, progress);
+	update_stage_done("particles", stage_start);
 
 	if(progress.get_cancel()) return;
 
 	progress.set_status("Updating Film");
 	film->device_update(device, &dscene, this);
+	update_stage_done("film", stage_start);
 
 	if(progress.get_cancel()) return;
 
 	progress.set_status("Updating Integrator");
 	integrator->device_update(device, &dscene, this);
+	update_stage_done("integrator", stage_start);
 
 	if(progress.get_cancel()) return;
 
 	progress.set_status("Updating Lookup Tables");
 	lookup_tables->device_update(device, &dscene);
+	update_stage_done("tables", stage_start);
 
 	if(progress.get_cancel()) return;
 
 	progress.set_status("Updating Baking");
 	bake_manager->device_update(device, &dscene, this, progress);
+	update_stage_done("baking", stage_start);
 
 	if(progress.get_cancel()) return;
 
 	progress.set_status("Updating Device", "Writing constant memory");
 	device->const_copy_to("__data", &dscene.data, sizeof(dscene.data));
+	update_stage_done("device", stage_start);
+}
+
+void Scene::update_stage_done(const char *name, double& stage_start)
+{
+	double stage_end = time_dt();
+	update_times.add(name, stage_end - stage_start);
+	stage_start = stage_end;
+}
+
+/* Scene Update Times */
+
+void SceneUpdateTimes::add(const string& name, double time)
+{
+	/* stages that run more than once accumulate */
+	for(size_t i = 0; i < stages.size(); i++) {
+		if(stages[i].first == name) {
+			stages[i].second += time;
+			return;
+		}
+	}
+
+	stages.push_back(std::make_pair(name, time));
+}
+
+double SceneUpdateTimes::get(const string& name) const
+{
+	for(size_t i = 0; i < stages.size(); i++)
+		if(stages[i].first == name)
+			return stages[i].second;
+
+	return 0.0;
+}
+
+double SceneUpdateTimes::total() const
+{
+	double time = 0.0;
+
+	for(size_t i = 0; i < stages.size(); i++)
+		time += stages[i].second;
+
+	return time;
 }
 
 Scene::MotionType Scene::need_motion(bool advanced_shading)
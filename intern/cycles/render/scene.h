@@ -17,6 +17,8 @@
 #ifndef __SCENE_H__
 #define __SCENE_H__
 
+#include <utility>
+
 #include "image.h"
 #include "shader.h"
 
@@ -61,6 +63,7 @@ class DeviceScene {
 public:
 	/* BVH */
 	device_vector<float4> bvh_nodes;
+	device_vector<float4> bvh_node_times;
 	device_vector<uint> object_node;
 	device_vector<float4> tri_woop;
 	device_vector<uint> prim_type;
@@ -126,6 +129,7 @@ public:
 	enum BVHType { BVH_DYNAMIC, BVH_STATIC } bvh_type;
 	bool use_bvh_cache;
 	bool use_bvh_spatial_split;
+	bool use_bvh_temporal_split;
 	bool use_qbvh;
 	bool persistent_data;
 
@@ -135,6 +139,7 @@ public:
 		bvh_type = BVH_DYNAMIC;
 		use_bvh_cache = false;
 		use_bvh_spatial_split = false;
+		use_bvh_temporal_split = false;
 #ifdef __QBVH__
 		use_qbvh = true;
 #else
@@ -148,10 +153,26 @@ public:
 		&& bvh_type == params.bvh_type
 		&& use_bvh_cache == params.use_bvh_cache
 		&& use_bvh_spatial_split == params.use_bvh_spatial_split
+		&& use_bvh_temporal_split == params.use_bvh_temporal_split
 		&& use_qbvh == params.use_qbvh
 		&& persistent_data == params.persistent_data); }
 };
 
+/* Scene Update Times
+ *
+ * Time in seconds spent in each stage of the last device update, in the
+ * order the stages ran. Used for statistics and benchmark reports. */
+
+class SceneUpdateTimes {
+public:
+	vector<std::pair<string, double> > stages;
+
+	void clear() { stages.clear(); }
+	void add(const string& name, double time);
+	double get(const string& name) const;
+	double total() const;
+};
+
 /* Scene */
 
 class Scene {
@@ -193,6 +214,9 @@ public:
 	/* parameters */
 	SceneParams params;
 
+	/* statistics */
+	SceneUpdateTimes update_times;
+
 	/* mutex must be locked manually by callers */
 	thread_mutex mutex;
 
@@ -215,6 +239,7 @@ public:
 
 protected:
 	void free_memory(bool final);
+	void update_stage_done(const char *name, double& stage_start);
 };
 
 CCL_NAMESPACE_END
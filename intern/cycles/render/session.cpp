@@ -49,6 +49,8 @@ Session::Session(const SessionParams& params_)
 
 	TaskScheduler::init(params.threads);
 
+	stats.mem_budget = params.memory_budget;
+
 	device = Device::create(params.device, stats, params.background);
 
 	if(params.background && params.output_path.empty()) {
@@ -77,6 +79,8 @@ Session::Session(const SessionParams& params_)
 	gpu_need_tonemap = false;
 	pause = false;
 	kernels_loaded = false;
+
+	tonemap_dirty_clear();
 }
 
 Session::~Session()
@@ -103,7 +107,7 @@ Session::~Session()
 
 		display = new DisplayBuffer(device, false);
 		display->reset(device, buffers->params);
-		tonemap(params.samples);
+		tonemap(params.samples, true);
 
 		progress.set_status("Writing Image", params.output_path);
 		display->write(device, params.output_path);
@@ -453,6 +457,14 @@ void Session::release_tile(RenderTile& rtile)
 {
 	thread_scoped_lock tile_lock(tile_mutex);
 
+	/* remember which part of the display buffer needs to be converted */
+	if(rtile.buffers == buffers) {
+		tonemap_dirty.x = min(tonemap_dirty.x, rtile.x);
+		tonemap_dirty.y = min(tonemap_dirty.y, rtile.y);
+		tonemap_dirty.z = max(tonemap_dirty.z, rtile.x + rtile.w);
+		tonemap_dirty.w = max(tonemap_dirty.w, rtile.y + rtile.h);
+	}
+
 	if(write_render_tile_cb) {
 		if(params.progressive_refine == false) {
 			/* todo: optimize this by making it thread safe and removing lock */
@@ -660,6 +672,11 @@ void Session::reset_(BufferParams& buffer_params, int samples)
 
 	tile_manager.reset(buffer_params, samples);
 
+	{
+		thread_scoped_lock tile_lock(tile_mutex);
+		tonemap_dirty_full();
+	}
+
 	start_time = time_dt();
 	preview_time = 0.0;
 	paused_time = 0.0;
@@ -762,6 +779,19 @@ void Session::update_scene()
 	if(scene->need_update()) {
 		progress.set_status("Updating Scene");
 		scene->device_update(device, progress);
+
+		/* images are downscaled to fit, if the scene still does not fit
+		 * we stop here rather than failing later on the device */
+		if(stats.mem_over_budget() && !progress.get_cancel()) {
+			string message = string_printf("Scene needs %.2fM of device memory, budget is %.2fM (%s)",
+				(double)stats.mem_used / (1024.0 * 1024.0),
+				(double)stats.mem_budget / (1024.0 * 1024.0),
+				stats.mem_summary().c_str());
+
+			progress.set_cancel(message);
+			progress.set_status("Error", message);
+			progress.set_update();
+		}
 	}
 }
 
@@ -854,15 +884,51 @@ void Session::path_trace()
 	device->task_add(task);
 }
 
-void Session::tonemap(int sample)
+void Session::tonemap_dirty_clear()
 {
+	tonemap_dirty = make_int4(INT_MAX, INT_MAX, INT_MIN, INT_MIN);
+}
+
+void Session::tonemap_dirty_full()
+{
+	/* clipped to the buffer in tonemap() */
+	tonemap_dirty = make_int4(INT_MIN, INT_MIN, INT_MAX, INT_MAX);
+}
+
+void Session::tonemap(int sample, bool full_frame)
+{
+	/* display updates only convert the tiles that were rendered since the last
+	 * update, clipped to the current buffer since the resolution may have changed.
+	 * full_frame is for writing the final image, the dirty region may already have
+	 * been consumed by the display then */
+	int4 dirty;
+
+	{
+		thread_scoped_lock tile_lock(tile_mutex);
+		dirty = tonemap_dirty;
+		tonemap_dirty_clear();
+	}
+
+	if(full_frame)
+		dirty = make_int4(INT_MIN, INT_MIN, INT_MAX, INT_MAX);
+
+	int full_x = tile_manager.state.buffer.full_x;
+	int full_y = tile_manager.state.buffer.full_y;
+	int full_w = tile_manager.state.buffer.width;
+	int full_h = tile_manager.state.buffer.height;
+
+	int x0 = max(dirty.x, full_x);
+	int y0 = max(dirty.y, full_y);
+	int x1 = min(dirty.z, full_x + full_w);
+	int y1 = min(dirty.w, full_y + full_h);
+
 	/* add tonemap task */
 	DeviceTask task(DeviceTask::FILM_CONVERT);
 
-	task.x = tile_manager.state.buffer.full_x;
-	task.y = tile_manager.state.buffer.full_y;
-	task.w = tile_manager.state.buffer.width;
-	task.h = tile_manager.state.buffer.height;
+	task.x = x0;
+	task.y = y0;
+	task.w = x1 - x0;
+	task.h = y1 - y0;
 	task.rgba_byte = display->rgba_byte.device_pointer;
 	task.rgba_half = display->rgba_half.device_pointer;
 	task.buffer = buffers->buffer.device_pointer;
@@ -872,9 +938,11 @@ void Session::tonemap(int sample)
 	if(task.w > 0 && task.h > 0) {
 		device->task_add(task);
 		device->task_wait();
+	}
 
+	if(full_w > 0 && full_h > 0) {
 		/* set display to new size */
-		display->draw_set(task.w, task.h);
+		display->draw_set(full_w, full_h);
 	}
 
 	display_outdated = false;
@@ -56,6 +56,9 @@ public:
 
 	bool display_buffer_linear;
 
+	/* device memory budget in bytes, 0 for no limit */
+	size_t memory_budget;
+
 	double cancel_timeout;
 	double reset_timeout;
 	double text_timeout;
@@ -77,6 +80,8 @@ public:
 
 		display_buffer_linear = false;
 
+		memory_budget = 0;
+
 		cancel_timeout = 0.1;
 		reset_timeout = 0.1;
 		text_timeout = 1.0;
@@ -98,6 +103,7 @@ public:
 		&& start_resolution == params.start_resolution
 		&& threads == params.threads
 		&& display_buffer_linear == params.display_buffer_linear
+		&& memory_budget == params.memory_budget
 		&& cancel_timeout == params.cancel_timeout
 		&& reset_timeout == params.reset_timeout
 		&& text_timeout == params.text_timeout
@@ -154,7 +160,9 @@ protected:
 
 	void update_status_time(bool show_pause = false, bool show_done = false);
 
-	void tonemap(int sample);
+	void tonemap(int sample, bool full_frame = false);
+	void tonemap_dirty_clear();
+	void tonemap_dirty_full();
 	void path_trace();
 	void reset_(BufferParams& params, int samples);
 
@@ -189,6 +197,10 @@ protected:
 	thread_mutex buffers_mutex;
 	thread_mutex display_mutex;
 
+	/* bounds of tiles written to the display buffer since the last tonemap,
+	 * as (min x, min y, max x, max y), protected by tile_mutex */
+	int4 tonemap_dirty;
+
 	bool kernels_loaded;
 
 	double start_time;
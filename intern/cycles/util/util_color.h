@@ -222,6 +222,38 @@ ccl_device ssef color_srgb_to_scene_linear(const ssef &c)
 	ssef gte = fastpow24(gtebase);
 	return select(cmp, lt, gte);
 }
+
+/* Calculate powf(x, 1/2.4). Working domain: 0.0031308 <= x <= 1.0, which is
+ * all we need for display conversion since the result gets clamped to 1.0.
+ * The initial guess interprets the float bits as a scaled log2, then three
+ * Newton iterations on y^12 = x^5 bring the error below 1e-5. */
+ccl_device_inline ssef fastpow_inv24(const ssef &arg)
+{
+	const ssei one = ssei(0x3F800000);
+	ssef y = cast(ssei(ssef(cast(arg) - one) * ssef(5.0f/12.0f)) + one);
+
+	ssef arg2 = arg * arg;
+	ssef arg5 = arg2 * arg2 * arg;
+
+	for(int i = 0; i < 3; i++) {
+		ssef y2 = y * y;
+		ssef y4 = y2 * y2;
+		ssef y11 = y4 * y4 * y2 * y;
+		y = madd(ssef(11.0f/12.0f), y, arg5 / (y11 * ssef(12.0f)));
+	}
+
+	return y;
+}
+
+/* Values above 1.0 are clamped, the output is meant for display only. */
+ccl_device ssef color_scene_linear_to_srgb_clamped(const ssef &c)
+{
+	ssef cc = min(c, ssef(1.0f));
+	sseb cmp = cc < ssef(0.0031308f);
+	ssef lt = max(cc * ssef(12.92f), ssef(0.0f));
+	ssef gte = madd(ssef(1.055f), fastpow_inv24(max(cc, ssef(0.0031308f))), ssef(-0.055f));
+	return select(c >= ssef(1.0f), ssef(1.0f), select(cmp, lt, gte));
+}
 #endif
 
 ccl_device float3 color_scene_linear_to_srgb(float3 c)
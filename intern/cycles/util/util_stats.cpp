@@ -0,0 +1,148 @@
+/*
+ * Copyright 2011-2013 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License
+ */
+
+#include <algorithm>
+#include <functional>
+#include <string.h>
+
+#include "util_foreach.h"
+#include "util_stats.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Categories are found from the name prefix, which is the kernel texture name
+ * or a name given by the owner of the memory. */
+
+static const struct {
+	const char *prefix;
+	const char *category;
+} stats_categories[] = {
+	{"__bvh", "BVH"},
+	{"__object_node", "BVH"},
+	{"__tri_woop", "BVH"},
+	{"__prim_", "BVH"},
+	{"__tri_", "Geometry"},
+	{"__curve", "Geometry"},
+	{"__attributes", "Attributes"},
+	{"__tex_image", "Images"},
+	{"__objects", "Objects"},
+	{"__light", "Lights"},
+	{"__svm", "Shaders"},
+	{"__shader", "Shaders"},
+	{"__lookup", "Tables"},
+	{"__sobol", "Tables"},
+	{"render_buffer", "Render Buffers"},
+	{"rng_state", "Render Buffers"},
+	{"display_buffer", "Display"},
+	{"shader_eval", "Shader Evaluation"},
+	{NULL, NULL}
+};
+
+static const char *stats_category(const string& name)
+{
+	for(int i = 0; stats_categories[i].prefix; i++)
+		if(name.compare(0, strlen(stats_categories[i].prefix), stats_categories[i].prefix) == 0)
+			return stats_categories[i].category;
+
+	return "Other";
+}
+
+static string stats_mb(size_t size)
+{
+	return string_printf("%.2fM", (double)size / (1024.0 * 1024.0));
+}
+
+void Stats::mem_categories(vector<pair<size_t, string> >& categories)
+{
+	thread_scoped_lock lock(mutex);
+	mem_categories_locked(categories);
+}
+
+void Stats::mem_categories_locked(vector<pair<size_t, string> >& categories)
+{
+	map<string, size_t> sizes;
+
+	for(map<string, size_t>::iterator it = mem_named.begin(); it != mem_named.end(); it++)
+		sizes[stats_category(it->first)] += it->second;
+
+	categories.clear();
+
+	for(map<string, size_t>::iterator it = sizes.begin(); it != sizes.end(); it++)
+		categories.push_back(pair<size_t, string>(it->second, it->first));
+
+	std::sort(categories.begin(), categories.end(), std::greater<pair<size_t, string> >());
+}
+
+string Stats::mem_report()
+{
+	thread_scoped_lock lock(mutex);
+
+	vector<pair<size_t, string> > categories;
+	mem_categories_locked(categories);
+
+	string report = string_printf("Memory: %s used, %s peak",
+		stats_mb(mem_used).c_str(), stats_mb(mem_peak).c_str());
+
+	if(mem_budget)
+		report += string_printf(", %s budget", stats_mb(mem_budget).c_str());
+
+	report += "\n";
+
+	for(size_t i = 0; i < categories.size(); i++) {
+		const string& category = categories[i].second;
+
+		report += string_printf("  %-20s %s\n", category.c_str(),
+			stats_mb(categories[i].first).c_str());
+
+		/* individual allocations in this category, largest first */
+		vector<pair<size_t, string> > names;
+
+		for(map<string, size_t>::iterator it = mem_named.begin(); it != mem_named.end(); it++)
+			if(category == stats_category(it->first))
+				names.push_back(pair<size_t, string>(it->second, it->first));
+
+		std::sort(names.begin(), names.end(), std::greater<pair<size_t, string> >());
+
+		for(size_t j = 0; j < names.size(); j++) {
+			const char *name = names[j].second.empty()? "(unnamed)": names[j].second.c_str();
+			report += string_printf("    %-40s %s\n", name, stats_mb(names[j].first).c_str());
+		}
+	}
+
+	return report;
+}
+
+string Stats::mem_summary()
+{
+	thread_scoped_lock lock(mutex);
+
+	vector<pair<size_t, string> > categories;
+	mem_categories_locked(categories);
+
+	string summary;
+
+	for(size_t i = 0; i < categories.size() && i < 3; i++) {
+		if(i > 0)
+			summary += ", ";
+
+		summary += categories[i].second + " " + stats_mb(categories[i].first);
+	}
+
+	return summary;
+}
+
+CCL_NAMESPACE_END
+
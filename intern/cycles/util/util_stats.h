@@ -17,25 +17,75 @@
 #ifndef __UTIL_STATS_H__
 #define __UTIL_STATS_H__
 
+#include "util_map.h"
+#include "util_string.h"
+#include "util_thread.h"
+#include "util_vector.h"
+
 CCL_NAMESPACE_BEGIN
 
+/* Device memory statistics
+ *
+ * Allocations are tracked per name, which is the kernel texture name for
+ * scene data, or a name given by the owner of the memory, for example the
+ * image file for image textures. Names are grouped into categories like BVH,
+ * geometry or images for the memory report. */
+
 class Stats {
 public:
-	Stats() : mem_used(0), mem_peak(0) {}
+	Stats() : mem_used(0), mem_peak(0), mem_budget(0) {}
+
+	void mem_alloc(size_t size, const string& name = "") {
+		thread_scoped_lock lock(mutex);
 
-	void mem_alloc(size_t size) {
 		mem_used += size;
 		if(mem_used > mem_peak)
 			mem_peak = mem_used;
+
+		mem_named[name] += size;
 	}
 
-	void mem_free(size_t size) {
+	void mem_free(size_t size, const string& name = "") {
+		thread_scoped_lock lock(mutex);
+
 		assert(mem_used >= size);
 		mem_used -= size;
+
+		map<string, size_t>::iterator it = mem_named.find(name);
+
+		if(it != mem_named.end()) {
+			assert(it->second >= size);
+			it->second -= size;
+
+			if(it->second == 0)
+				mem_named.erase(it);
+		}
+	}
+
+	/* true when a budget is set and the given additional size would exceed it */
+	bool mem_over_budget(size_t size = 0) {
+		thread_scoped_lock lock(mutex);
+		return (mem_budget != 0) && (mem_used + size > mem_budget);
 	}
 
+	/* memory usage per category, largest first */
+	void mem_categories(vector<pair<size_t, string> >& categories);
+	/* memory usage per category and name, largest first */
+	string mem_report();
+	/* one line summary with the largest categories */
+	string mem_summary();
+
 	size_t mem_used;
 	size_t mem_peak;
+
+	/* optional budget in bytes, 0 for no limit */
+	size_t mem_budget;
+
+protected:
+	void mem_categories_locked(vector<pair<size_t, string> >& categories);
+
+	map<string, size_t> mem_named;
+	thread_mutex mutex;
 };
 
 CCL_NAMESPACE_END
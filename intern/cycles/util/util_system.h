@@ -30,6 +30,9 @@ bool system_cpu_support_sse41();
 bool system_cpu_support_avx();
 bool system_cpu_support_avx2();
 
+/* Peak resident memory of the process in bytes, or 0 if not available */
+size_t system_process_peak_memory();
+
 CCL_NAMESPACE_END
 
 #endif /* __UTIL_SYSTEM_H__ */
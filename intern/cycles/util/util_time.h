@@ -27,6 +27,26 @@ double time_dt();
 
 void time_sleep(double t);
 
+/* Store the time elapsed between construction and destruction in value. */
+
+class scoped_timer {
+public:
+	scoped_timer(double *value_) : value(value_)
+	{
+		time_start = time_dt();
+	}
+
+	~scoped_timer()
+	{
+		if(value)
+			*value = time_dt() - time_start;
+	}
+
+protected:
+	double *value;
+	double time_start;
+};
+
 CCL_NAMESPACE_END
 
 #endif
@@ -407,6 +407,8 @@ class NODE_PT_quality(bpy.types.Panel):
         col.prop(tree, "render_quality", text="Render")
         col.prop(tree, "edit_quality", text="Edit")
         col.prop(tree, "chunk_size")
+        col.prop(tree, "result_cache_limit")
+        col.prop(tree, "buffer_memory_limit")
 
         col = layout.column()
         col.prop(tree, "use_opencl")
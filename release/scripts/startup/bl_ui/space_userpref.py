@@ -473,6 +473,7 @@ class USERPREF_PT_system(Panel):
         col.label(text="Sequencer / Clip Editor:")
         col.prop(system, "prefetch_frames")
         col.prop(system, "memory_cache_limit")
+        col.prop(system, "disk_cache_limit")
 
         # 3. Column
         column = split.column()
@@ -880,6 +881,7 @@ class USERPREF_PT_file(Panel):
         sub.label(text="Sounds:")
         sub.label(text="Temp:")
         sub.label(text="Render Cache:")
+        sub.label(text="Frame Cache:")
         sub.label(text="I18n Branches:")
         sub.label(text="Image Editor:")
         sub.label(text="Animation Player:")
@@ -892,6 +894,7 @@ class USERPREF_PT_file(Panel):
         sub.prop(paths, "sound_directory", text="")
         sub.prop(paths, "temporary_directory", text="")
         sub.prop(paths, "render_cache_directory", text="")
+        sub.prop(paths, "disk_cache_directory", text="")
         sub.prop(paths, "i18n_branches_directory", text="")
         sub.prop(paths, "image_editor", text="")
         subsplit = sub.split(percentage=0.3)
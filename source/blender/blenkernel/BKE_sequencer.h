@@ -46,6 +46,7 @@ struct StripElem;
 struct bSound;
 
 struct SeqIndexBuildContext;
+struct GSet;
 
 #define EARLY_NO_INPUT      -1
 #define EARLY_DO_EFFECT     0
@@ -174,10 +175,22 @@ struct SeqEffectHandle {
  * ********************************************************************** */
 
 struct ImBuf *BKE_sequencer_give_ibuf(const SeqRenderData *context, float cfra, int chanshown);
-struct ImBuf *BKE_sequencer_give_ibuf_threaded(const SeqRenderData *context, float cfra, int chanshown);
+struct ImBuf *BKE_sequencer_give_ibuf_cached(const SeqRenderData *context, float cfra, int chanshown);
 struct ImBuf *BKE_sequencer_give_ibuf_direct(const SeqRenderData *context, float cfra, struct Sequence *seq);
 struct ImBuf *BKE_sequencer_give_ibuf_seqbase(const SeqRenderData *context, float cfra, int chan_shown, struct ListBase *seqbasep);
-void BKE_sequencer_give_ibuf_prefetch_request(const SeqRenderData *context, float cfra, int chan_shown);
+
+/* **********************************************************************
+ * seqprefetch.c
+ *
+ * Render the frames after the current frame into the cache in the background
+ * ********************************************************************** */
+
+struct ImBuf *BKE_sequencer_give_ibuf_threaded(const SeqRenderData *context, float cfra, int chanshown);
+void BKE_sequencer_prefetch_start(const SeqRenderData *context, float cfra, int chanshown);
+void BKE_sequencer_prefetch_stop(void);
+void BKE_sequencer_prefetch_idle_begin(void);
+void BKE_sequencer_prefetch_idle_end(void);
+void BKE_sequencer_prefetch_free(void);
 
 /* **********************************************************************
  * sequencer.c
@@ -229,14 +242,17 @@ void BKE_sequence_reload_new_file(struct Scene *scene, struct Sequence *seq, con
 int BKE_sequencer_evaluate_frame(struct Scene *scene, int cfra);
 
 struct StripElem *BKE_sequencer_give_stripelem(struct Sequence *seq, int cfra);
+float BKE_sequencer_give_stripelem_index(struct Sequence *seq, float cfra);
 
 /* intern */
 void BKE_sequencer_update_changed_seq_and_deps(struct Scene *scene, struct Sequence *changed_seq, int len_change, int ibuf_change);
 bool BKE_sequencer_input_have_to_preprocess(const SeqRenderData *context, struct Sequence *seq, float cfra);
 
-struct SeqIndexBuildContext *BKE_sequencer_proxy_rebuild_context(struct Main *bmain, struct Scene *scene, struct Sequence *seq);
+struct SeqIndexBuildContext *BKE_sequencer_proxy_rebuild_context(struct Main *bmain, struct Scene *scene, struct Sequence *seq,
+                                                                  struct GSet *file_list);
 void BKE_sequencer_proxy_rebuild(struct SeqIndexBuildContext *context, short *stop, short *do_update, float *progress);
 void BKE_sequencer_proxy_rebuild_finish(struct SeqIndexBuildContext *context, bool stop);
+void BKE_sequencer_proxy_rebuild_batch(struct ListBase *contexts, short *stop, short *do_update, float *progress);
 
 /* **********************************************************************
  * seqcache.c
@@ -287,6 +303,8 @@ struct SeqEffectHandle BKE_sequence_get_effect(struct Sequence *seq);
 int BKE_sequence_effect_get_num_inputs(int seq_type);
 int BKE_sequence_effect_get_supports_mask(int seq_type);
 
+void BKE_sequencer_blend_effects_benchmark(int width, int height, int iterations);
+
 /* **********************************************************************
  * Sequencer editing functions
  * **********************************************************************
@@ -310,6 +328,7 @@ struct Sequence *BKE_sequence_metastrip(ListBase *seqbase /* = ed->seqbase */, s
 
 void BKE_sequencer_offset_animdata(struct Scene *scene, struct Sequence *seq, int ofs);
 void BKE_sequencer_dupe_animdata(struct Scene *scene, const char *name_src, const char *name_dst);
+bool BKE_sequencer_has_animdata(struct Scene *scene, struct Sequence *seq);
 bool BKE_sequence_base_shuffle(struct ListBase *seqbasep, struct Sequence *test, struct Scene *evil_scene);
 bool BKE_sequence_base_shuffle_time(ListBase *seqbasep, struct Scene *evil_scene);
 bool BKE_sequence_base_isolated_sel_check(struct ListBase *seqbase);
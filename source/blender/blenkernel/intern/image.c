@@ -2366,6 +2366,46 @@ RenderPass *BKE_image_multilayer_index(RenderResult *rr, ImageUser *iuser)
 	return rpass;
 }
 
+/* multilayer files on disk are opened without reading pixels (see image_load_multilayer_lazy),
+ * passes are read from the file when they're accessed first */
+static bool image_multilayer_pass_ensure(Image *ima, RenderLayer *rl, RenderPass *rpass)
+{
+	bool predivide = (ima->alpha_mode == IMA_ALPHA_PREMUL);
+
+	if (rpass->rect)
+		return true;
+
+	if (rl == NULL) {
+		for (rl = ima->rr->layers.first; rl; rl = rl->next) {
+			if (BLI_findindex(&rl->passes, rpass) != -1)
+				break;
+		}
+	}
+
+	if (rl == NULL)
+		return false;
+
+	return RE_MultilayerPassRead(ima->rr, rl, rpass, ima->colorspace_settings.name, predivide);
+}
+
+/* read all passes which were not accessed yet, for when the whole render result is needed */
+void BKE_image_multilayer_ensure_passes(Image *ima)
+{
+	RenderLayer *rl;
+	RenderPass *rpass;
+
+	BLI_spin_lock(&image_spin);
+
+	if (ima->rr) {
+		for (rl = ima->rr->layers.first; rl; rl = rl->next) {
+			for (rpass = rl->passes.first; rpass; rpass = rpass->next)
+				image_multilayer_pass_ensure(ima, rl, rpass);
+		}
+	}
+
+	BLI_spin_unlock(&image_spin);
+}
+
 RenderResult *BKE_image_acquire_renderresult(Scene *scene, Image *ima)
 {
 	if (ima->rr) {
@@ -2430,6 +2470,37 @@ static void image_create_multilayer(Image *ima, ImBuf *ibuf, int framenr)
 		ima->rr->framenr = framenr;
 }
 
+#ifdef WITH_OPENEXR
+/* open multilayer file without reading any pixels, so only passes which are
+ * actually used get read, instead of decoding all of them on load */
+static bool image_load_multilayer_lazy(Image *ima, const char *filepath, int framenr)
+{
+	const char *colorspace = ima->colorspace_settings.name;
+	bool predivide = (ima->alpha_mode == IMA_ALPHA_PREMUL);
+	void *exrhandle;
+	int width, height;
+
+	if (IMB_ispic_type(filepath) != OPENEXR)
+		return false;
+
+	exrhandle = IMB_exr_get_handle();
+
+	if (!IMB_exr_begin_read_lazy(exrhandle, filepath, &width, &height)) {
+		IMB_exr_close(exrhandle);
+		return false;
+	}
+
+	ima->rr = RE_MultilayerConvert(exrhandle, colorspace, predivide, width, height);
+
+	/* render result keeps the handle until it's freed, passes are read from the file on demand */
+	ima->rr->exrhandle = exrhandle;
+	ima->rr->framenr = framenr;
+	ima->type = IMA_TYPE_MULTILAYER;
+
+	return true;
+}
+#endif
+
 /* common stuff to do with images after loading */
 static void image_initialize_after_load(Image *ima, ImBuf *ibuf)
 {
@@ -2477,6 +2548,15 @@ static ImBuf *image_load_sequence_file(Image *ima, ImageUser *iuser, int frame)
 	flag = IB_rect | IB_multilayer;
 	flag |= imbuf_alpha_flags_for_image(ima);
 
+#ifdef WITH_OPENEXR
+	if (image_load_multilayer_lazy(ima, name, frame)) {
+		if (iuser)
+			iuser->ok = ima->ok;
+
+		return NULL;
+	}
+#endif
+
 	/* read ibuf */
 	ibuf = IMB_loadiffname(name, flag, ima->colorspace_settings.name);
 
@@ -2544,7 +2624,7 @@ static ImBuf *image_load_sequence_multilayer(Image *ima, ImageUser *iuser, int f
 	if (ima->rr) {
 		RenderPass *rpass = BKE_image_multilayer_index(ima->rr, iuser);
 
-		if (rpass) {
+		if (rpass && image_multilayer_pass_ensure(ima, NULL, rpass)) {
 			// printf("load from pass %s\n", rpass->name);
 			/* since we free  render results, we copy the rect */
 			ibuf = IMB_allocImBuf(ima->rr->rectx, ima->rr->recty, 32, 0);
@@ -2643,6 +2723,15 @@ static ImBuf *image_load_image_file(Image *ima, ImageUser *iuser, int cfra)
 		BKE_image_user_frame_calc(iuser, cfra, 0);
 		BKE_image_user_file_path(iuser, ima, str);
 
+#ifdef WITH_OPENEXR
+		if (image_load_multilayer_lazy(ima, str, cfra)) {
+			if (iuser)
+				iuser->ok = ima->ok;
+
+			return NULL;
+		}
+#endif
+
 		/* read ibuf */
 		ibuf = IMB_loadiffname(str, flag, ima->colorspace_settings.name);
 	}
@@ -2693,7 +2782,7 @@ static ImBuf *image_get_ibuf_multilayer(Image *ima, ImageUser *iuser)
 	if (ima->rr) {
 		RenderPass *rpass = BKE_image_multilayer_index(ima->rr, iuser);
 
-		if (rpass) {
+		if (rpass && image_multilayer_pass_ensure(ima, NULL, rpass)) {
 			ibuf = IMB_allocImBuf(ima->rr->rectx, ima->rr->recty, 32, 0);
 
 			image_initialize_after_load(ima, ibuf);
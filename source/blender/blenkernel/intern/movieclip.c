@@ -55,6 +55,7 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_dynstr.h"
 #include "BLI_ghash.h"
 #include "BLI_math.h"
 #include "BLI_threads.h"
@@ -389,6 +390,36 @@ static int user_frame_to_cache_frame(MovieClip *clip, int framenr)
 	return framenr;
 }
 
+/* frames are described by the file they are read from and the clip settings used to read them */
+static bool moviecache_disk_key(void *userkey, void *userdata, DynStr *key)
+{
+	MovieClipImBufCacheKey *cache_key = (MovieClipImBufCacheKey *)userkey;
+	MovieClip *clip = (MovieClip *)userdata;
+	char name[FILE_MAX];
+
+	if (clip->source == MCLIP_SRC_SEQUENCE) {
+		get_sequence_fname(clip, cache_key->framenr, name);
+	}
+	else {
+		BLI_strncpy(name, clip->name, sizeof(name));
+		BLI_path_abs(name, ID_BLEND_PATH(G.main, &clip->id));
+	}
+
+	if (!IMB_moviecache_disk_key_file(key, name))
+		return false;
+
+	BLI_dynstr_appendf(key, "%d %d %d %d %d %d %s|",
+	                   clip->source, cache_key->framenr, clip->start_frame, clip->frame_offset,
+	                   cache_key->proxy, cache_key->render_flag, clip->colorspace_settings.name);
+
+	if (clip->flag & MCLIP_USE_PROXY) {
+		BLI_dynstr_appendf(key, "proxy %d %d %s|", clip->proxy.tc, clip->proxy.quality,
+		                   (clip->flag & MCLIP_USE_PROXY_CUSTOM_DIR) ? clip->proxy.dir : "");
+	}
+
+	return true;
+}
+
 static void moviecache_keydata(void *userkey, int *framenr, int *proxy, int *render_flags)
 {
 	MovieClipImBufCacheKey *key = (MovieClipImBufCacheKey *)userkey;
@@ -503,6 +534,7 @@ static bool put_imbuf_cache(MovieClip *clip, MovieClipUser *user, ImBuf *ibuf, i
 		IMB_moviecache_set_getdata_callback(moviecache, moviecache_keydata);
 		IMB_moviecache_set_priority_callback(moviecache, moviecache_getprioritydata, moviecache_getitempriority,
 		                                     moviecache_prioritydeleter);
+		IMB_moviecache_set_disk_callback(moviecache, moviecache_disk_key, clip);
 
 		clip->cache->moviecache = moviecache;
 		clip->cache->sequence_offset = -1;
@@ -32,16 +32,25 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "DNA_color_types.h"
+#include "DNA_scene_types.h"
 #include "DNA_sequence_types.h"
 
 #include "IMB_moviecache.h"
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 
+#include "BLI_dynstr.h"
 #include "BLI_listbase.h"
+#include "BLI_path_util.h"
+#include "BLI_threads.h"
 
+#include "BKE_main.h"
 #include "BKE_sequencer.h"
 
+/* strips nested deeper than this are only cached in memory */
+#define SEQCACHE_DISK_KEY_MAX_DEPTH 16
+
 typedef struct SeqCacheKey {
 	struct Sequence *seq;
 	SeqRenderData context;
@@ -65,6 +74,8 @@ typedef struct SeqPreprocessCache {
 } SeqPreprocessCache;
 
 static struct MovieCache *moviecache = NULL;
+/* the prefetch thread uses the cache while it is read for drawing */
+static ThreadMutex cache_lock = BLI_MUTEX_INITIALIZER;
 static struct SeqPreprocessCache *preprocess_cache = NULL;
 
 static void preprocessed_cache_destruct(void);
@@ -116,8 +127,253 @@ static bool seqcache_hashcmp(const void *a_, const void *b_)
 	        seq_cmp_render_data(&a->context, &b->context));
 }
 
+static bool seqcache_disk_key_strip(const SeqRenderData *context, Sequence *seq, float cfra, DynStr *key, int depth);
+
+static void seqcache_disk_key_curve_mapping(DynStr *key, const CurveMapping *cumap)
+{
+	int i, j;
+
+	BLI_dynstr_appendf(key, "curves %d %.9g %.9g %.9g %.9g %.9g %.9g|", cumap->flag,
+	                   cumap->black[0], cumap->black[1], cumap->black[2],
+	                   cumap->white[0], cumap->white[1], cumap->white[2]);
+
+	for (i = 0; i < CM_TOT; i++) {
+		const CurveMap *cuma = &cumap->cm[i];
+
+		BLI_dynstr_appendf(key, "%d %.9g %.9g %.9g %.9g", cuma->flag,
+		                   cuma->ext_in[0], cuma->ext_in[1], cuma->ext_out[0], cuma->ext_out[1]);
+
+		for (j = 0; j < cuma->totpoint; j++) {
+			BLI_dynstr_appendf(key, " %.9g %.9g %d", cuma->curve[j].x, cuma->curve[j].y, cuma->curve[j].flag);
+		}
+
+		BLI_dynstr_append(key, "|");
+	}
+}
+
+static bool seqcache_disk_key_modifiers(const SeqRenderData *context, Sequence *seq, float cfra, DynStr *key, int depth)
+{
+	SequenceModifierData *smd;
+
+	for (smd = seq->modifiers.first; smd; smd = smd->next) {
+		if (smd->flag & SEQUENCE_MODIFIER_MUTE)
+			continue;
+
+		BLI_dynstr_appendf(key, "modifier %d %d|", smd->type, smd->mask_input_type);
+
+		switch (smd->type) {
+			case seqModifierType_ColorBalance:
+			{
+				ColorBalanceModifierData *cbmd = (ColorBalanceModifierData *) smd;
+				StripColorBalance *cb = &cbmd->color_balance;
+
+				BLI_dynstr_appendf(key, "%.9g %.9g %.9g %.9g %.9g %.9g %.9g %.9g %.9g %d %.9g|",
+				                   cb->lift[0], cb->lift[1], cb->lift[2],
+				                   cb->gamma[0], cb->gamma[1], cb->gamma[2],
+				                   cb->gain[0], cb->gain[1], cb->gain[2],
+				                   cb->flag, cbmd->color_multiply);
+				break;
+			}
+			case seqModifierType_Curves:
+				seqcache_disk_key_curve_mapping(key, &((CurvesModifierData *) smd)->curve_mapping);
+				break;
+			case seqModifierType_HueCorrect:
+				seqcache_disk_key_curve_mapping(key, &((HueCorrectModifierData *) smd)->curve_mapping);
+				break;
+			case seqModifierType_BrightContrast:
+			{
+				BrightContrastModifierData *bcmd = (BrightContrastModifierData *) smd;
+
+				BLI_dynstr_appendf(key, "%.9g %.9g|", bcmd->bright, bcmd->contrast);
+				break;
+			}
+			case seqModifierType_Mask:
+				break;
+			default:
+				return false;
+		}
+
+		if (smd->mask_input_type == SEQUENCE_MASK_INPUT_STRIP) {
+			if (smd->mask_sequence && !seqcache_disk_key_strip(context, smd->mask_sequence, cfra, key, depth + 1))
+				return false;
+		}
+		else if (smd->mask_id) {
+			/* masks are evaluated from their animation, like mask strips */
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool seqcache_disk_key_strip(const SeqRenderData *context, Sequence *seq, float cfra, DynStr *key, int depth)
+{
+	Strip *strip = seq->strip;
+	char name[FILE_MAX];
+	float nr;
+
+	if (depth > SEQCACHE_DISK_KEY_MAX_DEPTH)
+		return false;
+
+	/* scene, clip and mask strips render data that isn't described here, speed, multicam and
+	 * adjustment strips depend on the strips around them */
+	if (ELEM(seq->type, SEQ_TYPE_SCENE, SEQ_TYPE_MOVIECLIP, SEQ_TYPE_MASK,
+	         SEQ_TYPE_SPEED, SEQ_TYPE_MULTICAM, SEQ_TYPE_ADJUSTMENT))
+	{
+		return false;
+	}
+
+	/* the settings of animated strips are evaluated for the current frame only */
+	if (BKE_sequencer_has_animdata(context->scene, seq))
+		return false;
+
+	/* frames are relative to the strip, moving it in time keeps its frames */
+	BLI_dynstr_appendf(key, "strip %d %.9g %d %d %d %d %d %d %d %d|",
+	                   seq->type, cfra - seq->start, seq->len, seq->startofs, seq->endofs,
+	                   seq->startstill, seq->endstill, seq->anim_startofs, seq->anim_endofs,
+	                   seq->flag & ~(SEQ_ALLSEL | SEQ_OVERLAP | SEQ_LOCK));
+	BLI_dynstr_appendf(key, "%.9g %.9g %.9g %.9g %d %.9g %d|",
+	                   seq->sat, seq->mul, seq->strobe, seq->effect_fader,
+	                   seq->blend_mode, seq->blend_opacity, seq->alpha_mode);
+
+	if (strip) {
+		BLI_dynstr_appendf(key, "%s|", strip->colorspace_settings.name);
+
+		if ((seq->flag & SEQ_USE_CROP) && strip->crop) {
+			BLI_dynstr_appendf(key, "crop %d %d %d %d|",
+			                   strip->crop->top, strip->crop->bottom, strip->crop->left, strip->crop->right);
+		}
+		if ((seq->flag & SEQ_USE_TRANSFORM) && strip->transform) {
+			BLI_dynstr_appendf(key, "transform %d %d|", strip->transform->xofs, strip->transform->yofs);
+		}
+		if ((seq->flag & SEQ_USE_PROXY) && strip->proxy) {
+			BLI_dynstr_appendf(key, "proxy %d %d %s %s|",
+			                   strip->proxy->tc, strip->proxy->quality, strip->proxy->dir, strip->proxy->file);
+		}
+	}
+
+	nr = BKE_sequencer_give_stripelem_index(seq, cfra);
+
+	if (seq->type & SEQ_TYPE_EFFECT) {
+		Sequence *inputs[3] = {seq->seq1, seq->seq2, seq->seq3};
+		int i;
+
+		if (seq->effectdata) {
+			const unsigned char *data = seq->effectdata;
+			size_t len = MEM_allocN_len(seq->effectdata);
+
+			BLI_dynstr_append(key, "effect ");
+			while (len--) {
+				BLI_dynstr_appendf(key, "%02x", *data++);
+			}
+			BLI_dynstr_append(key, "|");
+		}
+
+		for (i = 0; i < 3; i++) {
+			if (inputs[i] && !seqcache_disk_key_strip(context, inputs[i], seq->start + nr, key, depth + 1))
+				return false;
+		}
+	}
+	else if (seq->type == SEQ_TYPE_IMAGE) {
+		StripElem *s_elem = BKE_sequencer_give_stripelem(seq, cfra);
+
+		if (s_elem) {
+			BLI_join_dirfile(name, sizeof(name), strip->dir, s_elem->name);
+			BLI_path_abs(name, context->bmain->name);
+
+			if (!IMB_moviecache_disk_key_file(key, name))
+				return false;
+		}
+	}
+	else if (seq->type == SEQ_TYPE_MOVIE) {
+		if (strip == NULL || strip->stripdata == NULL)
+			return false;
+
+		BLI_join_dirfile(name, sizeof(name), strip->dir, strip->stripdata->name);
+		BLI_path_abs(name, context->bmain->name);
+
+		if (!IMB_moviecache_disk_key_file(key, name))
+			return false;
+
+		BLI_dynstr_appendf(key, "%d %d|", seq->streamindex, seq->anim_preseek);
+	}
+	else if (seq->type == SEQ_TYPE_META) {
+		const float meta_cfra = seq->start + nr;
+		Sequence *child;
+
+		for (child = seq->seqbase.first; child; child = child->next) {
+			if ((child->flag & SEQ_MUTE) || child->startdisp > meta_cfra || child->enddisp <= meta_cfra)
+				continue;
+
+			BLI_dynstr_appendf(key, "channel %d|", child->machine);
+
+			if (!seqcache_disk_key_strip(context, child, meta_cfra, key, depth + 1))
+				return false;
+		}
+
+		BLI_dynstr_append(key, "end|");
+	}
+
+	return seqcache_disk_key_modifiers(context, seq, cfra, key, depth);
+}
+
+/* describe the strip and for composited frames all strips below it */
+static bool seqcache_disk_key(void *userkey, void *UNUSED(userdata), DynStr *key)
+{
+	SeqCacheKey *cache_key = (SeqCacheKey *) userkey;
+	const SeqRenderData *context = &cache_key->context;
+	Scene *scene = context->scene;
+	Sequence *seq = cache_key->seq;
+	const float cfra = cache_key->cfra + seq->start;
+
+	if (scene->ed == NULL)
+		return false;
+
+	BLI_dynstr_appendf(key, "%d %d %d %d %.9g %d %d %s|",
+	                   context->rectx, context->recty, context->preview_render_size,
+	                   context->motion_blur_samples, context->motion_blur_shutter, context->is_proxy_render,
+	                   scene->r.mode & R_FIELDS, scene->sequencer_colorspace_settings.name);
+	BLI_dynstr_appendf(key, "type %d|", cache_key->type);
+
+	if (cache_key->type == SEQ_STRIPELEM_IBUF_COMP) {
+		ListBase *seqbase = BKE_sequence_seqbase(&scene->ed->seqbase, seq);
+		Sequence *iseq;
+
+		if (seqbase == NULL)
+			return false;
+
+		for (iseq = seqbase->first; iseq; iseq = iseq->next) {
+			if ((iseq->flag & SEQ_MUTE) || iseq->machine > seq->machine ||
+			    iseq->startdisp > cfra || iseq->enddisp <= cfra)
+			{
+				continue;
+			}
+
+			BLI_dynstr_appendf(key, "channel %d|", iseq->machine);
+
+			if (!seqcache_disk_key_strip(context, iseq, cfra, key, 0))
+				return false;
+		}
+
+		return true;
+	}
+
+	return seqcache_disk_key_strip(context, seq, cfra, key, 0);
+}
+
+static struct MovieCache *seqcache_create(void)
+{
+	struct MovieCache *cache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
+
+	IMB_moviecache_set_disk_callback(cache, seqcache_disk_key, NULL);
+
+	return cache;
+}
+
 void BKE_sequencer_cache_destruct(void)
 {
+	BKE_sequencer_prefetch_free();
+
 	if (moviecache)
 		IMB_moviecache_free(moviecache);
 
@@ -126,10 +382,14 @@ void BKE_sequencer_cache_destruct(void)
 
 void BKE_sequencer_cache_cleanup(void)
 {
+	BKE_sequencer_prefetch_stop();
+
+	BLI_mutex_lock(&cache_lock);
 	if (moviecache) {
 		IMB_moviecache_free(moviecache);
-		moviecache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
+		moviecache = seqcache_create();
 	}
+	BLI_mutex_unlock(&cache_lock);
 
 	BKE_sequencer_preprocessed_cache_cleanup();
 }
@@ -144,12 +404,17 @@ static bool seqcache_key_check_seq(ImBuf *UNUSED(ibuf), void *userkey, void *use
 
 void BKE_sequencer_cache_cleanup_sequence(Sequence *seq)
 {
+	BLI_mutex_lock(&cache_lock);
 	if (moviecache)
 		IMB_moviecache_cleanup(moviecache, seqcache_key_check_seq, seq);
+	BLI_mutex_unlock(&cache_lock);
 }
 
 struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context, Sequence *seq, float cfra, seq_stripelem_ibuf_t type)
 {
+	ImBuf *ibuf = NULL;
+
+	BLI_mutex_lock(&cache_lock);
 	if (moviecache && seq) {
 		SeqCacheKey key;
 
@@ -158,10 +423,11 @@ struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context, Sequence *se
 		key.cfra = cfra - seq->start;
 		key.type = type;
 
-		return IMB_moviecache_get(moviecache, &key);
+		ibuf = IMB_moviecache_get(moviecache, &key);
 	}
+	BLI_mutex_unlock(&cache_lock);
 
-	return NULL;
+	return ibuf;
 }
 
 void BKE_sequencer_cache_put(const SeqRenderData *context, Sequence *seq, float cfra, seq_stripelem_ibuf_t type, ImBuf *i)
@@ -172,16 +438,18 @@ void BKE_sequencer_cache_put(const SeqRenderData *context, Sequence *seq, float
 		return;
 	}
 
-	if (!moviecache) {
-		moviecache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
-	}
-
 	key.seq = seq;
 	key.context = *context;
 	key.cfra = cfra - seq->start;
 	key.type = type;
 
+	BLI_mutex_lock(&cache_lock);
+	if (!moviecache) {
+		moviecache = seqcache_create();
+	}
+
 	IMB_moviecache_put(moviecache, &key, i);
+	BLI_mutex_unlock(&cache_lock);
 }
 
 void BKE_sequencer_preprocessed_cache_cleanup(void)
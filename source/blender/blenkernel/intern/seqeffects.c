@@ -37,6 +37,8 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_math.h" /* windows needs for M_PI */
+#include "BLI_rand.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_scene_types.h"
@@ -52,10 +54,11 @@
 
 #include "RNA_access.h"
 
-/* TODO(sergey): Could be considered a bad level call, but
- * need this for gaussian table.
- */
-#include "RE_pipeline.h"
+#include "PIL_time.h"
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
 
 static void slice_get_byte_buffers(const SeqRenderData *context, const ImBuf *ibuf1, const ImBuf *ibuf2,
                                    const ImBuf *ibuf3, const ImBuf *out, int start_line, unsigned char **rect1,
@@ -147,6 +150,140 @@ static ImBuf *prepare_effect_imbufs(const SeqRenderData *context, ImBuf *ibuf1,
 	return out;
 }
 
+/*********************** Blend kernels *************************/
+
+/* Blend effects are implemented as a pair of row kernels, one for byte and one
+ * for float buffers, which are run over the slice by do_blend_effect(). Rows
+ * alternate between facf0 and facf1 so field rendering keeps working.
+ *
+ * With SSE2 float pixels are processed as one vector each, byte kernels which
+ * are doing pure integer math process four pixels at once. Results are the same
+ * as the scalar code which is still used for the remaining pixels of a row.
+ */
+
+typedef void (*SeqBlendByteRowFn)(const unsigned char *rect1, const unsigned char *rect2, unsigned char *out,
+                                  int width, float fac);
+typedef void (*SeqBlendFloatRowFn)(const float *rect1, const float *rect2, float *out, int width, float fac);
+
+typedef struct SeqBlendKernel {
+	const char *name;
+	SeqBlendByteRowFn byte_row;
+	SeqBlendFloatRowFn float_row;
+} SeqBlendKernel;
+
+static void blend_effect_byte(const SeqBlendKernel *kernel, float facf0, float facf1, int x, int y,
+                              const unsigned char *rect1, const unsigned char *rect2, unsigned char *out)
+{
+	int i;
+
+	for (i = 0; i < y; i++) {
+		kernel->byte_row(rect1, rect2, out, x, (i & 1) ? facf1 : facf0);
+
+		rect1 += 4 * x;
+		rect2 += 4 * x;
+		out += 4 * x;
+	}
+}
+
+static void blend_effect_float(const SeqBlendKernel *kernel, float facf0, float facf1, int x, int y,
+                               const float *rect1, const float *rect2, float *out)
+{
+	int i;
+
+	for (i = 0; i < y; i++) {
+		kernel->float_row(rect1, rect2, out, x, (i & 1) ? facf1 : facf0);
+
+		rect1 += 4 * x;
+		rect2 += 4 * x;
+		out += 4 * x;
+	}
+}
+
+static void do_blend_effect(const SeqBlendKernel *kernel, const SeqRenderData *context, float facf0, float facf1,
+                            ImBuf *ibuf1, ImBuf *ibuf2, int start_line, int total_lines, ImBuf *out)
+{
+	if (out->rect_float) {
+		float *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
+
+		slice_get_float_buffers(context, ibuf1, ibuf2, NULL, out, start_line, &rect1, &rect2, NULL, &rect_out);
+
+		blend_effect_float(kernel, facf0, facf1, context->rectx, total_lines, rect1, rect2, rect_out);
+	}
+	else {
+		unsigned char *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
+
+		slice_get_byte_buffers(context, ibuf1, ibuf2, NULL, out, start_line, &rect1, &rect2, NULL, &rect_out);
+
+		blend_effect_byte(kernel, facf0, facf1, context->rectx, total_lines, rect1, rect2, rect_out);
+	}
+}
+
+#ifdef __SSE2__
+
+/* mask selecting the alpha channel of a float pixel */
+#define SSE_ALPHA_MASK_PS _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0))
+/* mask selecting the alpha bytes of four byte pixels */
+#define SSE_ALPHA_MASK_EPI8 _mm_set1_epi32((int)0xff000000)
+
+BLI_INLINE __m128 sse_select_ps(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+BLI_INLINE __m128i sse_select_si128(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+BLI_INLINE __m128 sse_splat_alpha(__m128 color)
+{
+	return _mm_shuffle_ps(color, color, _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+/* same as straight_uchar_to_premul_float() */
+BLI_INLINE __m128 sse_straight_uchar_to_premul_float(const unsigned char color[4])
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i icolor;
+	__m128 fcolor, alpha, fac;
+	int packed;
+
+	memcpy(&packed, color, sizeof(packed));
+	icolor = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+	fcolor = _mm_cvtepi32_ps(icolor);
+
+	alpha = _mm_mul_ps(sse_splat_alpha(fcolor), _mm_set1_ps(1.0f / 255.0f));
+	fac = _mm_mul_ps(alpha, _mm_set1_ps(1.0f / 255.0f));
+
+	return sse_select_ps(SSE_ALPHA_MASK_PS, alpha, _mm_mul_ps(fcolor, fac));
+}
+
+/* same as premul_float_to_straight_uchar() */
+BLI_INLINE void sse_premul_float_to_straight_uchar(unsigned char result[4], __m128 color)
+{
+	const __m128 alpha = sse_splat_alpha(color);
+	const float alpha_scalar = _mm_cvtss_f32(alpha);
+	__m128i icolor, over, under;
+	int packed;
+
+	if (alpha_scalar != 0.0f && alpha_scalar != 1.0f) {
+		const __m128 alpha_inv = _mm_div_ps(_mm_set1_ps(1.0f), alpha);
+		color = sse_select_ps(SSE_ALPHA_MASK_PS, color, _mm_mul_ps(color, alpha_inv));
+	}
+
+	/* FTOCHAR */
+	icolor = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(color, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+	over = _mm_castps_si128(_mm_cmpgt_ps(color, _mm_set1_ps(1.0f - 0.5f / 255.0f)));
+	under = _mm_castps_si128(_mm_cmple_ps(color, _mm_setzero_ps()));
+	icolor = _mm_andnot_si128(under, sse_select_si128(over, _mm_set1_epi32(255), icolor));
+
+	icolor = _mm_packs_epi32(icolor, icolor);
+	packed = _mm_cvtsi128_si32(_mm_packus_epi16(icolor, icolor));
+	memcpy(result, &packed, sizeof(packed));
+}
+
+#endif  /* __SSE2__ */
+
 /*********************** Alpha Over *************************/
 
 static void init_alpha_over_or_under(Sequence *seq)
@@ -158,430 +295,314 @@ static void init_alpha_over_or_under(Sequence *seq)
 	seq->seq1 = seq2;
 }
 
-static void do_alphaover_effect_byte(float facf0, float facf1, int x, int y,  unsigned char *rect1, unsigned char *rect2, unsigned char *out)
+static void blend_alphaover_byte_row(const unsigned char *rect1, const unsigned char *rect2, unsigned char *out,
+                                     int width, float fac)
 {
-	float fac2, mfac, fac, fac4;
-	int xo;
-	unsigned char *cp1, *cp2, *rt;
-	float tempc[4], rt1[4], rt2[4];
-
-	xo = x;
-	cp1 = rect1;
-	cp2 = rect2;
-	rt = out;
-
-	fac2 = facf0;
-	fac4 = facf1;
+	const unsigned char *cp1 = rect1, *cp2 = rect2;
+	unsigned char *rt = out;
+	float mfac;
+	int x;
 
-	while (y--) {
-		x = xo;
-		while (x--) {
-			/* rt = rt1 over rt2  (alpha from rt1) */
-
-			straight_uchar_to_premul_float(rt1, cp1);
-			straight_uchar_to_premul_float(rt2, cp2);
-
-			fac = fac2;
-			mfac = 1.0f - fac2 * rt1[3];
+	if (fac <= 0.0f) {
+		memcpy(out, rect2, 4 * sizeof(unsigned char) * width);
+		return;
+	}
 
-			if      (fac  <= 0.0f) *((unsigned int *) rt) = *((unsigned int *) cp2);
-			else if (mfac <= 0.0f) *((unsigned int *) rt) = *((unsigned int *) cp1);
-			else {
-				tempc[0] = fac * rt1[0] + mfac * rt2[0];
-				tempc[1] = fac * rt1[1] + mfac * rt2[1];
-				tempc[2] = fac * rt1[2] + mfac * rt2[2];
-				tempc[3] = fac * rt1[3] + mfac * rt2[3];
+	for (x = 0; x < width; x++) {
+		/* rt = rt1 over rt2  (alpha from rt1) */
+		mfac = 1.0f - fac * (cp1[3] * (1.0f / 255.0f));
 
-				premul_float_to_straight_uchar(rt, tempc);
-			}
-			cp1 += 4; cp2 += 4; rt += 4;
+		if (mfac <= 0.0f) {
+			memcpy(rt, cp1, 4 * sizeof(unsigned char));
 		}
+		else {
+#ifdef __SSE2__
+			__m128 rt1 = sse_straight_uchar_to_premul_float(cp1);
+			__m128 rt2 = sse_straight_uchar_to_premul_float(cp2);
 
-		if (y == 0) break;
-		y--;
+			sse_premul_float_to_straight_uchar(rt, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(fac), rt1),
+			                                                  _mm_mul_ps(_mm_set1_ps(mfac), rt2)));
+#else
+			float tempc[4], rt1[4], rt2[4];
 
-		x = xo;
-		while (x--) {
 			straight_uchar_to_premul_float(rt1, cp1);
 			straight_uchar_to_premul_float(rt2, cp2);
 
-			fac = fac4;
-			mfac = 1.0f - (fac4 * rt1[3]);
+			tempc[0] = fac * rt1[0] + mfac * rt2[0];
+			tempc[1] = fac * rt1[1] + mfac * rt2[1];
+			tempc[2] = fac * rt1[2] + mfac * rt2[2];
+			tempc[3] = fac * rt1[3] + mfac * rt2[3];
 
-			if      (fac  <= 0.0f) *((unsigned int *) rt) = *((unsigned int *) cp2);
-			else if (mfac <= 0.0f) *((unsigned int *) rt) = *((unsigned int *) cp1);
-			else {
-				tempc[0] = fac * rt1[0] + mfac * rt2[0];
-				tempc[1] = fac * rt1[1] + mfac * rt2[1];
-				tempc[2] = fac * rt1[2] + mfac * rt2[2];
-				tempc[3] = fac * rt1[3] + mfac * rt2[3];
-
-				premul_float_to_straight_uchar(rt, tempc);
-			}
-			cp1 += 4; cp2 += 4; rt += 4;
+			premul_float_to_straight_uchar(rt, tempc);
+#endif
 		}
+		cp1 += 4; cp2 += 4; rt += 4;
 	}
 }
 
-static void do_alphaover_effect_float(float facf0, float facf1, int x, int y,  float *rect1, float *rect2, float *out)
+static void blend_alphaover_float_row(const float *rect1, const float *rect2, float *out, int width, float fac)
 {
-	float fac2, mfac, fac, fac4;
-	int xo;
-	float *rt1, *rt2, *rt;
+	const float *rt1 = rect1, *rt2 = rect2;
+	float *rt = out;
+	int x;
 
-	xo = x;
-	rt1 = rect1;
-	rt2 = rect2;
-	rt = out;
+	if (fac <= 0.0f) {
+		memcpy(out, rect2, 4 * sizeof(float) * width);
+		return;
+	}
 
-	fac2 = facf0;
-	fac4 = facf1;
+#ifdef __SSE2__
+	{
+		const __m128 vfac = _mm_set1_ps(fac);
+		const __m128 one = _mm_set1_ps(1.0f);
 
-	while (y--) {
-		x = xo;
-		while (x--) {
-			/* rt = rt1 over rt2  (alpha from rt1) */
+		for (x = 0; x < width; x++) {
+			__m128 color1 = _mm_loadu_ps(rt1);
+			__m128 color2 = _mm_loadu_ps(rt2);
+			__m128 mfac = _mm_sub_ps(one, _mm_mul_ps(vfac, sse_splat_alpha(color1)));
+			__m128 result = _mm_add_ps(_mm_mul_ps(vfac, color1), _mm_mul_ps(mfac, color2));
 
-			fac = fac2;
-			mfac = 1.0f - (fac2 * rt1[3]);
+			_mm_storeu_ps(rt, sse_select_ps(_mm_cmple_ps(mfac, _mm_setzero_ps()), color1, result));
 
-			if (fac <= 0.0f) {
-				memcpy(rt, rt2, 4 * sizeof(float));
-			}
-			else if (mfac <= 0) {
-				memcpy(rt, rt1, 4 * sizeof(float));
-			}
-			else {
-				rt[0] = fac * rt1[0] + mfac * rt2[0];
-				rt[1] = fac * rt1[1] + mfac * rt2[1];
-				rt[2] = fac * rt1[2] + mfac * rt2[2];
-				rt[3] = fac * rt1[3] + mfac * rt2[3];
-			}
 			rt1 += 4; rt2 += 4; rt += 4;
 		}
+	}
+#else
+	for (x = 0; x < width; x++) {
+		/* rt = rt1 over rt2  (alpha from rt1) */
+		float mfac = 1.0f - (fac * rt1[3]);
 
-		if (y == 0)
-			break;
-		y--;
-
-		x = xo;
-		while (x--) {
-			fac = fac4;
-			mfac = 1.0f - (fac4 * rt1[3]);
-
-			if (fac <= 0.0f) {
-				memcpy(rt, rt2, 4 * sizeof(float));
-			}
-			else if (mfac <= 0.0f) {
-				memcpy(rt, rt1, 4 * sizeof(float));
-			}
-			else {
-				rt[0] = fac * rt1[0] + mfac * rt2[0];
-				rt[1] = fac * rt1[1] + mfac * rt2[1];
-				rt[2] = fac * rt1[2] + mfac * rt2[2];
-				rt[3] = fac * rt1[3] + mfac * rt2[3];
-			}
-			rt1 += 4; rt2 += 4; rt += 4;
+		if (mfac <= 0.0f) {
+			memcpy(rt, rt1, 4 * sizeof(float));
+		}
+		else {
+			rt[0] = fac * rt1[0] + mfac * rt2[0];
+			rt[1] = fac * rt1[1] + mfac * rt2[1];
+			rt[2] = fac * rt1[2] + mfac * rt2[2];
+			rt[3] = fac * rt1[3] + mfac * rt2[3];
 		}
+		rt1 += 4; rt2 += 4; rt += 4;
 	}
+#endif
 }
 
+static const SeqBlendKernel seq_blend_alphaover = {
+	"Alpha Over", blend_alphaover_byte_row, blend_alphaover_float_row
+};
+
 static void do_alphaover_effect(const SeqRenderData *context, Sequence *UNUSED(seq), float UNUSED(cfra), float facf0,
                                 float facf1, ImBuf *ibuf1, ImBuf *ibuf2, ImBuf *UNUSED(ibuf3),
                                 int start_line, int total_lines, ImBuf *out)
 {
-	if (out->rect_float) {
-		float *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
-
-		slice_get_float_buffers(context, ibuf1, ibuf2, NULL, out, start_line, &rect1, &rect2, NULL, &rect_out);
-
-		do_alphaover_effect_float(facf0, facf1, context->rectx, total_lines, rect1, rect2, rect_out);
-	}
-	else {
-		unsigned char *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
-
-		slice_get_byte_buffers(context, ibuf1, ibuf2, NULL, out, start_line, &rect1, &rect2, NULL, &rect_out);
-
-		do_alphaover_effect_byte(facf0, facf1, context->rectx, total_lines, rect1, rect2, rect_out);
-	}
+	do_blend_effect(&seq_blend_alphaover, context, facf0, facf1, ibuf1, ibuf2, start_line, total_lines, out);
 }
 
 /*********************** Alpha Under *************************/
 
-static void do_alphaunder_effect_byte(float facf0, float facf1, int x, int y, unsigned char *rect1, unsigned char *rect2, unsigned char *out)
+static void blend_alphaunder_byte_row(const unsigned char *rect1, const unsigned char *rect2, unsigned char *out,
+                                      int width, float fac)
 {
-	float fac2, fac, fac4;
-	int xo;
-	unsigned char *cp1, *cp2, *rt;
-	float tempc[4], rt1[4], rt2[4];
+	const unsigned char *cp1 = rect1, *cp2 = rect2;
+	unsigned char *rt = out;
+	float alpha2, mfac;
+	int x;
 
-	xo = x;
-	cp1 = rect1;
-	cp2 = rect2;
-	rt = out;
-
-	fac2 = facf0;
-	fac4 = facf1;
-
-	while (y--) {
-		x = xo;
-		while (x--) {
-			/* rt = rt1 under rt2  (alpha from rt2) */
-			straight_uchar_to_premul_float(rt1, cp1);
-			straight_uchar_to_premul_float(rt2, cp2);
+	for (x = 0; x < width; x++) {
+		/* rt = rt1 under rt2  (alpha from rt2) */
+		alpha2 = cp2[3] * (1.0f / 255.0f);
+
+		/* this complex optimization is because the
+		 * 'skybuf' can be crossed in
+		 */
+		if      (alpha2 <= 0.0f && fac >= 1.0f) memcpy(rt, cp1, 4 * sizeof(unsigned char));
+		else if (alpha2 >= 1.0f)                memcpy(rt, cp2, 4 * sizeof(unsigned char));
+		else {
+			mfac = fac * (1.0f - alpha2);
 
-			/* this complex optimization is because the
-			 * 'skybuf' can be crossed in
-			 */
-			if      (rt2[3] <= 0.0f && fac2 >= 1.0f) *((unsigned int *) rt) = *((unsigned int *) cp1);
-			else if (rt2[3] >= 1.0f)                 *((unsigned int *) rt) = *((unsigned int *) cp2);
+			if (mfac <= 0.0f) {
+				memcpy(rt, cp2, 4 * sizeof(unsigned char));
+			}
 			else {
-				fac = (fac2 * (1.0f - rt2[3]));
+#ifdef __SSE2__
+				__m128 rt1 = sse_straight_uchar_to_premul_float(cp1);
+				__m128 rt2 = sse_straight_uchar_to_premul_float(cp2);
 
-				if (fac <= 0) *((unsigned int *) rt) = *((unsigned int *) cp2);
-				else {
-					tempc[0] = (fac * rt1[0] + rt2[0]);
-					tempc[1] = (fac * rt1[1] + rt2[1]);
-					tempc[2] = (fac * rt1[2] + rt2[2]);
-					tempc[3] = (fac * rt1[3] + rt2[3]);
-					
-					premul_float_to_straight_uchar(rt, tempc);
-				}
-			}
-			cp1 += 4; cp2 += 4; rt += 4;
-		}
+				sse_premul_float_to_straight_uchar(rt, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(mfac), rt1), rt2));
+#else
+				float tempc[4], rt1[4], rt2[4];
 
-		if (y == 0)
-			break;
-		y--;
+				straight_uchar_to_premul_float(rt1, cp1);
+				straight_uchar_to_premul_float(rt2, cp2);
 
-		x = xo;
-		while (x--) {
-			straight_uchar_to_premul_float(rt1, cp1);
-			straight_uchar_to_premul_float(rt2, cp2);
-			
-			if      (rt2[3] <= 0.0f && fac4 >= 1.0f) *((unsigned int *) rt) = *((unsigned int *) cp1);
-			else if (rt2[3] >= 1.0f)                 *((unsigned int *) rt) = *((unsigned int *) cp2);
-			else {				
-				fac = (fac4 * (1.0f - rt2[3]));
+				tempc[0] = (mfac * rt1[0] + rt2[0]);
+				tempc[1] = (mfac * rt1[1] + rt2[1]);
+				tempc[2] = (mfac * rt1[2] + rt2[2]);
+				tempc[3] = (mfac * rt1[3] + rt2[3]);
 
-				if (fac <= 0) *((unsigned int *)rt) = *((unsigned int *)cp2);
-				else {
-					tempc[0] = (fac * rt1[0] + rt2[0]);
-					tempc[1] = (fac * rt1[1] + rt2[1]);
-					tempc[2] = (fac * rt1[2] + rt2[2]);
-					tempc[3] = (fac * rt1[3] + rt2[3]);
-					
-					premul_float_to_straight_uchar(rt, tempc);
-				}
+				premul_float_to_straight_uchar(rt, tempc);
+#endif
 			}
-			cp1 += 4; cp2 += 4; rt += 4;
 		}
+		cp1 += 4; cp2 += 4; rt += 4;
 	}
 }
 
-static void do_alphaunder_effect_float(float facf0, float facf1, int x, int y,  float *rect1, float *rect2, float *out)
+static void blend_alphaunder_float_row(const float *rect1, const float *rect2, float *out, int width, float fac)
 {
-	float fac2, fac, fac4;
-	int xo;
-	float *rt1, *rt2, *rt;
+	const float *rt1 = rect1, *rt2 = rect2;
+	float *rt = out;
+	int x;
 
-	xo = x;
-	rt1 = rect1;
-	rt2 = rect2;
-	rt = out;
-
-	fac2 = facf0;
-	fac4 = facf1;
+#ifdef __SSE2__
+	{
+		const __m128 vfac = _mm_set1_ps(fac);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
 
-	while (y--) {
-		x = xo;
-		while (x--) {
-			/* rt = rt1 under rt2  (alpha from rt2) */
+		for (x = 0; x < width; x++) {
+			__m128 color1 = _mm_loadu_ps(rt1);
+			__m128 color2 = _mm_loadu_ps(rt2);
+			__m128 alpha2 = sse_splat_alpha(color2);
+			__m128 mfac = _mm_mul_ps(vfac, _mm_sub_ps(one, alpha2));
+			__m128 result = _mm_add_ps(_mm_mul_ps(mfac, color1), color2);
 
-			/* this complex optimization is because the
-			 * 'skybuf' can be crossed in
-			 */
-			if (rt2[3] <= 0 && fac2 >= 1.0f) {
-				memcpy(rt, rt1, 4 * sizeof(float));
+			result = sse_select_ps(_mm_or_ps(_mm_cmpge_ps(alpha2, one), _mm_cmpeq_ps(mfac, zero)), color2, result);
+			if (fac >= 1.0f) {
+				result = sse_select_ps(_mm_cmple_ps(alpha2, zero), color1, result);
 			}
-			else if (rt2[3] >= 1.0f) {
-				memcpy(rt, rt2, 4 * sizeof(float));
-			}
-			else {
-				fac = fac2 * (1.0f - rt2[3]);
+			_mm_storeu_ps(rt, result);
 
-				if (fac == 0) {
-					memcpy(rt, rt2, 4 * sizeof(float));
-				}
-				else {
-					rt[0] = fac * rt1[0] + rt2[0];
-					rt[1] = fac * rt1[1] + rt2[1];
-					rt[2] = fac * rt1[2] + rt2[2];
-					rt[3] = fac * rt1[3] + rt2[3];
-				}
-			}
 			rt1 += 4; rt2 += 4; rt += 4;
 		}
+	}
+#else
+	for (x = 0; x < width; x++) {
+		/* rt = rt1 under rt2  (alpha from rt2) */
 
-		if (y == 0)
-			break;
-		y--;
+		/* this complex optimization is because the
+		 * 'skybuf' can be crossed in
+		 */
+		if (rt2[3] <= 0 && fac >= 1.0f) {
+			memcpy(rt, rt1, 4 * sizeof(float));
+		}
+		else if (rt2[3] >= 1.0f) {
+			memcpy(rt, rt2, 4 * sizeof(float));
+		}
+		else {
+			float mfac = fac * (1.0f - rt2[3]);
 
-		x = xo;
-		while (x--) {
-			if (rt2[3] <= 0 && fac4 >= 1.0f) {
-				memcpy(rt, rt1, 4 * sizeof(float));
-			}
-			else if (rt2[3] >= 1.0f) {
+			if (mfac == 0) {
 				memcpy(rt, rt2, 4 * sizeof(float));
 			}
 			else {
-				fac = fac4 * (1.0f - rt2[3]);
-
-				if (fac == 0) {
-					memcpy(rt, rt2, 4 * sizeof(float));
-				}
-				else {
-					rt[0] = fac * rt1[0] + rt2[0];
-					rt[1] = fac * rt1[1] + rt2[1];
-					rt[2] = fac * rt1[2] + rt2[2];
-					rt[3] = fac * rt1[3] + rt2[3];
-				}
+				rt[0] = mfac * rt1[0] + rt2[0];
+				rt[1] = mfac * rt1[1] + rt2[1];
+				rt[2] = mfac * rt1[2] + rt2[2];
+				rt[3] = mfac * rt1[3] + rt2[3];
 			}
-			rt1 += 4; rt2 += 4; rt += 4;
 		}
+		rt1 += 4; rt2 += 4; rt += 4;
 	}
+#endif
 }
 
+static const SeqBlendKernel seq_blend_alphaunder = {
+	"Alpha Under", blend_alphaunder_byte_row, blend_alphaunder_float_row
+};
+
 static void do_alphaunder_effect(const SeqRenderData *context, Sequence *UNUSED(seq), float UNUSED(cfra),
                                  float facf0, float facf1, ImBuf *ibuf1, ImBuf *ibuf2, ImBuf *UNUSED(ibuf3),
                                  int start_line, int total_lines, ImBuf *out)
 {
-	if (out->rect_float) {
-		float *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
-
-		slice_get_float_buffers(context, ibuf1, ibuf2, NULL, out, start_line, &rect1, &rect2, NULL, &rect_out);
-
-		do_alphaunder_effect_float(facf0, facf1, context->rectx, total_lines, rect1, rect2, rect_out);
-	}
-	else {
-		unsigned char *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
-
-		slice_get_byte_buffers(context, ibuf1, ibuf2, NULL, out, start_line, &rect1, &rect2, NULL, &rect_out);
-
-		do_alphaunder_effect_byte(facf0, facf1, context->rectx, total_lines, rect1, rect2, rect_out);
-	}
+	do_blend_effect(&seq_blend_alphaunder, context, facf0, facf1, ibuf1, ibuf2, start_line, total_lines, out);
 }
 
 /*********************** Cross *************************/
 
-static void do_cross_effect_byte(float facf0, float facf1, int x, int y, unsigned char *rect1, unsigned char *rect2, unsigned char *out)
+static void blend_cross_byte_row(const unsigned char *rect1, const unsigned char *rect2, unsigned char *out,
+                                 int width, float fac)
 {
-	int fac1, fac2, fac3, fac4;
-	int xo;
-	unsigned char *rt1, *rt2, *rt;
+	const unsigned char *rt1 = rect1, *rt2 = rect2;
+	unsigned char *rt = out;
+	int fac2 = (int) (256.0f * fac);
+	int fac1 = 256 - fac2;
+	int x = 0;
 
-	xo = x;
-	rt1 = rect1;
-	rt2 = rect2;
-	rt = out;
-
-	fac2 = (int) (256.0f * facf0);
-	fac1 = 256 - fac2;
-	fac4 = (int) (256.0f * facf1);
-	fac3 = 256 - fac4;
+#ifdef __SSE2__
+	/* factors have to fit unsigned 16 bit math */
+	if (fac2 >= 0 && fac2 <= 256) {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i vfac1 = _mm_set1_epi16((short)fac1);
+		const __m128i vfac2 = _mm_set1_epi16((short)fac2);
 
-	while (y--) {
-		x = xo;
-		while (x--) {
-			rt[0] = (fac1 * rt1[0] + fac2 * rt2[0]) >> 8;
-			rt[1] = (fac1 * rt1[1] + fac2 * rt2[1]) >> 8;
-			rt[2] = (fac1 * rt1[2] + fac2 * rt2[2]) >> 8;
-			rt[3] = (fac1 * rt1[3] + fac2 * rt2[3]) >> 8;
+		for (; x + 4 <= width; x += 4) {
+			__m128i color1 = _mm_loadu_si128((const __m128i *)rt1);
+			__m128i color2 = _mm_loadu_si128((const __m128i *)rt2);
+			__m128i lo, hi;
 
-			rt1 += 4; rt2 += 4; rt += 4;
-		}
-
-		if (y == 0)
-			break;
-		y--;
+			lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(color1, zero), vfac1),
+			                   _mm_mullo_epi16(_mm_unpacklo_epi8(color2, zero), vfac2));
+			hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(color1, zero), vfac1),
+			                   _mm_mullo_epi16(_mm_unpackhi_epi8(color2, zero), vfac2));
 
-		x = xo;
-		while (x--) {
-			rt[0] = (fac3 * rt1[0] + fac4 * rt2[0]) >> 8;
-			rt[1] = (fac3 * rt1[1] + fac4 * rt2[1]) >> 8;
-			rt[2] = (fac3 * rt1[2] + fac4 * rt2[2]) >> 8;
-			rt[3] = (fac3 * rt1[3] + fac4 * rt2[3]) >> 8;
+			_mm_storeu_si128((__m128i *)rt, _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
 
-			rt1 += 4; rt2 += 4; rt += 4;
+			rt1 += 16; rt2 += 16; rt += 16;
 		}
+	}
+#endif
 
+	for (; x < width; x++) {
+		rt[0] = (fac1 * rt1[0] + fac2 * rt2[0]) >> 8;
+		rt[1] = (fac1 * rt1[1] + fac2 * rt2[1]) >> 8;
+		rt[2] = (fac1 * rt1[2] + fac2 * rt2[2]) >> 8;
+		rt[3] = (fac1 * rt1[3] + fac2 * rt2[3]) >> 8;
+
+		rt1 += 4; rt2 += 4; rt += 4;
 	}
 }
 
-static void do_cross_effect_float(float facf0, float facf1, int x, int y, float *rect1, float *rect2, float *out)
+static void blend_cross_float_row(const float *rect1, const float *rect2, float *out, int width, float fac)
 {
-	float fac1, fac2, fac3, fac4;
-	int xo;
-	float *rt1, *rt2, *rt;
-
-	xo = x;
-	rt1 = rect1;
-	rt2 = rect2;
-	rt = out;
-
-	fac2 = facf0;
-	fac1 = 1.0f - fac2;
-	fac4 = facf1;
-	fac3 = 1.0f - fac4;
-
-	while (y--) {
-		x = xo;
-		while (x--) {
-			rt[0] = fac1 * rt1[0] + fac2 * rt2[0];
-			rt[1] = fac1 * rt1[1] + fac2 * rt2[1];
-			rt[2] = fac1 * rt1[2] + fac2 * rt2[2];
-			rt[3] = fac1 * rt1[3] + fac2 * rt2[3];
+	const float *rt1 = rect1, *rt2 = rect2;
+	float *rt = out;
+	float fac2 = fac;
+	float fac1 = 1.0f - fac2;
+	int x;
 
-			rt1 += 4; rt2 += 4; rt += 4;
-		}
-
-		if (y == 0)
-			break;
-		y--;
+#ifdef __SSE2__
+	{
+		const __m128 vfac1 = _mm_set1_ps(fac1);
+		const __m128 vfac2 = _mm_set1_ps(fac2);
 
-		x = xo;
-		while (x--) {
-			rt[0] = fac3 * rt1[0] + fac4 * rt2[0];
-			rt[1] = fac3 * rt1[1] + fac4 * rt2[1];
-			rt[2] = fac3 * rt1[2] + fac4 * rt2[2];
-			rt[3] = fac3 * rt1[3] + fac4 * rt2[3];
+		for (x = 0; x < width; x++) {
+			_mm_storeu_ps(rt, _mm_add_ps(_mm_mul_ps(vfac1, _mm_loadu_ps(rt1)),
+			                             _mm_mul_ps(vfac2, _mm_loadu_ps(rt2))));
 
 			rt1 += 4; rt2 += 4; rt += 4;
 		}
+	}
+#else
+	for (x = 0; x < width; x++) {
+		rt[0] = fac1 * rt1[0] + fac2 * rt2[0];
+		rt[1] = fac1 * rt1[1] + fac2 * rt2[1];
+		rt[2] = fac1 * rt1[2] + fac2 * rt2[2];
+		rt[3] = fac1 * rt1[3] + fac2 * rt2[3];
 
+		rt1 += 4; rt2 += 4; rt += 4;
 	}
+#endif
 }
 
+static const SeqBlendKernel seq_blend_cross = {
+	"Cross", blend_cross_byte_row, blend_cross_float_row
+};
+
 static void do_cross_effect(const SeqRenderData *context, Sequence *UNUSED(seq), float UNUSED(cfra),
                             float facf0, float facf1, ImBuf *ibuf1, ImBuf *ibuf2, ImBuf *UNUSED(ibuf3),
                             int start_line, int total_lines, ImBuf *out)
 {
-	if (out->rect_float) {
-		float *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
-
-		slice_get_float_buffers(context, ibuf1, ibuf2, NULL, out, start_line, &rect1, &rect2, NULL, &rect_out);
-
-		do_cross_effect_float(facf0, facf1, context->rectx, total_lines, rect1, rect2, rect_out);
-	}
-	else {
-		unsigned char *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
-
-		slice_get_byte_buffers(context, ibuf1, ibuf2, NULL, out, start_line, &rect1, &rect2, NULL, &rect_out);
-
-		do_cross_effect_byte(facf0, facf1, context->rectx, total_lines, rect1, rect2, rect_out);
-	}
+	do_blend_effect(&seq_blend_cross, context, facf0, facf1, ibuf1, ibuf2, start_line, total_lines, out);
 }
 
 /*********************** Gamma Cross *************************/
@@ -724,92 +745,49 @@ static void free_gammacross(Sequence *UNUSED(seq))
 {
 }
 
-static void do_gammacross_effect_byte(float facf0, float UNUSED(facf1),  int x, int y, unsigned char *rect1,
-                                      unsigned char *rect2, unsigned char *out)
+static void blend_gammacross_byte_row(const unsigned char *rect1, const unsigned char *rect2, unsigned char *out,
+                                      int width, float fac)
 {
-	float fac1, fac2;
-	int xo;
-	unsigned char *cp1, *cp2, *rt;
-	float rt1[4], rt2[4], tempc[4];
-
-	xo = x;
-	cp1 = rect1;
-	cp2 = rect2;
-	rt = out;
-
-	fac2 = facf0;
-	fac1 = 1.0f - fac2;
-
-	while (y--) {
-		x = xo;
-		while (x--) {
-			straight_uchar_to_premul_float(rt1, cp1);
-			straight_uchar_to_premul_float(rt2, cp2);
-
-			tempc[0] = gammaCorrect(fac1 * invGammaCorrect(rt1[0]) + fac2 * invGammaCorrect(rt2[0]));
-			tempc[1] = gammaCorrect(fac1 * invGammaCorrect(rt1[1]) + fac2 * invGammaCorrect(rt2[1]));
-			tempc[2] = gammaCorrect(fac1 * invGammaCorrect(rt1[2]) + fac2 * invGammaCorrect(rt2[2]));
-			tempc[3] = gammaCorrect(fac1 * invGammaCorrect(rt1[3]) + fac2 * invGammaCorrect(rt2[3]));
-
-			premul_float_to_straight_uchar(rt, tempc);
-			cp1 += 4; cp2 += 4; rt += 4;
-		}
-
-		if (y == 0)
-			break;
-		y--;
-
-		x = xo;
-		while (x--) {
-			straight_uchar_to_premul_float(rt1, cp1);
-			straight_uchar_to_premul_float(rt2, cp2);
-
-			tempc[0] = gammaCorrect(fac1 * invGammaCorrect(rt1[0]) + fac2 * invGammaCorrect(rt2[0]));
-			tempc[1] = gammaCorrect(fac1 * invGammaCorrect(rt1[1]) + fac2 * invGammaCorrect(rt2[1]));
-			tempc[2] = gammaCorrect(fac1 * invGammaCorrect(rt1[2]) + fac2 * invGammaCorrect(rt2[2]));
-			tempc[3] = gammaCorrect(fac1 * invGammaCorrect(rt1[3]) + fac2 * invGammaCorrect(rt2[3]));
-
-			premul_float_to_straight_uchar(rt, tempc);
-			cp1 += 4; cp2 += 4; rt += 4;
-		}
-	}
-}
-
-static void do_gammacross_effect_float(float facf0, float UNUSED(facf1), int x, int y, float *rect1,
-                                       float *rect2, float *out)
-{
-	float fac1, fac2;
-	int xo;
-	float *rt1, *rt2, *rt;
-
-	xo = x;
-	rt1 = rect1;
-	rt2 = rect2;
-	rt = out;
+	const unsigned char *cp1 = rect1, *cp2 = rect2;
+	unsigned char *rt = out;
+	float fac2 = fac;
+	float fac1 = 1.0f - fac2;
+	float rt1[4], rt2[4], tempc[4];
+	int x;
 
-	fac2 = facf0;
-	fac1 = 1.0f - fac2;
+	/* table lookups, no SIMD variant */
+	for (x = 0; x < width; x++) {
+		straight_uchar_to_premul_float(rt1, cp1);
+		straight_uchar_to_premul_float(rt2, cp2);
 
-	while (y--) {
-		x = xo * 4;
-		while (x--) {
-			*rt = gammaCorrect(fac1 * invGammaCorrect(*rt1) + fac2 * invGammaCorrect(*rt2));
-			rt1++; rt2++; rt++;
-		}
+		tempc[0] = gammaCorrect(fac1 * invGammaCorrect(rt1[0]) + fac2 * invGammaCorrect(rt2[0]));
+		tempc[1] = gammaCorrect(fac1 * invGammaCorrect(rt1[1]) + fac2 * invGammaCorrect(rt2[1]));
+		tempc[2] = gammaCorrect(fac1 * invGammaCorrect(rt1[2]) + fac2 * invGammaCorrect(rt2[2]));
+		tempc[3] = gammaCorrect(fac1 * invGammaCorrect(rt1[3]) + fac2 * invGammaCorrect(rt2[3]));
 
-		if (y == 0)
-			break;
-		y--;
+		premul_float_to_straight_uchar(rt, tempc);
+		cp1 += 4; cp2 += 4; rt += 4;
+	}
+}
 
-		x = xo * 4;
-		while (x--) {
-			*rt = gammaCorrect(fac1 * invGammaCorrect(*rt1) + fac2 * invGammaCorrect(*rt2));
+static void blend_gammacross_float_row(const float *rect1, const float *rect2, float *out, int width, float fac)
+{
+	const float *rt1 = rect1, *rt2 = rect2;
+	float *rt = out;
+	float fac2 = fac;
+	float fac1 = 1.0f - fac2;
+	int x;
 
-			rt1++; rt2++; rt++;
-		}
+	for (x = width * 4; x--; ) {
+		*rt = gammaCorrect(fac1 * invGammaCorrect(*rt1) + fac2 * invGammaCorrect(*rt2));
+		rt1++; rt2++; rt++;
 	}
 }
 
+static const SeqBlendKernel seq_blend_gammacross = {
+	"Gamma Cross", blend_gammacross_byte_row, blend_gammacross_float_row
+};
+
 static struct ImBuf *gammacross_init_execution(const SeqRenderData *context, ImBuf *ibuf1, ImBuf *ibuf2, ImBuf *ibuf3)
 {
 	ImBuf *out = prepare_effect_imbufs(context, ibuf1, ibuf2, ibuf3);
@@ -819,234 +797,184 @@ static struct ImBuf *gammacross_init_execution(const SeqRenderData *context, ImB
 }
 
 static void do_gammacross_effect(const SeqRenderData *context, Sequence *UNUSED(seq), float UNUSED(cfra),
-                                 float facf0, float facf1, ImBuf *ibuf1, ImBuf *ibuf2, ImBuf *UNUSED(ibuf3),
+                                 float facf0, float UNUSED(facf1), ImBuf *ibuf1, ImBuf *ibuf2, ImBuf *UNUSED(ibuf3),
                                  int start_line, int total_lines, ImBuf *out)
 {
-	if (out->rect_float) {
-		float *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
-
-		slice_get_float_buffers(context, ibuf1, ibuf2, NULL, out, start_line, &rect1, &rect2, NULL, &rect_out);
-
-		do_gammacross_effect_float(facf0, facf1, context->rectx, total_lines, rect1, rect2, rect_out);
-	}
-	else {
-		unsigned char *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
-
-		slice_get_byte_buffers(context, ibuf1, ibuf2, NULL, out, start_line, &rect1, &rect2, NULL, &rect_out);
-
-		do_gammacross_effect_byte(facf0, facf1, context->rectx, total_lines, rect1, rect2, rect_out);
-	}
+	/* gamma cross does not use fields */
+	do_blend_effect(&seq_blend_gammacross, context, facf0, facf0, ibuf1, ibuf2, start_line, total_lines, out);
 }
 
 /*********************** Add *************************/
 
-static void do_add_effect_byte(float facf0, float facf1, int x, int y, unsigned char *rect1, unsigned char *rect2,
-                               unsigned char *out)
+static void blend_add_byte_row(const unsigned char *rect1, const unsigned char *rect2, unsigned char *out,
+                               int width, float fac)
 {
-	int xo, fac1, fac3;
-	unsigned char *cp1, *cp2, *rt;
+	const unsigned char *cp1 = rect1, *cp2 = rect2;
+	unsigned char *rt = out;
+	int fac1 = (int)(256.0f * fac);
+	int x = 0;
 
-	xo = x;
-	cp1 = rect1;
-	cp2 = rect2;
-	rt = out;
+#ifdef __SSE2__
+	if (fac1 >= 0 && fac1 <= 256) {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i vfac = _mm_set1_epi16((short)fac1);
 
-	fac1 = (int)(256.0f * facf0);
-	fac3 = (int)(256.0f * facf1);
+		for (; x + 4 <= width; x += 4) {
+			__m128i color1 = _mm_loadu_si128((const __m128i *)cp1);
+			__m128i color2 = _mm_loadu_si128((const __m128i *)cp2);
+			__m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(color2, zero), vfac), 8);
+			__m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(color2, zero), vfac), 8);
+			__m128i result = _mm_adds_epu8(color1, _mm_packus_epi16(lo, hi));
 
-	while (y--) {
-		x = xo;
+			_mm_storeu_si128((__m128i *)rt, sse_select_si128(SSE_ALPHA_MASK_EPI8, color1, result));
 
-		while (x--) {
-			rt[0] = min_ii(cp1[0] + ((fac1 * cp2[0]) >> 8), 255);
-			rt[1] = min_ii(cp1[1] + ((fac1 * cp2[1]) >> 8), 255);
-			rt[2] = min_ii(cp1[2] + ((fac1 * cp2[2]) >> 8), 255);
-			rt[3] = cp1[3];
-
-			cp1 += 4; cp2 += 4; rt += 4;
+			cp1 += 16; cp2 += 16; rt += 16;
 		}
+	}
+#endif
 
-		if (y == 0)
-			break;
-		y--;
-
-		x = xo;
-		while (x--) {
-			rt[0] = min_ii(cp1[0] + ((fac3 * cp2[0]) >> 8), 255);
-			rt[1] = min_ii(cp1[1] + ((fac3 * cp2[1]) >> 8), 255);
-			rt[2] = min_ii(cp1[2] + ((fac3 * cp2[2]) >> 8), 255);
-			rt[3] = cp1[3];
+	for (; x < width; x++) {
+		rt[0] = min_ii(cp1[0] + ((fac1 * cp2[0]) >> 8), 255);
+		rt[1] = min_ii(cp1[1] + ((fac1 * cp2[1]) >> 8), 255);
+		rt[2] = min_ii(cp1[2] + ((fac1 * cp2[2]) >> 8), 255);
+		rt[3] = cp1[3];
 
-			cp1 += 4; cp2 += 4; rt += 4;
-		}
+		cp1 += 4; cp2 += 4; rt += 4;
 	}
 }
 
-static void do_add_effect_float(float facf0, float facf1, int x, int y, float *rect1, float *rect2, float *out)
+static void blend_add_float_row(const float *rect1, const float *rect2, float *out, int width, float fac)
 {
-	int xo;
-	float m, fac1, fac3;
-	float *rt1, *rt2, *rt;
+	const float *rt1 = rect1, *rt2 = rect2;
+	float *rt = out;
+	int x;
 
-	xo = x;
-	rt1 = rect1;
-	rt2 = rect2;
-	rt = out;
+#ifdef __SSE2__
+	{
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 vmfac = _mm_set1_ps(1.0f - fac);
 
-	fac1 = facf0;
-	fac3 = facf1;
+		for (x = 0; x < width; x++) {
+			__m128 color1 = _mm_loadu_ps(rt1);
+			__m128 m = _mm_sub_ps(one, _mm_mul_ps(sse_splat_alpha(color1), vmfac));
+			__m128 result = _mm_add_ps(color1, _mm_mul_ps(m, _mm_loadu_ps(rt2)));
 
-	while (y--) {
-		x = xo;
-		while (x--) {
-			m = 1.0f - (rt1[3] * (1.0f - fac1));
-			rt[0] = rt1[0] + m * rt2[0];
-			rt[1] = rt1[1] + m * rt2[1];
-			rt[2] = rt1[2] + m * rt2[2];
-			rt[3] = rt1[3];
+			_mm_storeu_ps(rt, sse_select_ps(SSE_ALPHA_MASK_PS, color1, result));
 
 			rt1 += 4; rt2 += 4; rt += 4;
 		}
+	}
+#else
+	for (x = 0; x < width; x++) {
+		float m = 1.0f - (rt1[3] * (1.0f - fac));
 
-		if (y == 0)
-			break;
-		y--;
-
-		x = xo;
-		while (x--) {
-			m = 1.0f - (rt1[3] * (1.0f - fac3));
-			rt[0] = rt1[0] + m * rt2[0];
-			rt[1] = rt1[1] + m * rt2[1];
-			rt[2] = rt1[2] + m * rt2[2];
-			rt[3] = rt1[3];
+		rt[0] = rt1[0] + m * rt2[0];
+		rt[1] = rt1[1] + m * rt2[1];
+		rt[2] = rt1[2] + m * rt2[2];
+		rt[3] = rt1[3];
 
-			rt1 += 4; rt2 += 4; rt += 4;
-		}
+		rt1 += 4; rt2 += 4; rt += 4;
 	}
+#endif
 }
 
+static const SeqBlendKernel seq_blend_add = {
+	"Add", blend_add_byte_row, blend_add_float_row
+};
+
 static void do_add_effect(const SeqRenderData *context, Sequence *UNUSED(seq), float UNUSED(cfra), float facf0, float facf1,
                           ImBuf *ibuf1, ImBuf *ibuf2, ImBuf *UNUSED(ibuf3), int start_line, int total_lines, ImBuf *out)
 {
-	if (out->rect_float) {
-		float *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
-
-		slice_get_float_buffers(context, ibuf1, ibuf2, NULL, out, start_line, &rect1, &rect2, NULL, &rect_out);
-
-		do_add_effect_float(facf0, facf1, context->rectx, total_lines, rect1, rect2, rect_out);
-	}
-	else {
-		unsigned char *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
-
-		slice_get_byte_buffers(context, ibuf1, ibuf2, NULL, out, start_line, &rect1, &rect2, NULL, &rect_out);
-
-		do_add_effect_byte(facf0, facf1, context->rectx, total_lines, rect1, rect2, rect_out);
-	}
+	do_blend_effect(&seq_blend_add, context, facf0, facf1, ibuf1, ibuf2, start_line, total_lines, out);
 }
 
 /*********************** Sub *************************/
 
-static void do_sub_effect_byte(float facf0, float facf1, int x, int y, unsigned char *rect1, unsigned char *rect2, unsigned char *out)
+static void blend_sub_byte_row(const unsigned char *rect1, const unsigned char *rect2, unsigned char *out,
+                               int width, float fac)
 {
-	int xo, fac1, fac3;
-	unsigned char *cp1, *cp2, *rt;
+	const unsigned char *cp1 = rect1, *cp2 = rect2;
+	unsigned char *rt = out;
+	int fac1 = (int) (256.0f * fac);
+	int x = 0;
 
-	xo = x;
-	cp1 = rect1;
-	cp2 = rect2;
-	rt = out;
+#ifdef __SSE2__
+	if (fac1 >= 0 && fac1 <= 256) {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i vfac = _mm_set1_epi16((short)fac1);
 
-	fac1 = (int) (256.0f * facf0);
-	fac3 = (int) (256.0f * facf1);
+		for (; x + 4 <= width; x += 4) {
+			__m128i color1 = _mm_loadu_si128((const __m128i *)cp1);
+			__m128i color2 = _mm_loadu_si128((const __m128i *)cp2);
+			__m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(color2, zero), vfac), 8);
+			__m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(color2, zero), vfac), 8);
+			__m128i result = _mm_subs_epu8(color1, _mm_packus_epi16(lo, hi));
 
-	while (y--) {
-		x = xo;
-		while (x--) {
-			rt[0] = max_ii(cp1[0] - ((fac1 * cp2[0]) >> 8), 0);
-			rt[1] = max_ii(cp1[1] - ((fac1 * cp2[1]) >> 8), 0);
-			rt[2] = max_ii(cp1[2] - ((fac1 * cp2[2]) >> 8), 0);
-			rt[3] = cp1[3];
+			_mm_storeu_si128((__m128i *)rt, sse_select_si128(SSE_ALPHA_MASK_EPI8, color1, result));
 
-			cp1 += 4; cp2 += 4; rt += 4;
+			cp1 += 16; cp2 += 16; rt += 16;
 		}
+	}
+#endif
 
-		if (y == 0)
-			break;
-		y--;
-
-		x = xo;
-		while (x--) {
-			rt[0] = max_ii(cp1[0] - ((fac3 * cp2[0]) >> 8), 0);
-			rt[1] = max_ii(cp1[1] - ((fac3 * cp2[1]) >> 8), 0);
-			rt[2] = max_ii(cp1[2] - ((fac3 * cp2[2]) >> 8), 0);
-			rt[3] = cp1[3];
+	for (; x < width; x++) {
+		rt[0] = max_ii(cp1[0] - ((fac1 * cp2[0]) >> 8), 0);
+		rt[1] = max_ii(cp1[1] - ((fac1 * cp2[1]) >> 8), 0);
+		rt[2] = max_ii(cp1[2] - ((fac1 * cp2[2]) >> 8), 0);
+		rt[3] = cp1[3];
 
-			cp1 += 4; cp2 += 4; rt += 4;
-		}
+		cp1 += 4; cp2 += 4; rt += 4;
 	}
 }
 
-static void do_sub_effect_float(float UNUSED(facf0), float facf1, int x, int y, float *rect1, float *rect2, float *out)
+static void blend_sub_float_row(const float *rect1, const float *rect2, float *out, int width, float fac)
 {
-	int xo;
-	float m /*, fac1*/, fac3;
-	float *rt1, *rt2, *rt;
+	const float *rt1 = rect1, *rt2 = rect2;
+	float *rt = out;
+	int x;
 
-	xo = x;
-	rt1 = rect1;
-	rt2 = rect2;
-	rt = out;
+#ifdef __SSE2__
+	{
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 vmfac = _mm_set1_ps(1.0f - fac);
 
-	/* UNUSED */
-	// fac1 = facf0;
-	fac3 = facf1;
+		for (x = 0; x < width; x++) {
+			__m128 color1 = _mm_loadu_ps(rt1);
+			__m128 m = _mm_sub_ps(one, _mm_mul_ps(sse_splat_alpha(color1), vmfac));
+			__m128 result = _mm_max_ps(_mm_sub_ps(color1, _mm_mul_ps(m, _mm_loadu_ps(rt2))), zero);
 
-	while (y--) {
-		x = xo;
-		while (x--) {
-			m = 1.0f - (rt1[3] * (1 - fac3));
-			rt[0] = max_ff(rt1[0] - m * rt2[0], 0.0f);
-			rt[1] = max_ff(rt1[1] - m * rt2[1], 0.0f);
-			rt[2] = max_ff(rt1[2] - m * rt2[2], 0.0f);
-			rt[3] = rt1[3];
+			_mm_storeu_ps(rt, sse_select_ps(SSE_ALPHA_MASK_PS, color1, result));
 
 			rt1 += 4; rt2 += 4; rt += 4;
 		}
+	}
+#else
+	for (x = 0; x < width; x++) {
+		float m = 1.0f - (rt1[3] * (1 - fac));
 
-		if (y == 0)
-			break;
-		y--;
-
-		x = xo;
-		while (x--) {
-			m = 1.0f - (rt1[3] * (1 - fac3));
-			rt[0] = max_ff(rt1[0] - m * rt2[0], 0.0f);
-			rt[1] = max_ff(rt1[1] - m * rt2[1], 0.0f);
-			rt[2] = max_ff(rt1[2] - m * rt2[2], 0.0f);
-			rt[3] = rt1[3];
+		rt[0] = max_ff(rt1[0] - m * rt2[0], 0.0f);
+		rt[1] = max_ff(rt1[1] - m * rt2[1], 0.0f);
+		rt[2] = max_ff(rt1[2] - m * rt2[2], 0.0f);
+		rt[3] = rt1[3];
 
-			rt1 += 4; rt2 += 4; rt += 4;
-		}
+		rt1 += 4; rt2 += 4; rt += 4;
 	}
+#endif
 }
 
+static const SeqBlendKernel seq_blend_sub = {
+	"Subtract", blend_sub_byte_row, blend_sub_float_row
+};
+
 static void do_sub_effect(const SeqRenderData *context, Sequence *UNUSED(seq), float UNUSED(cfra), float facf0, float facf1,
                           ImBuf *ibuf1, ImBuf *ibuf2, ImBuf *UNUSED(ibuf3), int start_line, int total_lines, ImBuf *out)
 {
-	if (out->rect_float) {
-		float *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
-
-		slice_get_float_buffers(context, ibuf1, ibuf2, NULL, out, start_line, &rect1, &rect2, NULL, &rect_out);
-
-		do_sub_effect_float(facf0, facf1, context->rectx, total_lines, rect1, rect2, rect_out);
-	}
-	else {
-		unsigned char *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
-
-		slice_get_byte_buffers(context, ibuf1, ibuf2, NULL, out, start_line, &rect1, &rect2, NULL, &rect_out);
+	/* float buffers always used the second field factor */
+	if (out->rect_float)
+		facf0 = facf1;
 
-		do_sub_effect_byte(facf0, facf1, context->rectx, total_lines, rect1, rect2, rect_out);
-	}
+	do_blend_effect(&seq_blend_sub, context, facf0, facf1, ibuf1, ibuf2, start_line, total_lines, out);
 }
 
 /*********************** Drop *************************/
@@ -1134,116 +1062,105 @@ static void do_drop_effect_float(float facf0, float facf1, int x, int y, float *
 
 /*********************** Mul *************************/
 
-static void do_mul_effect_byte(float facf0, float facf1, int x, int y, unsigned char *rect1, unsigned char *rect2,
-                               unsigned char *out)
+static void blend_mul_byte_row(const unsigned char *rect1, const unsigned char *rect2, unsigned char *out,
+                               int width, float fac)
 {
-	int xo, fac1, fac3;
-	unsigned char *rt1, *rt2, *rt;
-
-	xo = x;
-	rt1 = rect1;
-	rt2 = rect2;
-	rt = out;
-
-	fac1 = (int)(256.0f * facf0);
-	fac3 = (int)(256.0f * facf1);
+	const unsigned char *rt1 = rect1, *rt2 = rect2;
+	unsigned char *rt = out;
+	int fac1 = (int)(256.0f * fac);
+	int x = 0;
 
 	/* formula:
-	 *		fac * (a * b) + (1 - fac) * a  => fac * a * (b - 1) + axaux = c * px + py * s; //+centx
-	 *		yaux = -s * px + c * py; //+centy
+	 * fac * (a * b) + (1 - fac) * a  =>  fac * a * (b - 1) + a
 	 */
 
-	while (y--) {
-
-		x = xo;
-		while (x--) {
-
-			rt[0] = rt1[0] + ((fac1 * rt1[0] * (rt2[0] - 255)) >> 16);
-			rt[1] = rt1[1] + ((fac1 * rt1[1] * (rt2[1] - 255)) >> 16);
-			rt[2] = rt1[2] + ((fac1 * rt1[2] * (rt2[2] - 255)) >> 16);
-			rt[3] = rt1[3] + ((fac1 * rt1[3] * (rt2[3] - 255)) >> 16);
-
-			rt1 += 4; rt2 += 4; rt += 4;
+#ifdef __SSE2__
+	/* a * (255 - b) fits 16 bit, the product with fac is split in high and low
+	 * words. Shifting the negative product is a floor, so the high word gets
+	 * rounded up when any of the low bits are set.
+	 */
+	if (fac1 >= 0 && fac1 <= 256) {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i one = _mm_set1_epi16(1);
+		const __m128i full = _mm_set1_epi16(255);
+		const __m128i vfac = _mm_set1_epi16((short)fac1);
+
+		for (; x + 4 <= width; x += 4) {
+			__m128i color1 = _mm_loadu_si128((const __m128i *)rt1);
+			__m128i color2 = _mm_loadu_si128((const __m128i *)rt2);
+			__m128i a, p, lo, hi;
+
+			a = _mm_unpacklo_epi8(color1, zero);
+			p = _mm_mullo_epi16(a, _mm_sub_epi16(full, _mm_unpacklo_epi8(color2, zero)));
+			lo = _mm_sub_epi16(_mm_sub_epi16(a, _mm_mulhi_epu16(p, vfac)), one);
+			lo = _mm_sub_epi16(lo, _mm_cmpeq_epi16(_mm_mullo_epi16(p, vfac), zero));
+
+			a = _mm_unpackhi_epi8(color1, zero);
+			p = _mm_mullo_epi16(a, _mm_sub_epi16(full, _mm_unpackhi_epi8(color2, zero)));
+			hi = _mm_sub_epi16(_mm_sub_epi16(a, _mm_mulhi_epu16(p, vfac)), one);
+			hi = _mm_sub_epi16(hi, _mm_cmpeq_epi16(_mm_mullo_epi16(p, vfac), zero));
+
+			_mm_storeu_si128((__m128i *)rt, _mm_packus_epi16(lo, hi));
+
+			rt1 += 16; rt2 += 16; rt += 16;
 		}
+	}
+#endif
 
-		if (y == 0) break;
-		y--;
-
-		x = xo;
-		while (x--) {
-
-			rt[0] = rt1[0] + ((fac3 * rt1[0] * (rt2[0] - 255)) >> 16);
-			rt[1] = rt1[1] + ((fac3 * rt1[1] * (rt2[1] - 255)) >> 16);
-			rt[2] = rt1[2] + ((fac3 * rt1[2] * (rt2[2] - 255)) >> 16);
-			rt[3] = rt1[3] + ((fac3 * rt1[3] * (rt2[3] - 255)) >> 16);
+	for (; x < width; x++) {
+		rt[0] = rt1[0] + ((fac1 * rt1[0] * (rt2[0] - 255)) >> 16);
+		rt[1] = rt1[1] + ((fac1 * rt1[1] * (rt2[1] - 255)) >> 16);
+		rt[2] = rt1[2] + ((fac1 * rt1[2] * (rt2[2] - 255)) >> 16);
+		rt[3] = rt1[3] + ((fac1 * rt1[3] * (rt2[3] - 255)) >> 16);
 
-			rt1 += 4; rt2 += 4; rt += 4;
-		}
+		rt1 += 4; rt2 += 4; rt += 4;
 	}
 }
 
-static void do_mul_effect_float(float facf0, float facf1, int x, int y, float *rect1, float *rect2, float *out)
+static void blend_mul_float_row(const float *rect1, const float *rect2, float *out, int width, float fac)
 {
-	int xo;
-	float fac1, fac3;
-	float *rt1, *rt2, *rt;
-
-	xo = x;
-	rt1 = rect1;
-	rt2 = rect2;
-	rt = out;
-
-	fac1 = facf0;
-	fac3 = facf1;
+	const float *rt1 = rect1, *rt2 = rect2;
+	float *rt = out;
+	int x;
 
 	/* formula:
 	 * fac * (a * b) + (1 - fac) * a  =>  fac * a * (b - 1) + a
 	 */
 
-	while (y--) {
-		x = xo;
-		while (x--) {
-			rt[0] = rt1[0] + fac1 * rt1[0] * (rt2[0] - 1.0f);
-			rt[1] = rt1[1] + fac1 * rt1[1] * (rt2[1] - 1.0f);
-			rt[2] = rt1[2] + fac1 * rt1[2] * (rt2[2] - 1.0f);
-			rt[3] = rt1[3] + fac1 * rt1[3] * (rt2[3] - 1.0f);
-
-			rt1 += 4; rt2 += 4; rt += 4;
-		}
+#ifdef __SSE2__
+	{
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 vfac = _mm_set1_ps(fac);
 
-		if (y == 0)
-			break;
-		y--;
+		for (x = 0; x < width; x++) {
+			__m128 color1 = _mm_loadu_ps(rt1);
+			__m128 color2 = _mm_loadu_ps(rt2);
 
-		x = xo;
-		while (x--) {
-			rt[0] = rt1[0] + fac3 * rt1[0] * (rt2[0] - 1.0f);
-			rt[1] = rt1[1] + fac3 * rt1[1] * (rt2[1] - 1.0f);
-			rt[2] = rt1[2] + fac3 * rt1[2] * (rt2[2] - 1.0f);
-			rt[3] = rt1[3] + fac3 * rt1[3] * (rt2[3] - 1.0f);
+			_mm_storeu_ps(rt, _mm_add_ps(color1, _mm_mul_ps(_mm_mul_ps(vfac, color1), _mm_sub_ps(color2, one))));
 
 			rt1 += 4; rt2 += 4; rt += 4;
 		}
 	}
+#else
+	for (x = 0; x < width; x++) {
+		rt[0] = rt1[0] + fac * rt1[0] * (rt2[0] - 1.0f);
+		rt[1] = rt1[1] + fac * rt1[1] * (rt2[1] - 1.0f);
+		rt[2] = rt1[2] + fac * rt1[2] * (rt2[2] - 1.0f);
+		rt[3] = rt1[3] + fac * rt1[3] * (rt2[3] - 1.0f);
+
+		rt1 += 4; rt2 += 4; rt += 4;
+	}
+#endif
 }
 
+static const SeqBlendKernel seq_blend_mul = {
+	"Multiply", blend_mul_byte_row, blend_mul_float_row
+};
+
 static void do_mul_effect(const SeqRenderData *context, Sequence *UNUSED(seq), float UNUSED(cfra), float facf0, float facf1,
                           ImBuf *ibuf1, ImBuf *ibuf2, ImBuf *UNUSED(ibuf3), int start_line, int total_lines, ImBuf *out)
 {
-	if (out->rect_float) {
-		float *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
-
-		slice_get_float_buffers(context, ibuf1, ibuf2, NULL, out, start_line, &rect1, &rect2, NULL, &rect_out);
-
-		do_mul_effect_float(facf0, facf1, context->rectx, total_lines, rect1, rect2, rect_out);
-	}
-	else {
-		unsigned char *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
-
-		slice_get_byte_buffers(context, ibuf1, ibuf2, NULL, out, start_line, &rect1, &rect2, NULL, &rect_out);
-
-		do_mul_effect_byte(facf0, facf1, context->rectx, total_lines, rect1, rect2, rect_out);
-	}
+	do_blend_effect(&seq_blend_mul, context, facf0, facf1, ibuf1, ibuf2, start_line, total_lines, out);
 }
 
 /*********************** Wipe *************************/
@@ -2554,12 +2471,12 @@ static ImBuf *do_speed_effect(const SeqRenderData *context, Sequence *UNUSED(seq
 	ImBuf *out = prepare_effect_imbufs(context, ibuf1, ibuf2, ibuf3);
 
 	if (out->rect_float) {
-		do_cross_effect_float(facf0, facf1, context->rectx, context->recty,
-		                      ibuf1->rect_float, ibuf2->rect_float, out->rect_float);
+		blend_effect_float(&seq_blend_cross, facf0, facf1, context->rectx, context->recty,
+		                   ibuf1->rect_float, ibuf2->rect_float, out->rect_float);
 	}
 	else {
-		do_cross_effect_byte(facf0, facf1, context->rectx, context->recty,
-		                     (unsigned char *) ibuf1->rect, (unsigned char *) ibuf2->rect, (unsigned char *) out->rect);
+		blend_effect_byte(&seq_blend_cross, facf0, facf1, context->rectx, context->recty,
+		                  (unsigned char *) ibuf1->rect, (unsigned char *) ibuf2->rect, (unsigned char *) out->rect);
 	}
 	return out;
 }
@@ -2578,7 +2495,7 @@ static void do_overdrop_effect(const SeqRenderData *context, Sequence *UNUSED(se
 		slice_get_float_buffers(context, ibuf1, ibuf2, NULL, out, start_line, &rect1, &rect2, NULL, &rect_out);
 
 		do_drop_effect_float(facf0, facf1, x, y, rect1, rect2, rect_out);
-		do_alphaover_effect_float(facf0, facf1, x, y, rect1, rect2, rect_out);
+		blend_effect_float(&seq_blend_alphaover, facf0, facf1, x, y, rect1, rect2, rect_out);
 	}
 	else {
 		unsigned char *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
@@ -2586,20 +2503,28 @@ static void do_overdrop_effect(const SeqRenderData *context, Sequence *UNUSED(se
 		slice_get_byte_buffers(context, ibuf1, ibuf2, NULL, out, start_line, &rect1, &rect2, NULL, &rect_out);
 
 		do_drop_effect_byte(facf0, facf1, x, y, rect1, rect2, rect_out);
-		do_alphaover_effect_byte(facf0, facf1, x, y, rect1, rect2, rect_out);
+		blend_effect_byte(&seq_blend_alphaover, facf0, facf1, x, y, rect1, rect2, rect_out);
 	}
 }
 
 /*********************** Gaussian Blur *************************/
 
-/* NOTE: This gaussian blur implementation accumulates values in the square
- * kernel rather that doing X direction and then Y direction because of the
- * lack of using multiple-staged filters.
+/* NOTE: The blur is separable, it runs in X direction over rows and then in
+ * Y direction over columns. Small sizes use the gaussian kernel truncated at
+ * the size (three times sigma), larger ones approximate it by a cascade of
+ * three box filters. Every box pass is a running sum, so the cost per pixel
+ * does not depend on the blur size.
  *
- * Once we can we'll implement a way to apply filter as multiple stages we
- * can optimize hell of a lot in here.
+ * Pixels outside of the frame are not taken into account, the result gets
+ * normalized by the weights of the pixels inside the frame.
  */
 
+#define GAUSSIAN_BLUR_NUM_PASSES 3
+/* sizes below this use the gaussian kernel directly */
+#define GAUSSIAN_BLUR_KERNEL_SIZE 10
+/* number of rows or columns processed by one task */
+#define GAUSSIAN_BLUR_CHUNK_SIZE 16
+
 static void init_gaussian_blur_effect(Sequence *seq)
 {
 	if (seq->effectdata)
@@ -2635,248 +2560,294 @@ static int early_out_gaussian_blur(Sequence *seq, float UNUSED(facf0), float UNU
 	return EARLY_DO_EFFECT;
 }
 
-/* TODO(sergey): De-duplicate with compositor. */
-static float *make_gaussian_blur_kernel(float rad, int size)
+/* Radii of the box filters whose cascade has the variance of a gaussian with the
+ * given sigma, see "Fast Almost-Gaussian Filtering" by Peter Kovesi.
+ */
+static void gaussian_blur_box_radii(float sigma, int radii[GAUSSIAN_BLUR_NUM_PASSES])
 {
-	float *gausstab, sum, val;
-	float fac;
-	int i, n;
+	const int n = GAUSSIAN_BLUR_NUM_PASSES;
+	const float variance = 12.0f * sigma * sigma;
+	int width_lower, num_lower, i;
+
+	width_lower = (int)sqrtf(variance / n + 1.0f);
+	if (width_lower % 2 == 0)
+		width_lower--;
+	width_lower = max_ii(width_lower, 1);
 
-	n = 2 * size + 1;
+	num_lower = (int)floorf((variance - n * width_lower * width_lower - 4 * n * width_lower - 3 * n) /
+	                        (-4 * width_lower - 4) + 0.5f);
+	CLAMP(num_lower, 0, n);
 
-	gausstab = (float *)MEM_mallocN(sizeof(float) * n, __func__);
+	for (i = 0; i < n; i++) {
+		radii[i] = ((i < num_lower ? width_lower : width_lower + 2) - 1) / 2;
+	}
+}
+
+/* One box filter pass over len elements of num_channels floats, zero outside. */
+static void gaussian_blur_box_pass(const float *src, float *dst, double *sum, int len, int num_channels, int radius)
+{
+	int i, k;
 
-	sum = 0.0f;
-	fac = (rad > 0.0f ? 1.0f / rad : 0.0f);
-	for (i = -size; i <= size; i++) {
-		val = RE_filter_value(R_FILTER_GAUSS, (float)i * fac);
-		sum += val;
-		gausstab[i + size] = val;
+	for (k = 0; k < num_channels; k++)
+		sum[k] = 0.0;
+
+	for (i = 0; i <= radius && i < len; i++) {
+		const float *in = src + i * num_channels;
+		for (k = 0; k < num_channels; k++)
+			sum[k] += in[k];
 	}
 
-	sum = 1.0f / sum;
-	for (i = 0; i < n; i++)
-		gausstab[i] *= sum;
+	for (i = 0; i < len; i++) {
+		float *out = dst + i * num_channels;
+
+		for (k = 0; k < num_channels; k++)
+			out[k] = (float)sum[k];
 
-	return gausstab;
+		if (i + radius + 1 < len) {
+			const float *in = src + (i + radius + 1) * num_channels;
+			for (k = 0; k < num_channels; k++)
+				sum[k] += in[k];
+		}
+		if (i - radius >= 0) {
+			const float *in = src + (i - radius) * num_channels;
+			for (k = 0; k < num_channels; k++)
+				sum[k] -= in[k];
+		}
+	}
 }
 
-static void do_gaussian_blur_effect_byte(Sequence *seq,
-                                         int start_line,
-                                         int x, int y,
-                                         int frame_width, int frame_height,
-                                         unsigned char *rect,
-                                         unsigned char *out)
+/* Gaussian kernel pass, zero outside. */
+static void gaussian_blur_kernel_pass(const float *src, float *dst, int len, int num_channels,
+                                      const float *kernel, int size)
 {
-#define INDEX(_x, _y) (((_y) * (x) + (_x)) * 4)
-	GaussianBlurVars *data = seq->effectdata;
-	const int size_x = (int) (data->size_x + 0.5f),
-	          size_y = (int) (data->size_y + 0.5f);
-	int i, j;
+	int i, j, k;
 
-	/* Make gaussian weight tabke. */
-	float *gausstab_x, *gausstab_y;
-	gausstab_x = make_gaussian_blur_kernel(data->size_x, size_x);
-	if (data->size_x == data->size_y) {
-		gausstab_y = gausstab_x;
-	}
-	else {
-		gausstab_y = make_gaussian_blur_kernel(data->size_y, size_y);
-	}
-
-	for (i = 0; i < y; ++i) {
-		for (j = 0; j < x; ++j) {
-			int out_index = INDEX(j, i);
-			int current_x, current_y;
-			float accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
-			float accum_weight = 0.0f;
-			for (current_y = i - size_y;
-			     current_y <= i + size_y;
-			     ++current_y)
-			{
-				if (current_y < -start_line ||
-				    current_y + start_line >= frame_height)
-				{
-					/* Out of bounds. */
-					continue;
-				}
+	for (i = 0; i < len; i++) {
+		const int start = max_ii(i - size, 0), end = min_ii(i + size, len - 1);
+		float *out = dst + i * num_channels;
 
-				for (current_x = j - size_x;
-				     current_x <= j + size_x;
-				     ++current_x)
-				{
-					float weight;
-					int index = INDEX(current_x, current_y + start_line);
-					if (current_x < 0 || current_x >= frame_width) {
-						/* Out of bounds. */
-						continue;
-					}
-					BLI_assert(index >= 0);
-					BLI_assert(index < frame_width * frame_height * 4);
-
-					if (size_x != 0 && size_y != 0) {
-						weight = gausstab_x[current_x - j + size_x] *
-							gausstab_y[current_y - i + size_y];
-					}
-					else if (size_x == 0) {
-						weight = gausstab_y[current_y - i + size_y];
-					}
-					else {
-						weight = gausstab_x[current_x - j + size_x];
-					}
-					accum[0] += rect[index] * weight;
-					accum[1] += rect[index + 1] * weight;
-					accum[2] += rect[index + 2] * weight;
-					accum[3] += rect[index + 3] * weight;
-					accum_weight += weight;
-				}
-			}
-			out[out_index + 0] = accum[0] / accum_weight;
-			out[out_index + 1] = accum[1] / accum_weight;
-			out[out_index + 2] = accum[2] / accum_weight;
-			out[out_index + 3] = accum[3] / accum_weight;
+		for (k = 0; k < num_channels; k++)
+			out[k] = 0.0f;
+
+		for (j = start; j <= end; j++) {
+			const float *in = src + j * num_channels;
+			const float weight = kernel[j - i + size];
+
+			for (k = 0; k < num_channels; k++)
+				out[k] += in[k] * weight;
 		}
 	}
+}
+
+/* Blur settings of one direction. */
+typedef struct GaussianBlurAxis {
+	bool do_blur;
+	/* gaussian kernel of 2 * size + 1 taps, NULL when box filters are used */
+	float *kernel;
+	int size;
+	int radii[GAUSSIAN_BLUR_NUM_PASSES];
+	/* inverse of the weights of the pixels inside the frame */
+	float *weights;
+} GaussianBlurAxis;
+
+/* Blur len elements of num_channels floats, the result ends up in buffer[0]. */
+static void gaussian_blur_line(const GaussianBlurAxis *axis, float *buffer[2], double *sum, int len, int num_channels)
+{
+	int i;
+
+	if (axis->kernel) {
+		gaussian_blur_kernel_pass(buffer[0], buffer[1], len, num_channels, axis->kernel, axis->size);
+		SWAP(float *, buffer[0], buffer[1]);
+		return;
+	}
 
-	MEM_freeN(gausstab_x);
-	if (gausstab_x != gausstab_y) {
-		MEM_freeN(gausstab_y);
+	for (i = 0; i < GAUSSIAN_BLUR_NUM_PASSES; i++) {
+		gaussian_blur_box_pass(buffer[0], buffer[1], sum, len, num_channels, axis->radii[i]);
+		SWAP(float *, buffer[0], buffer[1]);
 	}
-#undef INDEX
 }
 
-static void do_gaussian_blur_effect_float(Sequence *seq,
-                                          int start_line,
-                                          int x, int y,
-                                          int frame_width, int frame_height,
-                                          float *rect,
-                                          float *out)
+static void gaussian_blur_axis_init(GaussianBlurAxis *axis, float rad, int len)
 {
-#define INDEX(_x, _y) (((_y) * (x) + (_x)) * 4)
-	GaussianBlurVars *data = seq->effectdata;
-	const int size_x = (int) (data->size_x + 0.5f),
-	          size_y = (int) (data->size_y + 0.5f);
-	int i, j;
+	float *buffer[2];
+	double sum;
+	int i;
+
+	/* kernel is truncated at the size, which is three times sigma */
+	axis->size = (int)(rad + 0.5f);
+	axis->do_blur = axis->size > 0;
 
-	/* Make gaussian weight tabke. */
-	float *gausstab_x, *gausstab_y;
-	gausstab_x = make_gaussian_blur_kernel(data->size_x, size_x);
-	if (data->size_x == data->size_y) {
-		gausstab_y = gausstab_x;
+	if (!axis->do_blur)
+		return;
+
+	if (axis->size < GAUSSIAN_BLUR_KERNEL_SIZE) {
+		axis->kernel = MEM_mallocN(sizeof(float) * (2 * axis->size + 1), "gaussian blur kernel");
+		for (i = -axis->size; i <= axis->size; i++) {
+			const float x = (float)i / rad;
+			axis->kernel[i + axis->size] = expf(-4.5f * x * x);
+		}
 	}
 	else {
-		gausstab_y = make_gaussian_blur_kernel(data->size_y, size_y);
-	}
-
-	for (i = 0; i < y; ++i) {
-		for (j = 0; j < x; ++j) {
-			int out_index = INDEX(j, i);
-			int current_x, current_y;
-			float accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
-			float accum_weight = 0.0f;
-			for (current_y = i - size_y;
-			     current_y <= i + size_y;
-			     ++current_y)
-			{
-				float weight;
-				if (current_y < -start_line ||
-				    current_y + start_line >= frame_height)
-				{
-					/* Out of bounds. */
-					continue;
-				}
+		gaussian_blur_box_radii(rad / 3.0f, axis->radii);
+	}
 
-				for (current_x = j - size_x;
-				     current_x <= j + size_x;
-				     ++current_x)
-				{
-					int index = INDEX(current_x, current_y + start_line);
-					if (current_x < 0 || current_x >= frame_width) {
-						/* Out of bounds. */
-						continue;
-					}
-
-					if (size_x != 0 && size_y != 0) {
-						weight = gausstab_x[current_x - j + size_x] *
-							gausstab_y[current_y - i + size_y];
-					}
-					else if (size_x == 0) {
-						weight = gausstab_y[current_y - i + size_y];
-					}
-					else {
-						weight = gausstab_x[current_x - j + size_x];
-					}
-					madd_v4_v4fl(accum, &rect[index], weight);
-					accum_weight += weight;
-				}
-			}
-			mul_v4_v4fl(&out[out_index], accum, 1.0f / accum_weight);
+	buffer[0] = MEM_mallocN(sizeof(float) * len, "gaussian blur weights");
+	buffer[1] = MEM_mallocN(sizeof(float) * len, "gaussian blur weights");
+
+	for (i = 0; i < len; i++)
+		buffer[0][i] = 1.0f;
+
+	gaussian_blur_line(axis, buffer, &sum, len, 1);
+
+	for (i = 0; i < len; i++)
+		buffer[0][i] = 1.0f / buffer[0][i];
+
+	axis->weights = buffer[0];
+	MEM_freeN(buffer[1]);
+}
+
+static void gaussian_blur_axis_free(GaussianBlurAxis *axis)
+{
+	if (axis->kernel)
+		MEM_freeN(axis->kernel);
+	if (axis->weights)
+		MEM_freeN(axis->weights);
+}
+
+typedef struct GaussianBlurThreadData {
+	int width, height;
+	GaussianBlurAxis axis_x, axis_y;
+
+	const unsigned char *rect;
+	const float *rect_float;
+
+	/* result of the horizontal pass */
+	float *buffer;
+
+	unsigned char *out;
+	float *out_float;
+} GaussianBlurThreadData;
+
+static void gaussian_blur_rows(void *userdata, int chunk)
+{
+	GaussianBlurThreadData *data = userdata;
+	const int width = data->width;
+	const int start = chunk * GAUSSIAN_BLUR_CHUNK_SIZE;
+	const int end = min_ii(start + GAUSSIAN_BLUR_CHUNK_SIZE, data->height);
+	float *buffer[2];
+	double sum[4];
+	int x, y, i;
+
+	buffer[0] = MEM_mallocN(sizeof(float) * 4 * width, "gaussian blur row");
+	buffer[1] = MEM_mallocN(sizeof(float) * 4 * width, "gaussian blur row");
+
+	for (y = start; y < end; y++) {
+		float *row = data->buffer + (size_t)y * width * 4;
+
+		if (data->rect_float) {
+			memcpy(buffer[0], data->rect_float + (size_t)y * width * 4, sizeof(float) * 4 * width);
+		}
+		else {
+			const unsigned char *rect = data->rect + (size_t)y * width * 4;
+			for (i = 0; i < 4 * width; i++)
+				buffer[0][i] = rect[i];
+		}
+
+		if (data->axis_x.do_blur) {
+			gaussian_blur_line(&data->axis_x, buffer, sum, width, 4);
+			for (x = 0; x < width; x++)
+				mul_v4_v4fl(row + x * 4, buffer[0] + x * 4, data->axis_x.weights[x]);
 		}
+		else {
+			memcpy(row, buffer[0], sizeof(float) * 4 * width);
+		}
+	}
+
+	MEM_freeN(buffer[0]);
+	MEM_freeN(buffer[1]);
+}
+
+static void gaussian_blur_columns(void *userdata, int chunk)
+{
+	GaussianBlurThreadData *data = userdata;
+	const int width = data->width, height = data->height;
+	const int start = chunk * GAUSSIAN_BLUR_CHUNK_SIZE;
+	const int num_columns = min_ii(GAUSSIAN_BLUR_CHUNK_SIZE, width - start);
+	/* columns of the chunk are blurred together, one row of the chunk at a time */
+	const int num_channels = 4 * num_columns;
+	float *buffer[2];
+	double sum[4 * GAUSSIAN_BLUR_CHUNK_SIZE];
+	int y, i;
+
+	buffer[0] = MEM_mallocN(sizeof(float) * num_channels * height, "gaussian blur columns");
+	buffer[1] = MEM_mallocN(sizeof(float) * num_channels * height, "gaussian blur columns");
+
+	for (y = 0; y < height; y++) {
+		memcpy(buffer[0] + y * num_channels, data->buffer + ((size_t)y * width + start) * 4,
+		       sizeof(float) * num_channels);
+	}
+
+	if (data->axis_y.do_blur) {
+		gaussian_blur_line(&data->axis_y, buffer, sum, height, num_channels);
 	}
 
-	MEM_freeN(gausstab_x);
-	if (gausstab_x != gausstab_y) {
-		MEM_freeN(gausstab_y);
+	for (y = 0; y < height; y++) {
+		const float *in = buffer[0] + y * num_channels;
+		const float weight = data->axis_y.do_blur ? data->axis_y.weights[y] : 1.0f;
+		const size_t offset = ((size_t)y * width + start) * 4;
+
+		if (data->out_float) {
+			for (i = 0; i < num_channels; i++)
+				data->out_float[offset + i] = in[i] * weight;
+		}
+		else {
+			/* truncated like the blur always did, rounding makes byte frames a bit brighter */
+			for (i = 0; i < num_channels; i++)
+				data->out[offset + i] = (unsigned char)CLAMPIS(in[i] * weight, 0.0f, 255.0f);
+		}
 	}
-#undef INDEX
+
+	MEM_freeN(buffer[0]);
+	MEM_freeN(buffer[1]);
 }
 
-static void do_gaussian_blur_effect(const SeqRenderData *context,
-                                    Sequence *seq,
-                                    float UNUSED(cfra),
-                                    float UNUSED(facf0),
-                                    float UNUSED(facf1),
-                                    ImBuf *ibuf1,
-                                    ImBuf *ibuf2,
-                                    ImBuf *UNUSED(ibuf3),
-                                    int start_line,
-                                    int total_lines,
-                                    ImBuf *out)
+static ImBuf *do_gaussian_blur_effect(const SeqRenderData *context, Sequence *seq, float UNUSED(cfra),
+                                      float UNUSED(facf0), float UNUSED(facf1),
+                                      ImBuf *ibuf1, ImBuf *ibuf2, ImBuf *ibuf3)
 {
-	if (out->rect_float) {
-		float *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
+	ImBuf *out = prepare_effect_imbufs(context, ibuf1, ibuf2, ibuf3);
+	GaussianBlurVars *vars = seq->effectdata;
+	GaussianBlurThreadData data = {0};
+	const int width = context->rectx, height = context->recty;
+
+	data.width = width;
+	data.height = height;
+	gaussian_blur_axis_init(&data.axis_x, vars->size_x, width);
+	gaussian_blur_axis_init(&data.axis_y, vars->size_y, height);
 
-		slice_get_float_buffers(context,
-		                        ibuf1, ibuf2,
-		                        NULL,
-		                        out,
-		                        start_line,
-		                        &rect1,
-		                        &rect2,
-		                        NULL,
-		                        &rect_out);
-
-		do_gaussian_blur_effect_float(seq,
-		                              start_line,
-		                              context->rectx,
-		                              total_lines,
-		                              context->rectx,
-		                              context->recty,
-		                              ibuf1->rect_float,
-		                              rect_out);
+	if (out->rect_float) {
+		data.rect_float = ibuf1->rect_float;
+		data.out_float = out->rect_float;
+		/* columns are blurred in place */
+		data.buffer = out->rect_float;
 	}
 	else {
-		unsigned char *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
+		data.rect = (unsigned char *)ibuf1->rect;
+		data.out = (unsigned char *)out->rect;
+		data.buffer = MEM_mallocN(sizeof(float) * 4 * width * height, "gaussian blur buffer");
+	}
 
-		slice_get_byte_buffers(context,
-		                       ibuf1, ibuf2,
-		                       NULL,
-		                       out,
-		                       start_line,
-		                       &rect1,
-		                       &rect2,
-		                       NULL,
-		                       &rect_out);
+	BLI_task_parallel_range_ex(0, (height + GAUSSIAN_BLUR_CHUNK_SIZE - 1) / GAUSSIAN_BLUR_CHUNK_SIZE,
+	                           &data, gaussian_blur_rows, 2, false);
+	BLI_task_parallel_range_ex(0, (width + GAUSSIAN_BLUR_CHUNK_SIZE - 1) / GAUSSIAN_BLUR_CHUNK_SIZE,
+	                           &data, gaussian_blur_columns, 2, false);
 
-		do_gaussian_blur_effect_byte(seq,
-		                             start_line,
-		                             context->rectx,
-		                             total_lines,
-		                             context->rectx,
-		                             context->recty,
-		                             (unsigned char *) ibuf1->rect,
-		                             rect_out);
-	}
+	if (data.buffer != out->rect_float)
+		MEM_freeN(data.buffer);
+	gaussian_blur_axis_free(&data.axis_x);
+	gaussian_blur_axis_free(&data.axis_y);
+
+	return out;
 }
 
 /*********************** sequence effect factory *************************/
@@ -3068,13 +3039,12 @@ static struct SeqEffectHandle get_sequence_effect_impl(int seq_type)
 			rval.execute = do_adjustment;
 			break;
 		case SEQ_TYPE_GAUSSIAN_BLUR:
-			rval.multithreaded = true;
 			rval.init = init_gaussian_blur_effect;
 			rval.num_inputs = num_inputs_gaussian_blur;
 			rval.free = free_gaussian_blur_effect;
 			rval.copy = copy_gaussian_blur_effect;
 			rval.early_out = early_out_gaussian_blur;
-			rval.execute_slice = do_gaussian_blur_effect;
+			rval.execute = do_gaussian_blur_effect;
 			break;
 	}
 
@@ -3128,3 +3098,67 @@ int BKE_sequence_effect_get_supports_mask(int seq_type)
 
 	return rval.supports_mask;
 }
+
+/* Print megapixels per second of the blend kernels on random buffers, to compare
+ * the SIMD kernels against the scalar ones (built without __SSE2__).
+ */
+void BKE_sequencer_blend_effects_benchmark(int width, int height, int iterations)
+{
+	static const SeqBlendKernel *kernels[] = {
+		&seq_blend_alphaover, &seq_blend_alphaunder, &seq_blend_cross, &seq_blend_gammacross,
+		&seq_blend_add, &seq_blend_sub, &seq_blend_mul
+	};
+	const size_t num_values = (size_t)width * height * 4;
+	const double mpix = (double)width * height * iterations / 1000000.0;
+	unsigned char *byte_rect[3];
+	float *float_rect[3];
+	RNG *rng = BLI_rng_new(0);
+	size_t i;
+	int j, k;
+
+	for (j = 0; j < 3; j++) {
+		byte_rect[j] = MEM_mallocN(sizeof(unsigned char) * num_values, "seq blend benchmark byte");
+		float_rect[j] = MEM_mallocN(sizeof(float) * num_values, "seq blend benchmark float");
+
+		for (i = 0; i < num_values; i++) {
+			float_rect[j][i] = BLI_rng_get_float(rng);
+			byte_rect[j][i] = FTOCHAR(float_rect[j][i]);
+		}
+	}
+
+	build_gammatabs();
+
+	printf("Sequencer blend effects, %dx%d, %d iterations%s:\n", width, height, iterations,
+#ifdef __SSE2__
+	       " (SSE2)"
+#else
+	       ""
+#endif
+	       );
+
+	for (k = 0; k < ARRAY_SIZE(kernels); k++) {
+		double start, time_byte, time_float;
+
+		start = PIL_check_seconds_timer();
+		for (j = 0; j < iterations; j++) {
+			blend_effect_byte(kernels[k], 0.5f, 0.5f, width, height, byte_rect[0], byte_rect[1], byte_rect[2]);
+		}
+		time_byte = PIL_check_seconds_timer() - start;
+
+		start = PIL_check_seconds_timer();
+		for (j = 0; j < iterations; j++) {
+			blend_effect_float(kernels[k], 0.5f, 0.5f, width, height, float_rect[0], float_rect[1], float_rect[2]);
+		}
+		time_float = PIL_check_seconds_timer() - start;
+
+		printf("  %-12s byte: %9.1f Mpix/s, float: %9.1f Mpix/s\n", kernels[k]->name,
+		       mpix / MAX2(time_byte, 1e-9), mpix / MAX2(time_float, 1e-9));
+	}
+
+	for (j = 0; j < 3; j++) {
+		MEM_freeN(byte_rect[j]);
+		MEM_freeN(float_rect[j]);
+	}
+
+	BLI_rng_free(rng);
+}
@@ -0,0 +1,374 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/blenkernel/intern/seqprefetch.c
+ *  \ingroup bke
+ *
+ * Read-ahead of the sequencer during playback.
+ *
+ * After a frame is given to the preview, a task renders the frames that follow it into the
+ * sequencer cache, so playback only has to read them from the cache. Strips share their
+ * decoders and the editing data isn't locked by the editors, so the task only renders while the
+ * main thread waits for events: it doesn't edit strips or render the preview then. Effects still
+ * use all threads to render a single frame.
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include "MEM_guardedalloc.h"
+#include "MEM_CacheLimiterC-Api.h"
+
+#include "DNA_scene_types.h"
+#include "DNA_sequence_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BLI_listbase.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "PIL_time.h"
+
+#include "BKE_global.h"
+#include "BKE_sequencer.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+/* number of frames given to the preview between printing the cache hit rate in debug mode */
+#define PREFETCH_STATS_INTERVAL 250
+
+typedef struct PrefetchState {
+	TaskPool *pool;
+	/* the task is pushed or running */
+	bool running;
+	/* the task has to stop after the frame it is rendering */
+	bool stop;
+	/* thread of the running task, stopping from the task itself must not wait for it */
+	pthread_t thread;
+	bool has_thread;
+
+	/* the latest request, the task always continues after the latest frame given to the preview */
+	SeqRenderData context;
+	float cfra;
+	int chanshown;
+	int request;
+
+	/* frames given to the preview that were found in the cache */
+	int hits, misses;
+} PrefetchState;
+
+static PrefetchState prefetch = {NULL};
+/* protects the prefetch state */
+static ThreadMutex prefetch_lock = BLI_MUTEX_INITIALIZER;
+/* held by the task while it renders a frame, and by the main thread to change main_is_idle */
+static ThreadMutex edit_lock = BLI_MUTEX_INITIALIZER;
+/* the main thread waits for events, nothing changes the editing data */
+static bool main_is_idle = false;
+
+static void prefetch_print_stats(void)
+{
+	const int total = prefetch.hits + prefetch.misses;
+
+	if ((G.debug & G_DEBUG) && total) {
+		printf("Sequencer prefetch: %d of %d frames from the cache (%.1f%%)\n",
+		       prefetch.hits, total, 100.0f * prefetch.hits / total);
+	}
+	prefetch.hits = 0;
+	prefetch.misses = 0;
+}
+
+static bool prefetch_is_canceled(TaskPool *pool)
+{
+	return prefetch.stop || G.is_rendering || BLI_task_pool_canceled(pool);
+}
+
+/* frames that fit in half of the cache, the other half is left to the frames that are played */
+static int prefetch_num_frames(const SeqRenderData *context)
+{
+	const size_t limit = MEM_CacheLimiter_get_maximum();
+	/* the final frame is float in the worst case, strip buffers come on top of it */
+	const size_t frame_size = (size_t)context->rectx * (size_t)context->recty * 4 * sizeof(float);
+	int num_frames = U.prefetchframes;
+
+	if (limit && frame_size) {
+		num_frames = (int)MIN2((size_t)num_frames, limit / 2 / frame_size);
+	}
+
+	return num_frames;
+}
+
+/* frame offset frames after cfra, wrapping around the end like looping playback does */
+static float prefetch_frame(const Scene *scene, float cfra, int offset)
+{
+	const int start = PSFRA, end = PEFRA;
+	float frame = cfra + offset;
+
+	if (cfra <= end && frame > end && end >= start) {
+		frame = start + fmodf(frame - end - 1, end - start + 1);
+	}
+
+	return frame;
+}
+
+static bool prefetch_seqbase_is_safe(Scene *scene, ListBase *seqbase, float cfra);
+
+/* scene, clip and mask strips evaluate shared data while rendering, animated strips evaluate the
+ * scene animation at the rendered frame, they are only rendered by the preview */
+static bool prefetch_strip_is_safe(Scene *scene, Sequence *seq, float cfra)
+{
+	SequenceModifierData *smd;
+
+	if (ELEM(seq->type, SEQ_TYPE_SCENE, SEQ_TYPE_MOVIECLIP, SEQ_TYPE_MASK)) {
+		return false;
+	}
+
+	if (BKE_sequencer_has_animdata(scene, seq)) {
+		return false;
+	}
+
+	for (smd = seq->modifiers.first; smd; smd = smd->next) {
+		if (smd->mask_id) {
+			return false;
+		}
+	}
+
+	/* effect inputs are rendered with the effect, also when they are in another channel or meta */
+	if ((seq->seq1 && !prefetch_strip_is_safe(scene, seq->seq1, cfra)) ||
+	    (seq->seq2 && !prefetch_strip_is_safe(scene, seq->seq2, cfra)) ||
+	    (seq->seq3 && !prefetch_strip_is_safe(scene, seq->seq3, cfra)))
+	{
+		return false;
+	}
+
+	if (seq->type == SEQ_TYPE_META && !prefetch_seqbase_is_safe(scene, &seq->seqbase, cfra)) {
+		return false;
+	}
+
+	return true;
+}
+
+static bool prefetch_seqbase_is_safe(Scene *scene, ListBase *seqbase, float cfra)
+{
+	Sequence *seq;
+
+	for (seq = seqbase->first; seq; seq = seq->next) {
+		if (seq->startdisp > cfra || seq->enddisp <= cfra) {
+			continue;
+		}
+
+		if (!prefetch_strip_is_safe(scene, seq, cfra)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* wait until the main thread waits for events, without blocking a stop */
+static bool prefetch_edit_lock(TaskPool *pool)
+{
+	while (true) {
+		BLI_mutex_lock(&edit_lock);
+
+		if (prefetch_is_canceled(pool)) {
+			BLI_mutex_unlock(&edit_lock);
+			return false;
+		}
+
+		if (main_is_idle) {
+			return true;
+		}
+
+		BLI_mutex_unlock(&edit_lock);
+		PIL_sleep_ms(1);
+	}
+}
+
+/* render a frame into the cache when it's not there yet, called with the edit lock */
+static void prefetch_render_frame(const SeqRenderData *context, float cfra, int offset, int chanshown)
+{
+	Editing *ed = BKE_sequencer_editing_get(context->scene, false);
+	const float frame = prefetch_frame(context->scene, cfra, offset);
+	ImBuf *ibuf;
+
+	if (!ed || !prefetch_seqbase_is_safe(context->scene, ed->seqbasep, frame)) {
+		return;
+	}
+
+	ibuf = BKE_sequencer_give_ibuf_cached(context, frame, chanshown);
+	if (!ibuf) {
+		ibuf = BKE_sequencer_give_ibuf(context, frame, chanshown);
+	}
+
+	if (ibuf) {
+		IMB_freeImBuf(ibuf);
+	}
+}
+
+static void prefetch_task(TaskPool *pool, void *UNUSED(taskdata), int UNUSED(threadid))
+{
+	BLI_mutex_lock(&prefetch_lock);
+	prefetch.thread = pthread_self();
+	prefetch.has_thread = true;
+
+	while (!prefetch_is_canceled(pool)) {
+		const SeqRenderData context = prefetch.context;
+		const float cfra = prefetch.cfra;
+		const int chanshown = prefetch.chanshown;
+		const int request = prefetch.request;
+		const int num_frames = prefetch_num_frames(&context);
+		int offset;
+
+		BLI_mutex_unlock(&prefetch_lock);
+
+		for (offset = 1; offset <= num_frames; offset++) {
+			/* the preview moved on, start again after its frame */
+			if (prefetch_is_canceled(pool) || request != prefetch.request) {
+				break;
+			}
+
+			if (!prefetch_edit_lock(pool)) {
+				break;
+			}
+			prefetch_render_frame(&context, cfra, offset, chanshown);
+			BLI_mutex_unlock(&edit_lock);
+		}
+
+		BLI_mutex_lock(&prefetch_lock);
+
+		if (request == prefetch.request) {
+			break;
+		}
+	}
+
+	prefetch.has_thread = false;
+	prefetch.running = false;
+	BLI_mutex_unlock(&prefetch_lock);
+}
+
+/* only called from the main thread, the task doesn't render while the main thread is busy */
+ImBuf *BKE_sequencer_give_ibuf_threaded(const SeqRenderData *context, float cfra, int chanshown)
+{
+	ImBuf *ibuf = BKE_sequencer_give_ibuf_cached(context, cfra, chanshown);
+
+	if (ibuf) {
+		prefetch.hits++;
+	}
+	else {
+		prefetch.misses++;
+		ibuf = BKE_sequencer_give_ibuf(context, cfra, chanshown);
+	}
+
+	BKE_sequencer_prefetch_start(context, cfra, chanshown);
+
+	if (prefetch.hits + prefetch.misses >= PREFETCH_STATS_INTERVAL) {
+		prefetch_print_stats();
+	}
+
+	return ibuf;
+}
+
+void BKE_sequencer_prefetch_start(const SeqRenderData *context, float cfra, int chanshown)
+{
+	if (U.prefetchframes <= 0 || G.is_rendering || context->skip_cache) {
+		return;
+	}
+
+	BLI_mutex_lock(&prefetch_lock);
+
+	prefetch.context = *context;
+	prefetch.cfra = cfra;
+	prefetch.chanshown = chanshown;
+	prefetch.request++;
+
+	if (!prefetch.running) {
+		if (!prefetch.pool) {
+			prefetch.pool = BLI_task_pool_create(BLI_task_scheduler_get(), NULL);
+		}
+
+		prefetch.running = true;
+		prefetch.stop = false;
+		BLI_task_pool_push(prefetch.pool, prefetch_task, NULL, false, TASK_PRIORITY_LOW);
+	}
+
+	BLI_mutex_unlock(&prefetch_lock);
+}
+
+/* the main thread waits for events, the task can render until BKE_sequencer_prefetch_idle_end */
+void BKE_sequencer_prefetch_idle_begin(void)
+{
+	BLI_mutex_lock(&edit_lock);
+	main_is_idle = true;
+	BLI_mutex_unlock(&edit_lock);
+}
+
+/* the main thread handles events and may change the editing data, waits for the frame the task renders */
+void BKE_sequencer_prefetch_idle_end(void)
+{
+	BLI_mutex_lock(&edit_lock);
+	main_is_idle = false;
+	BLI_mutex_unlock(&edit_lock);
+}
+
+/* must be called before the cache or the strips the task renders are freed */
+void BKE_sequencer_prefetch_stop(void)
+{
+	TaskPool *pool;
+
+	BLI_mutex_lock(&prefetch_lock);
+
+	if (!prefetch.running) {
+		BLI_mutex_unlock(&prefetch_lock);
+		return;
+	}
+
+	prefetch.stop = true;
+
+	/* called while the task renders a frame, it ends after the frame */
+	if (prefetch.has_thread && pthread_equal(prefetch.thread, pthread_self())) {
+		BLI_mutex_unlock(&prefetch_lock);
+		return;
+	}
+
+	pool = prefetch.pool;
+	BLI_mutex_unlock(&prefetch_lock);
+
+	/* removes the task when it did not start yet, waits for it otherwise */
+	BLI_task_pool_cancel(pool);
+
+	BLI_mutex_lock(&prefetch_lock);
+	prefetch.running = false;
+	prefetch.stop = false;
+	BLI_mutex_unlock(&prefetch_lock);
+
+	prefetch_print_stats();
+}
+
+void BKE_sequencer_prefetch_free(void)
+{
+	BKE_sequencer_prefetch_stop();
+
+	if (prefetch.pool) {
+		BLI_task_pool_free(prefetch.pool);
+		prefetch.pool = NULL;
+	}
+}
@@ -46,15 +46,19 @@
 
 #include "BLI_math.h"
 #include "BLI_fileops.h"
+#include "BLI_ghash.h"
 #include "BLI_listbase.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_string_utf8.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BLF_translation.h"
 
+#include "PIL_time.h"
+
 #include "BKE_animsys.h"
 #include "BKE_depsgraph.h"
 #include "BKE_global.h"
@@ -71,8 +75,6 @@
 
 #include "RE_pipeline.h"
 
-#include <pthread.h>
-
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 #include "IMB_colormanagement.h"
@@ -177,6 +179,9 @@ static void seq_free_strip(Strip *strip)
 /* only give option to skip cache locally (static func) */
 static void BKE_sequence_free_ex(Scene *scene, Sequence *seq, const bool do_cache)
 {
+	/* the strip may be rendered in the background */
+	BKE_sequencer_prefetch_stop();
+
 	if (seq->strip)
 		seq_free_strip(seq->strip);
 
@@ -1119,7 +1124,7 @@ static void multibuf(ImBuf *ibuf, float fmul)
 	}
 }
 
-static float give_stripelem_index(Sequence *seq, float cfra)
+float BKE_sequencer_give_stripelem_index(Sequence *seq, float cfra)
 {
 	float nr;
 	int sta = seq->start;
@@ -1163,7 +1168,7 @@ StripElem *BKE_sequencer_give_stripelem(Sequence *seq, int cfra)
 		 * all other strips don't use this...
 		 */
 
-		int nr = (int) give_stripelem_index(seq, cfra);
+		int nr = (int) BKE_sequencer_give_stripelem_index(seq, cfra);
 
 		if (nr == -1 || se == NULL)
 			return NULL;
@@ -1297,6 +1302,10 @@ typedef struct SeqIndexBuildContext {
 	Main *bmain;
 	Scene *scene;
 	Sequence *seq, *orig_seq;
+
+	/* proxy frames rendered for image strips and the time it took */
+	int num_frames;
+	double time;
 } SeqIndexBuildContext;
 
 #define PROXY_MAXFILE (2 * FILE_MAXDIR + FILE_MAXFILE)
@@ -1411,7 +1420,7 @@ static bool seq_proxy_get_fname(Sequence *seq, int cfra, int render_size, char *
 		frameno = 1;
 	}
 	else {
-		frameno = (int)give_stripelem_index(seq, cfra) + seq->anim_startofs;
+		frameno = (int)BKE_sequencer_give_stripelem_index(seq, cfra) + seq->anim_startofs;
 		BLI_snprintf(name, PROXY_MAXFILE, "%s/proxy_misc/%d/####", dir, render_size);
 	}
 
@@ -1447,7 +1456,7 @@ static ImBuf *seq_proxy_fetch(const SeqRenderData *context, Sequence *seq, int c
 	}
 
 	if (seq->flag & SEQ_USE_PROXY_CUSTOM_FILE) {
-		int frameno = (int)give_stripelem_index(seq, cfra) + seq->anim_startofs;
+		int frameno = (int)BKE_sequencer_give_stripelem_index(seq, cfra) + seq->anim_startofs;
 		if (seq->strip->proxy->anim == NULL) {
 			if (seq_proxy_get_fname(seq, cfra, render_size, name) == 0) {
 				return NULL;
@@ -1524,7 +1533,8 @@ static void seq_proxy_build_frame(const SeqRenderData *context, Sequence *seq, i
 	IMB_freeImBuf(ibuf);
 }
 
-SeqIndexBuildContext *BKE_sequencer_proxy_rebuild_context(Main *bmain, Scene *scene, Sequence *seq)
+/* file_list holds the movie files other contexts build, returns NULL when the strip has nothing left to build */
+SeqIndexBuildContext *BKE_sequencer_proxy_rebuild_context(Main *bmain, Scene *scene, Sequence *seq, GSet *file_list)
 {
 	SeqIndexBuildContext *context;
 	Sequence *nseq;
@@ -1555,7 +1565,14 @@ SeqIndexBuildContext *BKE_sequencer_proxy_rebuild_context(Main *bmain, Scene *sc
 
 		if (nseq->anim) {
 			context->index_context = IMB_anim_index_rebuild_context(nseq->anim,
-			        context->tc_flags, context->size_flags, context->quality);
+			        context->tc_flags, context->size_flags, context->quality, file_list);
+		}
+
+		/* another strip of the same movie builds its files, building them twice at once
+		 * would write to the same temporary files */
+		if (!context->index_context) {
+			BKE_sequencer_proxy_rebuild_finish(context, false);
+			return NULL;
 		}
 	}
 
@@ -1568,6 +1585,7 @@ void BKE_sequencer_proxy_rebuild(SeqIndexBuildContext *context, short *stop, sho
 	Sequence *seq = context->seq;
 	Scene *scene = context->scene;
 	Main *bmain = context->bmain;
+	double start_time;
 	int cfra;
 
 	if (seq->type == SEQ_TYPE_MOVIE) {
@@ -1595,6 +1613,8 @@ void BKE_sequencer_proxy_rebuild(SeqIndexBuildContext *context, short *stop, sho
 	render_context.skip_cache = true;
 	render_context.is_proxy_render = true;
 
+	start_time = PIL_check_seconds_timer();
+
 	for (cfra = seq->startdisp + seq->startstill;  cfra < seq->enddisp - seq->endstill; cfra++) {
 		if (context->size_flags & IMB_PROXY_25) {
 			seq_proxy_build_frame(&render_context, seq, cfra, 25);
@@ -1612,9 +1632,13 @@ void BKE_sequencer_proxy_rebuild(SeqIndexBuildContext *context, short *stop, sho
 		*progress = (float) (cfra - seq->startdisp - seq->startstill) / (seq->enddisp - seq->endstill - seq->startdisp - seq->startstill);
 		*do_update = true;
 
+		context->num_frames++;
+
 		if (*stop || G.is_break)
 			break;
 	}
+
+	context->time += PIL_check_seconds_timer() - start_time;
 }
 
 void BKE_sequencer_proxy_rebuild_finish(SeqIndexBuildContext *context, bool stop)
@@ -1630,6 +1654,129 @@ void BKE_sequencer_proxy_rebuild_finish(SeqIndexBuildContext *context, bool stop
 	MEM_freeN(context);
 }
 
+static void seq_proxy_rebuild_stats(SeqIndexBuildContext *context, int *r_num_frames, double *r_time)
+{
+	if (context->index_context) {
+		IMB_anim_index_rebuild_stats(context->index_context, r_num_frames, r_time);
+	}
+	else {
+		*r_num_frames = context->num_frames;
+		*r_time = context->time;
+	}
+}
+
+typedef struct SeqProxyBatchTask {
+	SeqIndexBuildContext *context;
+	short *stop;
+	short do_update;
+	float progress;
+} SeqProxyBatchTask;
+
+typedef struct SeqProxyBatch {
+	/* image strips render their proxies through the sequencer, which isn't made for concurrent use */
+	ThreadMutex render_lock;
+	ThreadMutex done_lock;
+	int num_done;
+} SeqProxyBatch;
+
+static void seq_proxy_batch_task(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+{
+	SeqProxyBatch *batch = BLI_task_pool_userdata(pool);
+	SeqProxyBatchTask *task = taskdata;
+	const bool use_render = (task->context->index_context == NULL);
+
+	if (!*task->stop && !G.is_break) {
+		if (use_render)
+			BLI_mutex_lock(&batch->render_lock);
+
+		BKE_sequencer_proxy_rebuild(task->context, task->stop, &task->do_update, &task->progress);
+
+		if (use_render)
+			BLI_mutex_unlock(&batch->render_lock);
+	}
+
+	task->progress = 1.0f;
+
+	BLI_mutex_lock(&batch->done_lock);
+	batch->num_done++;
+	BLI_mutex_unlock(&batch->done_lock);
+}
+
+/* rebuild the proxies of a list of contexts (LinkData) concurrently, a clip is decoded once for
+ * all its proxy sizes. progress is the average of all strips */
+void BKE_sequencer_proxy_rebuild_batch(ListBase *contexts, short *stop, short *do_update, float *progress)
+{
+	SeqProxyBatch batch;
+	SeqProxyBatchTask *tasks;
+	TaskPool *pool;
+	LinkData *link;
+	const double start_time = PIL_check_seconds_timer();
+	double time;
+	int num_tasks = 0, num_done = 0, total_frames = 0, i;
+
+	tasks = MEM_callocN(sizeof(*tasks) * max_ii(BLI_countlist(contexts), 1), "seq proxy batch tasks");
+
+	for (link = contexts->first; link; link = link->next) {
+		if (link->data) {
+			tasks[num_tasks].context = link->data;
+			tasks[num_tasks].stop = stop;
+			num_tasks++;
+		}
+	}
+
+	BLI_mutex_init(&batch.render_lock);
+	BLI_mutex_init(&batch.done_lock);
+	batch.num_done = 0;
+
+	pool = BLI_task_pool_create(BLI_task_scheduler_get(), &batch);
+
+	for (i = 0; i < num_tasks; i++) {
+		BLI_task_pool_push(pool, seq_proxy_batch_task, &tasks[i], false, TASK_PRIORITY_LOW);
+	}
+
+	while (num_done < num_tasks) {
+		float total_progress = 0.0f;
+
+		PIL_sleep_ms(100);
+
+		for (i = 0; i < num_tasks; i++) {
+			total_progress += tasks[i].progress;
+		}
+		*progress = total_progress / num_tasks;
+		*do_update = true;
+
+		BLI_mutex_lock(&batch.done_lock);
+		num_done = batch.num_done;
+		BLI_mutex_unlock(&batch.done_lock);
+	}
+
+	BLI_task_pool_work_and_wait(pool);
+	BLI_task_pool_free(pool);
+
+	BLI_mutex_end(&batch.render_lock);
+	BLI_mutex_end(&batch.done_lock);
+
+	if ((G.debug & G_DEBUG) && num_tasks) {
+		time = PIL_check_seconds_timer() - start_time;
+
+		for (i = 0; i < num_tasks; i++) {
+			int num_frames;
+			double strip_time;
+
+			seq_proxy_rebuild_stats(tasks[i].context, &num_frames, &strip_time);
+			total_frames += num_frames;
+
+			printf("Proxy of %s: %d frames in %.2f s (%.1f fps)\n", tasks[i].context->orig_seq->name + 2,
+			       num_frames, strip_time, strip_time > 0.0 ? num_frames / strip_time : 0.0);
+		}
+
+		printf("Proxies of %d strips: %d frames in %.2f s (%.1f fps)\n",
+		       num_tasks, total_frames, time, time > 0.0 ? total_frames / time : 0.0);
+	}
+
+	MEM_freeN(tasks);
+}
+
 /*********************** color balance *************************/
 
 static StripColorBalance calc_cb(StripColorBalance *cb_)
@@ -2653,7 +2800,7 @@ static ImBuf *seq_render_scene_strip(const SeqRenderData *context, Sequence *seq
 static ImBuf *do_render_strip_uncached(const SeqRenderData *context, Sequence *seq, float cfra)
 {
 	ImBuf *ibuf = NULL;
-	float nr = give_stripelem_index(seq, cfra);
+	float nr = BKE_sequencer_give_stripelem_index(seq, cfra);
 	int type = (seq->type & SEQ_TYPE_EFFECT && seq->type != SEQ_TYPE_SPEED) ? SEQ_TYPE_EFFECT : seq->type;
 	bool use_preprocess = BKE_sequencer_input_have_to_preprocess(context, seq, cfra);
 	char name[FILE_MAX];
@@ -2822,7 +2969,7 @@ static ImBuf *seq_render_strip(const SeqRenderData *context, Sequence *seq, floa
 	ImBuf *ibuf = NULL;
 	bool use_preprocess = false;
 	bool is_proxy_image = false;
-	float nr = give_stripelem_index(seq, cfra);
+	float nr = BKE_sequencer_give_stripelem_index(seq, cfra);
 	/* all effects are handled similarly with the exception of speed effect */
 	int type = (seq->type & SEQ_TYPE_EFFECT && seq->type != SEQ_TYPE_SPEED) ? SEQ_TYPE_EFFECT : seq->type;
 	bool is_preprocessed = !ELEM(type, SEQ_TYPE_IMAGE, SEQ_TYPE_MOVIE, SEQ_TYPE_SCENE);
@@ -3088,186 +3235,54 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context, ListBase *seq
  * you have to free after usage!
  */
 
-ImBuf *BKE_sequencer_give_ibuf(const SeqRenderData *context, float cfra, int chanshown)
+static ListBase *seq_give_seqbasep(Editing *ed, int chanshown)
 {
-	Editing *ed = BKE_sequencer_editing_get(context->scene, false);
-	ListBase *seqbasep;
-	
-	if (ed == NULL) return NULL;
-
 	if ((chanshown < 0) && !BLI_listbase_is_empty(&ed->metastack)) {
 		int count = BLI_countlist(&ed->metastack);
 		count = max_ii(count + chanshown, 0);
-		seqbasep = ((MetaStack *)BLI_findlink(&ed->metastack, count))->oldbasep;
+		return ((MetaStack *)BLI_findlink(&ed->metastack, count))->oldbasep;
 	}
 	else {
-		seqbasep = ed->seqbasep;
+		return ed->seqbasep;
 	}
-
-	return seq_render_strip_stack(context, seqbasep, cfra, chanshown);
 }
 
-ImBuf *BKE_sequencer_give_ibuf_seqbase(const SeqRenderData *context, float cfra, int chanshown, ListBase *seqbasep)
+ImBuf *BKE_sequencer_give_ibuf(const SeqRenderData *context, float cfra, int chanshown)
 {
-	return seq_render_strip_stack(context, seqbasep, cfra, chanshown);
-}
-
+	Editing *ed = BKE_sequencer_editing_get(context->scene, false);
+	
+	if (ed == NULL) return NULL;
 
-ImBuf *BKE_sequencer_give_ibuf_direct(const SeqRenderData *context, float cfra, Sequence *seq)
-{
-	return seq_render_strip(context, seq, cfra);
+	return seq_render_strip_stack(context, seq_give_seqbasep(ed, chanshown), cfra, chanshown);
 }
 
-/* *********************** threading api ******************* */
-
-static ListBase running_threads;
-static ListBase prefetch_wait;
-static ListBase prefetch_done;
-
-static pthread_mutex_t queue_lock          = PTHREAD_MUTEX_INITIALIZER;
-static pthread_mutex_t wakeup_lock         = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t wakeup_cond          = PTHREAD_COND_INITIALIZER;
-
-//static pthread_mutex_t prefetch_ready_lock = PTHREAD_MUTEX_INITIALIZER;
-//static pthread_cond_t  prefetch_ready_cond = PTHREAD_COND_INITIALIZER;
-
-static pthread_mutex_t frame_done_lock     = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t frame_done_cond      = PTHREAD_COND_INITIALIZER;
-
-static volatile bool seq_thread_shutdown = true; 
-static volatile int seq_last_given_monoton_cfra = 0;
-static int monoton_cfra = 0;
-
-typedef struct PrefetchThread {
-	struct PrefetchThread *next, *prev;
-	
-	Scene *scene;
-	struct PrefetchQueueElem *current;
-	pthread_t pthread;
-	int running;
-	
-} PrefetchThread;
-
-typedef struct PrefetchQueueElem {
-	struct PrefetchQueueElem *next, *prev;
-	
-	int rectx;
-	int recty;
-	float cfra;
-	int chanshown;
-	int preview_render_size;
+/* only looks up the result of the strip stack in the cache, nothing is rendered */
+ImBuf *BKE_sequencer_give_ibuf_cached(const SeqRenderData *context, float cfra, int chanshown)
+{
+	Editing *ed = BKE_sequencer_editing_get(context->scene, false);
+	Sequence *seq_arr[MAXSEQ + 1];
+	int count;
 
-	int monoton_cfra;
+	if (ed == NULL) return NULL;
 
-	ImBuf *ibuf;
-} PrefetchQueueElem;
+	count = get_shown_sequences(seq_give_seqbasep(ed, chanshown), cfra, chanshown, (Sequence **)&seq_arr);
 
-void BKE_sequencer_give_ibuf_prefetch_request(const SeqRenderData *context, float cfra, int chanshown)
-{
-	PrefetchQueueElem *e;
-	if (seq_thread_shutdown) {
-		return;
+	if (count == 0) {
+		return NULL;
 	}
 
-	e = MEM_callocN(sizeof(PrefetchQueueElem), "prefetch_queue_elem");
-	e->rectx = context->rectx;
-	e->recty = context->recty;
-	e->cfra = cfra;
-	e->chanshown = chanshown;
-	e->preview_render_size = context->preview_render_size;
-	e->monoton_cfra = monoton_cfra++;
-
-	pthread_mutex_lock(&queue_lock);
-	BLI_addtail(&prefetch_wait, e);
-	pthread_mutex_unlock(&queue_lock);
-	
-	pthread_mutex_lock(&wakeup_lock);
-	pthread_cond_signal(&wakeup_cond);
-	pthread_mutex_unlock(&wakeup_lock);
+	return BKE_sequencer_cache_get(context, seq_arr[count - 1], cfra, SEQ_STRIPELEM_IBUF_COMP);
 }
 
-ImBuf *BKE_sequencer_give_ibuf_threaded(const SeqRenderData *context, float cfra, int chanshown)
+ImBuf *BKE_sequencer_give_ibuf_seqbase(const SeqRenderData *context, float cfra, int chanshown, ListBase *seqbasep)
 {
-	PrefetchQueueElem *e = NULL;
-	bool found_something = false;
-
-	if (seq_thread_shutdown) {
-		return BKE_sequencer_give_ibuf(context, cfra, chanshown);
-	}
-
-	while (!e) {
-		bool success = false;
-		pthread_mutex_lock(&queue_lock);
-
-		for (e = prefetch_done.first; e; e = e->next) {
-			if (cfra == e->cfra &&
-			    chanshown == e->chanshown &&
-			    context->rectx == e->rectx &&
-			    context->recty == e->recty &&
-			    context->preview_render_size == e->preview_render_size)
-			{
-				success = true;
-				found_something = true;
-				break;
-			}
-		}
-
-		if (!e) {
-			for (e = prefetch_wait.first; e; e = e->next) {
-				if (cfra == e->cfra &&
-				    chanshown == e->chanshown &&
-				    context->rectx == e->rectx &&
-				    context->recty == e->recty &&
-				    context->preview_render_size == e->preview_render_size)
-				{
-					found_something = true;
-					break;
-				}
-			}
-		}
-
-		if (!e) {
-			PrefetchThread *tslot;
-
-			for (tslot = running_threads.first;
-			     tslot;
-			     tslot = tslot->next)
-			{
-				if (tslot->current &&
-				    cfra == tslot->current->cfra &&
-				    chanshown == tslot->current->chanshown &&
-				    context->rectx == tslot->current->rectx &&
-				    context->recty == tslot->current->recty &&
-				    context->preview_render_size == tslot->current->preview_render_size)
-				{
-					found_something = true;
-					break;
-				}
-			}
-		}
-
-		/* e->ibuf is unrefed by render thread on next round. */
-
-		if (e) {
-			seq_last_given_monoton_cfra = e->monoton_cfra;
-		}
-
-		pthread_mutex_unlock(&queue_lock);
+	return seq_render_strip_stack(context, seqbasep, cfra, chanshown);
+}
 
-		if (!success) {
-			e = NULL;
 
-			if (!found_something) {
-				fprintf(stderr, "SEQ-THREAD: Requested frame not in queue ???\n");
-				break;
-			}
-			pthread_mutex_lock(&frame_done_lock);
-			pthread_cond_wait(&frame_done_cond, &frame_done_lock);
-			pthread_mutex_unlock(&frame_done_lock);
-		}
-	}
-	
-	return e ? e->ibuf : NULL;
+ImBuf *BKE_sequencer_give_ibuf_direct(const SeqRenderData *context, float cfra, Sequence *seq)
+{
+	return seq_render_strip(context, seq, cfra);
 }
 
 /* Functions to free imbuf and anim data on changes */
@@ -3329,6 +3344,9 @@ static void sequence_invalidate_cache(Scene *scene, Sequence *seq, bool invalida
 {
 	Editing *ed = scene->ed;
 
+	/* frames rendered in the background are outdated, and the strip data is freed below */
+	BKE_sequencer_prefetch_stop();
+
 	/* invalidate cache for current sequence */
 	if (invalidate_self) {
 		if (seq->anim) {
@@ -4132,6 +4150,33 @@ void BKE_sequencer_dupe_animdata(Scene *scene, const char *name_src, const char
 	BLI_movelisttolist(&scene->adt->action->curves, &lb);
 }
 
+/* the strip has fcurves or drivers, its settings depend on the frame the scene is evaluated at */
+bool BKE_sequencer_has_animdata(Scene *scene, Sequence *seq)
+{
+	char str[SEQ_RNAPATH_MAXSTR];
+	size_t str_len;
+	FCurve *fcu;
+
+	if (scene->adt == NULL)
+		return false;
+
+	str_len = sequencer_rna_path_prefix(str, seq->name + 2);
+
+	if (scene->adt->action) {
+		for (fcu = scene->adt->action->curves.first; fcu; fcu = fcu->next) {
+			if (fcu->rna_path && STREQLEN(fcu->rna_path, str, str_len))
+				return true;
+		}
+	}
+
+	for (fcu = scene->adt->drivers.first; fcu; fcu = fcu->next) {
+		if (fcu->rna_path && STREQLEN(fcu->rna_path, str, str_len))
+			return true;
+	}
+
+	return false;
+}
+
 /* XXX - hackish function needed to remove all fcurves belonging to a sequencer strip */
 static void seq_free_animdata(Scene *scene, Sequence *seq)
 {
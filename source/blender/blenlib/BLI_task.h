@@ -35,7 +35,8 @@ extern "C" {
 /* Task Scheduler
  * 
  * Central scheduler that holds running threads ready to execute tasks. A single
- * queue holds the task from all pools.
+ * queue holds the task from all pools, tasks pushed from worker threads with
+ * BLI_task_pool_push_from_thread go into a queue per thread instead.
  *
  * Init/exit must be called before/after any task pools are created/freed, and
  * must be called from the main threads. All other scheduler and pool functions
@@ -80,6 +81,12 @@ void BLI_task_pool_free(TaskPool *pool);
 
 void BLI_task_pool_push(TaskPool *pool, TaskRunFunction run,
 	void *taskdata, bool free_taskdata, TaskPriority priority);
+/* push from a running task, thread_id is the id passed to its run function.
+ * the task goes into a queue local to that thread, which it pops before the
+ * shared queue and which idle threads steal from. priority is ignored for
+ * local queues. */
+void BLI_task_pool_push_from_thread(TaskPool *pool, TaskRunFunction run,
+	void *taskdata, bool free_taskdata, TaskPriority priority, int thread_id);
 
 /* work and wait until all tasks are done */
 void BLI_task_pool_work_and_wait(TaskPool *pool);
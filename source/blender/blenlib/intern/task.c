@@ -33,6 +33,8 @@
 #include "BLI_task.h"
 #include "BLI_threads.h"
 
+#include "atomic_ops.h"
+
 /* Types */
 
 typedef struct Task {
@@ -67,12 +69,23 @@ struct TaskScheduler {
 	ThreadMutex queue_mutex;
 	ThreadCondition queue_cond;
 
+	/* total number of tasks in the thread local queues, and number of threads
+	 * sleeping on queue_cond. only modified with atomic operations, these let
+	 * pushes to a local queue skip queue_mutex when no thread is idle */
+	uint32_t num_local_tasks;
+	uint32_t num_idle_threads;
+
 	volatile bool do_exit;
 };
 
 typedef struct TaskThread {
 	TaskScheduler *scheduler;
 	int id;
+
+	/* tasks pushed by tasks running on this thread. the thread itself pops
+	 * the most recent task, other threads steal the oldest one */
+	ListBase local_queue;
+	SpinLock local_lock;
 } TaskThread;
 
 /* Task Scheduler */
@@ -102,21 +115,97 @@ static void task_pool_num_increase(TaskPool *pool)
 	BLI_mutex_unlock(&pool->num_mutex);
 }
 
-static bool task_scheduler_thread_wait_pop(TaskScheduler *scheduler, Task **task)
+BLI_INLINE uint32_t task_scheduler_num_local_tasks(TaskScheduler *scheduler)
+{
+	/* atomic read, orders against the idle counter of the other side */
+	return atomic_add_uint32(&scheduler->num_local_tasks, 0);
+}
+
+/* pop the most recently pushed task of the thread's own queue */
+static Task *task_thread_local_pop(TaskThread *thread)
 {
+	Task *task;
+
+	/* other threads steal from this queue, so it is only read under the lock */
+	BLI_spin_lock(&thread->local_lock);
+	task = thread->local_queue.first;
+	if (task)
+		BLI_remlink(&thread->local_queue, task);
+	BLI_spin_unlock(&thread->local_lock);
+
+	if (task)
+		atomic_sub_uint32(&thread->scheduler->num_local_tasks, 1);
+
+	return task;
+}
+
+/* steal the oldest task from the local queue of another thread, optionally
+ * only tasks belonging to pool */
+static Task *task_scheduler_steal(TaskScheduler *scheduler, int thread_id, TaskPool *pool)
+{
+	int i;
+
+	for (i = 1; i <= scheduler->num_threads; i++) {
+		/* start with the next thread so not all thieves go for the same queue */
+		TaskThread *victim = &scheduler->task_threads[(thread_id + i) % scheduler->num_threads];
+		Task *task;
+
+		BLI_spin_lock(&victim->local_lock);
+		for (task = victim->local_queue.last; task; task = task->prev) {
+			if (pool == NULL || task->pool == pool) {
+				BLI_remlink(&victim->local_queue, task);
+				break;
+			}
+		}
+		BLI_spin_unlock(&victim->local_lock);
+
+		if (task) {
+			atomic_sub_uint32(&scheduler->num_local_tasks, 1);
+			return task;
+		}
+	}
+
+	return NULL;
+}
+
+static bool task_scheduler_thread_wait_pop(TaskScheduler *scheduler, TaskThread *thread, Task **task)
+{
+	/* own tasks first, they were pushed most recently and their data is
+	 * likely still in cache */
+	if ((*task = task_thread_local_pop(thread)))
+		return true;
+
 	BLI_mutex_lock(&scheduler->queue_mutex);
 
-	while (!scheduler->queue.first && !scheduler->do_exit)
-		BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
+	while (true) {
+		if (scheduler->queue.first) {
+			*task = scheduler->queue.first;
+			BLI_remlink(&scheduler->queue, *task);
+			break;
+		}
 
-	if (!scheduler->queue.first) {
-		BLI_mutex_unlock(&scheduler->queue_mutex);
-		BLI_assert(scheduler->do_exit);
-		return false;
+		if (task_scheduler_num_local_tasks(scheduler)) {
+			BLI_mutex_unlock(&scheduler->queue_mutex);
+
+			if ((*task = task_scheduler_steal(scheduler, thread->id, NULL)))
+				return true;
+
+			BLI_mutex_lock(&scheduler->queue_mutex);
+			continue;
+		}
+
+		if (scheduler->do_exit) {
+			BLI_mutex_unlock(&scheduler->queue_mutex);
+			return false;
+		}
+
+		/* announce we are going idle before checking the local queues once
+		 * more, a local push either sees us idle or we see its task */
+		atomic_add_uint32(&scheduler->num_idle_threads, 1);
+		if (!task_scheduler_num_local_tasks(scheduler))
+			BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
+		atomic_sub_uint32(&scheduler->num_idle_threads, 1);
 	}
-	
-	*task = scheduler->queue.first;
-	BLI_remlink(&scheduler->queue, *task);
 
 	BLI_mutex_unlock(&scheduler->queue_mutex);
 
@@ -131,7 +220,7 @@ static void *task_scheduler_thread_run(void *thread_p)
 	Task *task;
 
 	/* keep popping off tasks */
-	while (task_scheduler_thread_wait_pop(scheduler, &task)) {
+	while (task_scheduler_thread_wait_pop(scheduler, thread, &task)) {
 		TaskPool *pool = task->pool;
 
 		/* run task */
@@ -181,6 +270,8 @@ TaskScheduler *BLI_task_scheduler_create(int num_threads)
 			TaskThread *thread = &scheduler->task_threads[i];
 			thread->scheduler = scheduler;
 			thread->id = i + 1;
+			BLI_listbase_clear(&thread->local_queue);
+			BLI_spin_init(&thread->local_lock);
 
 			if (pthread_create(&scheduler->threads[i], NULL, task_scheduler_thread_run, thread) != 0) {
 				fprintf(stderr, "TaskScheduler failed to launch thread %d/%d\n", i, num_threads);
@@ -214,8 +305,21 @@ void BLI_task_scheduler_free(TaskScheduler *scheduler)
 		MEM_freeN(scheduler->threads);
 	}
 
-	/* Delete task thread data */
+	/* Delete task thread data and leftover local tasks */
 	if (scheduler->task_threads) {
+		int i;
+
+		for (i = 0; i < scheduler->num_threads; i++) {
+			TaskThread *thread = &scheduler->task_threads[i];
+
+			for (task = thread->local_queue.first; task; task = task->next) {
+				if (task->free_taskdata)
+					MEM_freeN(task->taskdata);
+			}
+			BLI_freelistN(&thread->local_queue);
+			BLI_spin_end(&thread->local_lock);
+		}
+
 		MEM_freeN(scheduler->task_threads);
 	}
 
@@ -254,10 +358,51 @@ static void task_scheduler_push(TaskScheduler *scheduler, Task *task, TaskPriori
 	BLI_mutex_unlock(&scheduler->queue_mutex);
 }
 
+static void task_scheduler_push_local(TaskScheduler *scheduler, Task *task, int thread_id)
+{
+	TaskThread *thread = &scheduler->task_threads[thread_id - 1];
+
+	task_pool_num_increase(task->pool);
+
+	BLI_spin_lock(&thread->local_lock);
+	BLI_addhead(&thread->local_queue, task);
+	BLI_spin_unlock(&thread->local_lock);
+
+	atomic_add_uint32(&scheduler->num_local_tasks, 1);
+
+	/* only wake up a sleeping thread to steal the task if there is one */
+	if (atomic_add_uint32(&scheduler->num_idle_threads, 0)) {
+		BLI_mutex_lock(&scheduler->queue_mutex);
+		BLI_condition_notify_one(&scheduler->queue_cond);
+		BLI_mutex_unlock(&scheduler->queue_mutex);
+	}
+}
+
 static void task_scheduler_clear(TaskScheduler *scheduler, TaskPool *pool)
 {
 	Task *task, *nexttask;
 	size_t done = 0;
+	int i;
+
+	/* free all tasks from this pool from the local queues */
+	for (i = 0; i < scheduler->num_threads; i++) {
+		TaskThread *thread = &scheduler->task_threads[i];
+
+		BLI_spin_lock(&thread->local_lock);
+		for (task = thread->local_queue.first; task; task = nexttask) {
+			nexttask = task->next;
+
+			if (task->pool == pool) {
+				if (task->free_taskdata)
+					MEM_freeN(task->taskdata);
+				BLI_freelinkN(&thread->local_queue, task);
+
+				atomic_sub_uint32(&scheduler->num_local_tasks, 1);
+				done++;
+			}
+		}
+		BLI_spin_unlock(&thread->local_lock);
+	}
 
 	BLI_mutex_lock(&scheduler->queue_mutex);
 
@@ -334,6 +479,28 @@ void BLI_task_pool_push(TaskPool *pool, TaskRunFunction run,
 	task_scheduler_push(pool->scheduler, task, priority);
 }
 
+void BLI_task_pool_push_from_thread(TaskPool *pool, TaskRunFunction run,
+	void *taskdata, bool free_taskdata, TaskPriority priority, int thread_id)
+{
+	TaskScheduler *scheduler = pool->scheduler;
+	Task *task;
+
+	/* the main thread and threads not owned by the scheduler have no local queue */
+	if (thread_id <= 0 || thread_id > scheduler->num_threads) {
+		BLI_task_pool_push(pool, run, taskdata, free_taskdata, priority);
+		return;
+	}
+
+	task = MEM_callocN(sizeof(Task), "Task");
+
+	task->run = run;
+	task->taskdata = taskdata;
+	task->free_taskdata = free_taskdata;
+	task->pool = pool;
+
+	task_scheduler_push_local(scheduler, task, thread_id);
+}
+
 void BLI_task_pool_work_and_wait(TaskPool *pool)
 {
 	TaskScheduler *scheduler = pool->scheduler;
@@ -362,6 +529,12 @@ void BLI_task_pool_work_and_wait(TaskPool *pool)
 
 		BLI_mutex_unlock(&scheduler->queue_mutex);
 
+		/* tasks of this pool may also be waiting in the local queues */
+		if (!found_task && task_scheduler_num_local_tasks(scheduler)) {
+			work_task = task_scheduler_steal(scheduler, 0, pool);
+			found_task = (work_task != NULL);
+		}
+
 		/* if found task, do it, otherwise wait until other tasks are done */
 		if (found_task) {
 			/* run task */
@@ -534,7 +707,7 @@ void BLI_task_parallel_range_ex(
 		state.chunk_size = 32;
 	}
 	else {
-		state.chunk_size = (stop - start) / (num_tasks);
+		state.chunk_size = max_ii(1, (stop - start) / (num_tasks));
 	}
 
 	for (i = 0; i < num_tasks; i++) {
@@ -122,6 +122,7 @@ static pthread_mutex_t _nodes_lock = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t _movieclip_lock = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t _colormanage_lock = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t _fftw_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t _task_scheduler_lock = PTHREAD_MUTEX_INITIALIZER;
 static pthread_t mainid;
 static int thread_levels = 0;  /* threads can be invoked inside threads */
 static int num_threads_override = 0;
@@ -158,12 +159,18 @@ void BLI_threadapi_exit(void)
 {
 	if (task_scheduler) {
 		BLI_task_scheduler_free(task_scheduler);
+		task_scheduler = NULL;
 	}
 	BLI_spin_end(&_malloc_lock);
 }
 
 TaskScheduler *BLI_task_scheduler_get(void)
 {
+	TaskScheduler *scheduler;
+
+	/* the first call can come from several threads at once, e.g. compositor
+	 * operations calling BLI_task_parallel_range, so only one may create it */
+	pthread_mutex_lock(&_task_scheduler_lock);
 	if (task_scheduler == NULL) {
 		int tot_thread = BLI_system_thread_count();
 
@@ -172,8 +179,10 @@ TaskScheduler *BLI_task_scheduler_get(void)
 		 */
 		task_scheduler = BLI_task_scheduler_create(tot_thread);
 	}
+	scheduler = task_scheduler;
+	pthread_mutex_unlock(&_task_scheduler_lock);
 
-	return task_scheduler;
+	return scheduler;
 }
 
 /* tot = 0 only initializes malloc mutex in a safe way (see sequence.c)
@@ -43,6 +43,7 @@
 #include "DNA_object_types.h"
 #include "DNA_mesh_types.h"
 #include "DNA_modifier_types.h"
+#include "DNA_node_types.h"
 #include "DNA_particle_types.h"
 #include "DNA_linestyle_types.h"
 #include "DNA_actuator_types.h"
@@ -437,4 +438,15 @@ void blo_do_versions_270(FileData *fd, Library *UNUSED(lib), Main *main)
 			}
 		}
 	}
+
+	if (!MAIN_VERSION_ATLEAST(main, 272, 3)) {
+		if (!DNA_struct_elem_find(fd->filesdna, "bNodeTree", "int", "result_cache_limit")) {
+			Scene *scene;
+			for (scene = main->scene.first; scene; scene = scene->id.next) {
+				if (scene->nodetree) {
+					scene->nodetree->result_cache_limit = 512;
+				}
+			}
+		}
+	}
 }
@@ -224,7 +224,13 @@ extern "C" {
  * the work-scheduler can work in 2 states. For witching these between the state you need to recompile blender
  *
  * @subsection multithread Multi threaded
- * Default the work-scheduler will place all work as WorkPackage in a queue.
+ * Default the work-scheduler will run all work as WorkPackage on a BLI_task scheduler.
+ * For every CPUcore a CPUDevice is created, a task executes its WorkPackage on the CPUDevice of the thread it runs on.
+ * A chunk is only handed to the work-scheduler when all chunks it depends on are executed.
+ * Chunks that become ready when a chunk is finished are pushed on the task queue of the thread that finished it,
+ * idle threads steal work from the other threads.
+ *
+ * With COM_TM_QUEUE the work-scheduler will place all work as WorkPackage in a queue.
  * For every CPUcore a working thread is created. These working threads will ask the WorkScheduler if there is work
  * for a specific Device.
  * the work-scheduler will find work for the device and the device will be asked to execute the WorkPackage
@@ -69,10 +69,20 @@ typedef enum CompositorPriority {
 #define COM_PREVIEW_SIZE 140.0f
 #define COM_OPENCL_ENABLED
 //#define COM_DEBUG
+/* per operation time and pixel statistics, see Profiler */
+//#define COM_PROFILE
 
 // workscheduler threading models
 /**
- * COM_TM_QUEUE is a multithreaded model, which uses the BLI_thread_queue pattern. This is the default option.
+ * COM_TM_TASK is a multithreaded model, which runs chunks on a BLI_task scheduler. A chunk is scheduled
+ * the moment the chunks it depends on are executed, chunks released by a worker thread are pushed on the
+ * queue of that thread. This is the default option.
+ */
+#define COM_TM_TASK 2
+
+/**
+ * COM_TM_QUEUE is a multithreaded model, which uses the BLI_thread_queue pattern. ExecutionGroup.execute
+ * polls until the chunks a chunk depends on are executed.
  */
 #define COM_TM_QUEUE 1
 
@@ -82,9 +92,9 @@ typedef enum CompositorPriority {
 #define COM_TM_NOTHREAD 0
 
 /**
- * COM_CURRENT_THREADING_MODEL can be one of the above, COM_TM_QUEUE is currently default.
+ * COM_CURRENT_THREADING_MODEL can be one of the above, COM_TM_TASK is currently default.
  */
-#define COM_CURRENT_THREADING_MODEL COM_TM_QUEUE
+#define COM_CURRENT_THREADING_MODEL COM_TM_TASK
 // chunk order
 /**
  * @brief The order of chunks to be scheduled
@@ -107,6 +117,65 @@ typedef enum OrderOfChunks {
 
 #define COM_NUMBER_OF_CHANNELS 4
 
+/**
+ * @brief number of channels a MemoryBuffer stores per pixel for each DataType
+ * @note pixels are always passed around as float[COM_NUMBER_OF_CHANNELS], only storage is reduced
+ */
+#define COM_NUM_CHANNELS_VALUE 1
+#define COM_NUM_CHANNELS_VECTOR 3
+#define COM_NUM_CHANNELS_COLOR 4
+
+inline int COM_data_type_num_channels(const DataType datatype)
+{
+	switch (datatype) {
+		case COM_DT_VALUE:
+			return COM_NUM_CHANNELS_VALUE;
+		case COM_DT_VECTOR:
+			return COM_NUM_CHANNELS_VECTOR;
+		case COM_DT_COLOR:
+		default:
+			return COM_NUM_CHANNELS_COLOR;
+	}
+}
+
+/**
+ * @brief maximum number of pixels calculated by a single executeRow call
+ * @note row operations keep their input rows on the stack, so this is kept small
+ * @see SocketReader.executeRow
+ */
+#define COM_ROW_LENGTH 64
+
+/**
+ * @brief maximum number of inputs of a pixel operation
+ * @see NodeOperation.isPixelOperation
+ */
+#define COM_PIXEL_OPERATION_MAX_INPUTS 4
+
+/**
+ * @brief maximum number of rows a FusedOperation keeps on the stack
+ * one row per input of the fused operation and one per fused operation, except the last one
+ * @see NodeOperationBuilder.fuse_pixel_operations
+ */
+#define COM_FUSED_MAX_ROWS 32
+
+/**
+ * @brief an operation is buffered when a pixel of it is evaluated at least this many times
+ * @see NodeOperationBuilder.add_overlap_buffers
+ */
+#define COM_OVERLAP_BUFFER_MIN_EVALUATIONS 2.0f
+
+/**
+ * @brief minimum number of operation evaluations per pixel an overlap buffer has to save
+ * @see NodeOperationBuilder.add_overlap_buffers
+ */
+#define COM_OVERLAP_BUFFER_MIN_SAVED 4.0f
+
 #define COM_BLUR_BOKEH_PIXELS 512
 
+/**
+ * @brief bokeh blur radius in pixels from which the image is convolved with the FHT instead of per pixel
+ * @see BokehBlurOperation
+ */
+#define COM_BOKEH_FFT_MIN_RADIUS 16
+
 #endif  /* __COM_DEFINES_H__ */
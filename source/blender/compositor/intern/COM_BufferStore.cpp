@@ -0,0 +1,345 @@
+/*
+ * Copyright 2015, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <map>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#ifndef WIN32
+#  include <unistd.h>
+#else
+#  include <io.h>
+#endif
+
+#include "COM_BufferStore.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_MemoryProxy.h"
+
+extern "C" {
+#  include "BLI_fileops.h"
+#  include "BLI_path_util.h"
+#  include "BLI_sys_types.h"
+#  include "BLI_threads.h"
+#  include "BLI_utildefines.h"
+#  ifdef WIN32
+#    include "BLI_winstuff.h"
+#  endif
+}
+
+/* largest number of bytes passed to a single read or write call */
+#define BUFFER_STORE_IO_BLOCK (1 << 30)
+
+typedef struct BufferStoreEntry {
+	size_t size;
+	/* number of acquire calls that are not released */
+	int users;
+	unsigned int lastUsed;
+	/* offset of the buffer in the scratch file, -1 when it was never written */
+	int64_t fileOffset;
+	/* the data in memory differs from the data in the scratch file */
+	bool dirty;
+	/* the buffer is being read from or written to the scratch file outside of the mutex */
+	bool busy;
+} BufferStoreEntry;
+
+typedef std::map<MemoryProxy *, BufferStoreEntry> BufferStoreEntries;
+
+/* a buffer that is written to the scratch file after the mutex is released */
+typedef struct BufferStoreUnload {
+	MemoryProxy *proxy;
+	BufferStoreEntry *entry;
+} BufferStoreUnload;
+
+typedef std::vector<BufferStoreUnload> BufferStoreUnloads;
+
+/* protects the entries and the file size, the file data itself is read and written
+ * outside of it at offsets reserved under it */
+static ThreadMutex s_mutex = BLI_MUTEX_INITIALIZER;
+/* signaled when the file I/O of a busy entry finished */
+static ThreadCondition s_ioCondition;
+static BufferStoreEntries s_entries;
+static size_t s_memoryLimit = 0;
+static size_t s_memoryUsed = 0;
+static unsigned int s_usageCounter = 0;
+static int s_file = -1;
+static int64_t s_fileSize = 0;
+static bool s_fileFailed = false;
+static char s_filePath[FILE_MAX];
+#ifdef WIN32
+/* there is no positional read or write, the file position is shared */
+static ThreadMutex s_fileMutex = BLI_MUTEX_INITIALIZER;
+#endif
+
+static bool file_open()
+{
+	if (s_file != -1) {
+		return true;
+	}
+	if (s_fileFailed) {
+		return false;
+	}
+
+	BLI_join_dirfile(s_filePath, sizeof(s_filePath), BLI_temp_dir_session(), "compositor_buffers.tmp");
+	s_file = BLI_open(s_filePath, O_BINARY | O_RDWR | O_CREAT | O_TRUNC, 0600);
+	if (s_file == -1) {
+		printf("Compositor: can't create scratch file %s (%s), buffers are kept in memory\n",
+		       s_filePath, strerror(errno));
+		s_fileFailed = true;
+		return false;
+	}
+	s_fileSize = 0;
+	return true;
+}
+
+/* read or write size bytes at a 64 bit offset, safe to call from several threads at once */
+static bool file_io(char *bytes, size_t size, int64_t offset, bool write)
+{
+	bool ok = true;
+
+#ifdef WIN32
+	BLI_mutex_lock(&s_fileMutex);
+	if (_lseeki64(s_file, offset, SEEK_SET) != offset) {
+		ok = false;
+	}
+#endif
+
+	while (ok && size > 0) {
+		const size_t block = MIN2(size, (size_t)BUFFER_STORE_IO_BLOCK);
+#ifdef WIN32
+		const int done = write ? _write(s_file, bytes, (unsigned int)block) : _read(s_file, bytes, (unsigned int)block);
+#else
+		const ssize_t done = write ? pwrite(s_file, bytes, block, (off_t)offset) : pread(s_file, bytes, block, (off_t)offset);
+#endif
+		if (done != (ssize_t)block) {
+			ok = false;
+		}
+		bytes += block;
+		size -= block;
+		offset += block;
+	}
+
+#ifdef WIN32
+	BLI_mutex_unlock(&s_fileMutex);
+#endif
+
+	return ok;
+}
+
+/* choose least recently used buffers that are not in use until the buffers in memory fit in limit.
+ * clean buffers are freed right away, dirty ones get a file offset and are added to unloads,
+ * they stay allocated and busy until unload_finish wrote them */
+static void free_least_recently_used(size_t limit, BufferStoreUnloads &unloads)
+{
+	while (s_memoryUsed > limit) {
+		BufferStoreEntries::iterator oldest = s_entries.end();
+		for (BufferStoreEntries::iterator it = s_entries.begin(); it != s_entries.end(); ++it) {
+			if (it->second.users == 0 && !it->second.busy && it->first->getBuffer()->isAllocated() &&
+			    (oldest == s_entries.end() || it->second.lastUsed < oldest->second.lastUsed))
+			{
+				oldest = it;
+			}
+		}
+		/* all buffers in memory are in use */
+		if (oldest == s_entries.end()) {
+			return;
+		}
+
+		BufferStoreEntry &entry = oldest->second;
+		if (entry.dirty) {
+			if (!file_open()) {
+				return;
+			}
+			if (entry.fileOffset == -1) {
+				entry.fileOffset = s_fileSize;
+				s_fileSize += entry.size;
+			}
+			entry.busy = true;
+
+			BufferStoreUnload unload;
+			unload.proxy = oldest->first;
+			unload.entry = &entry;
+			unloads.push_back(unload);
+		}
+		else {
+			oldest->first->getBuffer()->freeBuffer();
+		}
+		s_memoryUsed -= entry.size;
+	}
+}
+
+/* write the buffers chosen by free_least_recently_used and free their data,
+ * called without holding the mutex */
+static void unload_finish(BufferStoreUnloads &unloads)
+{
+	for (size_t i = 0; i < unloads.size(); i++) {
+		MemoryBuffer *buffer = unloads[i].proxy->getBuffer();
+		BufferStoreEntry *entry = unloads[i].entry;
+		const bool ok = file_io((char *)buffer->getBuffer(), entry->size, entry->fileOffset, true);
+
+		BLI_mutex_lock(&s_mutex);
+		if (ok) {
+			buffer->freeBuffer();
+			entry->dirty = false;
+		}
+		else if (!s_fileFailed) {
+			printf("Compositor: can't write scratch file %s (%s), buffers are kept in memory\n",
+			       s_filePath, strerror(errno));
+			s_fileFailed = true;
+		}
+		if (!ok) {
+			s_memoryUsed += entry->size;
+		}
+		entry->busy = false;
+		BLI_condition_notify_all(&s_ioCondition);
+		BLI_mutex_unlock(&s_mutex);
+	}
+}
+
+void BufferStore::initialize(size_t limit)
+{
+	s_memoryLimit = limit;
+	s_memoryUsed = 0;
+	s_usageCounter = 0;
+	s_fileFailed = false;
+	BLI_condition_init(&s_ioCondition);
+}
+
+void BufferStore::deinitialize()
+{
+	BLI_assert(s_entries.empty());
+	s_entries.clear();
+	s_memoryLimit = 0;
+	s_memoryUsed = 0;
+
+	if (s_file != -1) {
+		close(s_file);
+		s_file = -1;
+		BLI_delete(s_filePath, false, false);
+	}
+	BLI_condition_end(&s_ioCondition);
+}
+
+bool BufferStore::isEnabled()
+{
+	return s_memoryLimit != 0;
+}
+
+void BufferStore::add(MemoryProxy *proxy)
+{
+	MemoryBuffer *buffer = proxy->getBuffer();
+	BufferStoreEntry entry;
+	entry.size = (size_t)buffer->getWidth() * buffer->getHeight() * buffer->getNumberOfChannels() * sizeof(float);
+	entry.users = 0;
+	entry.lastUsed = 0;
+	entry.fileOffset = -1;
+	entry.dirty = false;
+	entry.busy = false;
+
+	BLI_mutex_lock(&s_mutex);
+	s_entries[proxy] = entry;
+	BLI_mutex_unlock(&s_mutex);
+}
+
+void BufferStore::remove(MemoryProxy *proxy)
+{
+	BLI_mutex_lock(&s_mutex);
+	BufferStoreEntries::iterator entry = s_entries.find(proxy);
+	if (entry != s_entries.end()) {
+		if (proxy->getBuffer()->isAllocated()) {
+			s_memoryUsed -= entry->second.size;
+		}
+		s_entries.erase(entry);
+	}
+	BLI_mutex_unlock(&s_mutex);
+}
+
+void BufferStore::acquire(MemoryProxy *proxy, bool write)
+{
+	if (!isEnabled()) {
+		return;
+	}
+
+	BufferStoreUnloads unloads;
+	bool load = false;
+
+	BLI_mutex_lock(&s_mutex);
+	BufferStoreEntries::iterator it = s_entries.find(proxy);
+	if (it == s_entries.end()) {
+		BLI_mutex_unlock(&s_mutex);
+		return;
+	}
+
+	BufferStoreEntry &entry = it->second;
+	MemoryBuffer *buffer = proxy->getBuffer();
+
+	/* another thread is reading or writing this buffer */
+	while (entry.busy) {
+		BLI_condition_wait(&s_ioCondition, &s_mutex);
+	}
+
+	if (!buffer->isAllocated()) {
+		free_least_recently_used(s_memoryLimit > entry.size ? s_memoryLimit - entry.size : 0, unloads);
+		buffer->allocateBuffer();
+		s_memoryUsed += entry.size;
+
+		if (entry.fileOffset != -1) {
+			entry.busy = true;
+			load = true;
+		}
+	}
+	entry.users++;
+	entry.lastUsed = ++s_usageCounter;
+	if (write) {
+		entry.dirty = true;
+	}
+	BLI_mutex_unlock(&s_mutex);
+
+	/* the file I/O runs without the mutex, so other threads only wait for it
+	 * when they need the same buffer */
+	unload_finish(unloads);
+
+	if (load) {
+		if (!file_io((char *)buffer->getBuffer(), entry.size, entry.fileOffset, false)) {
+			printf("Compositor: can't read scratch file %s (%s)\n", s_filePath, strerror(errno));
+			buffer->clear();
+		}
+
+		BLI_mutex_lock(&s_mutex);
+		entry.busy = false;
+		BLI_condition_notify_all(&s_ioCondition);
+		BLI_mutex_unlock(&s_mutex);
+	}
+}
+
+void BufferStore::release(MemoryProxy *proxy)
+{
+	if (!isEnabled()) {
+		return;
+	}
+
+	BLI_mutex_lock(&s_mutex);
+	BufferStoreEntries::iterator it = s_entries.find(proxy);
+	if (it != s_entries.end()) {
+		BLI_assert(it->second.users > 0);
+		it->second.users--;
+	}
+	BLI_mutex_unlock(&s_mutex);
+}
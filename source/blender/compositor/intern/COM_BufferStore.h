@@ -0,0 +1,81 @@
+/*
+ * Copyright 2015, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_BufferStore_h_
+#define _COM_BufferStore_h_
+
+#include <stddef.h>
+
+class MemoryProxy;
+
+/**
+ * @brief bounds the memory used by the buffers of MemoryProxies by moving them to a scratch file.
+ *
+ * When enabled the data of a MemoryProxy buffer is only allocated when a chunk that writes or
+ * reads it is executed. During the execution of the chunk the buffer is in use and stays in memory.
+ * When the buffers in memory exceed the memory limit, the least recently used buffers that are not
+ * in use are written to the scratch file and freed. They are read back the next time they are used.
+ *
+ * Buffers are moved as a whole, operations address the data of a buffer as a single array.
+ * Buffers that are in use are never moved, so the limit can be exceeded by the buffers a single
+ * chunk needs.
+ *
+ * @see ExecutionGroup.acquireBuffers
+ * @ingroup Memory
+ */
+class BufferStore {
+public:
+	/**
+	 * @brief start an execution
+	 * @param limit memory in bytes the buffers may use, 0 disables the store and keeps all buffers in memory
+	 */
+	static void initialize(size_t limit);
+
+	/**
+	 * @brief end an execution, removes the scratch file
+	 */
+	static void deinitialize();
+
+	/**
+	 * @brief are the buffers of MemoryProxies managed by the store
+	 */
+	static bool isEnabled();
+
+	/**
+	 * @brief add the buffer of a MemoryProxy, its data is allocated when it is first used
+	 */
+	static void add(MemoryProxy *proxy);
+
+	/**
+	 * @brief remove the buffer of a MemoryProxy before it is freed
+	 */
+	static void remove(MemoryProxy *proxy);
+
+	/**
+	 * @brief make sure the buffer of the MemoryProxy is in memory and keep it there until released
+	 * @param write the caller changes the data, the buffer is written again when it is moved to the scratch file
+	 */
+	static void acquire(MemoryProxy *proxy, bool write);
+
+	/**
+	 * @brief the buffer is not used anymore by the caller of acquire
+	 */
+	static void release(MemoryProxy *proxy);
+};
+
+#endif
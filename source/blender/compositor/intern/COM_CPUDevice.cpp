@@ -30,7 +30,12 @@ void CPUDevice::execute(WorkPackage *work)
 
 	executionGroup->determineChunkRect(&rect, chunkNumber);
 
-	executionGroup->getOutputOperation()->executeRegion(&rect, chunkNumber);
+	executionGroup->acquireBuffers();
+	{
+		COM_PROFILE_SCOPE(executionGroup->getOutputOperation(), BLI_rcti_size_x(&rect) * BLI_rcti_size_y(&rect));
+		executionGroup->getOutputOperation()->executeRegion(&rect, chunkNumber);
+	}
+	executionGroup->releaseBuffers();
 
 	executionGroup->finalizeChunkExecution(chunkNumber, NULL);
 }
@@ -186,6 +186,19 @@ public:
 	void setFastCalculation(bool fastCalculation) {this->m_fastCalculation = fastCalculation;}
 	bool isFastCalculation() const { return this->m_fastCalculation; }
 	bool isGroupnodeBufferEnabled() const { return this->getbNodeTree()->flag & NTREE_COM_GROUPNODE_BUFFER; }
+
+	/**
+	 * @brief keep buffers of unchanged operations between executions, only while editing
+	 * @see ResultCache
+	 */
+	bool isResultCacheEnabled() const { return !this->m_rendering && this->getbNodeTree()->result_cache_limit > 0; }
+	size_t getResultCacheLimit() const { return (size_t)this->getbNodeTree()->result_cache_limit * 1024 * 1024; }
+
+	/**
+	 * @brief memory in bytes for the buffers of the execution before they are moved to disk, 0 is unlimited
+	 * @see BufferStore
+	 */
+	size_t getBufferMemoryLimit() const { return (size_t)this->getbNodeTree()->buffer_memory_limit * 1024 * 1024; }
 };
 
 
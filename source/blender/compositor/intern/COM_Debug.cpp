@@ -37,8 +37,10 @@ extern "C" {
 
 #include "COM_Node.h"
 #include "COM_ExecutionSystem.h"
+#include "COM_Profiler.h"
 #include "COM_ExecutionGroup.h"
 
+#include "COM_FusedOperation.h"
 #include "COM_ReadBufferOperation.h"
 #include "COM_ViewerOperation.h"
 #include "COM_WriteBufferOperation.h"
@@ -102,6 +104,23 @@ void DebugInfo::operation_read_write_buffer(const NodeOperation *operation)
 	m_current_op_name = m_op_names[operation];
 }
 
+void DebugInfo::operation_fused(const NodeOperation *operation)
+{
+	const FusedOperation::Operations &operations = ((const FusedOperation *)operation)->getFusedOperations();
+	std::string name;
+	
+	/* name of the fused operation lists the nodes of all fused operations */
+	for (FusedOperation::Operations::const_iterator it = operations.begin(); it != operations.end(); ++it) {
+		const std::string &op_name = m_op_names[*it];
+		if (op_name.empty() || name.find(op_name) != std::string::npos)
+			continue;
+		if (!name.empty())
+			name += " + ";
+		name += op_name;
+	}
+	m_op_names[operation] = name;
+}
+
 void DebugInfo::execution_group_started(const ExecutionGroup *group)
 {
 	m_group_states[group] = EG_RUNNING;
@@ -138,6 +157,9 @@ int DebugInfo::graphviz_operation(const ExecutionSystem *system, const NodeOpera
 	else if (operation->isWriteBufferOperation()) {
 		fillcolor = "darkorange";
 	}
+	else if (operation->isFusedOperation()) {
+		fillcolor = "plum1";
+	}
 	
 	len += snprintf(str + len, maxlen > len ? maxlen - len : 0, "// OPERATION: %p\r\n", operation);
 	if (group)
@@ -175,6 +197,17 @@ int DebugInfo::graphviz_operation(const ExecutionSystem *system, const NodeOpera
 	
 	len += snprintf(str + len, maxlen > len ? maxlen - len : 0, " (%d,%d)", operation->getWidth(), operation->getHeight());
 	
+	len += Profiler::graphviz_operation(operation, str + len, maxlen > len ? maxlen - len : 0);
+	
+	if (operation->isFusedOperation()) {
+		/* list the fused operations in execution order */
+		const FusedOperation::Operations &operations = ((const FusedOperation *)operation)->getFusedOperations();
+		for (FusedOperation::Operations::const_iterator it = operations.begin(); it != operations.end(); ++it) {
+			len += snprintf(str + len, maxlen > len ? maxlen - len : 0, "\\n%s (%s)", m_op_names[*it].c_str(), typeid(**it).name());
+			len += Profiler::graphviz_operation(*it, str + len, maxlen > len ? maxlen - len : 0);
+		}
+	}
+	
 	int totoutputs = operation->getNumberOfOutputSockets();
 	if (totoutputs != 0) {
 		len += snprintf(str + len, maxlen > len ? maxlen - len : 0, "|");
@@ -245,6 +278,7 @@ int DebugInfo::graphviz_legend(char *str, int maxlen)
 	len += graphviz_legend_color("Write Buffer", "darkorange", str + len, maxlen > len ? maxlen - len : 0);
 	len += graphviz_legend_color("Read Buffer", "darkolivegreen3", str + len, maxlen > len ? maxlen - len : 0);
 	len += graphviz_legend_color("Input Value", "khaki1", str + len, maxlen > len ? maxlen - len : 0);
+	len += graphviz_legend_color("Fused Operations", "plum1", str + len, maxlen > len ? maxlen - len : 0);
 
 	len += snprintf(str + len, maxlen > len ? maxlen - len : 0, "<TR><TD></TD></TR>\r\n");
 
@@ -417,6 +451,7 @@ void DebugInfo::node_added(const Node * /*node*/) {}
 void DebugInfo::node_to_operations(const Node * /*node*/) {}
 void DebugInfo::operation_added(const NodeOperation * /*operation*/) {}
 void DebugInfo::operation_read_write_buffer(const NodeOperation * /*operation*/) {}
+void DebugInfo::operation_fused(const NodeOperation * /*operation*/) {}
 void DebugInfo::execution_group_started(const ExecutionGroup * /*group*/) {}
 void DebugInfo::execution_group_finished(const ExecutionGroup * /*group*/) {}
 void DebugInfo::graphviz(const ExecutionSystem * /*system*/) {}
@@ -35,6 +35,7 @@
 #include "COM_ViewerOperation.h"
 #include "COM_ChunkOrder.h"
 #include "COM_Debug.h"
+#include "COM_BufferStore.h"
 
 #include "MEM_guardedalloc.h"
 #include "BLI_math.h"
@@ -44,11 +45,15 @@
 #include "WM_api.h"
 #include "WM_types.h"
 
+#include "atomic_ops.h"
+
 ExecutionGroup::ExecutionGroup()
 {
 	this->m_isOutput = false;
 	this->m_complex = false;
 	this->m_chunkExecutionStates = NULL;
+	this->m_chunkDependents = NULL;
+	this->m_chunkDependencyCounts = NULL;
 	this->m_bTree = NULL;
 	this->m_height = 0;
 	this->m_width = 0;
@@ -121,10 +126,16 @@ void ExecutionGroup::initExecution()
 		for (index = 0; index < this->m_numberOfChunks; index++) {
 			this->m_chunkExecutionStates[index] = COM_ES_NOT_SCHEDULED;
 		}
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+		this->m_chunkDependents = new vector<ChunkReference>[this->m_numberOfChunks];
+		this->m_chunkDependencyCounts = (unsigned int *)MEM_callocN(sizeof(unsigned int) * this->m_numberOfChunks, __func__);
+#endif
 	}
+	BLI_mutex_init(&this->m_chunkMutex);
 
 
 	unsigned int maxNumber = 0;
+	bool rowExecution = !this->m_complex;
 
 	for (index = 0; index < this->m_operations.size(); index++) {
 		NodeOperation *operation = this->m_operations[index];
@@ -133,10 +144,19 @@ void ExecutionGroup::initExecution()
 			this->m_cachedReadOperations.push_back(readOperation);
 			maxNumber = max(maxNumber, readOperation->getOffset());
 		}
+		if (!operation->isWriteBufferOperation() && !operation->isRowOperation()) {
+			rowExecution = false;
+		}
 	}
 	maxNumber++;
 	this->m_cachedMaxReadBufferOffset = maxNumber;
 
+	/* execute row by row when every operation in this group implements executeRow */
+	NodeOperation *outputOperation = this->getOutputOperation();
+	if (outputOperation->isWriteBufferOperation()) {
+		((WriteBufferOperation *)outputOperation)->setUseRowExecution(rowExecution);
+	}
+
 }
 
 void ExecutionGroup::deinitExecution()
@@ -145,6 +165,15 @@ void ExecutionGroup::deinitExecution()
 		MEM_freeN(this->m_chunkExecutionStates);
 		this->m_chunkExecutionStates = NULL;
 	}
+	if (this->m_chunkDependents != NULL) {
+		delete[] this->m_chunkDependents;
+		this->m_chunkDependents = NULL;
+	}
+	if (this->m_chunkDependencyCounts != NULL) {
+		MEM_freeN(this->m_chunkDependencyCounts);
+		this->m_chunkDependencyCounts = NULL;
+	}
+	BLI_mutex_end(&this->m_chunkMutex);
 	this->m_numberOfChunks = 0;
 	this->m_numberOfXChunks = 0;
 	this->m_numberOfYChunks = 0;
@@ -303,6 +332,19 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
 	DebugInfo::execution_group_started(this);
 	DebugInfo::graphviz(graph);
 
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+	/* request all chunks up front, every chunk is scheduled by the chunks it depends on
+	 * as soon as their execution is finished. the workers test the tree for a break
+	 * before each chunk */
+	for (index = 0; index < this->m_numberOfChunks; index++) {
+		if (bTree->test_break && bTree->test_break(bTree->tbh)) {
+			break;
+		}
+		requestChunk(chunkOrder[index]);
+	}
+
+	WorkScheduler::finish();
+#else
 	bool breaked = false;
 	bool finished = false;
 	unsigned int startIndex = 0;
@@ -343,6 +385,7 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
 			breaked = true;
 		}
 	}
+#endif
 	DebugInfo::execution_group_finished(this);
 	DebugInfo::graphviz(graph);
 
@@ -408,10 +451,12 @@ void ExecutionGroup::printBackgroundStats(void)
 
 void ExecutionGroup::finalizeChunkExecution(int chunkNumber, MemoryBuffer **memoryBuffers)
 {
+	BLI_mutex_lock(&this->m_chunkMutex);
 	if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_SCHEDULED)
 		this->m_chunkExecutionStates[chunkNumber] = COM_ES_EXECUTED;
+	BLI_mutex_unlock(&this->m_chunkMutex);
 	
-	this->m_chunksFinished++;
+	atomic_add_uint32((uint32_t *)&this->m_chunksFinished, 1);
 	if (memoryBuffers) {
 		for (unsigned int index = 0; index < this->m_cachedMaxReadBufferOffset; index++) {
 			MemoryBuffer *buffer = memoryBuffers[index];
@@ -432,6 +477,42 @@ void ExecutionGroup::finalizeChunkExecution(int chunkNumber, MemoryBuffer **memo
 
 		if (G.background)
 			printBackgroundStats();
+
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+		/* the main thread waits in WorkScheduler.finish, redraw from here */
+		if (this->m_bTree->update_draw)
+			this->m_bTree->update_draw(this->m_bTree->udh);
+#endif
+	}
+}
+
+void ExecutionGroup::acquireBuffers()
+{
+	if (!BufferStore::isEnabled()) {
+		return;
+	}
+	NodeOperation *operation = this->getOutputOperation();
+	if (operation->isWriteBufferOperation()) {
+		BufferStore::acquire(((WriteBufferOperation *)operation)->getMemoryProxy(), true);
+	}
+	for (unsigned int index = 0; index < this->m_cachedReadOperations.size(); index++) {
+		ReadBufferOperation *readOperation = (ReadBufferOperation *)this->m_cachedReadOperations[index];
+		BufferStore::acquire(readOperation->getMemoryProxy(), false);
+	}
+}
+
+void ExecutionGroup::releaseBuffers()
+{
+	if (!BufferStore::isEnabled()) {
+		return;
+	}
+	NodeOperation *operation = this->getOutputOperation();
+	if (operation->isWriteBufferOperation()) {
+		BufferStore::release(((WriteBufferOperation *)operation)->getMemoryProxy());
+	}
+	for (unsigned int index = 0; index < this->m_cachedReadOperations.size(); index++) {
+		ReadBufferOperation *readOperation = (ReadBufferOperation *)this->m_cachedReadOperations[index];
+		BufferStore::release(readOperation->getMemoryProxy());
 	}
 }
 
@@ -472,15 +553,11 @@ MemoryBuffer *ExecutionGroup::allocateOutputBuffer(int chunkNumber, rcti *rect)
 }
 
 
-bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area)
+void ExecutionGroup::determineAreaChunks(rcti *area, int *r_minxchunk, int *r_maxxchunk, int *r_minychunk, int *r_maxychunk) const
 {
-	if (this->m_singleThreaded) {
-		return scheduleChunkWhenPossible(graph, 0, 0);
-	}
 	// find all chunks inside the rect
 	// determine minxchunk, minychunk, maxxchunk, maxychunk where x and y are chunknumbers
 
-	int indexx, indexy;
 	int minx = max_ii(area->xmin - m_viewerBorder.xmin, 0);
 	int maxx = min_ii(area->xmax - m_viewerBorder.xmin, m_viewerBorder.xmax - m_viewerBorder.xmin);
 	int miny = max_ii(area->ymin - m_viewerBorder.ymin, 0);
@@ -494,6 +571,22 @@ bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area
 	maxxchunk = min_ii(maxxchunk, (int)m_numberOfXChunks);
 	maxychunk = min_ii(maxychunk, (int)m_numberOfYChunks);
 
+	*r_minxchunk = minxchunk;
+	*r_maxxchunk = maxxchunk;
+	*r_minychunk = minychunk;
+	*r_maxychunk = maxychunk;
+}
+
+bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area)
+{
+	if (this->m_singleThreaded) {
+		return scheduleChunkWhenPossible(graph, 0, 0);
+	}
+
+	int indexx, indexy;
+	int minxchunk, maxxchunk, minychunk, maxychunk;
+	determineAreaChunks(area, &minxchunk, &maxxchunk, &minychunk, &maxychunk);
+
 	bool result = true;
 	for (indexx = minxchunk; indexx < maxxchunk; indexx++) {
 		for (indexy = minychunk; indexy < maxychunk; indexy++) {
@@ -569,6 +662,112 @@ bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChun
 	return false;
 }
 
+void ExecutionGroup::requestChunk(unsigned int chunkNumber)
+{
+	BLI_mutex_lock(&this->m_chunkMutex);
+	if (this->m_chunkExecutionStates[chunkNumber] != COM_ES_NOT_SCHEDULED) {
+		BLI_mutex_unlock(&this->m_chunkMutex);
+		return;
+	}
+	this->m_chunkExecutionStates[chunkNumber] = COM_ES_SCHEDULED;
+	BLI_mutex_unlock(&this->m_chunkMutex);
+
+	/* hold one dependency while the depending chunks are requested, so the chunk
+	 * is not scheduled before all of them are registered */
+	this->m_chunkDependencyCounts[chunkNumber] = 1;
+
+	ChunkReference self;
+	self.group = this;
+	self.chunkNumber = chunkNumber;
+
+	rcti rect;
+	rcti area;
+	determineChunkRect(&rect, chunkNumber);
+
+	for (unsigned int index = 0; index < this->m_cachedReadOperations.size(); index++) {
+		ReadBufferOperation *readOperation = (ReadBufferOperation *)this->m_cachedReadOperations[index];
+		BLI_rcti_init(&area, 0, 0, 0, 0);
+		determineDependingAreaOfInterest(&rect, readOperation, &area);
+		ExecutionGroup *group = readOperation->getMemoryProxy()->getExecutor();
+
+		if (group == NULL) {
+			throw "ERROR";
+		}
+		group->addAreaDependent(&area, self);
+	}
+
+	releaseChunkDependency(chunkNumber, -1);
+}
+
+void ExecutionGroup::addAreaDependent(rcti *area, const ChunkReference &dependent)
+{
+	if (this->m_singleThreaded) {
+		requestChunk(0);
+		addChunkDependent(0, dependent);
+		return;
+	}
+
+	int indexx, indexy;
+	int minxchunk, maxxchunk, minychunk, maxychunk;
+	determineAreaChunks(area, &minxchunk, &maxxchunk, &minychunk, &maxychunk);
+
+	for (indexy = minychunk; indexy < maxychunk; indexy++) {
+		for (indexx = minxchunk; indexx < maxxchunk; indexx++) {
+			const unsigned int chunkNumber = indexy * this->m_numberOfXChunks + indexx;
+			requestChunk(chunkNumber);
+			addChunkDependent(chunkNumber, dependent);
+		}
+	}
+}
+
+void ExecutionGroup::addChunkDependent(unsigned int chunkNumber, const ChunkReference &dependent)
+{
+	BLI_mutex_lock(&this->m_chunkMutex);
+	if (this->m_chunkExecutionStates[chunkNumber] != COM_ES_EXECUTED) {
+		atomic_add_uint32((uint32_t *)&dependent.group->m_chunkDependencyCounts[dependent.chunkNumber], 1);
+		this->m_chunkDependents[chunkNumber].push_back(dependent);
+	}
+	BLI_mutex_unlock(&this->m_chunkMutex);
+}
+
+void ExecutionGroup::releaseChunkDependency(unsigned int chunkNumber, int threadID)
+{
+	if (atomic_sub_uint32((uint32_t *)&this->m_chunkDependencyCounts[chunkNumber], 1) == 0) {
+		WorkScheduler::schedule(this, chunkNumber, threadID);
+	}
+}
+
+bool ExecutionGroup::isCompletelyExecuted() const
+{
+	for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+		if (this->m_chunkExecutionStates[index] != COM_ES_EXECUTED) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void ExecutionGroup::setCompletelyExecuted()
+{
+	for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+		this->m_chunkExecutionStates[index] = COM_ES_EXECUTED;
+	}
+}
+
+void ExecutionGroup::releaseDependentChunks(unsigned int chunkNumber, int threadID)
+{
+	vector<ChunkReference> dependents;
+
+	BLI_mutex_lock(&this->m_chunkMutex);
+	dependents.swap(this->m_chunkDependents[chunkNumber]);
+	BLI_mutex_unlock(&this->m_chunkMutex);
+
+	for (unsigned int index = 0; index < dependents.size(); index++) {
+		const ChunkReference &dependent = dependents[index];
+		dependent.group->releaseChunkDependency(dependent.chunkNumber, threadID);
+	}
+}
+
 void ExecutionGroup::determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output)
 {
 	this->getOutputOperation()->determineDependingAreaOfInterest(input, readOperation, output);
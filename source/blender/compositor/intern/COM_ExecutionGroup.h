@@ -31,12 +31,17 @@
 #include "COM_Device.h"
 #include "COM_CompositorContext.h"
 
+extern "C" {
+#  include "BLI_threads.h"
+}
+
 using std::vector;
 
 class ExecutionSystem;
 class MemoryProxy;
 class ReadBufferOperation;
 class Device;
+class ExecutionGroup;
 
 /**
  * @brief the execution state of a chunk in an ExecutionGroup
@@ -57,6 +62,15 @@ typedef enum ChunkExecutionState {
 	COM_ES_EXECUTED = 2
 } ChunkExecutionState;
 
+/**
+ * @brief reference to a single chunk of an ExecutionGroup
+ * @ingroup Execution
+ */
+typedef struct ChunkReference {
+	ExecutionGroup *group;
+	unsigned int chunkNumber;
+} ChunkReference;
+
 /**
  * @brief Class ExecutionGroup is a group of Operations that are executed as one.
  * This grouping is used to combine Operations that can be executed as one whole when multi-processing.
@@ -155,6 +169,23 @@ private:
 	 *   - COM_ES_EXECUTED: executed
 	 */
 	ChunkExecutionState *m_chunkExecutionStates;
+
+	/**
+	 * @brief per chunk the chunks of other ExecutionGroups that wait for this chunk to be executed
+	 * @note only used with COM_TM_TASK
+	 */
+	vector<ChunkReference> *m_chunkDependents;
+
+	/**
+	 * @brief per chunk the number of chunks it still waits for, the chunk is scheduled when this becomes zero
+	 * @note only used with COM_TM_TASK
+	 */
+	unsigned int *m_chunkDependencyCounts;
+
+	/**
+	 * @brief protects m_chunkExecutionStates and m_chunkDependents, chunks are requested from multiple threads
+	 */
+	ThreadMutex m_chunkMutex;
 	
 	/**
 	 * @brief indicator when this ExecutionGroup has valid Operations in its vector for Execution
@@ -231,6 +262,41 @@ private:
 	 */
 	bool scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *rect);
 
+	/**
+	 * @brief determine the range of chunks that overlap an area
+	 * @note the ranges are half open: [minxchunk, maxxchunk) and [minychunk, maxychunk)
+	 */
+	void determineAreaChunks(rcti *area, int *r_minxchunk, int *r_maxxchunk, int *r_minychunk, int *r_maxychunk) const;
+
+	/**
+	 * @brief request a chunk to be executed (COM_TM_TASK)
+	 * @note the chunks of the groups this chunk reads from are requested as well. The chunk
+	 * is scheduled by the last of these chunks that finishes, no thread waits for it.
+	 * Requesting a chunk that was already requested does nothing.
+	 * @param chunkNumber
+	 */
+	void requestChunk(unsigned int chunkNumber);
+
+	/**
+	 * @brief request all chunks overlapping an area and let the dependent chunk wait for them (COM_TM_TASK)
+	 * @param area the area of this group that is needed by the dependent chunk
+	 * @param dependent the chunk of another group that reads the area
+	 */
+	void addAreaDependent(rcti *area, const ChunkReference &dependent);
+
+	/**
+	 * @brief let a chunk of another group wait for a chunk of this group (COM_TM_TASK)
+	 * @note does nothing when the chunk is already executed
+	 */
+	void addChunkDependent(unsigned int chunkNumber, const ChunkReference &dependent);
+
+	/**
+	 * @brief one of the chunks a chunk waits for is executed (COM_TM_TASK)
+	 * @note when it was the last one the chunk is scheduled
+	 * @param threadID thread that executed the chunk, see WorkScheduler.schedule
+	 */
+	void releaseChunkDependency(unsigned int chunkNumber, int threadID);
+
 	/**
 	 * @brief add a chunk to the WorkScheduler.
 	 * @param chunknumber
@@ -357,6 +423,36 @@ public:
 	 * @param memorybuffers
 	 */
 	void finalizeChunkExecution(int chunkNumber, MemoryBuffer **memoryBuffers);
+
+	/**
+	 * @brief keep the buffers that are read and written by a chunk in memory during its execution
+	 * @see BufferStore
+	 */
+	void acquireBuffers();
+
+	/**
+	 * @brief the buffers of acquireBuffers are not used anymore
+	 */
+	void releaseBuffers();
+
+	/**
+	 * @brief release the chunks of other groups that wait for an executed chunk (COM_TM_TASK)
+	 * @note called by the WorkScheduler after finalizeChunkExecution
+	 * @param chunkNumber the executed chunk
+	 * @param threadID thread that executed the chunk, see WorkScheduler.schedule
+	 */
+	void releaseDependentChunks(unsigned int chunkNumber, int threadID);
+
+	/**
+	 * @brief are all chunks of this ExecutionGroup executed
+	 */
+	bool isCompletelyExecuted() const;
+
+	/**
+	 * @brief mark all chunks as executed, used when the output is restored from the ResultCache
+	 * @note must be called after initExecution
+	 */
+	void setCompletelyExecuted();
 	
 	/**
 	 * @brief deinitExecution is called just after execution the whole graph.
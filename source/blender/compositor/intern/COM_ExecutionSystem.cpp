@@ -34,7 +34,11 @@ extern "C" {
 #include "COM_ExecutionGroup.h"
 #include "COM_WorkScheduler.h"
 #include "COM_ReadBufferOperation.h"
+#include "COM_WriteBufferOperation.h"
+#include "COM_ResultCache.h"
+#include "COM_BufferStore.h"
 #include "COM_Debug.h"
+#include "COM_Profiler.h"
 
 #include "BKE_global.h"
 
@@ -125,6 +129,7 @@ void ExecutionSystem::set_operations(const Operations &operations, const Groups
 void ExecutionSystem::execute()
 {
 	DebugInfo::execute_started(this);
+	Profiler::execute_started(this);
 	
 	unsigned int order = 0;
 	for (vector<NodeOperation *>::iterator iter = this->m_operations.begin(); iter != this->m_operations.end(); ++iter) {
@@ -137,6 +142,9 @@ void ExecutionSystem::execute()
 	}
 	unsigned int index;
 
+	/* before initExecution, the buffers of write buffer operations are allocated there */
+	BufferStore::initialize(this->m_context.getBufferMemoryLimit());
+
 	for (index = 0; index < this->m_operations.size(); index++) {
 		NodeOperation *operation = this->m_operations[index];
 		operation->setbNodeTree(this->m_context.getbNodeTree());
@@ -155,6 +163,30 @@ void ExecutionSystem::execute()
 		executionGroup->initExecution();
 	}
 
+	vector<bool> restoredGroups(this->m_groups.size(), false);
+	if (this->m_context.isResultCacheEnabled()) {
+		ResultCache::setMemoryLimit(this->m_context.getResultCacheLimit());
+		/* groups are only scheduled for chunks that are not executed yet, so groups
+		 * only needed to calculate a restored buffer are skipped as well */
+		for (index = 0; index < this->m_groups.size(); index++) {
+			ExecutionGroup *executionGroup = this->m_groups[index];
+			NodeOperation *operation = executionGroup->getOutputOperation();
+			if (operation->isWriteBufferOperation()) {
+				WriteBufferOperation *writeOperation = (WriteBufferOperation *)operation;
+				if (writeOperation->getResultCacheKey() == COM_RESULT_CACHE_NO_KEY) {
+					continue;
+				}
+				MemoryProxy *memoryProxy = writeOperation->getMemoryProxy();
+				BufferStore::acquire(memoryProxy, true);
+				if (ResultCache::restore(writeOperation->getResultCacheKey(), memoryProxy->getBuffer())) {
+					executionGroup->setCompletelyExecuted();
+					restoredGroups[index] = true;
+				}
+				BufferStore::release(memoryProxy);
+			}
+		}
+	}
+
 	WorkScheduler::start(this->m_context);
 
 	executeGroups(COM_PRIORITY_HIGH);
@@ -166,6 +198,26 @@ void ExecutionSystem::execute()
 	WorkScheduler::finish();
 	WorkScheduler::stop();
 
+	Profiler::execute_finished(this);
+	DebugInfo::graphviz(this);
+
+	const bNodeTree *bTree = this->m_context.getbNodeTree();
+	if (this->m_context.isResultCacheEnabled() && !(bTree->test_break && bTree->test_break(bTree->tbh))) {
+		/* store buffers that are calculated completely, when execution was cancelled
+		 * operations may have stopped halfway through a chunk */
+		for (index = 0; index < this->m_groups.size(); index++) {
+			ExecutionGroup *executionGroup = this->m_groups[index];
+			NodeOperation *operation = executionGroup->getOutputOperation();
+			if (!restoredGroups[index] && operation->isWriteBufferOperation() && executionGroup->isCompletelyExecuted()) {
+				WriteBufferOperation *writeOperation = (WriteBufferOperation *)operation;
+				MemoryProxy *memoryProxy = writeOperation->getMemoryProxy();
+				BufferStore::acquire(memoryProxy, false);
+				ResultCache::store(writeOperation->getResultCacheKey(), memoryProxy->getBuffer());
+				BufferStore::release(memoryProxy);
+			}
+		}
+	}
+
 	for (index = 0; index < this->m_operations.size(); index++) {
 		NodeOperation *operation = this->m_operations[index];
 		operation->deinitExecution();
@@ -174,6 +226,8 @@ void ExecutionSystem::execute()
 		ExecutionGroup *executionGroup = this->m_groups[index];
 		executionGroup->deinitExecution();
 	}
+
+	BufferStore::deinitialize();
 }
 
 void ExecutionSystem::executeGroups(CompositorPriority priority)
@@ -181,6 +181,7 @@ private:
 
 	/* allow the DebugInfo class to look at internals */
 	friend class DebugInfo;
+	friend class Profiler;
 
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("COM:ExecutionSystem")
@@ -41,14 +41,18 @@ int MemoryBuffer::getHeight() const
 	return this->m_rect.ymax - this->m_rect.ymin;
 }
 
-MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, unsigned int chunkNumber, rcti *rect)
+MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, unsigned int chunkNumber, rcti *rect, bool allocate)
 {
 	BLI_rcti_init(&this->m_rect, rect->xmin, rect->xmax, rect->ymin, rect->ymax);
 	this->m_memoryProxy = memoryProxy;
 	this->m_chunkNumber = chunkNumber;
-	this->m_buffer = (float *)MEM_mallocN_aligned(sizeof(float) * determineBufferSize() * COM_NUMBER_OF_CHANNELS, 16, "COM_MemoryBuffer");
+	this->m_datatype = memoryProxy->getDataType();
+	this->m_num_channels = COM_data_type_num_channels(this->m_datatype);
+	this->m_buffer = NULL;
+	if (allocate) {
+		allocateBuffer();
+	}
 	this->m_state = COM_MB_ALLOCATED;
-	this->m_datatype = COM_DT_COLOR;
 	this->m_chunkWidth = this->m_rect.xmax - this->m_rect.xmin;
 }
 
@@ -57,20 +61,48 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect)
 	BLI_rcti_init(&this->m_rect, rect->xmin, rect->xmax, rect->ymin, rect->ymax);
 	this->m_memoryProxy = memoryProxy;
 	this->m_chunkNumber = -1;
-	this->m_buffer = (float *)MEM_mallocN_aligned(sizeof(float) * determineBufferSize() * COM_NUMBER_OF_CHANNELS, 16, "COM_MemoryBuffer");
+	this->m_datatype = memoryProxy->getDataType();
+	this->m_num_channels = COM_data_type_num_channels(this->m_datatype);
+	this->m_buffer = (float *)MEM_mallocN_aligned(sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
 	this->m_state = COM_MB_TEMPORARILY;
-	this->m_datatype = COM_DT_COLOR;
 	this->m_chunkWidth = this->m_rect.xmax - this->m_rect.xmin;
 }
+
+MemoryBuffer::MemoryBuffer(DataType datatype, rcti *rect)
+{
+	BLI_rcti_init(&this->m_rect, rect->xmin, rect->xmax, rect->ymin, rect->ymax);
+	this->m_memoryProxy = NULL;
+	this->m_chunkNumber = -1;
+	this->m_datatype = datatype;
+	this->m_num_channels = COM_data_type_num_channels(this->m_datatype);
+	this->m_buffer = (float *)MEM_mallocN_aligned(sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+	this->m_state = COM_MB_TEMPORARILY;
+	this->m_chunkWidth = this->m_rect.xmax - this->m_rect.xmin;
+}
+void MemoryBuffer::allocateBuffer()
+{
+	BLI_assert(this->m_buffer == NULL);
+	this->m_buffer = (float *)MEM_mallocN_aligned(sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+}
+
+void MemoryBuffer::freeBuffer()
+{
+	if (this->m_buffer) {
+		MEM_freeN(this->m_buffer);
+		this->m_buffer = NULL;
+	}
+}
+
 MemoryBuffer *MemoryBuffer::duplicate()
 {
-	MemoryBuffer *result = new MemoryBuffer(this->m_memoryProxy, &this->m_rect);
-	memcpy(result->m_buffer, this->m_buffer, this->determineBufferSize() * COM_NUMBER_OF_CHANNELS * sizeof(float));
+	MemoryBuffer *result = new MemoryBuffer(this->m_datatype, &this->m_rect);
+	result->m_memoryProxy = this->m_memoryProxy;
+	memcpy(result->m_buffer, this->m_buffer, this->determineBufferSize() * this->m_num_channels * sizeof(float));
 	return result;
 }
 void MemoryBuffer::clear()
 {
-	memset(this->m_buffer, 0, this->determineBufferSize() * COM_NUMBER_OF_CHANNELS * sizeof(float));
+	memset(this->m_buffer, 0, this->determineBufferSize() * this->m_num_channels * sizeof(float));
 }
 
 float *MemoryBuffer::convertToValueBuffer()
@@ -83,7 +115,7 @@ float *MemoryBuffer::convertToValueBuffer()
 	const float *fp_src = this->m_buffer;
 	float       *fp_dst = result;
 
-	for (i = 0; i < size; i++, fp_dst++, fp_src += COM_NUMBER_OF_CHANNELS) {
+	for (i = 0; i < size; i++, fp_dst++, fp_src += this->m_num_channels) {
 		*fp_dst = *fp_src;
 	}
 
@@ -98,7 +130,7 @@ float MemoryBuffer::getMaximumValue()
 
 	const float *fp_src = this->m_buffer;
 
-	for (i = 0; i < size; i++, fp_src += COM_NUMBER_OF_CHANNELS) {
+	for (i = 0; i < size; i++, fp_src += this->m_num_channels) {
 		float value = *fp_src;
 		if (value > result) {
 			result = value;
@@ -116,7 +148,7 @@ float MemoryBuffer::getMaximumValue(rcti *rect)
 	BLI_rcti_isect(rect, &this->m_rect, &rect_clamp);
 
 	if (!BLI_rcti_is_empty(&rect_clamp)) {
-		MemoryBuffer *temp = new MemoryBuffer(NULL, &rect_clamp);
+		MemoryBuffer *temp = new MemoryBuffer(this->m_datatype, &rect_clamp);
 		temp->copyContentFrom(this);
 		float result = temp->getMaximumValue();
 		delete temp;
@@ -142,6 +174,8 @@ void MemoryBuffer::copyContentFrom(MemoryBuffer *otherBuffer)
 		BLI_assert(0);
 		return;
 	}
+	BLI_assert(this->m_num_channels == otherBuffer->m_num_channels);
+
 	unsigned int otherY;
 	unsigned int minX = max(this->m_rect.xmin, otherBuffer->m_rect.xmin);
 	unsigned int maxX = min(this->m_rect.xmax, otherBuffer->m_rect.xmax);
@@ -152,9 +186,9 @@ void MemoryBuffer::copyContentFrom(MemoryBuffer *otherBuffer)
 
 
 	for (otherY = minY; otherY < maxY; otherY++) {
-		otherOffset = ((otherY - otherBuffer->m_rect.ymin) * otherBuffer->m_chunkWidth + minX - otherBuffer->m_rect.xmin) * COM_NUMBER_OF_CHANNELS;
-		offset = ((otherY - this->m_rect.ymin) * this->m_chunkWidth + minX - this->m_rect.xmin) * COM_NUMBER_OF_CHANNELS;
-		memcpy(&this->m_buffer[offset], &otherBuffer->m_buffer[otherOffset], (maxX - minX) * COM_NUMBER_OF_CHANNELS * sizeof(float));
+		otherOffset = ((otherY - otherBuffer->m_rect.ymin) * otherBuffer->m_chunkWidth + minX - otherBuffer->m_rect.xmin) * this->m_num_channels;
+		offset = ((otherY - this->m_rect.ymin) * this->m_chunkWidth + minX - this->m_rect.xmin) * this->m_num_channels;
+		memcpy(&this->m_buffer[offset], &otherBuffer->m_buffer[otherOffset], (maxX - minX) * this->m_num_channels * sizeof(float));
 	}
 }
 
@@ -163,8 +197,8 @@ void MemoryBuffer::writePixel(int x, int y, const float color[4])
 	if (x >= this->m_rect.xmin && x < this->m_rect.xmax &&
 	    y >= this->m_rect.ymin && y < this->m_rect.ymax)
 	{
-		const int offset = (this->m_chunkWidth * (y - this->m_rect.ymin) + x - this->m_rect.xmin) * COM_NUMBER_OF_CHANNELS;
-		copy_v4_v4(&this->m_buffer[offset], color);
+		const int offset = (this->m_chunkWidth * (y - this->m_rect.ymin) + x - this->m_rect.xmin) * this->m_num_channels;
+		memcpy(&this->m_buffer[offset], color, sizeof(float) * this->m_num_channels);
 	}
 }
 
@@ -173,8 +207,42 @@ void MemoryBuffer::addPixel(int x, int y, const float color[4])
 	if (x >= this->m_rect.xmin && x < this->m_rect.xmax &&
 	    y >= this->m_rect.ymin && y < this->m_rect.ymax)
 	{
-		const int offset = (this->m_chunkWidth * (y - this->m_rect.ymin) + x - this->m_rect.xmin) * COM_NUMBER_OF_CHANNELS;
-		add_v4_v4(&this->m_buffer[offset], color);
+		const int offset = (this->m_chunkWidth * (y - this->m_rect.ymin) + x - this->m_rect.xmin) * this->m_num_channels;
+		float *dst = &this->m_buffer[offset];
+		for (unsigned int i = 0; i < this->m_num_channels; i++) {
+			dst[i] += color[i];
+		}
+	}
+}
+
+void MemoryBuffer::readRow(float *result, int x, int y, int length)
+{
+	const int xmin = max(x, this->m_rect.xmin);
+	const int xmax = min(x + length, this->m_rect.xmax);
+
+	if (y < this->m_rect.ymin || y >= this->m_rect.ymax || xmin >= xmax) {
+		/* clip result outside rect is zero */
+		memset(result, 0, length * COM_NUMBER_OF_CHANNELS * sizeof(float));
+		return;
+	}
+
+	if (xmin > x) {
+		memset(result, 0, (xmin - x) * COM_NUMBER_OF_CHANNELS * sizeof(float));
+	}
+
+	const int offset = (this->m_chunkWidth * (y - this->m_rect.ymin) + xmin - this->m_rect.xmin) * this->m_num_channels;
+	if (this->m_num_channels == COM_NUMBER_OF_CHANNELS) {
+		memcpy(&result[(xmin - x) * COM_NUMBER_OF_CHANNELS], &this->m_buffer[offset], (xmax - xmin) * COM_NUMBER_OF_CHANNELS * sizeof(float));
+	}
+	else {
+		const float *pixel = &this->m_buffer[offset];
+		for (int i = xmin - x; i < xmax - x; i++, pixel += this->m_num_channels) {
+			readPixel(&result[i * COM_NUMBER_OF_CHANNELS], pixel);
+		}
+	}
+
+	if (xmax < x + length) {
+		memset(&result[(xmax - x) * COM_NUMBER_OF_CHANNELS], 0, (x + length - xmax) * COM_NUMBER_OF_CHANNELS * sizeof(float));
 	}
 }
 
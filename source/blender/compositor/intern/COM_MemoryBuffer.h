@@ -69,6 +69,11 @@ private:
 	 * @brief the type of buffer COM_DT_VALUE, COM_DT_VECTOR, COM_DT_COLOR
 	 */
 	DataType m_datatype;
+
+	/**
+	 * @brief number of floats stored per pixel, depends on m_datatype
+	 */
+	unsigned int m_num_channels;
 	
 	
 	/**
@@ -100,13 +105,19 @@ private:
 public:
 	/**
 	 * @brief construct new MemoryBuffer for a chunk
+	 * @param allocate when false the data is allocated later with allocateBuffer
 	 */
-	MemoryBuffer(MemoryProxy *memoryProxy, unsigned int chunkNumber, rcti *rect);
+	MemoryBuffer(MemoryProxy *memoryProxy, unsigned int chunkNumber, rcti *rect, bool allocate = true);
 	
 	/**
 	 * @brief construct new temporarily MemoryBuffer for an area
 	 */
 	MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect);
+
+	/**
+	 * @brief construct new temporarily MemoryBuffer for an area, not related to a MemoryProxy
+	 */
+	MemoryBuffer(DataType datatype, rcti *rect);
 	
 	/**
 	 * @brief destructor
@@ -123,6 +134,33 @@ public:
 	 * @note buffer should already be available in memory
 	 */
 	float *getBuffer() { return this->m_buffer; }
+
+	/**
+	 * @brief is the data of this MemoryBuffer in memory
+	 * @see BufferStore
+	 */
+	bool isAllocated() const { return this->m_buffer != NULL; }
+
+	/**
+	 * @brief allocate the data of a MemoryBuffer that was constructed without data, the content is undefined
+	 */
+	void allocateBuffer();
+
+	/**
+	 * @brief free the data, the MemoryBuffer can not be accessed until the data is allocated again
+	 */
+	void freeBuffer();
+
+	/**
+	 * @brief get the data type of this MemoryBuffer
+	 */
+	DataType getDataType() const { return this->m_datatype; }
+
+	/**
+	 * @brief number of floats per pixel in the buffer
+	 * @see COM_data_type_num_channels
+	 */
+	unsigned int getNumberOfChannels() const { return this->m_num_channels; }
 	
 	/**
 	 * @brief after execution the state will be set to available by calling this method
@@ -132,6 +170,26 @@ public:
 		this->m_state = COM_MB_AVAILABLE;
 	}
 	
+	/**
+	 * @brief expand a stored pixel to COM_NUMBER_OF_CHANNELS floats, channels that are not stored are zero
+	 */
+	inline void readPixel(float result[4], const float *pixel) const
+	{
+		switch (this->m_num_channels) {
+			case COM_NUM_CHANNELS_VALUE:
+				result[0] = pixel[0];
+				result[1] = result[2] = result[3] = 0.0f;
+				break;
+			case COM_NUM_CHANNELS_VECTOR:
+				copy_v3_v3(result, pixel);
+				result[3] = 0.0f;
+				break;
+			default:
+				copy_v4_v4(result, pixel);
+				break;
+		}
+	}
+
 	inline void wrap_pixel(int &x, int &y, MemoryBufferExtend extend_x, MemoryBufferExtend extend_y)
 	{
 		int w = m_rect.xmax - m_rect.xmin;
@@ -176,8 +234,8 @@ public:
 		}
 		else {
 			wrap_pixel(x, y, extend_x, extend_y);
-			const int offset = (this->m_chunkWidth * y + x) * COM_NUMBER_OF_CHANNELS;
-			copy_v4_v4(result, &this->m_buffer[offset]);
+			const int offset = (this->m_chunkWidth * y + x) * this->m_num_channels;
+			readPixel(result, &this->m_buffer[offset]);
 		}
 	}
 
@@ -186,22 +244,28 @@ public:
 	                        MemoryBufferExtend extend_y = COM_MB_CLIP)
 	{
 		wrap_pixel(x, y, extend_x, extend_y);
-		const int offset = (this->m_chunkWidth * y + x) * COM_NUMBER_OF_CHANNELS;
+		const int offset = (this->m_chunkWidth * y + x) * this->m_num_channels;
 
 		BLI_assert(offset >= 0);
-		BLI_assert(offset < this->determineBufferSize() * COM_NUMBER_OF_CHANNELS);
+		BLI_assert(offset < this->determineBufferSize() * this->m_num_channels);
 		BLI_assert(!(extend_x == COM_MB_CLIP && (x < m_rect.xmin || x >= m_rect.xmax)) &&
 		           !(extend_y == COM_MB_CLIP && (y < m_rect.ymin || y >= m_rect.ymax)));
 
 #if 0
 		/* always true */
 		BLI_assert((int)(MEM_allocN_len(this->m_buffer) / sizeof(*this->m_buffer)) ==
-		           (int)(this->determineBufferSize() * COM_NUMBER_OF_CHANNELS));
+		           (int)(this->determineBufferSize() * this->m_num_channels));
 #endif
 
-		copy_v4_v4(result, &this->m_buffer[offset]);
+		readPixel(result, &this->m_buffer[offset]);
 	}
 	
+	/**
+	 * @brief read a row of pixels into result, pixels outside the buffer are zero
+	 * @see SocketReader.executeRow
+	 */
+	void readRow(float *result, int x, int y, int length);
+
 	void writePixel(int x, int y, const float color[4]);
 	void addPixel(int x, int y, const float color[4]);
 	inline void readBilinear(float result[4], float x, float y,
@@ -21,12 +21,15 @@
  */
 
 #include "COM_MemoryProxy.h"
+#include "COM_BufferStore.h"
 
 
-MemoryProxy::MemoryProxy()
+MemoryProxy::MemoryProxy(DataType datatype)
 {
 	this->m_writeBufferOperation = NULL;
 	this->m_executor = NULL;
+	this->m_datatype = datatype;
+	this->m_buffer = NULL;
 }
 
 void MemoryProxy::allocate(unsigned int width, unsigned int height)
@@ -37,12 +40,20 @@ void MemoryProxy::allocate(unsigned int width, unsigned int height)
 	result.ymin = 0;
 	result.ymax = height;
 
-	this->m_buffer = new MemoryBuffer(this, 1, &result);
+	if (BufferStore::isEnabled()) {
+		/* the data is allocated by the store when the buffer is used */
+		this->m_buffer = new MemoryBuffer(this, 1, &result, false);
+		BufferStore::add(this);
+	}
+	else {
+		this->m_buffer = new MemoryBuffer(this, 1, &result);
+	}
 }
 
 void MemoryProxy::free()
 {
 	if (this->m_buffer) {
+		BufferStore::remove(this);
 		delete this->m_buffer;
 		this->m_buffer = NULL;
 	}
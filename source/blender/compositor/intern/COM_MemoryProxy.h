@@ -51,7 +51,7 @@ private:
 	/**
 	 * @brief datatype of this MemoryProxy
 	 */
-	/* DataType m_datatype; */ /* UNUSED */
+	DataType m_datatype;
 	
 	/**
 	 * @brief channel information of this buffer
@@ -64,7 +64,7 @@ private:
 	MemoryBuffer *m_buffer;
 
 public:
-	MemoryProxy();
+	MemoryProxy(DataType type);
 	
 	/**
 	 * @brief set the ExecutionGroup that can be scheduled to calculate a certain chunk.
@@ -104,6 +104,11 @@ public:
 	 */
 	inline MemoryBuffer *getBuffer() { return this->m_buffer; }
 
+	/**
+	 * @brief get the DataType of this MemoryProxy
+	 */
+	inline DataType getDataType() { return this->m_datatype; }
+
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("COM:MemoryProxy")
 #endif
@@ -22,6 +22,7 @@
 
 #include <typeinfo>
 #include <stdio.h>
+#include <string.h>
 
 #include "COM_defines.h"
 #include "COM_ExecutionSystem.h"
@@ -40,6 +41,8 @@ NodeOperation::NodeOperation()
 	this->m_height = 0;
 	this->m_isResolutionSet = false;
 	this->m_openCL = false;
+	this->m_rowOperation = false;
+	this->m_pixelOperation = false;
 	this->m_btree = NULL;
 }
 
@@ -113,6 +116,33 @@ void NodeOperation::initExecution()
 	/* pass */
 }
 
+void NodeOperation::executeRow(float *output, int x, int y, int length)
+{
+	if (!this->m_pixelOperation) {
+		SocketReader::executeRow(output, x, y, length);
+		return;
+	}
+
+	float inputBuffers[COM_PIXEL_OPERATION_MAX_INPUTS][COM_ROW_LENGTH * COM_NUMBER_OF_CHANNELS];
+	float *inputRows[COM_PIXEL_OPERATION_MAX_INPUTS];
+	const unsigned int totinputs = this->m_inputs.size();
+
+	BLI_assert(totinputs <= COM_PIXEL_OPERATION_MAX_INPUTS);
+
+	for (unsigned int index = 0; index < totinputs; index++) {
+		SocketReader *reader = this->getInputSocketReader(index);
+		inputRows[index] = inputBuffers[index];
+		if (reader) {
+			reader->readRow(inputRows[index], x, y, length);
+		}
+		else {
+			memset(inputRows[index], 0, sizeof(float) * length * COM_NUMBER_OF_CHANNELS);
+		}
+	}
+
+	calculateRow(output, inputRows, length);
+}
+
 void NodeOperation::initMutex()
 {
 	BLI_mutex_init(&this->m_mutex);
@@ -105,6 +105,18 @@ private:
 	 */
 	bool m_openCL;
 
+	/**
+	 * @brief can this operation calculate whole rows of pixels at once.
+	 * @see SocketReader.executeRow
+	 */
+	bool m_rowOperation;
+
+	/**
+	 * @brief is the output pixel only depending on the input pixels at the same position.
+	 * @see NodeOperation.calculateRow
+	 */
+	bool m_pixelOperation;
+
 	/**
 	 * @brief mutex reference for very special node initializations
 	 * @note only use when you really know what you are doing.
@@ -282,6 +294,39 @@ public:
 	 * @see ExecutionGroup.addOperation
 	 */
 	bool isOpenCL() const { return this->m_openCL; }
+
+	/**
+	 * @brief does this NodeOperation implement executeRow
+	 * @note an ExecutionGroup is only executed row by row when all its operations are row operations
+	 * @see ExecutionGroup.initExecution
+	 */
+	bool isRowOperation() const { return this->m_rowOperation; }
+
+	/**
+	 * @brief does this NodeOperation only read its inputs at the pixel it calculates
+	 * pixel operations implement calculateRow and can be fused with other pixel operations.
+	 * @see FusedOperation
+	 */
+	bool isPixelOperation() const { return this->m_pixelOperation; }
+
+	/**
+	 * @brief is this NodeOperation a FusedOperation
+	 */
+	virtual bool isFusedOperation() const { return false; }
+
+	/**
+	 * @brief calculate a row of pixels from the already read rows of all inputs
+	 * @note only called for pixel operations
+	 * @param output is a float array of length * COM_NUMBER_OF_CHANNELS to store the result
+	 * @param inputRows per input socket a row of length * COM_NUMBER_OF_CHANNELS floats
+	 * @param length the number of pixels to calculate, at most COM_ROW_LENGTH
+	 */
+	virtual void calculateRow(float *output, float *const *inputRows, int length) {}
+
+	/**
+	 * @brief pixel operations read the rows of all inputs and call calculateRow
+	 */
+	void executeRow(float *output, int x, int y, int length);
 	
 	virtual bool isViewerOperation() const { return false; }
 	virtual bool isPreviewOperation() const { return false; }
@@ -327,6 +372,21 @@ protected:
 	 */
 	void setOpenCL(bool openCL) { this->m_openCL = openCL; }
 
+	/**
+	 * @brief set if this NodeOperation implements executeRow
+	 */
+	void setRowOperation(bool rowOperation) { this->m_rowOperation = rowOperation; }
+
+	/**
+	 * @brief set if this NodeOperation is a pixel operation, this also makes it a row operation
+	 * @note the operation can have at most COM_PIXEL_OPERATION_MAX_INPUTS inputs
+	 */
+	void setPixelOperation(bool pixelOperation)
+	{
+		this->m_pixelOperation = pixelOperation;
+		this->m_rowOperation = this->m_rowOperation || pixelOperation;
+	}
+
 	/* allow the DebugInfo class to look at internals */
 	friend class DebugInfo;
 
@@ -19,10 +19,16 @@
  *		Lukas Toenne
  */
 
+#include <algorithm>
+#include <string.h>
+#include <typeinfo>
+
 extern "C" {
 #include "BLI_utildefines.h"
 }
 
+#include "BKE_global.h"
+
 #include "COM_NodeConverter.h"
 #include "COM_Converter.h"
 #include "COM_Debug.h"
@@ -31,6 +37,7 @@ extern "C" {
 #include "COM_SocketProxyNode.h"
 
 #include "COM_NodeOperation.h"
+#include "COM_FusedOperation.h"
 #include "COM_PreviewOperation.h"
 #include "COM_SetValueOperation.h"
 #include "COM_SetVectorOperation.h"
@@ -45,6 +52,7 @@ extern "C" {
 NodeOperationBuilder::NodeOperationBuilder(const CompositorContext *context, bNodeTree *b_nodetree) :
     m_context(context),
     m_current_node(NULL),
+    m_current_node_operations(0),
     m_active_viewer(NULL)
 {
 	m_graph.from_bNodeTree(*context, b_nodetree);
@@ -63,6 +71,7 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 		Node *node = (Node *)m_graph.nodes()[index];
 		
 		m_current_node = node;
+		m_current_node_operations = 0;
 		
 		DebugInfo::node_to_operations(node);
 		node->convertToOperations(converter, *m_context);
@@ -112,6 +121,16 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 	/* surround complex ops with read/write buffer */
 	add_complex_operation_buffers();
 	
+	/* calculate chains of pixel operations in a single operation */
+	fuse_pixel_operations();
+	
+	/* buffer operations that are still calculated multiple times per pixel,
+	 * fused operations already calculate their shared members once */
+	add_overlap_buffers();
+	
+	/* identify buffers that can be reused from previous executions */
+	determine_result_cache_keys();
+	
 	/* links not available from here on */
 	/* XXX make m_links a local variable to avoid confusion! */
 	m_links.clear();
@@ -131,6 +150,9 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 void NodeOperationBuilder::addOperation(NodeOperation *operation)
 {
 	m_operations.push_back(operation);
+	
+	if (m_current_node)
+		m_operation_origins[operation] = OperationOrigin(m_current_node->getbNode(), m_current_node_operations++);
 }
 
 void NodeOperationBuilder::mapInputSocket(NodeInput *node_socket, NodeOperationInput *operation_socket)
@@ -476,7 +498,7 @@ void NodeOperationBuilder::add_input_buffers(NodeOperation *operation, NodeOpera
 	/* check of other end already has write operation, otherwise add a new one */
 	WriteBufferOperation *writeoperation = find_attached_write_buffer_operation(output);
 	if (!writeoperation) {
-		writeoperation = new WriteBufferOperation();
+		writeoperation = new WriteBufferOperation(output->getDataType());
 		writeoperation->setbNodeTree(m_context->getbNodeTree());
 		addOperation(writeoperation);
 		
@@ -486,7 +508,7 @@ void NodeOperationBuilder::add_input_buffers(NodeOperation *operation, NodeOpera
 	}
 	
 	/* add readbuffer op for the input */
-	ReadBufferOperation *readoperation = new ReadBufferOperation();
+	ReadBufferOperation *readoperation = new ReadBufferOperation(output->getDataType());
 	readoperation->setMemoryProxy(writeoperation->getMemoryProxy());
 	this->addOperation(readoperation);
 	
@@ -519,7 +541,7 @@ void NodeOperationBuilder::add_output_buffers(NodeOperation *operation, NodeOper
 	
 	/* if no write buffer operation exists yet, create a new one */
 	if (!writeOperation) {
-		writeOperation = new WriteBufferOperation();
+		writeOperation = new WriteBufferOperation(output->getDataType());
 		writeOperation->setbNodeTree(m_context->getbNodeTree());
 		addOperation(writeOperation);
 		
@@ -534,7 +556,7 @@ void NodeOperationBuilder::add_output_buffers(NodeOperation *operation, NodeOper
 		if (&target->getOperation() == writeOperation)
 			continue; /* skip existing write op links */
 		
-		ReadBufferOperation *readoperation = new ReadBufferOperation();
+		ReadBufferOperation *readoperation = new ReadBufferOperation(output->getDataType());
 		readoperation->setMemoryProxy(writeOperation->getMemoryProxy());
 		addOperation(readoperation);
 		
@@ -642,6 +664,322 @@ void NodeOperationBuilder::sort_operations()
 	m_operations = sorted;
 }
 
+/* operations that calculate their result for every read and are not buffered yet */
+static bool is_overlap_buffer_candidate(NodeOperation *op)
+{
+	return !(op->isReadBufferOperation() || op->isWriteBufferOperation() || op->isSetOperation() ||
+	         op->isComplex() || op->getNumberOfOutputSockets() == 0);
+}
+
+/* number of operations that are evaluated to calculate a pixel of op */
+static float operation_cost(NodeOperation *op, NodeOperationBuilder::OperationFactorMap &costs)
+{
+	if (!is_overlap_buffer_candidate(op))
+		return 0.0f;
+	
+	NodeOperationBuilder::OperationFactorMap::const_iterator found = costs.find(op);
+	if (found != costs.end())
+		return found->second;
+	
+	float cost = op->isFusedOperation() ? (float)((FusedOperation *)op)->getFusedOperations().size() : 1.0f;
+	for (int i = 0; i < op->getNumberOfInputSockets(); ++i) {
+		NodeOperationInput *input = op->getInputSocket(i);
+		if (input->isConnected())
+			cost += operation_cost(&input->getLink()->getOperation(), costs);
+	}
+	costs[op] = cost;
+	return cost;
+}
+
+float NodeOperationBuilder::operation_evaluations(NodeOperation *operation, const OperationFactorMap &evaluations) const
+{
+	/* every pixel of a buffer or output is calculated once */
+	if (operation->isWriteBufferOperation() || operation->isOutputOperation(m_context->isRendering()))
+		return 1.0f;
+	
+	const float area = (float)operation->getWidth() * operation->getHeight();
+	float result = 0.0f;
+	for (Links::const_iterator it = m_links.begin(); it != m_links.end(); ++it) {
+		const Link &link = *it;
+		if (&link.from()->getOperation() != operation)
+			continue;
+		
+		NodeOperation *target = &link.to()->getOperation();
+		OperationFactorMap::const_iterator target_evaluations = evaluations.find(target);
+		if (target_evaluations == evaluations.end())
+			continue; /* not executed */
+		
+		/* a pixel of the target reads a pixel of the operation, scaled by their sizes */
+		const float target_area = (float)target->getWidth() * target->getHeight();
+		result += target_evaluations->second * ((area > 0.0f) ? target_area / area : 1.0f);
+	}
+	return result;
+}
+
+void NodeOperationBuilder::add_overlap_buffers()
+{
+	/* operations ordered from inputs to outputs */
+	Operations sorted;
+	Tags visited;
+	for (Operations::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it) {
+		NodeOperation *op = *it;
+		if (op->isOutputOperation(m_context->isRendering()))
+			sort_operations_recursive(sorted, visited, op);
+	}
+	
+	/* visit every operation after the operations reading it, so its targets are final */
+	OperationFactorMap evaluations;
+	OperationFactorMap costs;
+	for (Operations::reverse_iterator it = sorted.rbegin(); it != sorted.rend(); ++it) {
+		NodeOperation *op = *it;
+		float op_evaluations = operation_evaluations(op, evaluations);
+		
+		if (is_overlap_buffer_candidate(op) && op_evaluations >= COM_OVERLAP_BUFFER_MIN_EVALUATIONS) {
+			/* a buffer costs memory, only add it when it saves enough calculations */
+			const float saved = (op_evaluations - 1.0f) * operation_cost(op, costs);
+			if (saved >= COM_OVERLAP_BUFFER_MIN_SAVED) {
+				if (G.debug & G_DEBUG) {
+					OperationOriginMap::const_iterator origin = m_operation_origins.find(op);
+					printf("Compositor: buffering %s (%s), evaluated %.1f times per pixel, saves %.1f operations per pixel\n",
+					       (origin != m_operation_origins.end() && origin->second.first) ? origin->second.first->name : "",
+					       typeid(*op).name(), op_evaluations, saved);
+				}
+				
+				for (int i = 0; i < op->getNumberOfOutputSockets(); ++i)
+					add_output_buffers(op, op->getOutputSocket(i));
+				op_evaluations = 1.0f;
+			}
+		}
+		
+		evaluations[op] = op_evaluations;
+	}
+}
+
+/* number of rows a FusedOperation of these operations needs, see COM_FUSED_MAX_ROWS */
+static int fused_operation_num_rows(const NodeOperationBuilder::Operations &members)
+{
+	std::set<NodeOperationOutput *> inputs;
+	for (NodeOperationBuilder::Operations::const_iterator it = members.begin(); it != members.end(); ++it) {
+		NodeOperation *op = *it;
+		for (int i = 0; i < op->getNumberOfInputSockets(); ++i) {
+			NodeOperationOutput *from = op->getInputSocket(i)->getLink();
+			if (std::find(members.begin(), members.end(), &from->getOperation()) == members.end())
+				inputs.insert(from);
+		}
+	}
+	return inputs.size() + members.size() - 1;
+}
+
+static bool is_fusable_pixel_operation(NodeOperation *op)
+{
+	if (!op->isPixelOperation() || op->getNumberOfOutputSockets() != 1)
+		return false;
+	
+	for (int i = 0; i < op->getNumberOfInputSockets(); ++i) {
+		if (!op->getInputSocket(i)->isConnected())
+			return false;
+	}
+	return true;
+}
+
+void NodeOperationBuilder::determine_result_cache_keys()
+{
+	if (!m_context->isResultCacheEnabled())
+		return;
+	
+	ResultCacheKeyMap keys;
+	NodeResultCacheKeyMap node_keys;
+	for (Operations::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it) {
+		NodeOperation *op = *it;
+		if (op->isWriteBufferOperation()) {
+			WriteBufferOperation *write_op = (WriteBufferOperation *)op;
+			write_op->setResultCacheKey(operation_result_cache_key(write_op, keys, node_keys));
+		}
+	}
+}
+
+ResultCacheKey NodeOperationBuilder::operation_result_cache_key(NodeOperation *operation, ResultCacheKeyMap &keys,
+                                                                NodeResultCacheKeyMap &node_keys) const
+{
+	ResultCacheKeyMap::const_iterator found = keys.find(operation);
+	if (found != keys.end())
+		return found->second;
+	
+	/* the operation type and its size */
+	const char *type_name = typeid(*operation).name();
+	ResultCacheKey key = ResultCache::hash(type_name, strlen(type_name));
+	unsigned int resolution[2] = {operation->getWidth(), operation->getHeight()};
+	key = ResultCache::hash(key, resolution, sizeof(resolution));
+	
+	/* settings of the node that created it */
+	OperationOriginMap::const_iterator origin = m_operation_origins.find(operation);
+	if (origin != m_operation_origins.end() && origin->second.first) {
+		const bNode *b_node = origin->second.first;
+		NodeResultCacheKeyMap::const_iterator node_key = node_keys.find(b_node);
+		if (node_key == node_keys.end()) {
+			/* only once per node, the key of tagged nodes changes every time */
+			node_key = node_keys.insert(NodeResultCacheKeyMap::value_type(
+			                                b_node, ResultCache::getNodeKey(b_node, *m_context))).first;
+		}
+		if (node_key->second == COM_RESULT_CACHE_NO_KEY) {
+			keys[operation] = COM_RESULT_CACHE_NO_KEY;
+			return COM_RESULT_CACHE_NO_KEY;
+		}
+		key = ResultCache::hash(key, &node_key->second, sizeof(ResultCacheKey));
+		key = ResultCache::hash(key, &origin->second.second, sizeof(int));
+	}
+	
+	/* constants for unconnected inputs are not created by a node */
+	if (operation->isSetOperation()) {
+		float value[4];
+		operation->readSampled(value, 0.0f, 0.0f, COM_PS_NEAREST);
+		key = ResultCache::hash(key, value, sizeof(value));
+	}
+	
+	/* everything upstream */
+	for (unsigned int index = 0; index < operation->getNumberOfInputSockets(); index++) {
+		NodeOperationOutput *from = operation->getInputSocket(index)->getLink();
+		ResultCacheKey input_key = COM_RESULT_CACHE_NO_KEY;
+		if (from) {
+			NodeOperation *from_op = &from->getOperation();
+			input_key = operation_result_cache_key(from_op, keys, node_keys);
+			if (input_key == COM_RESULT_CACHE_NO_KEY) {
+				keys[operation] = COM_RESULT_CACHE_NO_KEY;
+				return COM_RESULT_CACHE_NO_KEY;
+			}
+			for (unsigned int output = 0; output < from_op->getNumberOfOutputSockets(); output++) {
+				if (from_op->getOutputSocket(output) == from)
+					key = ResultCache::hash(key, &output, sizeof(output));
+			}
+		}
+		key = ResultCache::hash(key, &input_key, sizeof(input_key));
+	}
+	if (operation->isReadBufferOperation()) {
+		WriteBufferOperation *write_op = ((ReadBufferOperation *)operation)->getMemoryProxy()->getWriteBufferOperation();
+		ResultCacheKey input_key = operation_result_cache_key(write_op, keys, node_keys);
+		if (input_key == COM_RESULT_CACHE_NO_KEY) {
+			keys[operation] = COM_RESULT_CACHE_NO_KEY;
+			return COM_RESULT_CACHE_NO_KEY;
+		}
+		key = ResultCache::hash(key, &input_key, sizeof(input_key));
+	}
+	if (operation->isFusedOperation()) {
+		/* settings of the fused operations, they still link to their inputs */
+		NodeOperation *output_op = ((FusedOperation *)operation)->getFusedOperations().back();
+		ResultCacheKey input_key = operation_result_cache_key(output_op, keys, node_keys);
+		if (input_key == COM_RESULT_CACHE_NO_KEY) {
+			keys[operation] = COM_RESULT_CACHE_NO_KEY;
+			return COM_RESULT_CACHE_NO_KEY;
+		}
+		key = ResultCache::hash(key, &input_key, sizeof(input_key));
+	}
+	
+	keys[operation] = key;
+	return key;
+}
+
+void NodeOperationBuilder::fuse_pixel_operations()
+{
+	/* visit operations from the outputs to the inputs,
+	 * so every fused set grows as far upstream as possible */
+	Operations sorted;
+	Tags visited;
+	for (Operations::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it)
+		sort_operations_recursive(sorted, visited, *it);
+	
+	Tags fused;
+	Operations fused_ops;
+	for (Operations::const_reverse_iterator it = sorted.rbegin(); it != sorted.rend(); ++it) {
+		NodeOperation *root = *it;
+		if (fused.find(root) != fused.end() || !is_fusable_pixel_operation(root))
+			continue;
+		
+		/* add input operations whose output is only used inside the set, until nothing changes */
+		Operations members;
+		members.push_back(root);
+		bool changed = true;
+		while (changed) {
+			changed = false;
+			for (int index = 0; index < members.size(); ++index) {
+				NodeOperation *op = members[index];
+				for (int i = 0; i < op->getNumberOfInputSockets(); ++i) {
+					NodeOperationOutput *from = op->getInputSocket(i)->getLink();
+					NodeOperation *input_op = &from->getOperation();
+					
+					if (fused.find(input_op) != fused.end() ||
+					    std::find(members.begin(), members.end(), input_op) != members.end() ||
+					    !is_fusable_pixel_operation(input_op))
+					{
+						continue;
+					}
+					
+					bool used_outside = false;
+					OpInputs targets = cache_output_links(from);
+					for (OpInputs::const_iterator target = targets.begin(); target != targets.end(); ++target) {
+						if (std::find(members.begin(), members.end(), &(*target)->getOperation()) == members.end()) {
+							used_outside = true;
+							break;
+						}
+					}
+					if (used_outside)
+						continue;
+					
+					members.push_back(input_op);
+					if (fused_operation_num_rows(members) > COM_FUSED_MAX_ROWS) {
+						members.pop_back();
+						continue;
+					}
+					changed = true;
+				}
+			}
+		}
+		
+		if (members.size() < 2)
+			continue;
+		
+		/* execution order of the fused operations is the topological order */
+		Operations ordered;
+		for (Operations::const_iterator op_it = sorted.begin(); op_it != sorted.end(); ++op_it) {
+			if (std::find(members.begin(), members.end(), *op_it) != members.end()) {
+				ordered.push_back(*op_it);
+				fused.insert(*op_it);
+			}
+		}
+		
+		FusedOperation *fused_op = new FusedOperation(ordered);
+		for (int i = 0; i < fused_op->getNumberOfInputSockets(); ++i)
+			addLink(fused_op->getInputLink(i), fused_op->getInputSocket(i));
+		
+		/* redirect the users of the set output to the fused operation */
+		OpInputs targets = cache_output_links(root->getOutputSocket());
+		for (OpInputs::const_iterator target = targets.begin(); target != targets.end(); ++target) {
+			removeInputLink(*target);
+			addLink(fused_op->getOutputSocket(), *target);
+		}
+		
+		fused_ops.push_back(fused_op);
+		DebugInfo::operation_fused(fused_op);
+	}
+	
+	/* fused operations are owned by their FusedOperation */
+	Operations remaining_ops;
+	for (Operations::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it) {
+		if (fused.find(*it) == fused.end())
+			remaining_ops.push_back(*it);
+	}
+	remaining_ops.insert(remaining_ops.end(), fused_ops.begin(), fused_ops.end());
+	m_operations = remaining_ops;
+	
+	/* the sockets of fused operations keep their links, they are still needed for initExecution.
+	 * they are no longer part of the graph, later passes only see the links of the FusedOperation */
+	Links remaining_links;
+	for (Links::const_iterator it = m_links.begin(); it != m_links.end(); ++it) {
+		if (fused.find(&it->to()->getOperation()) == fused.end())
+			remaining_links.push_back(*it);
+	}
+	m_links = remaining_links;
+}
+
 static void add_group_operations_recursive(Tags &visited, NodeOperation *op, ExecutionGroup *group)
 {
 	if (visited.find(op) != visited.end())
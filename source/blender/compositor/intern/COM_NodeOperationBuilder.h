@@ -27,6 +27,7 @@
 #include <vector>
 
 #include "COM_NodeGraph.h"
+#include "COM_ResultCache.h"
 
 using std::vector;
 
@@ -46,6 +47,8 @@ class PreviewOperation;
 class WriteBufferOperation;
 class ViewerOperation;
 
+struct bNode;
+
 class NodeOperationBuilder {
 public:
 	class Link {
@@ -73,6 +76,14 @@ public:
 	typedef std::vector<NodeOperationInput *> OpInputs;
 	typedef std::map<NodeInput *, OpInputs> OpInputInverseMap;
 	
+	/** Editor node an operation is created for and the index among the operations of that node */
+	typedef std::pair<const bNode *, int> OperationOrigin;
+	typedef std::map<NodeOperation *, OperationOrigin> OperationOriginMap;
+	
+	typedef std::map<NodeOperation *, ResultCacheKey> ResultCacheKeyMap;
+	typedef std::map<const bNode *, ResultCacheKey> NodeResultCacheKeyMap;
+	typedef std::map<NodeOperation *, float> OperationFactorMap;
+	
 private:
 	const CompositorContext *m_context;
 	NodeGraph m_graph;
@@ -87,6 +98,11 @@ private:
 	OutputSocketMap m_output_map;
 	
 	Node *m_current_node;
+	/** Number of operations added for the current node */
+	int m_current_node_operations;
+	
+	/** Maps operations to the editor nodes they are created for */
+	OperationOriginMap m_operation_origins;
 	
 	/** Operation that will be writing to the viewer image
 	 *  Only one operation can occupy this place at a time,
@@ -99,6 +115,8 @@ public:
 	~NodeOperationBuilder();
 
 	const CompositorContext &context() const { return *m_context; }
+	/** Operations created so far, or the result of the passes before they are moved to the system */
+	const Operations &operations() const { return m_operations; }
 
 	void convertToOperations(ExecutionSystem *system);
 
@@ -149,6 +167,18 @@ protected:
 	void add_input_buffers(NodeOperation *operation, NodeOperationInput *input);
 	void add_output_buffers(NodeOperation *operation, NodeOperationOutput *output);
 	
+	/** Add buffers after operations that are evaluated multiple times per pixel in their execution group */
+	void add_overlap_buffers();
+	float operation_evaluations(NodeOperation *operation, const OperationFactorMap &evaluations) const;
+	
+	/** Calculate the ResultCache keys of the buffers written by write buffer operations */
+	void determine_result_cache_keys();
+	ResultCacheKey operation_result_cache_key(NodeOperation *operation, ResultCacheKeyMap &keys,
+	                                          NodeResultCacheKeyMap &node_keys) const;
+	
+	/** Replace connected pixel operations by a single FusedOperation */
+	void fuse_pixel_operations();
+	
 	/** Remove unreachable operations */
 	void prune_operations();
 	
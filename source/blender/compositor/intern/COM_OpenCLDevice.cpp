@@ -55,6 +55,7 @@ void OpenCLDevice::execute(WorkPackage *work)
 	rcti rect;
 
 	executionGroup->determineChunkRect(&rect, chunkNumber);
+	executionGroup->acquireBuffers();
 	MemoryBuffer **inputBuffers = executionGroup->getInputBuffersOpenCL(chunkNumber);
 	MemoryBuffer *outputBuffer = executionGroup->allocateOutputBuffer(chunkNumber, &rect);
 
@@ -62,9 +63,30 @@ void OpenCLDevice::execute(WorkPackage *work)
 	                                                              chunkNumber, inputBuffers, outputBuffer);
 
 	delete outputBuffer;
+	executionGroup->releaseBuffers();
 	
 	executionGroup->finalizeChunkExecution(chunkNumber, inputBuffers);
 }
+const cl_image_format *OpenCLDevice::determineImageFormat(MemoryBuffer *memoryBuffer)
+{
+	static const cl_image_format IMAGE_FORMAT_COLOR = {
+		CL_RGBA,
+		CL_FLOAT
+	};
+	static const cl_image_format IMAGE_FORMAT_VALUE = {
+		CL_R,
+		CL_FLOAT
+	};
+
+	/* vector buffers have no matching image format, none of the OpenCL operations use them */
+	BLI_assert(memoryBuffer->getNumberOfChannels() != COM_NUM_CHANNELS_VECTOR);
+
+	if (memoryBuffer->getNumberOfChannels() == COM_NUM_CHANNELS_VALUE) {
+		return &IMAGE_FORMAT_VALUE;
+	}
+	return &IMAGE_FORMAT_COLOR;
+}
+
 cl_mem OpenCLDevice::COM_clAttachMemoryBufferToKernelParameter(cl_kernel kernel, int parameterIndex, int offsetIndex,
                                                                list<cl_mem> *cleanup, MemoryBuffer **inputMemoryBuffers,
                                                                SocketReader *reader)
@@ -80,12 +102,9 @@ cl_mem OpenCLDevice::COM_clAttachMemoryBufferToKernelParameter(cl_kernel kernel,
 	
 	MemoryBuffer *result = reader->getInputMemoryBuffer(inputMemoryBuffers);
 
-	const cl_image_format imageFormat = {
-		CL_RGBA,
-		CL_FLOAT
-	};
+	const cl_image_format *imageFormat = determineImageFormat(result);
 
-	cl_mem clBuffer = clCreateImage2D(this->m_context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, &imageFormat, result->getWidth(),
+	cl_mem clBuffer = clCreateImage2D(this->m_context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, imageFormat, result->getWidth(),
 	                                  result->getHeight(), 0, result->getBuffer(), &error);
 
 	if (error != CL_SUCCESS) { printf("CLERROR[%d]: %s\n", error, clewErrorString(error));  }
@@ -0,0 +1,200 @@
+/*
+ * Copyright 2015, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "COM_Profiler.h"
+
+#ifdef COM_PROFILE
+
+#include <algorithm>
+#include <map>
+#include <stdio.h>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+extern "C" {
+#include "BLI_threads.h"
+#include "PIL_time.h"
+}
+
+#include "atomic_ops.h"
+
+#include "COM_Debug.h"
+#include "COM_ExecutionSystem.h"
+#include "COM_FusedOperation.h"
+#include "COM_WriteBufferOperation.h"
+
+typedef struct OperationProfile {
+	const NodeOperation *operation;
+	/* time spent in the operation itself, in nanoseconds */
+	uint64_t time;
+	uint64_t pixels;
+} OperationProfile;
+
+typedef std::map<const SocketReader *, OperationProfile> OperationProfiles;
+
+/* only filled in execute_started, lookups during execution don't need a lock */
+static OperationProfiles s_profiles;
+/* innermost active ProfileScope of the thread */
+static pthread_key_t s_scope_key;
+static bool s_scope_key_created = false;
+static double s_start_time;
+
+ProfileScope::ProfileScope(const SocketReader *reader, unsigned int pixels)
+{
+	OperationProfiles::iterator it = s_profiles.find(reader);
+	this->m_profile = (it != s_profiles.end()) ? &it->second : NULL;
+	this->m_parent = (ProfileScope *)pthread_getspecific(s_scope_key);
+	this->m_childTime = 0.0;
+	if (this->m_profile) {
+		atomic_add_uint64(&this->m_profile->pixels, pixels);
+	}
+	pthread_setspecific(s_scope_key, this);
+	this->m_start = PIL_check_seconds_timer();
+}
+
+ProfileScope::~ProfileScope()
+{
+	const double time = PIL_check_seconds_timer() - this->m_start;
+	if (this->m_profile) {
+		const double own_time = std::max(time - this->m_childTime, 0.0);
+		atomic_add_uint64(&this->m_profile->time, (uint64_t)(own_time * 1e9));
+	}
+	if (this->m_parent) {
+		this->m_parent->m_childTime += time;
+	}
+	pthread_setspecific(s_scope_key, this->m_parent);
+}
+
+static void add_profile(const NodeOperation *operation)
+{
+	OperationProfile &profile = s_profiles[operation];
+	profile.operation = operation;
+	profile.time = 0;
+	profile.pixels = 0;
+
+	if (operation->isFusedOperation()) {
+		const FusedOperation::Operations &operations = ((const FusedOperation *)operation)->getFusedOperations();
+		for (FusedOperation::Operations::const_iterator it = operations.begin(); it != operations.end(); ++it) {
+			add_profile(*it);
+		}
+	}
+}
+
+static size_t operation_buffer_size(const NodeOperation *operation)
+{
+	if (!operation->isWriteBufferOperation()) {
+		return 0;
+	}
+	MemoryProxy *proxy = ((WriteBufferOperation *)operation)->getMemoryProxy();
+	return (size_t)operation->getWidth() * operation->getHeight() *
+	       COM_data_type_num_channels(proxy->getDataType()) * sizeof(float);
+}
+
+/* number of times a pixel of the operation is evaluated on average */
+static float operation_evaluations(const OperationProfile &profile)
+{
+	const uint64_t area = (uint64_t)profile.operation->getWidth() * profile.operation->getHeight();
+	return area ? (float)profile.pixels / area : 0.0f;
+}
+
+static std::string operation_label(const NodeOperation *operation)
+{
+	std::string name = DebugInfo::operation_name(operation);
+	if (!name.empty()) {
+		name += " ";
+	}
+	return name + "(" + typeid(*operation).name() + ")";
+}
+
+static bool profile_time_greater(const OperationProfile *a, const OperationProfile *b)
+{
+	return a->time > b->time;
+}
+
+void Profiler::execute_started(const ExecutionSystem *system)
+{
+	if (!s_scope_key_created) {
+		pthread_key_create(&s_scope_key, NULL);
+		s_scope_key_created = true;
+	}
+
+	s_profiles.clear();
+	for (ExecutionSystem::Operations::const_iterator it = system->m_operations.begin(); it != system->m_operations.end(); ++it) {
+		add_profile(*it);
+	}
+	s_start_time = PIL_check_seconds_timer();
+}
+
+void Profiler::execute_finished(const ExecutionSystem * /*system*/)
+{
+	const double wall_time = PIL_check_seconds_timer() - s_start_time;
+	std::vector<const OperationProfile *> profiles;
+	uint64_t total_time = 0;
+	size_t total_buffers = 0;
+
+	for (OperationProfiles::const_iterator it = s_profiles.begin(); it != s_profiles.end(); ++it) {
+		profiles.push_back(&it->second);
+		total_time += it->second.time;
+		total_buffers += operation_buffer_size(it->second.operation);
+	}
+	std::sort(profiles.begin(), profiles.end(), profile_time_greater);
+
+	printf("Compositor profile: %.3f s, %.3f s in operations, %.2fM buffers\n",
+	       wall_time, total_time * 1e-9, total_buffers / (1024.0 * 1024.0));
+	printf("%12s %7s %14s %9s %10s  %s\n", "time", "%", "pixels", "evals/px", "buffer", "operation");
+	for (std::vector<const OperationProfile *>::const_iterator it = profiles.begin(); it != profiles.end(); ++it) {
+		const OperationProfile *profile = *it;
+		if (profile->time == 0 && profile->pixels == 0) {
+			continue;
+		}
+		printf("%10.2fms %6.2f%% %14llu %9.2f %9.2fM  %s\n",
+		       profile->time * 1e-6,
+		       total_time ? 100.0 * profile->time / total_time : 0.0,
+		       (unsigned long long)profile->pixels,
+		       operation_evaluations(*profile),
+		       operation_buffer_size(profile->operation) / (1024.0 * 1024.0),
+		       operation_label(profile->operation).c_str());
+	}
+	fflush(stdout);
+}
+
+int Profiler::graphviz_operation(const NodeOperation *operation, char *str, int maxlen)
+{
+	OperationProfiles::const_iterator it = s_profiles.find(operation);
+	if (it == s_profiles.end()) {
+		return 0;
+	}
+	const OperationProfile &profile = it->second;
+	int len = 0;
+	len += snprintf(str + len, maxlen > len ? maxlen - len : 0, "\\n%.2f ms, %llu pixels, %.2f evals/px",
+	                profile.time * 1e-6, (unsigned long long)profile.pixels, operation_evaluations(profile));
+	const size_t buffer_size = operation_buffer_size(operation);
+	if (buffer_size) {
+		len += snprintf(str + len, maxlen > len ? maxlen - len : 0, "\\nbuffer %.2fM", buffer_size / (1024.0 * 1024.0));
+	}
+	return len;
+}
+
+#else
+
+void Profiler::execute_started(const ExecutionSystem * /*system*/) {}
+void Profiler::execute_finished(const ExecutionSystem * /*system*/) {}
+int Profiler::graphviz_operation(const NodeOperation * /*operation*/, char * /*str*/, int /*maxlen*/) { return 0; }
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2015, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_Profiler_h
+#define _COM_Profiler_h
+
+#include "COM_defines.h"
+
+class SocketReader;
+class NodeOperation;
+class ExecutionSystem;
+
+#ifdef COM_PROFILE
+
+/**
+ * @brief measures a call of an operation, see COM_PROFILE_SCOPE
+ *
+ * Scopes of the operations that are read while the scope is active are subtracted,
+ * so the time of an operation only includes its own calculations.
+ */
+class ProfileScope {
+private:
+	struct OperationProfile *m_profile;
+	ProfileScope *m_parent;
+	double m_start;
+	double m_childTime;
+
+public:
+	ProfileScope(const SocketReader *reader, unsigned int pixels);
+	~ProfileScope();
+};
+
+/**
+ * @brief add the time until the end of the current block to reader, pixels is the number of evaluated pixels
+ */
+#  define COM_PROFILE_SCOPE(reader, pixels) ProfileScope profile_scope_(reader, pixels)
+
+#else
+
+#  define COM_PROFILE_SCOPE(reader, pixels) (void)0
+
+#endif
+
+/**
+ * @brief collects per operation execution time, evaluated pixels and buffer memory
+ *
+ * Enabled by COM_PROFILE in COM_defines.h. After every execution a report sorted by time is
+ * printed, with COM_DEBUG the statistics are added to the graphviz output as well.
+ * @see DebugInfo
+ */
+class Profiler {
+public:
+	static void execute_started(const ExecutionSystem *system);
+	static void execute_finished(const ExecutionSystem *system);
+
+	/**
+	 * @brief write the statistics of an operation as graphviz record label lines
+	 */
+	static int graphviz_operation(const NodeOperation *operation, char *str, int maxlen);
+};
+
+#endif
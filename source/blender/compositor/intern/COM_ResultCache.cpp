@@ -0,0 +1,253 @@
+/*
+ * Copyright 2015, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <map>
+#include <string.h>
+
+#include "COM_ResultCache.h"
+#include "COM_CompositorContext.h"
+#include "COM_MemoryBuffer.h"
+
+extern "C" {
+#  include "BLI_utildefines.h"
+#  include "DNA_camera_types.h"
+#  include "DNA_color_types.h"
+#  include "DNA_ID.h"
+#  include "DNA_node_types.h"
+#  include "DNA_object_types.h"
+#  include "DNA_scene_types.h"
+#  include "BKE_camera.h"
+#  include "BKE_node.h"
+#  include "MEM_guardedalloc.h"
+}
+
+typedef struct ResultCacheEntry {
+	MemoryBuffer *buffer;
+	size_t size;
+	unsigned int lastUsed;
+} ResultCacheEntry;
+
+typedef std::map<ResultCacheKey, ResultCacheEntry> ResultCacheEntries;
+
+static ResultCacheEntries s_entries;
+static size_t s_memoryUsed = 0;
+static size_t s_memoryLimit = 0;
+static unsigned int s_usageCounter = 0;
+
+static size_t buffer_size(MemoryBuffer *buffer)
+{
+	return (size_t)buffer->getWidth() * buffer->getHeight() * buffer->getNumberOfChannels() * sizeof(float);
+}
+
+static void free_entry(ResultCacheEntries::iterator entry)
+{
+	s_memoryUsed -= entry->second.size;
+	delete entry->second.buffer;
+	s_entries.erase(entry);
+}
+
+static void free_least_recently_used(size_t limit)
+{
+	while (s_memoryUsed > limit && !s_entries.empty()) {
+		ResultCacheEntries::iterator oldest = s_entries.begin();
+		for (ResultCacheEntries::iterator it = s_entries.begin(); it != s_entries.end(); ++it) {
+			if (it->second.lastUsed < oldest->second.lastUsed) {
+				oldest = it;
+			}
+		}
+		free_entry(oldest);
+	}
+}
+
+static ResultCacheKey hash_curve_mapping(ResultCacheKey key, const CurveMapping *cumap)
+{
+	/* the curve points are stored outside the struct, the tables are derived from them */
+	CurveMapping copy = *cumap;
+	for (int a = 0; a < CM_TOT; a++) {
+		copy.cm[a].curve = NULL;
+		copy.cm[a].table = NULL;
+		copy.cm[a].premultable = NULL;
+	}
+	key = ResultCache::hash(key, &copy, sizeof(copy));
+
+	for (int a = 0; a < CM_TOT; a++) {
+		const CurveMap *cuma = &cumap->cm[a];
+		if (cuma->curve) {
+			key = ResultCache::hash(key, cuma->curve, sizeof(CurveMapPoint) * cuma->totpoint);
+		}
+	}
+	return key;
+}
+
+static ResultCacheKey hash_defocus_camera(ResultCacheKey key, const bNode *node, const CompositorContext &context)
+{
+	/* see DefocusNode, the radius is derived from the lens and dof distance of the scene camera */
+	Scene *scene = node->id ? (Scene *)node->id : context.getScene();
+	Object *camob = scene ? scene->camera : NULL;
+
+	key = ResultCache::hash(key, &camob, sizeof(camob));
+	if (camob && camob->type == OB_CAMERA) {
+		const Camera *camera = (const Camera *)camob->data;
+		const float dof_distance = BKE_camera_object_dof_distance(camob);
+
+		key = ResultCache::hash(key, &camera->lens, sizeof(camera->lens));
+		key = ResultCache::hash(key, &camera->sensor_x, sizeof(camera->sensor_x));
+		key = ResultCache::hash(key, &camera->sensor_y, sizeof(camera->sensor_y));
+		key = ResultCache::hash(key, &camera->sensor_fit, sizeof(camera->sensor_fit));
+		key = ResultCache::hash(key, &dof_distance, sizeof(dof_distance));
+	}
+	return key;
+}
+
+ResultCacheKey ResultCache::hash(const void *data, size_t size)
+{
+	return hash(14695981039346656037ULL, data, size);
+}
+
+ResultCacheKey ResultCache::hash(ResultCacheKey key, const void *data, size_t size)
+{
+	/* FNV-1a */
+	const unsigned char *bytes = (const unsigned char *)data;
+	for (size_t i = 0; i < size; i++) {
+		key ^= bytes[i];
+		key *= 1099511628211ULL;
+	}
+	return key;
+}
+
+ResultCacheKey ResultCache::getNodeKey(const bNode *node, const CompositorContext &context)
+{
+	const RenderData *rd = context.getRenderData();
+	const CompositorQuality quality = context.getQuality();
+	const bool fast_calculation = context.isFastCalculation();
+	ResultCacheKey key = hash(&node->type, sizeof(node->type));
+	bool use_frame = (node->type == CMP_NODE_TIME);
+	bNodeSocket *sock;
+
+	key = hash(key, &quality, sizeof(quality));
+	key = hash(key, &fast_calculation, sizeof(fast_calculation));
+	key = hash(key, &rd->xsch, sizeof(rd->xsch));
+	key = hash(key, &rd->ysch, sizeof(rd->ysch));
+	key = hash(key, &rd->size, sizeof(rd->size));
+
+	key = hash(key, &node->custom1, sizeof(node->custom1));
+	key = hash(key, &node->custom2, sizeof(node->custom2));
+	key = hash(key, &node->custom3, sizeof(node->custom3));
+	key = hash(key, &node->custom4, sizeof(node->custom4));
+
+	if (node->id) {
+		/* images and render results tag their nodes when they change (need_exec),
+		 * other data like movie clips and masks is edited without updating the node */
+		if (!ELEM(GS(node->id->name), ID_IM, ID_SCE)) {
+			return COM_RESULT_CACHE_NO_KEY;
+		}
+		key = hash(key, &node->id, sizeof(node->id));
+		key = hash(key, node->id->name, sizeof(node->id->name));
+		use_frame = true;
+
+		/* counted on the main thread when the tree is localized */
+		key = hash(key, &node->exec_generation, sizeof(node->exec_generation));
+	}
+
+	if (node->type == CMP_NODE_DEFOCUS) {
+		key = hash_defocus_camera(key, node, context);
+	}
+
+	if (use_frame) {
+		int framenumber = context.getFramenumber();
+		key = hash(key, &framenumber, sizeof(framenumber));
+	}
+
+	if (node->storage) {
+		if (ELEM(node->type, CMP_NODE_CURVE_VEC, CMP_NODE_CURVE_RGB, CMP_NODE_TIME, CMP_NODE_HUECORRECT)) {
+			key = hash_curve_mapping(key, (const CurveMapping *)node->storage);
+		}
+		else {
+			key = hash(key, node->storage, MEM_allocN_len(node->storage));
+		}
+	}
+
+	for (sock = (bNodeSocket *)node->inputs.first; sock; sock = sock->next) {
+		if (sock->default_value) {
+			key = hash(key, sock->default_value, MEM_allocN_len(sock->default_value));
+		}
+	}
+	/* value and color input nodes store their value in the output socket */
+	for (sock = (bNodeSocket *)node->outputs.first; sock; sock = sock->next) {
+		if (sock->default_value) {
+			key = hash(key, sock->default_value, MEM_allocN_len(sock->default_value));
+		}
+	}
+
+	return (key == COM_RESULT_CACHE_NO_KEY) ? 1 : key;
+}
+
+void ResultCache::setMemoryLimit(size_t limit)
+{
+	s_memoryLimit = limit;
+	free_least_recently_used(limit);
+}
+
+bool ResultCache::restore(ResultCacheKey key, MemoryBuffer *buffer)
+{
+	ResultCacheEntries::iterator entry = s_entries.find(key);
+	if (entry == s_entries.end()) {
+		return false;
+	}
+
+	MemoryBuffer *stored = entry->second.buffer;
+	if (stored->getWidth() != buffer->getWidth() ||
+	    stored->getHeight() != buffer->getHeight() ||
+	    stored->getNumberOfChannels() != buffer->getNumberOfChannels())
+	{
+		return false;
+	}
+
+	memcpy(buffer->getBuffer(), stored->getBuffer(), entry->second.size);
+	entry->second.lastUsed = ++s_usageCounter;
+	return true;
+}
+
+void ResultCache::store(ResultCacheKey key, MemoryBuffer *buffer)
+{
+	const size_t size = buffer_size(buffer);
+	if (key == COM_RESULT_CACHE_NO_KEY || size > s_memoryLimit) {
+		return;
+	}
+
+	ResultCacheEntries::iterator existing = s_entries.find(key);
+	if (existing != s_entries.end()) {
+		free_entry(existing);
+	}
+	free_least_recently_used(s_memoryLimit - size);
+
+	ResultCacheEntry entry;
+	entry.buffer = buffer->duplicate();
+	entry.size = size;
+	entry.lastUsed = ++s_usageCounter;
+	s_entries[key] = entry;
+	s_memoryUsed += size;
+}
+
+void ResultCache::free()
+{
+	while (!s_entries.empty()) {
+		free_entry(s_entries.begin());
+	}
+	s_usageCounter = 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2015, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_ResultCache_h_
+#define _COM_ResultCache_h_
+
+#include <stddef.h>
+
+extern "C" {
+#  include "BLI_sys_types.h"
+}
+
+class CompositorContext;
+class MemoryBuffer;
+struct bNode;
+
+/**
+ * @brief identifies the result of an operation, 0 when the result can not be cached
+ * @see NodeOperationBuilder.determine_result_cache_keys
+ * @ingroup Memory
+ */
+typedef uint64_t ResultCacheKey;
+
+#define COM_RESULT_CACHE_NO_KEY ((ResultCacheKey)0)
+
+/**
+ * @brief keeps the buffers of WriteBufferOperations between executions of the compositor.
+ *
+ * A buffer is stored under the key of the operations writing it. The key is a hash of the
+ * parameters of those operations and the keys of their inputs, so a buffer is found again
+ * by the next execution as long as nothing upstream of it changed.
+ * When the cache exceeds its memory limit the least recently used buffers are freed.
+ *
+ * @note the cache is only accessed from COM_execute, which is serialized by the compositor mutex
+ * @ingroup Memory
+ */
+class ResultCache {
+public:
+	/**
+	 * @brief start a new key from data
+	 */
+	static ResultCacheKey hash(const void *data, size_t size);
+
+	/**
+	 * @brief add data to a key
+	 */
+	static ResultCacheKey hash(ResultCacheKey key, const void *data, size_t size);
+
+	/**
+	 * @brief key of the parameters of an editor node and the context settings it is executed with
+	 * for nodes using images or render results the key changes every execution the node is tagged
+	 * by an update (bNode.need_exec). the defocus node also includes the lens and dof distance
+	 * of the scene camera
+	 * @return COM_RESULT_CACHE_NO_KEY for nodes that read data the cache can not track
+	 */
+	static ResultCacheKey getNodeKey(const bNode *node, const CompositorContext &context);
+
+	/**
+	 * @brief set the maximum memory in bytes the stored buffers may use
+	 * @note buffers are freed right away when the cache is larger than the new limit
+	 */
+	static void setMemoryLimit(size_t limit);
+
+	/**
+	 * @brief copy a stored buffer into buffer
+	 * @return false when there is no stored buffer for the key with the same size
+	 */
+	static bool restore(ResultCacheKey key, MemoryBuffer *buffer);
+
+	/**
+	 * @brief store a copy of buffer under key
+	 */
+	static void store(ResultCacheKey key, MemoryBuffer *buffer);
+
+	/**
+	 * @brief free all stored buffers
+	 */
+	static void free();
+};
+
+#endif
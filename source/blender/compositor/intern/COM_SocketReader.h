@@ -24,6 +24,7 @@
 #define _COM_SocketReader_h
 #include "BLI_rect.h"
 #include "COM_defines.h"
+#include "COM_Profiler.h"
 
 #ifdef WITH_CXX_GUARDEDALLOC
 #include "MEM_guardedalloc.h"
@@ -90,16 +91,56 @@ protected:
 	 */
 	virtual void executePixelFiltered(float output[4], float x, float y, float dx[2], float dy[2], PixelSampler sampler) {}
 
+	/**
+	 * @brief calculate a row of pixels
+	 * @note this method is called for non-complex, when all operations of the ExecutionGroup are row operations
+	 * @param output is a float array of length * COM_NUMBER_OF_CHANNELS to store the result
+	 * @param x the x-coordinate of the first pixel to calculate in image space
+	 * @param y the y-coordinate of the row to calculate in image space
+	 * @param length the number of pixels to calculate, at most COM_ROW_LENGTH
+	 */
+	virtual void executeRow(float *output, int x, int y, int length) {
+		for (int i = 0; i < length; i++) {
+			executePixelSampled(&output[i * COM_NUMBER_OF_CHANNELS], x + i, y, COM_PS_NEAREST);
+		}
+	}
+
+	/**
+	 * @brief calculate a row of pixels of a complex operation
+	 * @param output is a float array of length * COM_NUMBER_OF_CHANNELS to store the result
+	 * @param x the x-coordinate of the first pixel to calculate in image space
+	 * @param y the y-coordinate of the row to calculate in image space
+	 * @param length the number of pixels to calculate, at most COM_ROW_LENGTH
+	 * @param chunkData the data returned by initializeTileData
+	 * @see executePixel
+	 */
+	virtual void executeTileRow(float *output, int x, int y, int length, void *chunkData) {
+		for (int i = 0; i < length; i++) {
+			executePixel(&output[i * COM_NUMBER_OF_CHANNELS], x + i, y, chunkData);
+		}
+	}
+
 public:
 	inline void readSampled(float result[4], float x, float y, PixelSampler sampler) {
+		COM_PROFILE_SCOPE(this, 1);
 		executePixelSampled(result, x, y, sampler);
 	}
 	inline void read(float result[4], int x, int y, void *chunkData) {
+		COM_PROFILE_SCOPE(this, 1);
 		executePixel(result, x, y, chunkData);
 	}
 	inline void readFiltered(float result[4], float x, float y, float dx[2], float dy[2], PixelSampler sampler) {
+		COM_PROFILE_SCOPE(this, 1);
 		executePixelFiltered(result, x, y, dx, dy, sampler);
 	}
+	inline void readRow(float *result, int x, int y, int length) {
+		COM_PROFILE_SCOPE(this, length);
+		executeRow(result, x, y, length);
+	}
+	inline void readTileRow(float *result, int x, int y, int length, void *chunkData) {
+		COM_PROFILE_SCOPE(this, length);
+		executeTileRow(result, x, y, length, chunkData);
+	}
 
 	virtual void *initializeTileData(rcti *rect) { return 0; }
 	virtual void deinitializeTileData(rcti *rect, void *data) {}
@@ -34,8 +34,11 @@
 #include "MEM_guardedalloc.h"
 
 #include "PIL_time.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
+#include "atomic_ops.h"
+
 #include "BKE_global.h"
 
 #if COM_CURRENT_THREADING_MODEL == COM_TM_NOTHREAD
@@ -43,6 +46,8 @@
 #    warning COM_CURRENT_THREADING_MODEL COM_TM_NOTHREAD is activated. Use only for debugging.
 #  endif
 #elif COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+   /* do nothing */
+#elif COM_CURRENT_THREADING_MODEL == COM_TM_TASK
    /* do nothing - default */
 #else
 #  error COM_CURRENT_THREADING_MODEL No threading model selected
@@ -52,12 +57,28 @@
 /// @brief list of all CPUDevices. for every hardware thread an instance of CPUDevice is created
 static vector<CPUDevice *> g_cpudevices;
 
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
 /// @brief list of all thread for every CPUDevice in cpudevices a thread exists
 static ListBase g_cputhreads;
-static bool g_cpuInitialized = false;
 /// @brief all scheduled work for the cpu
 static ThreadQueue *g_cpuqueue;
+#else
+/// @brief task scheduler with a thread for every CPUDevice, the thread id is the index of its CPUDevice
+static TaskScheduler *g_taskScheduler = NULL;
+/// @brief all scheduled work for the cpu
+static TaskPool *g_taskPool;
+/// @brief number of WorkPackages that are scheduled on any device but not finished yet
+static uint32_t g_numPendingPackages;
+/// @brief tree of the current execution, chunks test it for a break before executing
+static const bNodeTree *g_bTree;
+static volatile bool g_breaked;
+/// @brief number of WorkPackages finished by the GPU, the main thread waits on it in finish
+static uint32_t g_numGPUFinished;
+static ThreadMutex g_gpuFinishedMutex;
+static ThreadCondition g_gpuFinishedCondition;
+#endif
+static bool g_cpuInitialized = false;
 static ThreadQueue *g_gpuqueue;
 #ifdef COM_OPENCL_ENABLED
 static cl_context g_context;
@@ -162,16 +183,62 @@ void *WorkScheduler::thread_execute_cpu(void *data)
 	
 	return NULL;
 }
+#endif
+
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+/* once the tree breaks, the remaining chunks finish without executing and
+ * without scheduling the chunks that depend on them */
+static bool task_test_break()
+{
+	if (!g_breaked && g_bTree && g_bTree->test_break && g_bTree->test_break(g_bTree->tbh)) {
+		g_breaked = true;
+	}
+	return g_breaked;
+}
 
+void WorkScheduler::task_execute_cpu(TaskPool * /*pool*/, void *taskdata, int threadid)
+{
+	WorkPackage *work = (WorkPackage *)taskdata;
+	Device *device = g_cpudevices[threadid];
+
+	if (!task_test_break()) {
+		HIGHLIGHT(work);
+		device->execute(work);
+
+		/* chunks released by this chunk are pushed on the queue of this thread */
+		work->getExecutionGroup()->releaseDependentChunks(work->getChunkNumber(), threadid);
+	}
+	delete work;
+
+	atomic_sub_uint32(&g_numPendingPackages, 1);
+}
+#endif
+
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
 void *WorkScheduler::thread_execute_gpu(void *data)
 {
 	Device *device = (Device *)data;
 	WorkPackage *work;
 	
 	while ((work = (WorkPackage *)BLI_thread_queue_pop(g_gpuqueue))) {
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+		if (!task_test_break()) {
+			HIGHLIGHT(work);
+			device->execute(work);
+			work->getExecutionGroup()->releaseDependentChunks(work->getChunkNumber(), -1);
+		}
+		delete work;
+		atomic_sub_uint32(&g_numPendingPackages, 1);
+
+		BLI_mutex_lock(&g_gpuFinishedMutex);
+		g_numGPUFinished++;
+		BLI_condition_notify_all(&g_gpuFinishedCondition);
+		BLI_mutex_unlock(&g_gpuFinishedMutex);
+#else
 		HIGHLIGHT(work);
 		device->execute(work);
 		delete work;
+#endif
 	}
 	
 	return NULL;
@@ -180,7 +247,7 @@ void *WorkScheduler::thread_execute_gpu(void *data)
 
 
 
-void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber)
+void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber, int threadID)
 {
 	WorkPackage *package = new WorkPackage(group, chunkNumber);
 #if COM_CURRENT_THREADING_MODEL == COM_TM_NOTHREAD
@@ -198,19 +265,38 @@ void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber)
 #else
 	BLI_thread_queue_push(cpuqueue, package);
 #endif
+#elif COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+	atomic_add_uint32(&g_numPendingPackages, 1);
+#ifdef COM_OPENCL_ENABLED
+	if (group->isOpenCL() && g_openclActive) {
+		BLI_thread_queue_push(g_gpuqueue, package);
+		return;
+	}
+#endif
+	BLI_task_pool_push_from_thread(g_taskPool, task_execute_cpu, package, false, TASK_PRIORITY_LOW, threadID);
 #endif
 }
 
 void WorkScheduler::start(CompositorContext &context)
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
 	unsigned int index;
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
 	g_cpuqueue = BLI_thread_queue_init();
 	BLI_init_threads(&g_cputhreads, thread_execute_cpu, g_cpudevices.size());
 	for (index = 0; index < g_cpudevices.size(); index++) {
 		Device *device = g_cpudevices[index];
 		BLI_insert_thread(&g_cputhreads, device);
 	}
+#else
+	g_taskPool = BLI_task_pool_create(g_taskScheduler, NULL);
+	g_numPendingPackages = 0;
+	g_bTree = context.getbNodeTree();
+	g_breaked = false;
+	g_numGPUFinished = 0;
+	BLI_mutex_init(&g_gpuFinishedMutex);
+	BLI_condition_init(&g_gpuFinishedCondition);
+#endif
 #ifdef COM_OPENCL_ENABLED
 	if (context.getHasActiveOpenCLDevices()) {
 		g_gpuqueue = BLI_thread_queue_init();
@@ -241,15 +327,44 @@ void WorkScheduler::finish()
 #else
 	BLI_thread_queue_wait_finish(cpuqueue);
 #endif
+#elif COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+	uint32_t numGPUFinished;
+
+	BLI_mutex_lock(&g_gpuFinishedMutex);
+	numGPUFinished = g_numGPUFinished;
+	BLI_mutex_unlock(&g_gpuFinishedMutex);
+
+	BLI_task_pool_work_and_wait(g_taskPool);
+
+	while (atomic_add_uint32(&g_numPendingPackages, 0) != 0) {
+		/* a chunk is still executing on the GPU, when it finishes it can have
+		 * released chunks for the CPU */
+		BLI_mutex_lock(&g_gpuFinishedMutex);
+		while (g_numGPUFinished == numGPUFinished) {
+			BLI_condition_wait(&g_gpuFinishedCondition, &g_gpuFinishedMutex);
+		}
+		numGPUFinished = g_numGPUFinished;
+		BLI_mutex_unlock(&g_gpuFinishedMutex);
+
+		BLI_task_pool_work_and_wait(g_taskPool);
+	}
 #endif
 }
 void WorkScheduler::stop()
 {
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
 	BLI_thread_queue_nowait(g_cpuqueue);
 	BLI_end_threads(&g_cputhreads);
 	BLI_thread_queue_free(g_cpuqueue);
 	g_cpuqueue = NULL;
+#else
+	BLI_task_pool_free(g_taskPool);
+	g_taskPool = NULL;
+	g_bTree = NULL;
+	BLI_mutex_end(&g_gpuFinishedMutex);
+	BLI_condition_end(&g_gpuFinishedCondition);
+#endif
 #ifdef COM_OPENCL_ENABLED
 	if (g_openclActive) {
 		BLI_thread_queue_nowait(g_gpuqueue);
@@ -263,7 +378,7 @@ void WorkScheduler::stop()
 
 bool WorkScheduler::hasGPUDevices()
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
 #ifdef COM_OPENCL_ENABLED
 	return g_gpudevices.size() > 0;
 #else
@@ -294,7 +409,7 @@ void WorkScheduler::initialize(bool use_opencl, int num_cpu_threads)
 		g_highlightInitialized = true;
 	}
 
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
 	/* deinitialize if number of threads doesn't match */
 	if (g_cpudevices.size() != num_cpu_threads) {
 		Device *device;
@@ -306,6 +421,13 @@ void WorkScheduler::initialize(bool use_opencl, int num_cpu_threads)
 			delete device;
 		}
 
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+		if (g_taskScheduler) {
+			BLI_task_scheduler_free(g_taskScheduler);
+			g_taskScheduler = NULL;
+		}
+#endif
+
 		g_cpuInitialized = false;
 	}
 
@@ -317,6 +439,11 @@ void WorkScheduler::initialize(bool use_opencl, int num_cpu_threads)
 			g_cpudevices.push_back(device);
 		}
 
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+		/* the calling thread works as well and has thread id 0 */
+		g_taskScheduler = BLI_task_scheduler_create(num_cpu_threads);
+#endif
+
 		g_cpuInitialized = true;
 	}
 
@@ -392,7 +519,7 @@ void WorkScheduler::initialize(bool use_opencl, int num_cpu_threads)
 
 void WorkScheduler::deinitialize()
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
 	/* deinitialize CPU threads */
 	if (g_cpuInitialized) {
 		Device *device;
@@ -403,6 +530,11 @@ void WorkScheduler::deinitialize()
 			delete device;
 		}
 
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+		BLI_task_scheduler_free(g_taskScheduler);
+		g_taskScheduler = NULL;
+#endif
+
 		g_cpuInitialized = false;
 	}
 
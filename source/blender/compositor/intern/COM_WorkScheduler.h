@@ -25,6 +25,7 @@
 
 #include "COM_ExecutionGroup.h"
 extern "C" {
+#  include "BLI_task.h"
 #  include "BLI_threads.h"
 }
 #include "COM_WorkPackage.h"
@@ -47,13 +48,23 @@ class WorkScheduler {
 	 * inside this loop new work is queried and being executed
 	 */
 	static void *thread_execute_cpu(void *data);
+#endif
+
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+	/**
+	 * @brief task run for a WorkPackage on the CPUDevice of the executing thread
+	 * after execution the chunks waiting for this chunk are released
+	 */
+	static void task_execute_cpu(TaskPool *pool, void *taskdata, int threadid);
+#endif
 
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
 	/**
 	 * @brief main thread loop for gpudevices
 	 * inside this loop new work is queried and being executed
 	 */
 	static void *thread_execute_gpu(void *data);
-#endif	
+#endif
 public:
 	/**
 	 * @brief schedule a chunk of a group to be calculated.
@@ -63,8 +74,10 @@ public:
 	 * @see ExecutionGroup.execute
 	 * @param group the execution group
 	 * @param chunkNumber the number of the chunk in the group to be executed
+	 * @param threadID thread that releases the chunk, with COM_TM_TASK the chunk is
+	 * pushed on the queue of this thread. -1 when not called from a worker thread
 	 */
-	static void schedule(ExecutionGroup *group, int chunkNumber);
+	static void schedule(ExecutionGroup *group, int chunkNumber, int threadID = -1);
 
 	/**
 	 * @brief initialize the WorkScheduler
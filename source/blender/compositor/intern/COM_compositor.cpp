@@ -34,6 +34,7 @@ extern "C" {
 #include "COM_WorkScheduler.h"
 #include "clew.h"
 #include "COM_MovieDistortionOperation.h"
+#include "COM_ResultCache.h"
 
 static ThreadMutex s_compositorMutex;
 static bool is_compositorMutex_init = false;
@@ -41,6 +42,7 @@ static bool is_compositorMutex_init = false;
 static void intern_freeCompositorCaches()
 {
 	deintializeDistortionCache();
+	ResultCache::free();
 }
 
 void COM_execute(RenderData *rd, Scene *scene, bNodeTree *editingtree, int rendering,
@@ -39,7 +39,7 @@ public:
 	/**
 	 * the inner loop of this program
 	 */
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void blendPixel(float output[4], const float value[4], const float inputColor1[4], const float inputOverColor[4]);
 
 };
 #endif
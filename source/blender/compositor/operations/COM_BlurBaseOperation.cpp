@@ -103,6 +103,50 @@ __m128 *BlurBaseOperation::convert_gausstab_sse(const float *gausstab, float rad
 }
 #endif
 
+void BlurBaseOperation::blur_row(float *output, const float *src, int length, int tap_offset,
+                                 const float *weights, int num_weights)
+{
+	float weight_accum = 0.0f;
+	int i, k;
+
+	BLI_assert(length <= COM_ROW_LENGTH);
+
+	for (k = 0; k < num_weights; k++) {
+		weight_accum += weights[k];
+	}
+
+	/* the kernel is the outer loop, so every weight is applied to a contiguous run of pixels */
+#ifdef __SSE2__
+	__m128 accum[COM_ROW_LENGTH];
+	for (i = 0; i < length; i++) {
+		accum[i] = _mm_setzero_ps();
+	}
+	for (k = 0; k < num_weights; k++) {
+		const __m128 weight = _mm_set1_ps(weights[k]);
+		const float *tap = &src[k * tap_offset];
+		for (i = 0; i < length; i++) {
+			accum[i] = _mm_add_ps(accum[i], _mm_mul_ps(_mm_loadu_ps(&tap[i * COM_NUMBER_OF_CHANNELS]), weight));
+		}
+	}
+	const __m128 normalize = _mm_set1_ps(1.0f / weight_accum);
+	for (i = 0; i < length; i++) {
+		_mm_storeu_ps(&output[i * COM_NUMBER_OF_CHANNELS], _mm_mul_ps(accum[i], normalize));
+	}
+#else
+	memset(output, 0, sizeof(float) * length * COM_NUMBER_OF_CHANNELS);
+	for (k = 0; k < num_weights; k++) {
+		const float weight = weights[k];
+		const float *tap = &src[k * tap_offset];
+		for (i = 0; i < length; i++) {
+			madd_v4_v4fl(&output[i * COM_NUMBER_OF_CHANNELS], &tap[i * COM_NUMBER_OF_CHANNELS], weight);
+		}
+	}
+	for (i = 0; i < length; i++) {
+		mul_v4_fl(&output[i * COM_NUMBER_OF_CHANNELS], 1.0f / weight_accum);
+	}
+#endif
+}
+
 /* normalized distance from the current (inverted so 1.0 is close and 0.0 is far)
  * 'ease' is applied after, looks nicer */
 float *BlurBaseOperation::make_dist_fac_inverse(float rad, int size, int falloff)
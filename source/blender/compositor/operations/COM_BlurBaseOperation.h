@@ -43,6 +43,16 @@ protected:
 #endif
 	float *make_dist_fac_inverse(float rad, int size, int falloff);
 
+	/**
+	 * @brief calculate a row of pixels as the normalized weighted sum of num_weights input rows
+	 * output pixel i = sum(weights[k] * src[k * tap_offset + i * COM_NUMBER_OF_CHANNELS]) / sum(weights)
+	 * @param length number of pixels, at most COM_ROW_LENGTH
+	 * @param tap_offset offset in floats between the input rows of two consecutive weights,
+	 * one pixel for a horizontal blur or one buffer row for a vertical blur
+	 */
+	static void blur_row(float *output, const float *src, int length, int tap_offset,
+	                     const float *weights, int num_weights);
+
 	void updateSize();
 
 	/**
@@ -21,8 +21,10 @@
  */
 
 #include "COM_BokehBlurOperation.h"
+#include "COM_FHTConvolution.h"
 #include "BLI_math.h"
 #include "COM_OpenCLDevice.h"
+#include "MEM_guardedalloc.h"
 
 extern "C" {
 #  include "RE_pipeline.h"
@@ -43,6 +45,8 @@ BokehBlurOperation::BokehBlurOperation() : NodeOperation()
 	this->m_inputProgram = NULL;
 	this->m_inputBokehProgram = NULL;
 	this->m_inputBoundingBoxReader = NULL;
+	this->m_useFFT = false;
+	this->m_convolved = NULL;
 }
 
 void *BokehBlurOperation::initializeTileData(rcti *rect)
@@ -52,10 +56,84 @@ void *BokehBlurOperation::initializeTileData(rcti *rect)
 		updateSize();
 	}
 	void *buffer = getInputOperation(0)->initializeTileData(NULL);
+	if (this->m_useFFT && !this->m_convolved) {
+		convolve((MemoryBuffer *)buffer);
+	}
 	unlockMutex();
 	return buffer;
 }
 
+int BokehBlurOperation::getPixelSize() const
+{
+	const float max_dim = max(this->getWidth(), this->getHeight());
+	return this->m_size * max_dim / 100.0f;
+}
+
+void BokehBlurOperation::convolve(MemoryBuffer *inputBuffer)
+{
+	const int pixelSize = getPixelSize();
+	const int kernelSize = 2 * pixelSize + 1;
+	const int width = inputBuffer->getWidth();
+	const int height = inputBuffer->getHeight();
+	const float m = this->m_bokehDimension / pixelSize;
+	float bokeh[4];
+	int x, y, c;
+
+	/* kernel element (kx, ky) weights the input pixel (x + pixelSize - kx, y + pixelSize - ky),
+	 * the first row and column stay empty as the per pixel filter excludes the pixels at +pixelSize */
+	rcti kernelRect;
+	BLI_rcti_init(&kernelRect, 0, kernelSize, 0, kernelSize);
+	MemoryBuffer *kernel = new MemoryBuffer(COM_DT_COLOR, &kernelRect);
+	float *kernelBuffer = kernel->getBuffer();
+	for (y = 1; y < kernelSize; y++) {
+		for (x = 1; x < kernelSize; x++) {
+			const float u = this->m_bokehMidX - (pixelSize - x) * m;
+			const float v = this->m_bokehMidY - (pixelSize - y) * m;
+			this->m_inputBokehProgram->readSampled(bokeh, u, v, COM_PS_NEAREST);
+			copy_v4_v4(&kernelBuffer[(y * kernelSize + x) * COM_NUMBER_OF_CHANNELS], bokeh);
+		}
+	}
+
+	this->m_convolved = (float *)MEM_mallocN(sizeof(float) * width * height * COM_NUMBER_OF_CHANNELS, __func__);
+	FHT_convolve(this->m_convolved, inputBuffer, kernel, COM_NUMBER_OF_CHANNELS);
+
+	/* normalize by the part of the kernel that lies inside the image,
+	 * using a summed area table of the kernel with an extra zero row and column */
+	const int tableSize = kernelSize + 1;
+	double *table = (double *)MEM_callocN(sizeof(double) * tableSize * tableSize * COM_NUMBER_OF_CHANNELS, __func__);
+	for (y = 0; y < kernelSize; y++) {
+		for (x = 0; x < kernelSize; x++) {
+			const float *weight = &kernelBuffer[(y * kernelSize + x) * COM_NUMBER_OF_CHANNELS];
+			double *entry = &table[((y + 1) * tableSize + x + 1) * COM_NUMBER_OF_CHANNELS];
+			for (c = 0; c < COM_NUMBER_OF_CHANNELS; c++) {
+				entry[c] = weight[c] +
+				           entry[c - COM_NUMBER_OF_CHANNELS] +
+				           entry[c - tableSize * COM_NUMBER_OF_CHANNELS] -
+				           entry[c - (tableSize + 1) * COM_NUMBER_OF_CHANNELS];
+			}
+		}
+	}
+	delete kernel;
+
+	for (y = 0; y < height; y++) {
+		const int kymin = max(1, pixelSize - height + 1 + y);
+		const int kymax = min(kernelSize - 1, pixelSize + y) + 1;
+		for (x = 0; x < width; x++) {
+			const int kxmin = max(1, pixelSize - width + 1 + x);
+			const int kxmax = min(kernelSize - 1, pixelSize + x) + 1;
+			float *color = &this->m_convolved[(y * width + x) * COM_NUMBER_OF_CHANNELS];
+			for (c = 0; c < COM_NUMBER_OF_CHANNELS; c++) {
+				const double weight = table[(kymax * tableSize + kxmax) * COM_NUMBER_OF_CHANNELS + c] -
+				                      table[(kymax * tableSize + kxmin) * COM_NUMBER_OF_CHANNELS + c] -
+				                      table[(kymin * tableSize + kxmax) * COM_NUMBER_OF_CHANNELS + c] +
+				                      table[(kymin * tableSize + kxmin) * COM_NUMBER_OF_CHANNELS + c];
+				color[c] = (weight != 0.0) ? (float)(color[c] / weight) : 0.0f;
+			}
+		}
+	}
+	MEM_freeN(table);
+}
+
 void BokehBlurOperation::initExecution()
 {
 	initMutex();
@@ -71,6 +149,8 @@ void BokehBlurOperation::initExecution()
 	this->m_bokehMidX = width / 2.0f;
 	this->m_bokehMidY = height / 2.0f;
 	this->m_bokehDimension = dimension / 2.0f;
+	/* the area of interest of the whole image is only known up front with a fixed size */
+	this->m_useFFT = this->m_sizeavailable && isFFTSize();
 	QualityStepHelper::initExecution(COM_QH_INCREASE);
 }
 
@@ -81,7 +161,10 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 	float bokeh[4];
 
 	this->m_inputBoundingBoxReader->readSampled(tempBoundingBox, x, y, COM_PS_NEAREST);
-	if (tempBoundingBox[0] > 0.0f) {
+	if (tempBoundingBox[0] > 0.0f && this->m_convolved) {
+		copy_v4_v4(output, &this->m_convolved[(y * this->getWidth() + x) * COM_NUMBER_OF_CHANNELS]);
+	}
+	else if (tempBoundingBox[0] > 0.0f) {
 		float multiplier_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
 		MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
 		float *buffer = inputBuffer->getBuffer();
@@ -137,6 +220,10 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 void BokehBlurOperation::deinitExecution()
 {
 	deinitMutex();
+	if (this->m_convolved) {
+		MEM_freeN(this->m_convolved);
+		this->m_convolved = NULL;
+	}
 	this->m_inputProgram = NULL;
 	this->m_inputBokehProgram = NULL;
 	this->m_inputBoundingBoxReader = NULL;
@@ -148,7 +235,13 @@ bool BokehBlurOperation::determineDependingAreaOfInterest(rcti *input, ReadBuffe
 	rcti bokehInput;
 	const float max_dim = max(this->getWidth(), this->getHeight());
 
-	if (this->m_sizeavailable) {
+	if (this->m_sizeavailable && isFFTSize()) {
+		newInput.xmax = this->getWidth();
+		newInput.xmin = 0;
+		newInput.ymax = this->getHeight();
+		newInput.ymin = 0;
+	}
+	else if (this->m_sizeavailable) {
 		newInput.xmax = input->xmax + (this->m_size * max_dim / 100.0f);
 		newInput.xmin = input->xmin - (this->m_size * max_dim / 100.0f);
 		newInput.ymax = input->ymax + (this->m_size * max_dim / 100.0f);
@@ -37,6 +37,17 @@ private:
 	float m_bokehMidX;
 	float m_bokehMidY;
 	float m_bokehDimension;
+
+	/**
+	 * @brief large kernels convolve the whole image once using the FHT
+	 * @see COM_BOKEH_FFT_MIN_RADIUS
+	 */
+	bool m_useFFT;
+	float *m_convolved;
+
+	int getPixelSize() const;
+	bool isFFTSize() const { return getPixelSize() >= COM_BOKEH_FFT_MIN_RADIUS; }
+	void convolve(MemoryBuffer *inputBuffer);
 public:
 	BokehBlurOperation();
 
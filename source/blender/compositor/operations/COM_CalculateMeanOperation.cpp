@@ -23,7 +23,18 @@
 #include "COM_CalculateMeanOperation.h"
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
+#include "BLI_task.h"
+#include "MEM_guardedalloc.h"
 
+typedef struct CalculateMeanRows {
+	MemoryBuffer *tile;
+	int setting;
+	bool deviation;
+	float mean;
+	/* results per row, so the total does not depend on the number of threads */
+	float *sums;
+	int *pixels;
+} CalculateMeanRows;
 
 
 CalculateMeanOperation::CalculateMeanOperation() : NodeOperation()
@@ -82,47 +93,91 @@ void *CalculateMeanOperation::initializeTileData(rcti *rect)
 	return NULL;
 }
 
-void CalculateMeanOperation::calculateMean(MemoryBuffer *tile)
+BLI_INLINE float setting_value(const float *color, int setting)
 {
-	this->m_result = 0.0f;
-	float *buffer = tile->getBuffer();
-	int size = tile->getWidth() * tile->getHeight();
-	int pixels = 0;
+	switch (setting) {
+		case 1:  /* rgb combined */
+			return rgb_to_bw(color);
+		case 2:  /* red */
+			return color[0];
+		case 3:  /* green */
+			return color[1];
+		case 4:  /* blue */
+			return color[2];
+		case 5:  /* luminance */
+		{
+			float yuv[3];
+			rgb_to_yuv(color[0], color[1], color[2], &yuv[0], &yuv[1], &yuv[2]);
+			return yuv[0];
+		}
+	}
+	return 0.0f;
+}
+
+static void calculate_mean_row(void *userdata, int y)
+{
+	CalculateMeanRows *data = (CalculateMeanRows *)userdata;
+	const int width = data->tile->getWidth();
+	const int num_channels = data->tile->getNumberOfChannels();
+	const int setting = data->setting;
+	const float mean = data->mean;
+	const float *color = data->tile->getBuffer() + (size_t)y * width * num_channels;
 	float sum = 0.0f;
-	for (int i = 0, offset = 0; i < size; i++, offset += 4) {
-		if (buffer[offset + 3] > 0) {
-			pixels++;
-	
-			switch (this->m_setting) {
-				case 1:
-				{
-					sum += rgb_to_bw(&buffer[offset]);
-					break;
-				}
-				case 2:
-				{
-					sum += buffer[offset];
-					break;
-				}
-				case 3:
-				{
-					sum += buffer[offset + 1];
-					break;
-				}
-				case 4:
-				{
-					sum += buffer[offset + 2];
-					break;
-				}
-				case 5:
-				{
-					float yuv[3];
-					rgb_to_yuv(buffer[offset], buffer[offset + 1], buffer[offset + 2], &yuv[0], &yuv[1], &yuv[2]);
-					sum += yuv[0];
-					break;
-				}
+	int pixels = 0;
+
+	/* separate loops, so the inner loop has no branch for the mode */
+	if (data->deviation) {
+		for (int x = 0; x < width; x++, color += num_channels) {
+			if (color[3] > 0) {
+				const float value = setting_value(color, setting);
+				sum += (value - mean) * (value - mean);
+				pixels++;
 			}
 		}
 	}
+	else {
+		for (int x = 0; x < width; x++, color += num_channels) {
+			if (color[3] > 0) {
+				sum += setting_value(color, setting);
+				pixels++;
+			}
+		}
+	}
+	data->sums[y] = sum;
+	data->pixels[y] = pixels;
+}
+
+float CalculateMeanOperation::sumValues(MemoryBuffer *tile, bool deviation, int *r_pixels)
+{
+	const int height = tile->getHeight();
+	CalculateMeanRows data;
+	data.tile = tile;
+	data.setting = this->m_setting;
+	data.deviation = deviation;
+	data.mean = this->m_result;
+	data.sums = (float *)MEM_mallocN(sizeof(float) * height, __func__);
+	data.pixels = (int *)MEM_mallocN(sizeof(int) * height, __func__);
+
+	if (height > 0) {
+		BLI_task_parallel_range(0, height, &data, calculate_mean_row);
+	}
+
+	float sum = 0.0f;
+	*r_pixels = 0;
+	for (int y = 0; y < height; y++) {
+		sum += data.sums[y];
+		*r_pixels += data.pixels[y];
+	}
+
+	MEM_freeN(data.sums);
+	MEM_freeN(data.pixels);
+	return sum;
+}
+
+void CalculateMeanOperation::calculateMean(MemoryBuffer *tile)
+{
+	int pixels;
+	this->m_result = 0.0f;
+	float sum = sumValues(tile, false, &pixels);
 	this->m_result = sum / pixels;
 }
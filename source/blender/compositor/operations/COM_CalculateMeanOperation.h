@@ -65,5 +65,12 @@ public:
 	
 protected:
 	void calculateMean(MemoryBuffer *tile);
+	
+	/**
+	 * @brief sum the values of the pixels with alpha, the rows are summed in parallel
+	 * @param deviation sum the squared differences with m_result instead of the values
+	 * @param r_pixels number of summed pixels
+	 */
+	float sumValues(MemoryBuffer *tile, bool deviation, int *r_pixels);
 };
 #endif
@@ -27,6 +27,7 @@ ChangeHSVOperation::ChangeHSVOperation() : NodeOperation()
 	this->addInputSocket(COM_DT_COLOR);
 	this->addOutputSocket(COM_DT_COLOR);
 	this->m_inputOperation = NULL;
+	this->setPixelOperation(true);
 }
 
 void ChangeHSVOperation::initExecution()
@@ -45,11 +46,21 @@ void ChangeHSVOperation::executePixelSampled(float output[4], float x, float y,
 	
 	this->m_inputOperation->readSampled(inputColor1, x, y, sampler);
 	
-	output[0] = inputColor1[0] + (this->m_hue - 0.5f);
-	if      (output[0] > 1.0f) output[0] -= 1.0f;
-	else if (output[0] < 0.0f) output[0] += 1.0f;
-	output[1] = inputColor1[1] * this->m_saturation;
-	output[2] = inputColor1[2] * this->m_value;
-	output[3] = inputColor1[3];
+	float *inputRows[1] = {inputColor1};
+	calculateRow(output, inputRows, 1);
+}
+
+void ChangeHSVOperation::calculateRow(float *output, float *const *inputRows, int length)
+{
+	const float *inputColor1 = inputRows[0];
+
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		output[i + 0] = inputColor1[i + 0] + (this->m_hue - 0.5f);
+		if      (output[i + 0] > 1.0f) output[i + 0] -= 1.0f;
+		else if (output[i + 0] < 0.0f) output[i + 0] += 1.0f;
+		output[i + 1] = inputColor1[i + 1] * this->m_saturation;
+		output[i + 2] = inputColor1[i + 2] * this->m_value;
+		output[i + 3] = inputColor1[i + 3];
+	}
 }
 
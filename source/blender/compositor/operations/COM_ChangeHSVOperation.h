@@ -51,6 +51,11 @@ public:
 	 */
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 
+	/**
+	 * the inner loop of this program, a row at a time
+	 */
+	void calculateRow(float *output, float *const *inputRows, int length);
+
 	void setHue(float hue) { this->m_hue = hue; }
 	void setSaturation(float saturation) { this->m_saturation = saturation; }
 	void setValue(float value) { this->m_value = value; }
@@ -33,6 +33,7 @@ ColorCorrectionOperation::ColorCorrectionOperation() : NodeOperation()
 	this->m_redChannelEnabled = true;
 	this->m_greenChannelEnabled = true;
 	this->m_blueChannelEnabled = true;
+	this->setPixelOperation(true);
 }
 void ColorCorrectionOperation::initExecution()
 {
@@ -46,7 +47,22 @@ void ColorCorrectionOperation::executePixelSampled(float output[4], float x, flo
 	float inputMask[4];
 	this->m_inputImage->readSampled(inputImageColor, x, y, sampler);
 	this->m_inputMask->readSampled(inputMask, x, y, sampler);
-	
+
+	correctPixel(output, inputImageColor, inputMask);
+}
+
+void ColorCorrectionOperation::calculateRow(float *output, float *const *inputRows, int length)
+{
+	const float *inputImageColor = inputRows[0];
+	const float *inputMask = inputRows[1];
+
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		correctPixel(&output[i], &inputImageColor[i], &inputMask[i]);
+	}
+}
+
+void ColorCorrectionOperation::correctPixel(float output[4], const float inputImageColor[4], const float inputMask[4])
+{
 	float level = (inputImageColor[0] + inputImageColor[1] + inputImageColor[2]) / 3.0f;
 	float contrast = this->m_data->master.contrast;
 	float saturation = this->m_data->master.saturation;
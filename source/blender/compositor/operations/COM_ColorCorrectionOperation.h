@@ -38,6 +38,8 @@ private:
 	bool m_greenChannelEnabled;
 	bool m_blueChannelEnabled;
 
+	void correctPixel(float output[4], const float inputImageColor[4], const float inputMask[4]);
+
 public:
 	ColorCorrectionOperation();
 	
@@ -45,6 +47,11 @@ public:
 	 * the inner loop of this program
 	 */
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+	/**
+	 * the inner loop of this program, a row at a time
+	 */
+	void calculateRow(float *output, float *const *inputRows, int length);
 	
 	/**
 	 * Initialize the execution
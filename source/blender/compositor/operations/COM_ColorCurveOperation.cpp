@@ -45,6 +45,7 @@ ColorCurveOperation::ColorCurveOperation() : CurveBaseOperation()
 	this->m_inputWhiteProgram = NULL;
 
 	this->setResolutionInputSocketIndex(1);
+	this->setPixelOperation(true);
 }
 void ColorCurveOperation::initExecution()
 {
@@ -60,40 +61,51 @@ void ColorCurveOperation::initExecution()
 
 void ColorCurveOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
-	CurveMapping *cumap = this->m_curveMapping;
-	
 	float fac[4];
 	float image[4];
-
-	/* local versions of cumap->black, cumap->white, cumap->bwmul */
 	float black[4];
 	float white[4];
-	float bwmul[3];
 
+	this->m_inputFacProgram->readSampled(fac, x, y, sampler);
+	this->m_inputImageProgram->readSampled(image, x, y, sampler);
 	this->m_inputBlackProgram->readSampled(black, x, y, sampler);
 	this->m_inputWhiteProgram->readSampled(white, x, y, sampler);
 
-	/* get our own local bwmul value,
-	 * since we can't be threadsafe and use cumap->bwmul & friends */
-	curvemapping_set_black_white_ex(black, white, bwmul);
+	float *inputRows[4] = {fac, image, black, white};
+	calculateRow(output, inputRows, 1);
+}
 
-	this->m_inputFacProgram->readSampled(fac, x, y, sampler);
-	this->m_inputImageProgram->readSampled(image, x, y, sampler);
+void ColorCurveOperation::calculateRow(float *output, float *const *inputRows, int length)
+{
+	CurveMapping *cumap = this->m_curveMapping;
 
-	if (*fac >= 1.0f) {
-		curvemapping_evaluate_premulRGBF_ex(cumap, output, image,
-		                                    black, bwmul);
-	}
-	else if (*fac <= 0.0f) {
-		copy_v3_v3(output, image);
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		const float fac = inputRows[0][i];
+		const float *image = &inputRows[1][i];
+		/* local versions of cumap->black, cumap->white, cumap->bwmul */
+		const float *black = &inputRows[2][i];
+		const float *white = &inputRows[3][i];
+		float bwmul[3];
+
+		/* get our own local bwmul value,
+		 * since we can't be threadsafe and use cumap->bwmul & friends */
+		curvemapping_set_black_white_ex(black, white, bwmul);
+
+		if (fac >= 1.0f) {
+			curvemapping_evaluate_premulRGBF_ex(cumap, &output[i], image,
+			                                    black, bwmul);
+		}
+		else if (fac <= 0.0f) {
+			copy_v3_v3(&output[i], image);
+		}
+		else {
+			float col[4];
+			curvemapping_evaluate_premulRGBF_ex(cumap, col, image,
+			                                    black, bwmul);
+			interp_v3_v3v3(&output[i], image, col, fac);
+		}
+		output[i + 3] = image[3];
 	}
-	else {
-		float col[4];
-		curvemapping_evaluate_premulRGBF_ex(cumap, col, image,
-		                                    black, bwmul);
-		interp_v3_v3v3(output, image, col, *fac);
-	}
-	output[3] = image[3];
 }
 
 void ColorCurveOperation::deinitExecution()
@@ -118,6 +130,7 @@ ConstantLevelColorCurveOperation::ConstantLevelColorCurveOperation() : CurveBase
 	this->m_inputImageProgram = NULL;
 
 	this->setResolutionInputSocketIndex(1);
+	this->setPixelOperation(true);
 }
 void ConstantLevelColorCurveOperation::initExecution()
 {
@@ -138,18 +151,29 @@ void ConstantLevelColorCurveOperation::executePixelSampled(float output[4], floa
 	this->m_inputFacProgram->readSampled(fac, x, y, sampler);
 	this->m_inputImageProgram->readSampled(image, x, y, sampler);
 
-	if (*fac >= 1.0f) {
-		curvemapping_evaluate_premulRGBF(this->m_curveMapping, output, image);
-	}
-	else if (*fac <= 0.0f) {
-		copy_v3_v3(output, image);
-	}
-	else {
-		float col[4];
-		curvemapping_evaluate_premulRGBF(this->m_curveMapping, col, image);
-		interp_v3_v3v3(output, image, col, *fac);
+	float *inputRows[2] = {fac, image};
+	calculateRow(output, inputRows, 1);
+}
+
+void ConstantLevelColorCurveOperation::calculateRow(float *output, float *const *inputRows, int length)
+{
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		const float fac = inputRows[0][i];
+		const float *image = &inputRows[1][i];
+
+		if (fac >= 1.0f) {
+			curvemapping_evaluate_premulRGBF(this->m_curveMapping, &output[i], image);
+		}
+		else if (fac <= 0.0f) {
+			copy_v3_v3(&output[i], image);
+		}
+		else {
+			float col[4];
+			curvemapping_evaluate_premulRGBF(this->m_curveMapping, col, image);
+			interp_v3_v3v3(&output[i], image, col, fac);
+		}
+		output[i + 3] = image[3];
 	}
-	output[3] = image[3];
 }
 
 void ConstantLevelColorCurveOperation::deinitExecution()
@@ -26,6 +26,7 @@
 ConvertBaseOperation::ConvertBaseOperation()
 {
 	this->m_inputOperation = NULL;
+	this->setPixelOperation(true);
 }
 
 void ConvertBaseOperation::initExecution()
@@ -38,6 +39,22 @@ void ConvertBaseOperation::deinitExecution()
 	this->m_inputOperation = NULL;
 }
 
+void ConvertBaseOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+{
+	float input[4];
+	this->m_inputOperation->readSampled(input, x, y, sampler);
+	convertPixel(output, input);
+}
+
+void ConvertBaseOperation::calculateRow(float *output, float *const *inputRows, int length)
+{
+	const float *input = inputRows[0];
+
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		convertPixel(&output[i], &input[i]);
+	}
+}
+
 
 /* ******** Value to Color ******** */
 
@@ -47,10 +64,8 @@ ConvertValueToColorOperation::ConvertValueToColorOperation() : ConvertBaseOperat
 	this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertValueToColorOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertValueToColorOperation::convertPixel(float output[4], const float inputValue[4])
 {
-	float inputValue[4];
-	this->m_inputOperation->readSampled(inputValue, x, y, sampler);
 	output[0] = output[1] = output[2] = inputValue[0];
 	output[3] = 1.0f;
 }
@@ -64,10 +79,8 @@ ConvertColorToValueOperation::ConvertColorToValueOperation() : ConvertBaseOperat
 	this->addOutputSocket(COM_DT_VALUE);
 }
 
-void ConvertColorToValueOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertColorToValueOperation::convertPixel(float output[4], const float inputColor[4])
 {
-	float inputColor[4];
-	this->m_inputOperation->readSampled(inputColor, x, y, sampler);
 	output[0] = (inputColor[0] + inputColor[1] + inputColor[2]) / 3.0f;
 }
 
@@ -80,10 +93,8 @@ ConvertColorToBWOperation::ConvertColorToBWOperation() : ConvertBaseOperation()
 	this->addOutputSocket(COM_DT_VALUE);
 }
 
-void ConvertColorToBWOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertColorToBWOperation::convertPixel(float output[4], const float inputColor[4])
 {
-	float inputColor[4];
-	this->m_inputOperation->readSampled(inputColor, x, y, sampler);
 	output[0] = rgb_to_bw(inputColor);
 }
 
@@ -96,9 +107,9 @@ ConvertColorToVectorOperation::ConvertColorToVectorOperation() : ConvertBaseOper
 	this->addOutputSocket(COM_DT_VECTOR);
 }
 
-void ConvertColorToVectorOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertColorToVectorOperation::convertPixel(float output[4], const float input[4])
 {
-	this->m_inputOperation->readSampled(output, x, y, sampler);
+	copy_v4_v4(output, input);
 }
 
 
@@ -110,10 +121,8 @@ ConvertValueToVectorOperation::ConvertValueToVectorOperation() : ConvertBaseOper
 	this->addOutputSocket(COM_DT_VECTOR);
 }
 
-void ConvertValueToVectorOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertValueToVectorOperation::convertPixel(float output[4], const float input[4])
 {
-	float input[4];
-	this->m_inputOperation->readSampled(input, x, y, sampler);
 	output[0] = input[0];
 	output[1] = input[0];
 	output[2] = input[0];
@@ -129,9 +138,9 @@ ConvertVectorToColorOperation::ConvertVectorToColorOperation() : ConvertBaseOper
 	this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertVectorToColorOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertVectorToColorOperation::convertPixel(float output[4], const float input[4])
 {
-	this->m_inputOperation->readSampled(output, x, y, sampler);
+	copy_v3_v3(output, input);
 	output[3] = 1.0f;
 }
 
@@ -144,10 +153,8 @@ ConvertVectorToValueOperation::ConvertVectorToValueOperation() : ConvertBaseOper
 	this->addOutputSocket(COM_DT_VALUE);
 }
 
-void ConvertVectorToValueOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertVectorToValueOperation::convertPixel(float output[4], const float input[4])
 {
-	float input[4];
-	this->m_inputOperation->readSampled(input, x, y, sampler);
 	output[0] = (input[0] + input[1] + input[2]) / 3.0f;
 }
 
@@ -176,12 +183,10 @@ void ConvertRGBToYCCOperation::setMode(int mode)
 	}
 }
 
-void ConvertRGBToYCCOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertRGBToYCCOperation::convertPixel(float output[4], const float inputColor[4])
 {
-	float inputColor[4];
 	float color[3];
 
-	this->m_inputOperation->readSampled(inputColor, x, y, sampler);
 	rgb_to_ycc(inputColor[0], inputColor[1], inputColor[2], &color[0], &color[1], &color[2], this->m_mode);
 
 	/* divided by 255 to normalize for viewing in */
@@ -214,16 +219,15 @@ void ConvertYCCToRGBOperation::setMode(int mode)
 	}
 }
 
-void ConvertYCCToRGBOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertYCCToRGBOperation::convertPixel(float output[4], const float inputColor[4])
 {
-	float inputColor[4];
-	this->m_inputOperation->readSampled(inputColor, x, y, sampler);
+	float color[3];
 
 	/* need to un-normalize the data */
 	/* R,G,B --> Y,Cb,Cr */
-	mul_v3_fl(inputColor, 255.0f);
+	mul_v3_v3fl(color, inputColor, 255.0f);
 
-	ycc_to_rgb(inputColor[0], inputColor[1], inputColor[2], &output[0], &output[1], &output[2], this->m_mode);
+	ycc_to_rgb(color[0], color[1], color[2], &output[0], &output[1], &output[2], this->m_mode);
 	output[3] = inputColor[3];
 }
 
@@ -236,10 +240,8 @@ ConvertRGBToYUVOperation::ConvertRGBToYUVOperation() : ConvertBaseOperation()
 	this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertRGBToYUVOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertRGBToYUVOperation::convertPixel(float output[4], const float inputColor[4])
 {
-	float inputColor[4];
-	this->m_inputOperation->readSampled(inputColor, x, y, sampler);
 	rgb_to_yuv(inputColor[0], inputColor[1], inputColor[2], &output[0], &output[1], &output[2]);
 	output[3] = inputColor[3];
 }
@@ -253,10 +255,8 @@ ConvertYUVToRGBOperation::ConvertYUVToRGBOperation() : ConvertBaseOperation()
 	this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertYUVToRGBOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertYUVToRGBOperation::convertPixel(float output[4], const float inputColor[4])
 {
-	float inputColor[4];
-	this->m_inputOperation->readSampled(inputColor, x, y, sampler);
 	yuv_to_rgb(inputColor[0], inputColor[1], inputColor[2], &output[0], &output[1], &output[2]);
 	output[3] = inputColor[3];
 }
@@ -270,10 +270,8 @@ ConvertRGBToHSVOperation::ConvertRGBToHSVOperation() : ConvertBaseOperation()
 	this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertRGBToHSVOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertRGBToHSVOperation::convertPixel(float output[4], const float inputColor[4])
 {
-	float inputColor[4];
-	this->m_inputOperation->readSampled(inputColor, x, y, sampler);
 	rgb_to_hsv_v(inputColor, output);
 	output[3] = inputColor[3];
 }
@@ -287,10 +285,8 @@ ConvertHSVToRGBOperation::ConvertHSVToRGBOperation() : ConvertBaseOperation()
 	this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertHSVToRGBOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertHSVToRGBOperation::convertPixel(float output[4], const float inputColor[4])
 {
-	float inputColor[4];
-	this->m_inputOperation->readSampled(inputColor, x, y, sampler);
 	hsv_to_rgb_v(inputColor, output);
 	output[0] = max_ff(output[0], 0.0f);
 	output[1] = max_ff(output[1], 0.0f);
@@ -307,12 +303,10 @@ ConvertPremulToStraightOperation::ConvertPremulToStraightOperation() : ConvertBa
 	this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertPremulToStraightOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertPremulToStraightOperation::convertPixel(float output[4], const float inputValue[4])
 {
-	float inputValue[4];
 	float alpha;
 
-	this->m_inputOperation->readSampled(inputValue, x, y, sampler);
 	alpha = inputValue[3];
 
 	if (fabsf(alpha) < 1e-5f) {
@@ -335,12 +329,10 @@ ConvertStraightToPremulOperation::ConvertStraightToPremulOperation() : ConvertBa
 	this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertStraightToPremulOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertStraightToPremulOperation::convertPixel(float output[4], const float inputValue[4])
 {
-	float inputValue[4];
 	float alpha;
 
-	this->m_inputOperation->readSampled(inputValue, x, y, sampler);
 	alpha = inputValue[3];
 
 	mul_v3_v3fl(output, inputValue, alpha);
@@ -357,6 +349,7 @@ SeparateChannelOperation::SeparateChannelOperation() : NodeOperation()
 	this->addInputSocket(COM_DT_COLOR);
 	this->addOutputSocket(COM_DT_VALUE);
 	this->m_inputOperation = NULL;
+	this->setPixelOperation(true);
 }
 void SeparateChannelOperation::initExecution()
 {
@@ -376,6 +369,15 @@ void SeparateChannelOperation::executePixelSampled(float output[4], float x, flo
 	output[0] = input[this->m_channel];
 }
 
+void SeparateChannelOperation::calculateRow(float *output, float *const *inputRows, int length)
+{
+	const float *input = inputRows[0];
+
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		output[i] = input[i + this->m_channel];
+	}
+}
+
 
 /* ******** Combine Channels ******** */
 
@@ -391,6 +393,7 @@ CombineChannelsOperation::CombineChannelsOperation() : NodeOperation()
 	this->m_inputChannel2Operation = NULL;
 	this->m_inputChannel3Operation = NULL;
 	this->m_inputChannel4Operation = NULL;
+	this->setPixelOperation(true);
 }
 
 void CombineChannelsOperation::initExecution()
@@ -430,3 +433,13 @@ void CombineChannelsOperation::executePixelSampled(float output[4], float x, flo
 		output[3] = input[0];
 	}
 }
+
+void CombineChannelsOperation::calculateRow(float *output, float *const *inputRows, int length)
+{
+	for (int channel = 0; channel < 4; channel++) {
+		const float *input = inputRows[channel];
+		for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+			output[i + channel] = input[i];
+		}
+	}
+}
@@ -29,10 +29,18 @@
 class ConvertBaseOperation : public NodeOperation {
 protected:
 	SocketReader *m_inputOperation;
+
+	/**
+	 * convert a single pixel from the already read input
+	 */
+	virtual void convertPixel(float output[4], const float input[4]) = 0;
 	
 public:
 	ConvertBaseOperation();
 	
+	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void calculateRow(float *output, float *const *inputRows, int length);
+
 	void initExecution();
 	void deinitExecution();
 };
@@ -42,7 +50,7 @@ class ConvertValueToColorOperation : public ConvertBaseOperation {
 public:
 	ConvertValueToColorOperation();
 	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void convertPixel(float output[4], const float input[4]);
 };
 
 
@@ -50,7 +58,7 @@ class ConvertColorToValueOperation : public ConvertBaseOperation {
 public:
 	ConvertColorToValueOperation();
 	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void convertPixel(float output[4], const float input[4]);
 };
 
 
@@ -58,7 +66,7 @@ class ConvertColorToBWOperation : public ConvertBaseOperation {
 public:
 	ConvertColorToBWOperation();
 	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void convertPixel(float output[4], const float input[4]);
 };
 
 
@@ -66,7 +74,7 @@ class ConvertColorToVectorOperation : public ConvertBaseOperation {
 public:
 	ConvertColorToVectorOperation();
 	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void convertPixel(float output[4], const float input[4]);
 };
 
 
@@ -74,7 +82,7 @@ class ConvertValueToVectorOperation : public ConvertBaseOperation {
 public:
 	ConvertValueToVectorOperation();
 	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void convertPixel(float output[4], const float input[4]);
 };
 
 
@@ -82,7 +90,7 @@ class ConvertVectorToColorOperation : public ConvertBaseOperation {
 public:
 	ConvertVectorToColorOperation();
 	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void convertPixel(float output[4], const float input[4]);
 };
 
 
@@ -90,7 +98,7 @@ class ConvertVectorToValueOperation : public ConvertBaseOperation {
 public:
 	ConvertVectorToValueOperation();
 	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void convertPixel(float output[4], const float input[4]);
 };
 
 
@@ -101,7 +109,7 @@ private:
 public:
 	ConvertRGBToYCCOperation();
 
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void convertPixel(float output[4], const float input[4]);
 
 	/** Set the YCC mode */
 	void setMode(int mode);
@@ -115,7 +123,7 @@ private:
 public:
 	ConvertYCCToRGBOperation();
 	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void convertPixel(float output[4], const float input[4]);
 	
 	/** Set the YCC mode */
 	void setMode(int mode);
@@ -126,7 +134,7 @@ class ConvertRGBToYUVOperation : public ConvertBaseOperation {
 public:
 	ConvertRGBToYUVOperation();
 	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void convertPixel(float output[4], const float input[4]);
 };
 
 
@@ -134,7 +142,7 @@ class ConvertYUVToRGBOperation : public ConvertBaseOperation {
 public:
 	ConvertYUVToRGBOperation();
 	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void convertPixel(float output[4], const float input[4]);
 };
 
 
@@ -142,7 +150,7 @@ class ConvertRGBToHSVOperation : public ConvertBaseOperation {
 public:
 	ConvertRGBToHSVOperation();
 	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void convertPixel(float output[4], const float input[4]);
 };
 
 
@@ -150,7 +158,7 @@ class ConvertHSVToRGBOperation : public ConvertBaseOperation {
 public:
 	ConvertHSVToRGBOperation();
 	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void convertPixel(float output[4], const float input[4]);
 };
 
 
@@ -158,7 +166,7 @@ class ConvertPremulToStraightOperation : public ConvertBaseOperation {
 public:
 	ConvertPremulToStraightOperation();
 
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void convertPixel(float output[4], const float input[4]);
 };
 
 
@@ -166,7 +174,7 @@ class ConvertStraightToPremulOperation : public ConvertBaseOperation {
 public:
 	ConvertStraightToPremulOperation();
 
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void convertPixel(float output[4], const float input[4]);
 };
 
 
@@ -177,6 +185,7 @@ private:
 public:
 	SeparateChannelOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void calculateRow(float *output, float *const *inputRows, int length);
 	
 	void initExecution();
 	void deinitExecution();
@@ -194,6 +203,7 @@ private:
 public:
 	CombineChannelsOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void calculateRow(float *output, float *const *inputRows, int length);
 	
 	void initExecution();
 	void deinitExecution();
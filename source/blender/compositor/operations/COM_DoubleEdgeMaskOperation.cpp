@@ -25,6 +25,11 @@
 #include "DNA_node_types.h"
 #include "MEM_guardedalloc.h"
 
+extern "C" {
+#  include "BLI_sys_types.h"
+#  include "BLI_task.h"
+}
+
 // this part has been copied from the double edge mask
 // Contributor(s): Peter Larabell.
 static void do_adjacentKeepBorders(unsigned int t, unsigned int rw, unsigned int *limask, unsigned int *lomask, unsigned int *lres, float *res, unsigned int *rsize)
@@ -889,144 +894,169 @@ static void do_adjacentEdgeDetection(unsigned int t, unsigned int rw, unsigned i
 	rsize[2] = in_gsz;
 }
 
-static void do_createEdgeLocationBuffer(unsigned int t, unsigned int rw, unsigned int *lres, float *res, unsigned short *gbuf, unsigned int *innerEdgeOffset, unsigned int *outerEdgeOffset, unsigned int isz, unsigned int gsz)
+typedef struct EdgeDistanceData {
+	unsigned int *lres;                // pixel flags, shares the memory of res
+	float *res;
+	unsigned int *idist;               // squared distance to the closest inside edge pixel
+	unsigned int *odist;               // squared distance to the closest outside edge pixel
+	int rw;                            // row width
+	int rh;                            // number of rows
+	bool has_inner;                    // there are inside edge pixels
+	bool has_outer;                    // there are outside edge pixels
+} EdgeDistanceData;
+
+/* Meijster's separation of the parabolas of rows i and u, rounded down */
+static int64_t edge_distance_separation(int64_t i, int64_t u, int64_t gi, int64_t gu)
 {
-	int x;                             // x = pixel loop counter
-	int a;                             // a = temporary pixel index buffer loop counter
-	unsigned int ud;                   // ud = unscaled edge distance
-	unsigned int dmin;                 // dmin = minimum edge distance
-	
-	unsigned int rsl;                  // long used for finding fast 1.0/sqrt
-	unsigned int gradientFillOffset;
-	unsigned int innerAccum = 0;       // for looping inner edge pixel indexes, represents current position from offset
-	unsigned int outerAccum = 0;       // for looping outer edge pixel indexes, represents current position from offset
-	unsigned int gradientAccum = 0;    // for looping gradient pixel indexes, represents current position from offset
-	/*
-	 * Here we compute the size of buffer needed to hold (row,col) coordinates
-	 * for each pixel previously determined to be either gradient, inner edge,
-	 * or outer edge.
-	 *
-	 * Allocation is done by requesting 4 bytes "sizeof(int)" per pixel, even
-	 * though gbuf[] is declared as (unsigned short *) (2 bytes) because we don't
-	 * store the pixel indexes, we only store x,y location of pixel in buffer.
-	 *
-	 * This does make the assumption that x and y can fit in 16 unsigned bits
-	 * so if Blender starts doing renders greater than 65536 in either direction
-	 * this will need to allocate gbuf[] as unsigned int *and allocate 8 bytes
-	 * per flagged pixel.
-	 *
-	 * In general, the buffer on-screen:
-	 *
-	 * Example:  9 by 9 pixel block
-	 *
-	 * . = pixel non-white in both outer and inner mask
-	 * o = pixel white in outer, but not inner mask, adjacent to "." pixel
-	 * g = pixel white in outer, but not inner mask, not adjacent to "." pixel
-	 * i = pixel white in inner mask, adjacent to "g" or "." pixel
-	 * F = pixel white in inner mask, only adjacent to other pixels white in the inner mask
-	 *
-	 *
-	 * .........   <----- pixel #80
-	 * ..oooo...
-	 * .oggggo..
-	 * .oggiggo.
-	 * .ogiFigo.
-	 * .oggiggo.
-	 * .oggggo..
-	 * ..oooo...
-	 * pixel #00 -----> .........
-	 *
-	 * gsz = 18   (18 "g" pixels above)
-	 * isz = 4    (4 "i" pixels above)
-	 * osz = 18   (18 "o" pixels above)
-	 *
-	 *
-	 * The memory in gbuf[] after filling will look like this:
-	 *
-	 * gradientFillOffset (0 pixels)                   innerEdgeOffset (18 pixels)    outerEdgeOffset (22 pixels)
-	 * /                                               /                              /
-	 * /                                               /                              /
-	 * |X   Y   X   Y   X   Y   X   Y   >     <X   Y   X   Y   >     <X   Y   X   Y   X   Y   >     <X   Y   X   Y   | <- (x,y)
-	 * +-------------------------------->     <---------------->     <------------------------>     <----------------+
-	 * |0   2   4   6   8   10  12  14  > ... <68  70  72  74  > ... <80  82  84  86  88  90  > ... <152 154 156 158 | <- bytes
-	 * +-------------------------------->     <---------------->     <------------------------>     <----------------+
-	 * |g0  g0  g1  g1  g2  g2  g3  g3  >     <g17 g17 i0  i0  >     <i2  i2  i3  i3  o0  o0  >     <o16 o16 o17 o17 | <- pixel
-	 *       /                              /                              /
-	 *      /                              /                              /
-	 *        /                              /                              /
-	 * +---------- gradientAccum (18) ---------+      +--- innerAccum (22) ---+      +--- outerAccum (40) ---+
-	 *
-	 *
-	 * Ultimately we do need the pixel's memory buffer index to set the output
-	 * pixel color, but it's faster to reconstruct the memory buffer location
-	 * each iteration of the final gradient calculation than it is to deconstruct
-	 * a memory location into x,y pairs each round.
-	 */
+	int64_t num = u * u - i * i + gu * gu - gi * gi;
+	int64_t den = 2 * (u - i);
+	return (num >= 0) ? num / den : -((-num + den - 1) / den);
+}
 
+/*
+ * Squared euclidean distance in a column, from the distances along the rows.
+ * This is the second phase of the exact distance transform by Meijster et al,
+ * the minimum of (y - i)^2 + g(i)^2 over all rows i.
+ */
+static void edge_distance_column(unsigned int *col, int rw, int rh, unsigned int no_edge, int *g, int *s, int *t)
+{
+	int q = 0;
+	int u;
 
-	gradientFillOffset = 0;                            // since there are likely "more" of these, put it first. :)
-	*innerEdgeOffset = gradientFillOffset + gsz;       // set start of inner edge indexes
-	*outerEdgeOffset = (*innerEdgeOffset) + isz;       // set start of outer edge indexes
-	/* set the accumulators to correct positions */    // set up some accumulator variables for loops
-	gradientAccum = gradientFillOffset;                // each accumulator variable starts at its respective
-	innerAccum = *innerEdgeOffset;                     // section's offset so when we start filling, each
-	outerAccum = *outerEdgeOffset;                     // section fills up it's allocated space in gbuf
-	//uses dmin=row, rsl=col
-	for (x = 0, dmin = 0; x < t; x += rw, dmin++) {
-		for (rsl = 0; rsl < rw; rsl++) {
-			a = x + rsl;
-			if (lres[a] == 2) {                  // it is a gradient pixel flagged by 2
-				ud = gradientAccum << 1;         // double the index to reach correct unsigned short location
-				gbuf[ud] = dmin;                 // insert pixel's row into gradient pixel location buffer
-				gbuf[ud + 1] = rsl;              // insert pixel's column into gradient pixel location buffer
-				gradientAccum++;                 // increment gradient index buffer pointer
-			}
-			else if (lres[a] == 3) {             // it is an outer edge pixel flagged by 3
-				ud = outerAccum << 1;            // double the index to reach correct unsigned short location
-				gbuf[ud] = dmin;                 // insert pixel's row into outer edge pixel location buffer
-				gbuf[ud + 1] = rsl;              // insert pixel's column into outer edge pixel location buffer
-				outerAccum++;                    // increment outer edge index buffer pointer
-				res[a] = 0.0f;                   // set output pixel intensity now since it won't change later
-			}
-			else if (lres[a] == 4) {             // it is an inner edge pixel flagged by 4
-				ud = innerAccum << 1;            // double int index to reach correct unsigned short location
-				gbuf[ud] = dmin;                 // insert pixel's row into inner edge pixel location buffer
-				gbuf[ud + 1] = rsl;              // insert pixel's column into inner edge pixel location buffer
-				innerAccum++;                    // increment inner edge index buffer pointer
-				res[a] = 1.0f;                   // set output pixel intensity now since it won't change later
+	for (u = 0; u < rh; u++) {
+		g[u] = col[u * rw];
+	}
+
+	s[0] = 0;
+	t[0] = 0;
+	for (u = 1; u < rh; u++) {
+		while (q >= 0 &&
+		       (int64_t)(t[q] - s[q]) * (t[q] - s[q]) + (int64_t)g[s[q]] * g[s[q]] >
+		       (int64_t)(t[q] - u) * (t[q] - u) + (int64_t)g[u] * g[u])
+		{
+			q--;
+		}
+		if (q < 0) {
+			q = 0;
+			s[0] = u;
+		}
+		else {
+			int64_t w = 1 + edge_distance_separation(s[q], u, g[s[q]], g[u]);
+			if (w < rh) {
+				q++;
+				s[q] = u;
+				t[q] = (int)w;
 			}
 		}
 	}
-	
+
+	for (u = rh - 1; u >= 0; u--) {
+		if (no_edge) {
+			col[u * rw] = no_edge;
+		}
+		else {
+			col[u * rw] = (unsigned int)((int64_t)(u - s[q]) * (u - s[q]) + (int64_t)g[s[q]] * g[s[q]]);
+		}
+		if (u == t[q]) {
+			q--;
+		}
+	}
 }
 
-static void do_fillGradientBuffer(unsigned int rw, float *res, unsigned short *gbuf, unsigned int isz, unsigned int osz, unsigned int gsz, unsigned int innerEdgeOffset, unsigned int outerEdgeOffset)
+/* distance along the row to the closest edge pixels */
+static void do_edgeDistanceRow(void *userdata, int y)
+{
+	EdgeDistanceData *data = (EdgeDistanceData *)userdata;
+	const int rw = data->rw;
+	const unsigned int inf = data->rw + data->rh;   // larger than any distance in the buffer
+	unsigned int *lres = &data->lres[y * rw];
+	float *res = &data->res[y * rw];
+	unsigned int *idist = &data->idist[y * rw];
+	unsigned int *odist = &data->odist[y * rw];
+	int x;
+
+	for (x = 0; x < rw; x++) {
+		idist[x] = (lres[x] == 4) ? 0 : ((x > 0) ? min(idist[x - 1] + 1, inf) : inf);
+		odist[x] = (lres[x] == 3) ? 0 : ((x > 0) ? min(odist[x - 1] + 1, inf) : inf);
+	}
+	for (x = rw - 2; x >= 0; x--) {
+		idist[x] = min(idist[x], idist[x + 1] + 1);
+		odist[x] = min(odist[x], odist[x + 1] + 1);
+	}
+
+	// set output pixel intensity of the edges now since it won't change later
+	for (x = 0; x < rw; x++) {
+		if (lres[x] == 3) {
+			res[x] = 0.0f;
+		}
+		else if (lres[x] == 4) {
+			res[x] = 1.0f;
+		}
+	}
+}
+
+static void do_edgeDistanceColumn(void *userdata, int x)
+{
+	EdgeDistanceData *data = (EdgeDistanceData *)userdata;
+	int *buffer = (int *)MEM_mallocN(sizeof(int) * data->rh * 3, "DEM column");
+
+	// without any edge pixels of a kind the distance is the largest possible
+	edge_distance_column(&data->idist[x], data->rw, data->rh, data->has_inner ? 0 : 0xffffffff,
+	                     buffer, buffer + data->rh, buffer + data->rh * 2);
+	edge_distance_column(&data->odist[x], data->rw, data->rh, data->has_outer ? 0 : 0xffffffff,
+	                     buffer, buffer + data->rh, buffer + data->rh * 2);
+
+	MEM_freeN(buffer);
+}
+
+/* fast approximate reciprocal square root of a sum of squares */
+static float edge_distance_inverse(unsigned int dmin)
 {
-	int x;                             // x = pixel loop counter
-	int a;                             // a = temporary pixel index buffer loop counter
-	int fsz;                           // size of the frame
 	unsigned int rsl;                  // long used for finding fast 1.0/sqrt
 	float rsf;                         // float used for finding fast 1.0/sqrt
 	const float rsopf = 1.5f;          // constant float used for finding fast 1.0/sqrt
-	
-	unsigned int gradientFillOffset;
-	unsigned int t;
-	unsigned int ud;                   // ud = unscaled edge distance
-	unsigned int dmin;                 // dmin = minimum edge distance
-	float odist;                       // odist = current outer edge distance
-	float idist;                       // idist = current inner edge distance
-	int dx;                            // dx = X-delta (used for distance proportion calculation)
-	int dy;                            // dy = Y-delta (used for distance proportion calculation)
-	
+	float dist = (float)(dmin);        // cast min to a float
+
+	rsf = dist * 0.5f;                 //
+	rsl = *(unsigned int *)&dist;      // use some peculiar properties of the way bits are stored
+	rsl = 0x5f3759df - (rsl >> 1);     // in floats vs. unsigned ints to compute an approximate
+	dist = *(float *)&rsl;             // reciprocal square root
+	return dist * (rsopf - (rsf * dist * dist));   // -- ** this line can be iterated for more accuracy ** --
+}
+
+static void do_fillGradientRow(void *userdata, int y)
+{
+	EdgeDistanceData *data = (EdgeDistanceData *)userdata;
+	const int rw = data->rw;
+	unsigned int *lres = &data->lres[y * rw];
+	float *res = &data->res[y * rw];
+	const unsigned int *idist = &data->idist[y * rw];
+	const unsigned int *odist = &data->odist[y * rw];
+
+	for (int x = 0; x < rw; x++) {
+		if (lres[x] == 2) {                  // it is a gradient pixel flagged by 2
+			float o = edge_distance_inverse(odist[x]);
+			float i = edge_distance_inverse(idist[x]);
+			/*
+			 * Note once again that since we are using reciprocals of distance values our
+			 * proportion is already the correct intensity, and does not need to be
+			 * subtracted from 1.0 like it would have if we used real distances.
+			 */
+			res[x] = (i / (i + o));          // set intensity
+		}
+	}
+}
+
+static void do_fillGradientBuffer(unsigned int rw, unsigned int rh, unsigned int *lres, float *res, unsigned int isz, unsigned int osz)
+{
 	/*
 	 * The general algorithm used to color each gradient pixel is:
 	 *
-	 * 1.) Loop through all gradient pixels.
+	 * 1.) Compute the distance to the closest outside edge pixel and to the
+	 * closest inside edge pixel for every pixel. This is an exact euclidean
+	 * distance transform, separated in a pass along the rows and a pass along
+	 * the columns. The rows and columns are processed in parallel.
 	 * A.) For each gradient pixel:
-	 * a.) Loop though all outside edge pixels, looking for closest one
-	 * to the gradient pixel we are in.
-	 * b.) Loop through all inside edge pixels, looking for closest one
-	 * to the gradient pixel we are in.
 	 * c.) Find proportion of distance from gradient pixel to inside edge
 	 * pixel compared to sum of distance to inside edge and distance to
 	 * outside edge.
@@ -1073,59 +1103,24 @@ static void do_fillGradientBuffer(unsigned int rw, float *res, unsigned short *g
 	 * For the purposes of the minimum distance comparisons, we only check
 	 * the sums-of-squares against eachother, since they are in the same
 	 * mathematical sort-order as if we did go ahead and take square roots
-	 *
-	 * Loop through all gradient pixels.
 	 */
 
-	for (x = gsz - 1; x >= 0; x--) {
-		gradientFillOffset = x << 1;
-		t = gbuf[gradientFillOffset];            // calculate column of pixel indexed by gbuf[x]
-		fsz = gbuf[gradientFillOffset + 1];      // calculate row of pixel indexed by gbuf[x]
-		dmin = 0xffffffff;                       // reset min distance to edge pixel
-		for (a = outerEdgeOffset + osz - 1; a >= outerEdgeOffset; a--) {   // loop through all outer edge buffer pixels
-			ud = a << 1;
-			dy = t - gbuf[ud];                   // set dx to gradient pixel column - outer edge pixel row
-			dx = fsz - gbuf[ud + 1];             // set dy to gradient pixel row - outer edge pixel column
-			ud = dx * dx + dy * dy;              // compute sum of squares
-			if (ud < dmin) {                     // if our new sum of squares is less than the current minimum
-				dmin = ud;                       // set a new minimum equal to the new lower value
-			}
-		}
-		odist = (float)(dmin);                   // cast outer min to a float
-		rsf = odist * 0.5f;                      //
-		rsl = *(unsigned int *)&odist;           // use some peculiar properties of the way bits are stored
-		rsl = 0x5f3759df - (rsl >> 1);           // in floats vs. unsigned ints to compute an approximate
-		odist = *(float *)&rsl;                  // reciprocal square root
-		odist = odist * (rsopf - (rsf * odist * odist));   // -- ** this line can be iterated for more accuracy ** --
-		dmin = 0xffffffff;                       // reset min distance to edge pixel
-		for (a = innerEdgeOffset + isz - 1; a >= innerEdgeOffset; a--) {   // loop through all inside edge pixels
-			ud = a << 1;
-			dy = t - gbuf[ud];         // compute delta in Y from gradient pixel to inside edge pixel
-			dx = fsz - gbuf[ud + 1];     // compute delta in X from gradient pixel to inside edge pixel
-			ud = dx * dx + dy * dy;        // compute sum of squares
-			if (ud < dmin) {          // if our new sum of squares is less than the current minimum we've found
-				dmin = ud;           // set a new minimum equal to the new lower value
-			}
-		}
-		idist = (float)(dmin);                   // cast inner min to a float
-		rsf = idist * 0.5f;                      //
-		rsl = *(unsigned int *)&idist;           //
-		rsl = 0x5f3759df - (rsl >> 1);           // see notes above
-		idist = *(float *)&rsl;                  //
-		idist = idist * (rsopf - (rsf * idist * idist));   //
-		/*
-		 * Note once again that since we are using reciprocals of distance values our
-		 * proportion is already the correct intensity, and does not need to be
-		 * subtracted from 1.0 like it would have if we used real distances.
-		 */
-		
-		/*
-		 * Here we reconstruct the pixel's memory location in the CompBuf by
-		 * Pixel Index = Pixel Column + ( Pixel Row * Row Width )
-		 */
-		res[gbuf[gradientFillOffset + 1] + (gbuf[gradientFillOffset] * rw)] = (idist / (idist + odist));    //set intensity
-	}
-	
+	EdgeDistanceData data;
+	data.lres = lres;
+	data.res = res;
+	data.idist = (unsigned int *)MEM_mallocN(sizeof(unsigned int) * rw * rh, "DEM inner distance");
+	data.odist = (unsigned int *)MEM_mallocN(sizeof(unsigned int) * rw * rh, "DEM outer distance");
+	data.rw = rw;
+	data.rh = rh;
+	data.has_inner = (isz != 0);
+	data.has_outer = (osz != 0);
+
+	BLI_task_parallel_range(0, rh, &data, do_edgeDistanceRow);
+	BLI_task_parallel_range(0, rw, &data, do_edgeDistanceColumn);
+	BLI_task_parallel_range(0, rh, &data, do_fillGradientRow);
+
+	MEM_freeN(data.idist);
+	MEM_freeN(data.odist);
 }
 
 // end of copy
@@ -1138,16 +1133,10 @@ void DoubleEdgeMaskOperation::doDoubleEdgeMask(float *imask, float *omask, float
 	
 	int rw;                            // rw = pixel row width
 	int t;                             // t = total number of pixels in buffer - 1 (used for loop starts)
-	int fsz;                           // size of the frame
-	
 	unsigned int isz = 0;                // size (in pixels) of inside edge pixel index buffer
 	unsigned int osz = 0;                // size (in pixels) of outside edge pixel index buffer
 	unsigned int gsz = 0;                // size (in pixels) of gradient pixel index buffer
 	unsigned int rsize[3];               // size storage to pass to helper functions
-	unsigned int innerEdgeOffset = 0;    // offset into final buffer where inner edge pixel indexes start
-	unsigned int outerEdgeOffset = 0;    // offset into final buffer where outer edge pixel indexes start
-	
-	unsigned short *gbuf;              // gradient/inner/outer pixel location index buffer
 	
 	if (true) {                    // if both input sockets have some data coming in...
 		
@@ -1215,13 +1204,7 @@ void DoubleEdgeMaskOperation::doDoubleEdgeMask(float *imask, float *omask, float
 		osz = rsize[1];                          // the sizes in rsize[] may have been modified
 		gsz = rsize[2];                          // by the do_*EdgeDetection() function.
 		
-		fsz = gsz + isz + osz;                                   // calculate size of pixel index buffer needed
-		gbuf = (unsigned short *)MEM_callocN(sizeof(unsigned short) * fsz * 2, "DEM"); // allocate edge/gradient pixel index buffer
-		
-		do_createEdgeLocationBuffer(t, rw, lres, res, gbuf, &innerEdgeOffset, &outerEdgeOffset, isz, gsz);
-		do_fillGradientBuffer(rw, res, gbuf, isz, osz, gsz, innerEdgeOffset, outerEdgeOffset);
-		
-		MEM_freeN(gbuf);                         // free the gradient index buffer
+		do_fillGradientBuffer(rw, this->getHeight(), lres, res, isz, osz);
 	}
 }
 
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2011, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor:
+ *		Jeroen Bakker
+ *		Monique Dewanchand
+ */
+
+#ifndef _COM_FHTConvolution_h
+#define _COM_FHTConvolution_h
+
+#include "COM_MemoryBuffer.h"
+
+/**
+ * @brief convolve an image with a kernel using the 2D Fast Hartley Transform
+ *
+ * The image is convolved in blocks (overlap-add), so the transform size depends on the kernel size only.
+ * The center of the kernel is at (kernel width / 2, kernel height / 2).
+ * The kernel is not normalized.
+ *
+ * @param dst result, image width * image height pixels of COM_NUMBER_OF_CHANNELS floats,
+ *        channels that are not convolved are zero
+ * @param image the image to convolve, its rect must start at 0, 0
+ * @param kernel the convolution kernel, channel n of the image is convolved with channel n of the kernel
+ * @param num_channels the number of channels to convolve
+ */
+void FHT_convolve(float *dst, MemoryBuffer *image, MemoryBuffer *kernel, unsigned int num_channels);
+
+#endif
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2015, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+
+#include "COM_FusedOperation.h"
+
+FusedOperation::FusedOperation(const Operations &operations) : NodeOperation()
+{
+	const int totops = operations.size();
+	this->m_operations = operations;
+
+	/* every output of a not fused operation that is read becomes a single input */
+	for (int index = 0; index < totops; index++) {
+		NodeOperation *operation = operations[index];
+		BLI_assert(operation->isPixelOperation());
+		BLI_assert(operation->getNumberOfInputSockets() <= COM_PIXEL_OPERATION_MAX_INPUTS);
+
+		for (unsigned int socket = 0; socket < operation->getNumberOfInputSockets(); socket++) {
+			NodeOperationOutput *link = operation->getInputSocket(socket)->getLink();
+			BLI_assert(link != NULL);
+
+			if (std::find(operations.begin(), operations.begin() + index, &link->getOperation()) != operations.begin() + index)
+				continue;
+
+			if (std::find(this->m_inputLinks.begin(), this->m_inputLinks.end(), link) == this->m_inputLinks.end()) {
+				this->m_inputLinks.push_back(link);
+				this->addInputSocket(link->getDataType(), COM_SC_NO_RESIZE);
+			}
+		}
+	}
+
+	/* rows of the fused operations start after the input rows */
+	const int totinputs = this->m_inputLinks.size();
+	BLI_assert(totinputs + totops - 1 <= COM_FUSED_MAX_ROWS);
+
+	this->m_inputRows.resize(totops * COM_PIXEL_OPERATION_MAX_INPUTS, 0);
+	for (int index = 0; index < totops; index++) {
+		NodeOperation *operation = operations[index];
+
+		for (unsigned int socket = 0; socket < operation->getNumberOfInputSockets(); socket++) {
+			NodeOperationOutput *link = operation->getInputSocket(socket)->getLink();
+			Operations::const_iterator op_it = std::find(operations.begin(), operations.begin() + index, &link->getOperation());
+			int row;
+
+			if (op_it != operations.begin() + index)
+				row = totinputs + (op_it - operations.begin());
+			else
+				row = std::find(this->m_inputLinks.begin(), this->m_inputLinks.end(), link) - this->m_inputLinks.begin();
+
+			this->m_inputRows[index * COM_PIXEL_OPERATION_MAX_INPUTS + socket] = row;
+		}
+	}
+
+	NodeOperation *outputOperation = operations.back();
+	this->addOutputSocket(outputOperation->getOutputSocket()->getDataType());
+
+	unsigned int resolution[2] = {outputOperation->getWidth(), outputOperation->getHeight()};
+	this->setResolution(resolution);
+	this->setRowOperation(true);
+}
+
+FusedOperation::~FusedOperation()
+{
+	for (unsigned int index = 0; index < this->m_operations.size(); index++) {
+		delete this->m_operations[index];
+	}
+}
+
+void FusedOperation::initExecution()
+{
+	this->m_inputReaders.resize(this->getNumberOfInputSockets());
+	for (unsigned int index = 0; index < this->getNumberOfInputSockets(); index++) {
+		this->m_inputReaders[index] = this->getInputSocketReader(index);
+	}
+	for (unsigned int index = 0; index < this->m_operations.size(); index++) {
+		this->m_operations[index]->initExecution();
+	}
+}
+
+void FusedOperation::deinitExecution()
+{
+	for (unsigned int index = 0; index < this->m_operations.size(); index++) {
+		this->m_operations[index]->deinitExecution();
+	}
+	this->m_inputReaders.clear();
+}
+
+void FusedOperation::calculateOperations(float *output, float *const *rows, int length)
+{
+	const int totops = this->m_operations.size();
+	const int totinputs = this->m_inputReaders.size();
+	float *inputRows[COM_PIXEL_OPERATION_MAX_INPUTS];
+
+	for (int index = 0; index < totops; index++) {
+		NodeOperation *operation = this->m_operations[index];
+		const int *rowIndices = &this->m_inputRows[index * COM_PIXEL_OPERATION_MAX_INPUTS];
+
+		for (unsigned int socket = 0; socket < operation->getNumberOfInputSockets(); socket++) {
+			inputRows[socket] = rows[rowIndices[socket]];
+		}
+
+		/* the last operation writes the result directly */
+		float *result = (index == totops - 1) ? output : rows[totinputs + index];
+		COM_PROFILE_SCOPE(operation, length);
+		operation->calculateRow(result, inputRows, length);
+	}
+}
+
+void FusedOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+{
+	float pixels[COM_FUSED_MAX_ROWS][COM_NUMBER_OF_CHANNELS];
+	float *rows[COM_FUSED_MAX_ROWS];
+
+	for (int index = 0; index < COM_FUSED_MAX_ROWS; index++) {
+		rows[index] = pixels[index];
+	}
+	for (unsigned int index = 0; index < this->m_inputReaders.size(); index++) {
+		this->m_inputReaders[index]->readSampled(rows[index], x, y, sampler);
+	}
+
+	calculateOperations(output, rows, 1);
+}
+
+void FusedOperation::executeRow(float *output, int x, int y, int length)
+{
+	float buffers[COM_FUSED_MAX_ROWS][COM_ROW_LENGTH * COM_NUMBER_OF_CHANNELS];
+	float *rows[COM_FUSED_MAX_ROWS];
+
+	for (int index = 0; index < COM_FUSED_MAX_ROWS; index++) {
+		rows[index] = buffers[index];
+	}
+	for (unsigned int index = 0; index < this->m_inputReaders.size(); index++) {
+		this->m_inputReaders[index]->readRow(rows[index], x, y, length);
+	}
+
+	calculateOperations(output, rows, length);
+}
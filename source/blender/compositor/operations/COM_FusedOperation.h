@@ -0,0 +1,95 @@
+/*
+ * Copyright 2015, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_FusedOperation_h
+#define _COM_FusedOperation_h
+
+#include <vector>
+
+#include "COM_NodeOperation.h"
+
+/**
+ * @brief calculates a connected set of pixel operations as a single operation
+ *
+ * The fused operations are owned by this operation and are not part of the ExecutionSystem.
+ * Per row the inputs are read once, then every fused operation calculates its row from the
+ * rows of the operations before it. Intermediate rows are kept on the stack, so an operation
+ * that is used by multiple fused operations is only calculated once.
+ * @see NodeOperation.isPixelOperation
+ * @see NodeOperationBuilder.fuse_pixel_operations
+ */
+class FusedOperation : public NodeOperation {
+public:
+	typedef std::vector<NodeOperation *> Operations;
+
+private:
+	/**
+	 * @brief the fused operations in execution order, the last one calculates the output
+	 */
+	Operations m_operations;
+
+	/**
+	 * @brief per input socket the output of a not fused operation that is read
+	 */
+	std::vector<NodeOperationOutput *> m_inputLinks;
+
+	/**
+	 * @brief per fused operation COM_PIXEL_OPERATION_MAX_INPUTS row indices, one for every input
+	 * the first rows are the inputs of this operation, followed by a row per fused operation.
+	 */
+	std::vector<int> m_inputRows;
+
+	/**
+	 * @brief cached readers of the input sockets
+	 */
+	std::vector<SocketReader *> m_inputReaders;
+
+	/**
+	 * @brief calculate all fused operations, the input rows must already be read
+	 */
+	void calculateOperations(float *output, float *const *rows, int length);
+
+public:
+	/**
+	 * @brief fuse operations
+	 * @param operations pixel operations in topological order, the last one is the output.
+	 * all outputs except the last one may only be used by the other operations.
+	 */
+	FusedOperation(const Operations &operations);
+	~FusedOperation();
+
+	void initExecution();
+	void deinitExecution();
+
+	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int length);
+
+	bool isFusedOperation() const { return true; }
+
+	/**
+	 * @brief the fused operations in execution order
+	 */
+	const Operations &getFusedOperations() const { return this->m_operations; }
+
+	/**
+	 * @brief the output the input socket has to be linked to
+	 */
+	NodeOperationOutput *getInputLink(unsigned int index) const { return this->m_inputLinks[index]; }
+};
+
+#endif
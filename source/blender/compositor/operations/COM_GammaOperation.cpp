@@ -30,6 +30,7 @@ GammaOperation::GammaOperation() : NodeOperation()
 	this->addOutputSocket(COM_DT_COLOR);
 	this->m_inputProgram = NULL;
 	this->m_inputGammaProgram = NULL;
+	this->setPixelOperation(true);
 }
 void GammaOperation::initExecution()
 {
@@ -44,13 +45,24 @@ void GammaOperation::executePixelSampled(float output[4], float x, float y, Pixe
 	
 	this->m_inputProgram->readSampled(inputValue, x, y, sampler);
 	this->m_inputGammaProgram->readSampled(inputGamma, x, y, sampler);
-	const float gamma = inputGamma[0];
-	/* check for negative to avoid nan's */
-	output[0] = inputValue[0] > 0.0f ? powf(inputValue[0], gamma) : inputValue[0];
-	output[1] = inputValue[1] > 0.0f ? powf(inputValue[1], gamma) : inputValue[1];
-	output[2] = inputValue[2] > 0.0f ? powf(inputValue[2], gamma) : inputValue[2];
-	
-	output[3] = inputValue[3];
+
+	float *inputRows[2] = {inputValue, inputGamma};
+	calculateRow(output, inputRows, 1);
+}
+
+void GammaOperation::calculateRow(float *output, float *const *inputRows, int length)
+{
+	const float *inputValue = inputRows[0];
+	const float *inputGamma = inputRows[1];
+
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		const float gamma = inputGamma[i];
+		/* check for negative to avoid nan's */
+		output[i + 0] = inputValue[i + 0] > 0.0f ? powf(inputValue[i + 0], gamma) : inputValue[i + 0];
+		output[i + 1] = inputValue[i + 1] > 0.0f ? powf(inputValue[i + 1], gamma) : inputValue[i + 1];
+		output[i + 2] = inputValue[i + 2] > 0.0f ? powf(inputValue[i + 2], gamma) : inputValue[i + 2];
+		output[i + 3] = inputValue[i + 3];
+	}
 }
 
 void GammaOperation::deinitExecution()
@@ -125,6 +125,38 @@ void GaussianXBlurOperation::executePixel(float output[4], int x, int y, void *d
 	mul_v4_v4fl(output, color_accum, 1.0f / multiplier_accum);
 }
 
+void GaussianXBlurOperation::executeTileRow(float *output, int x, int y, int length, void *data)
+{
+	MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
+	rcti &rect = *inputBuffer->getRect();
+
+	if (getStep() != 1 || y < rect.ymin || y >= rect.ymax) {
+		NodeOperation::executeTileRow(output, x, y, length, data);
+		return;
+	}
+
+	/* pixels with the full filter inside the buffer are calculated as a run, the others clip the filter */
+	const int interior_xmin = rect.xmin + this->m_filtersize;
+	const int interior_xmax = rect.xmax - this->m_filtersize;
+	const float *buffer_row = inputBuffer->getBuffer() + (y - rect.ymin) * inputBuffer->getWidth() * COM_NUMBER_OF_CHANNELS;
+	int px = x;
+	const int end = x + length;
+
+	while (px < end) {
+		float *out = &output[(px - x) * COM_NUMBER_OF_CHANNELS];
+		if (px < interior_xmin || px >= interior_xmax) {
+			executePixel(out, px, y, data);
+			px++;
+		}
+		else {
+			const int run = min_ii(end, interior_xmax) - px;
+			const float *src = &buffer_row[(px - this->m_filtersize - rect.xmin) * COM_NUMBER_OF_CHANNELS];
+			blur_row(out, src, run, COM_NUMBER_OF_CHANNELS, this->m_gausstab, this->m_filtersize * 2 + 1);
+			px += run;
+		}
+	}
+}
+
 void GaussianXBlurOperation::executeOpenCL(OpenCLDevice *device,
                                            MemoryBuffer *outputMemoryBuffer, cl_mem clOutputBuffer,
                                            MemoryBuffer **inputMemoryBuffers, list<cl_mem> *clMemToCleanUp,
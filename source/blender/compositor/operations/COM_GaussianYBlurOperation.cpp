@@ -127,6 +127,27 @@ void GaussianYBlurOperation::executePixel(float output[4], int x, int y, void *d
 	mul_v4_v4fl(output, color_accum, 1.0f / multiplier_accum);
 }
 
+void GaussianYBlurOperation::executeTileRow(float *output, int x, int y, int length, void *data)
+{
+	MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
+	rcti &rect = *inputBuffer->getRect();
+
+	/* only rows with the full filter inside the buffer are calculated as a run */
+	if (getStep() != 1 ||
+	    x < rect.xmin || x + length > rect.xmax ||
+	    y - this->m_filtersize < rect.ymin || y + this->m_filtersize >= rect.ymax)
+	{
+		NodeOperation::executeTileRow(output, x, y, length, data);
+		return;
+	}
+
+	const int row_offset = inputBuffer->getWidth() * COM_NUMBER_OF_CHANNELS;
+	const float *src = inputBuffer->getBuffer() +
+	                   (y - this->m_filtersize - rect.ymin) * row_offset +
+	                   (x - rect.xmin) * COM_NUMBER_OF_CHANNELS;
+	blur_row(output, src, length, row_offset, this->m_gausstab, this->m_filtersize * 2 + 1);
+}
+
 void GaussianYBlurOperation::executeOpenCL(OpenCLDevice *device,
                                            MemoryBuffer *outputMemoryBuffer, cl_mem clOutputBuffer,
                                            MemoryBuffer **inputMemoryBuffers, list<cl_mem> *clMemToCleanUp,
@@ -23,6 +23,7 @@
 #include "COM_GlareGhostOperation.h"
 #include "BLI_math.h"
 #include "COM_FastGaussianBlurOperation.h"
+#include "BLI_task.h"
 
 static float smoothMask(float x, float y)
 {
@@ -37,13 +38,73 @@ static float smoothMask(float x, float y)
 	}
 }
 
+typedef struct GhostPass {
+	MemoryBuffer *gbuf;
+	MemoryBuffer *tbuf1;
+	MemoryBuffer *tbuf2;
+	int n;
+	const float *scalef;
+	const fRGB *cm;
+} GhostPass;
+
+/* ghosts of the blurred buffers, written to gbuf */
+static void ghost_first_row(void *userdata, int y)
+{
+	const GhostPass *pass = (const GhostPass *)userdata;
+	MemoryBuffer *gbuf = pass->gbuf;
+	const float sc = 2.13f, isc = -0.97f;
+	const float v = ((float)y + 0.5f) / (float)gbuf->getHeight();
+	float u, s, t, sm;
+	fRGB c, tc;
+
+	for (int x = 0; x < gbuf->getWidth(); x++) {
+		u = ((float)x + 0.5f) / (float)gbuf->getWidth();
+		s = (u - 0.5f) * sc + 0.5f, t = (v - 0.5f) * sc + 0.5f;
+		pass->tbuf1->readBilinear(c, s * gbuf->getWidth(), t * gbuf->getHeight());
+		sm = smoothMask(s, t);
+		mul_v3_fl(c, sm);
+		s = (u - 0.5f) * isc + 0.5f, t = (v - 0.5f) * isc + 0.5f;
+		pass->tbuf2->readBilinear(tc, s * gbuf->getWidth() - 0.5f, t * gbuf->getHeight() - 0.5f);
+		sm = smoothMask(s, t);
+		madd_v3_v3fl(c, tc, sm);
+
+		gbuf->writePixel(x, y, c);
+	}
+}
+
+/* scaled copies of gbuf, added to tbuf1 */
+static void ghost_iteration_row(void *userdata, int y)
+{
+	const GhostPass *pass = (const GhostPass *)userdata;
+	MemoryBuffer *gbuf = pass->gbuf;
+	const float v = ((float)y + 0.5f) / (float)gbuf->getHeight();
+	float u, s, t, sm;
+	fRGB c, tc;
+	int p, np;
+
+	for (int x = 0; x < gbuf->getWidth(); x++) {
+		u = ((float)x + 0.5f) / (float)gbuf->getWidth();
+		tc[0] = tc[1] = tc[2] = tc[3] = 0.f;
+		for (p = 0; p < 4; p++) {
+			np = (pass->n << 2) + p;
+			s = (u - 0.5f) * pass->scalef[np] + 0.5f;
+			t = (v - 0.5f) * pass->scalef[np] + 0.5f;
+			gbuf->readBilinear(c, s * gbuf->getWidth() - 0.5f, t * gbuf->getHeight() - 0.5f);
+			mul_v3_v3(c, pass->cm[np]);
+			sm = smoothMask(s, t) * 0.25f;
+			madd_v3_v3fl(tc, c, sm);
+		}
+		pass->tbuf1->addPixel(x, y, tc);
+	}
+}
+
 void GlareGhostOperation::generateGlare(float *data, MemoryBuffer *inputTile, NodeGlare *settings)
 {
 	const int qt = 1 << settings->quality;
 	const float s1 = 4.f / (float)qt, s2 = 2.f * s1;
-	int x, y, n, p, np;
-	fRGB c, tc, cm[64];
-	float sc, isc, u, v, sm, s, t, ofs, scalef[64];
+	int x, y, n;
+	fRGB cm[64];
+	float ofs, scalef[64];
 	const float cmo = 1.f - settings->colmod;
 
 	MemoryBuffer *gbuf = inputTile->duplicate();
@@ -76,47 +137,25 @@ void GlareGhostOperation::generateGlare(float *data, MemoryBuffer *inputTile, No
 		if (x & 1) scalef[x] = -0.99f / scalef[x];
 	}
 
-	sc = 2.13;
-	isc = -0.97;
-	for (y = 0; y < gbuf->getHeight() && (!breaked); y++) {
-		v = ((float)y + 0.5f) / (float)gbuf->getHeight();
-		for (x = 0; x < gbuf->getWidth(); x++) {
-			u = ((float)x + 0.5f) / (float)gbuf->getWidth();
-			s = (u - 0.5f) * sc + 0.5f, t = (v - 0.5f) * sc + 0.5f;
-			tbuf1->readBilinear(c, s * gbuf->getWidth(), t * gbuf->getHeight());
-			sm = smoothMask(s, t);
-			mul_v3_fl(c, sm);
-			s = (u - 0.5f) * isc + 0.5f, t = (v - 0.5f) * isc + 0.5f;
-			tbuf2->readBilinear(tc, s * gbuf->getWidth() - 0.5f, t * gbuf->getHeight() - 0.5f);
-			sm = smoothMask(s, t);
-			madd_v3_v3fl(c, tc, sm);
-
-			gbuf->writePixel(x, y, c);
-		}
-		if (isBreaked()) breaked = true;
+	/* every pass reads other buffers than it writes, the rows are calculated in parallel */
+	GhostPass pass;
+	pass.gbuf = gbuf;
+	pass.tbuf1 = tbuf1;
+	pass.tbuf2 = tbuf2;
+	pass.n = 0;
+	pass.scalef = scalef;
+	pass.cm = cm;
 
+	if (!breaked) {
+		BLI_task_parallel_range(0, gbuf->getHeight(), &pass, ghost_first_row);
+		if (isBreaked()) breaked = true;
 	}
 
 	memset(tbuf1->getBuffer(), 0, tbuf1->getWidth() * tbuf1->getHeight() * COM_NUMBER_OF_CHANNELS * sizeof(float));
 	for (n = 1; n < settings->iter && (!breaked); n++) {
-		for (y = 0; y < gbuf->getHeight() && (!breaked); y++) {
-			v = ((float)y + 0.5f) / (float)gbuf->getHeight();
-			for (x = 0; x < gbuf->getWidth(); x++) {
-				u = ((float)x + 0.5f) / (float)gbuf->getWidth();
-				tc[0] = tc[1] = tc[2] = 0.f;
-				for (p = 0; p < 4; p++) {
-					np = (n << 2) + p;
-					s = (u - 0.5f) * scalef[np] + 0.5f;
-					t = (v - 0.5f) * scalef[np] + 0.5f;
-					gbuf->readBilinear(c, s * gbuf->getWidth() - 0.5f, t * gbuf->getHeight() - 0.5f);
-					mul_v3_v3(c, cm[np]);
-					sm = smoothMask(s, t) * 0.25f;
-					madd_v3_v3fl(tc, c, sm);
-				}
-				tbuf1->addPixel(x, y, tc);
-			}
-			if (isBreaked()) breaked = true;
-		}
+		pass.n = n;
+		BLI_task_parallel_range(0, gbuf->getHeight(), &pass, ghost_iteration_row);
+		if (isBreaked()) breaked = true;
 		memcpy(gbuf->getBuffer(), tbuf1->getBuffer(), tbuf1->getWidth() * tbuf1->getHeight() * COM_NUMBER_OF_CHANNELS * sizeof(float));
 	}
 	memcpy(data, gbuf->getBuffer(), gbuf->getWidth() * gbuf->getHeight() * COM_NUMBER_OF_CHANNELS * sizeof(float));
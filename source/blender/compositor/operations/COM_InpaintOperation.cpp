@@ -26,6 +26,10 @@
 #include "COM_OpenCLDevice.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
+
+/* fewer pixels of one distance are filled without tasks */
+#define INPAINT_PARALLEL_MIN_PIXELS 16384
 
 #define ASSERT_XY_RANGE(x, y)  \
 	BLI_assert(x >= 0 && x < this->getWidth() && \
@@ -96,26 +100,6 @@ int InpaintSimpleOperation::mdist(int x, int y)
 	return this->m_manhatten_distance[y * width + x];
 }
 
-bool InpaintSimpleOperation::next_pixel(int &x, int &y, int & curr, int iters)
-{
-	int width = this->getWidth();
-
-	if (curr >= this->m_area_size) {
-		return false;
-	}
-	
-	int r = this->m_pixelorder[curr++];
-
-	x = r % width;
-	y = r / width;
-
-	if (this->mdist(x, y) > iters) {
-		return false;
-	}
-	
-	return true;
-}
-
 void InpaintSimpleOperation::calc_manhatten_distance() 
 {
 	int width = this->getWidth();
@@ -215,6 +199,15 @@ void InpaintSimpleOperation::pix_step(int x, int y)
 	}
 }
 
+void InpaintSimpleOperation::pix_step_task(void *userdata, int index)
+{
+	InpaintSimpleOperation *operation = (InpaintSimpleOperation *)userdata;
+	int width = operation->getWidth();
+	int r = operation->m_pixelorder[index];
+
+	operation->pix_step(r % width, r / width);
+}
+
 void *InpaintSimpleOperation::initializeTileData(rcti *rect)
 {
 	if (this->m_cached_buffer_ready) {
@@ -227,12 +220,22 @@ void *InpaintSimpleOperation::initializeTileData(rcti *rect)
 
 		this->calc_manhatten_distance();
 
+		/* pixels only read pixels that are closer to the opaque pixels,
+		 * so all pixels with the same distance can be filled in parallel.
+		 * most distances only have a few pixels, tasks cost more than they gain there */
 		int curr = 0;
-		int x, y;
+		while (curr < this->m_area_size) {
+			const int d = this->m_manhatten_distance[this->m_pixelorder[curr]];
+			if (d > this->m_iterations) {
+				break;
+			}
 
-	
-		while (this->next_pixel(x, y, curr, this->m_iterations)) {
-			this->pix_step(x, y);
+			int end = curr + 1;
+			while (end < this->m_area_size && this->m_manhatten_distance[this->m_pixelorder[end]] == d) {
+				end++;
+			}
+			BLI_task_parallel_range_ex(curr, end, this, pix_step_task, INPAINT_PARALLEL_MIN_PIXELS, false);
+			curr = end;
 		}
 		this->m_cached_buffer_ready = true;
 	}
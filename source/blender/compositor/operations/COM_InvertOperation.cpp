@@ -32,6 +32,7 @@ InvertOperation::InvertOperation() : NodeOperation()
 	this->m_color = true;
 	this->m_alpha = false;
 	setResolutionInputSocketIndex(1);
+	this->setPixelOperation(true);
 }
 void InvertOperation::initExecution()
 {
@@ -45,24 +46,34 @@ void InvertOperation::executePixelSampled(float output[4], float x, float y, Pix
 	float inputColor[4];
 	this->m_inputValueProgram->readSampled(inputValue, x, y, sampler);
 	this->m_inputColorProgram->readSampled(inputColor, x, y, sampler);
-	
-	const float value = inputValue[0];
-	const float invertedValue = 1.0f - value;
-	
-	if (this->m_color) {
-		output[0] = (1.0f - inputColor[0]) * value + inputColor[0] * invertedValue;
-		output[1] = (1.0f - inputColor[1]) * value + inputColor[1] * invertedValue;
-		output[2] = (1.0f - inputColor[2]) * value + inputColor[2] * invertedValue;
-	}
-	else {
-		copy_v3_v3(output, inputColor);
-	}
-	
-	if (this->m_alpha)
-		output[3] = (1.0f - inputColor[3]) * value + inputColor[3] * invertedValue;
-	else
-		output[3] = inputColor[3];
 
+	float *inputRows[2] = {inputValue, inputColor};
+	calculateRow(output, inputRows, 1);
+}
+
+void InvertOperation::calculateRow(float *output, float *const *inputRows, int length)
+{
+	const float *inputValue = inputRows[0];
+	const float *inputColor = inputRows[1];
+
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		const float value = inputValue[i];
+		const float invertedValue = 1.0f - value;
+
+		if (this->m_color) {
+			output[i + 0] = (1.0f - inputColor[i + 0]) * value + inputColor[i + 0] * invertedValue;
+			output[i + 1] = (1.0f - inputColor[i + 1]) * value + inputColor[i + 1] * invertedValue;
+			output[i + 2] = (1.0f - inputColor[i + 2]) * value + inputColor[i + 2] * invertedValue;
+		}
+		else {
+			copy_v3_v3(&output[i], &inputColor[i]);
+		}
+
+		if (this->m_alpha)
+			output[i + 3] = (1.0f - inputColor[i + 3]) * value + inputColor[i + 3] * invertedValue;
+		else
+			output[i + 3] = inputColor[i + 3];
+	}
 }
 
 void InvertOperation::deinitExecution()
@@ -43,6 +43,11 @@ public:
 	 * the inner loop of this program
 	 */
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+	/**
+	 * the inner loop of this program, a row at a time
+	 */
+	void calculateRow(float *output, float *const *inputRows, int length);
 	
 	/**
 	 * Initialize the execution
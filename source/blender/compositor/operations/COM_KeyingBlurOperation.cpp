@@ -51,6 +51,7 @@ void KeyingBlurOperation::executePixel(float output[4], int x, int y, void *data
 	MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
 	const int bufferWidth = inputBuffer->getWidth();
 	float *buffer = inputBuffer->getBuffer();
+	const int num_channels = inputBuffer->getNumberOfChannels();
 	int count = 0;
 	float average = 0.0f;
 
@@ -58,7 +59,7 @@ void KeyingBlurOperation::executePixel(float output[4], int x, int y, void *data
 		const int start = max(0, x - this->m_size + 1),
 		          end = min(bufferWidth, x + this->m_size);
 		for (int cx = start; cx < end; ++cx) {
-			int bufferIndex = (y * bufferWidth + cx) * 4;
+			int bufferIndex = (y * bufferWidth + cx) * num_channels;
 			average += buffer[bufferIndex];
 			count++;
 		}
@@ -67,7 +68,7 @@ void KeyingBlurOperation::executePixel(float output[4], int x, int y, void *data
 		const int start = max(0, y - this->m_size + 1),
 		          end = min(inputBuffer->getHeight(), y + this->m_size);
 		for (int cy = start; cy < end; ++cy) {
-			int bufferIndex = (cy * bufferWidth + x) * 4;
+			int bufferIndex = (cy * bufferWidth + x) * num_channels;
 			average += buffer[bufferIndex];
 			count++;
 		}
@@ -33,6 +33,7 @@ MathBaseOperation::MathBaseOperation() : NodeOperation()
 	this->m_inputValue1Operation = NULL;
 	this->m_inputValue2Operation = NULL;
 	this->m_useClamp = false;
+	this->setPixelOperation(true);
 }
 
 void MathBaseOperation::initExecution()
@@ -65,6 +66,27 @@ void MathBaseOperation::determineResolution(unsigned int resolution[2], unsigned
 	NodeOperation::determineResolution(resolution, preferredResolution);
 }
 
+void MathBaseOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+{
+	float inputValue1[4];
+	float inputValue2[4];
+
+	this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
+	this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+
+	calculatePixel(output, inputValue1, inputValue2);
+}
+
+void MathBaseOperation::calculateRow(float *output, float *const *inputRows, int length)
+{
+	const float *inputValue1 = inputRows[0];
+	const float *inputValue2 = inputRows[1];
+
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		calculatePixel(&output[i], &inputValue1[i], &inputValue2[i]);
+	}
+}
+
 void MathBaseOperation::clampIfNeeded(float *color)
 {
 	if (this->m_useClamp) {
@@ -72,53 +94,29 @@ void MathBaseOperation::clampIfNeeded(float *color)
 	}
 }
 
-void MathAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MathAddOperation::calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4])
 {
-	float inputValue1[4];
-	float inputValue2[4];
-	
-	this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-	this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-	
 	output[0] = inputValue1[0] + inputValue2[0];
 
 	clampIfNeeded(output);
 }
 
-void MathSubtractOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MathSubtractOperation::calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4])
 {
-	float inputValue1[4];
-	float inputValue2[4];
-	
-	this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-	this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-	
 	output[0] = inputValue1[0] - inputValue2[0];
 
 	clampIfNeeded(output);
 }
 
-void MathMultiplyOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MathMultiplyOperation::calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4])
 {
-	float inputValue1[4];
-	float inputValue2[4];
-	
-	this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-	this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-	
 	output[0] = inputValue1[0] * inputValue2[0];
 
 	clampIfNeeded(output);
 }
 
-void MathDivideOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MathDivideOperation::calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4])
 {
-	float inputValue1[4];
-	float inputValue2[4];
-	
-	this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-	this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-	
 	if (inputValue2[0] == 0) /* We don't want to divide by zero. */
 		output[0] = 0.0;
 	else
@@ -127,53 +125,29 @@ void MathDivideOperation::executePixelSampled(float output[4], float x, float y,
 	clampIfNeeded(output);
 }
 
-void MathSineOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MathSineOperation::calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4])
 {
-	float inputValue1[4];
-	float inputValue2[4];
-	
-	this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-	this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-	
 	output[0] = sin(inputValue1[0]);
 
 	clampIfNeeded(output);
 }
 
-void MathCosineOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MathCosineOperation::calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4])
 {
-	float inputValue1[4];
-	float inputValue2[4];
-	
-	this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-	this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-	
 	output[0] = cos(inputValue1[0]);
 
 	clampIfNeeded(output);
 }
 
-void MathTangentOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MathTangentOperation::calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4])
 {
-	float inputValue1[4];
-	float inputValue2[4];
-	
-	this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-	this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-	
 	output[0] = tan(inputValue1[0]);
 
 	clampIfNeeded(output);
 }
 
-void MathArcSineOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MathArcSineOperation::calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4])
 {
-	float inputValue1[4];
-	float inputValue2[4];
-	
-	this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-	this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-	
 	if (inputValue1[0] <= 1 && inputValue1[0] >= -1)
 		output[0] = asin(inputValue1[0]);
 	else
@@ -182,14 +156,8 @@ void MathArcSineOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
-void MathArcCosineOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MathArcCosineOperation::calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4])
 {
-	float inputValue1[4];
-	float inputValue2[4];
-	
-	this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-	this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-	
 	if (inputValue1[0] <= 1 && inputValue1[0] >= -1)
 		output[0] = acos(inputValue1[0]);
 	else
@@ -198,27 +166,15 @@ void MathArcCosineOperation::executePixelSampled(float output[4], float x, float
 	clampIfNeeded(output);
 }
 
-void MathArcTangentOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MathArcTangentOperation::calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4])
 {
-	float inputValue1[4];
-	float inputValue2[4];
-	
-	this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-	this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-	
 	output[0] = atan(inputValue1[0]);
 
 	clampIfNeeded(output);
 }
 
-void MathPowerOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MathPowerOperation::calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4])
 {
-	float inputValue1[4];
-	float inputValue2[4];
-	
-	this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-	this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-	
 	if (inputValue1[0] >= 0) {
 		output[0] = pow(inputValue1[0], inputValue2[0]);
 	}
@@ -236,14 +192,8 @@ void MathPowerOperation::executePixelSampled(float output[4], float x, float y,
 	clampIfNeeded(output);
 }
 
-void MathLogarithmOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MathLogarithmOperation::calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4])
 {
-	float inputValue1[4];
-	float inputValue2[4];
-	
-	this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-	this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-	
 	if (inputValue1[0] > 0  && inputValue2[0] > 0)
 		output[0] = log(inputValue1[0]) / log(inputValue2[0]);
 	else
@@ -252,79 +202,43 @@ void MathLogarithmOperation::executePixelSampled(float output[4], float x, float
 	clampIfNeeded(output);
 }
 
-void MathMinimumOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MathMinimumOperation::calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4])
 {
-	float inputValue1[4];
-	float inputValue2[4];
-	
-	this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-	this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-	
 	output[0] = min(inputValue1[0], inputValue2[0]);
 
 	clampIfNeeded(output);
 }
 
-void MathMaximumOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MathMaximumOperation::calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4])
 {
-	float inputValue1[4];
-	float inputValue2[4];
-	
-	this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-	this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-	
 	output[0] = max(inputValue1[0], inputValue2[0]);
 
 	clampIfNeeded(output);
 }
 
-void MathRoundOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MathRoundOperation::calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4])
 {
-	float inputValue1[4];
-	float inputValue2[4];
-	
-	this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-	this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-	
 	output[0] = round(inputValue1[0]);
 
 	clampIfNeeded(output);
 }
 
-void MathLessThanOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MathLessThanOperation::calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4])
 {
-	float inputValue1[4];
-	float inputValue2[4];
-	
-	this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-	this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-	
 	output[0] = inputValue1[0] < inputValue2[0] ? 1.0f : 0.0f;
 
 	clampIfNeeded(output);
 }
 
-void MathGreaterThanOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MathGreaterThanOperation::calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4])
 {
-	float inputValue1[4];
-	float inputValue2[4];
-	
-	this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-	this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-	
 	output[0] = inputValue1[0] > inputValue2[0] ? 1.0f : 0.0f;
 
 	clampIfNeeded(output);
 }
 
-void MathModuloOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MathModuloOperation::calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4])
 {
-	float inputValue1[4];
-	float inputValue2[4];
-	
-	this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-	this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-	
 	if (inputValue2[0] == 0)
 		output[0] = 0.0;
 	else
@@ -333,12 +247,8 @@ void MathModuloOperation::executePixelSampled(float output[4], float x, float y,
 	clampIfNeeded(output);
 }
 
-void MathAbsoluteOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MathAbsoluteOperation::calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4])
 {
-	float inputValue1[4];
-
-	this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-
 	output[0] = fabs(inputValue1[0]);
 
 	clampIfNeeded(output);
@@ -46,11 +46,21 @@ protected:
 	MathBaseOperation();
 
 	void clampIfNeeded(float color[4]);
+
+	/**
+	 * calculate a single pixel from the already read inputs
+	 */
+	virtual void calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4]) = 0;
 public:
 	/**
 	 * the inner loop of this program
 	 */
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) = 0;
+	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+	/**
+	 * the inner loop of this program, a row at a time
+	 */
+	void calculateRow(float *output, float *const *inputRows, int length);
 	
 	/**
 	 * Initialize the execution
@@ -73,100 +83,100 @@ public:
 class MathAddOperation : public MathBaseOperation {
 public:
 	MathAddOperation() : MathBaseOperation() {}
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4]);
 };
 class MathSubtractOperation : public MathBaseOperation {
 public:
 	MathSubtractOperation() : MathBaseOperation() {}
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4]);
 };
 class MathMultiplyOperation : public MathBaseOperation {
 public:
 	MathMultiplyOperation() : MathBaseOperation() {}
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4]);
 };
 class MathDivideOperation : public MathBaseOperation {
 public:
 	MathDivideOperation() : MathBaseOperation() {}
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4]);
 };
 class MathSineOperation : public MathBaseOperation {
 public:
 	MathSineOperation() : MathBaseOperation() {}
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4]);
 };
 class MathCosineOperation : public MathBaseOperation {
 public:
 	MathCosineOperation() : MathBaseOperation() {}
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4]);
 };
 class MathTangentOperation : public MathBaseOperation {
 public:
 	MathTangentOperation() : MathBaseOperation() {}
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4]);
 };
 
 class MathArcSineOperation : public MathBaseOperation {
 public:
 	MathArcSineOperation() : MathBaseOperation() {}
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4]);
 };
 class MathArcCosineOperation : public MathBaseOperation {
 public:
 	MathArcCosineOperation() : MathBaseOperation() {}
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4]);
 };
 class MathArcTangentOperation : public MathBaseOperation {
 public:
 	MathArcTangentOperation() : MathBaseOperation() {}
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4]);
 };
 class MathPowerOperation : public MathBaseOperation {
 public:
 	MathPowerOperation() : MathBaseOperation() {}
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4]);
 };
 class MathLogarithmOperation : public MathBaseOperation {
 public:
 	MathLogarithmOperation() : MathBaseOperation() {}
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4]);
 };
 class MathMinimumOperation : public MathBaseOperation {
 public:
 	MathMinimumOperation() : MathBaseOperation() {}
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4]);
 };
 class MathMaximumOperation : public MathBaseOperation {
 public:
 	MathMaximumOperation() : MathBaseOperation() {}
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4]);
 };
 class MathRoundOperation : public MathBaseOperation {
 public:
 	MathRoundOperation() : MathBaseOperation() {}
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4]);
 };
 class MathLessThanOperation : public MathBaseOperation {
 public:
 	MathLessThanOperation() : MathBaseOperation() {}
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4]);
 };
 class MathGreaterThanOperation : public MathBaseOperation {
 public:
 	MathGreaterThanOperation() : MathBaseOperation() {}
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4]);
 };
 
 class MathModuloOperation : public MathBaseOperation {
 public:
 	MathModuloOperation() : MathBaseOperation() {}
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4]);
 };
 
 class MathAbsoluteOperation : public MathBaseOperation {
 public:
 	MathAbsoluteOperation() : MathBaseOperation() {}
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void calculatePixel(float output[4], const float inputValue1[4], const float inputValue2[4]);
 };
 
 #endif
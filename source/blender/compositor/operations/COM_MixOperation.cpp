@@ -39,6 +39,7 @@ MixBaseOperation::MixBaseOperation() : NodeOperation()
 	this->m_inputColor2Operation = NULL;
 	this->setUseValueAlphaMultiply(false);
 	this->setUseClamp(false);
+	this->setPixelOperation(true);
 }
 
 void MixBaseOperation::initExecution()
@@ -53,11 +54,38 @@ void MixBaseOperation::executePixelSampled(float output[4], float x, float y, Pi
 	float inputColor1[4];
 	float inputColor2[4];
 	float inputValue[4];
-	
+
 	this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
 	this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
 	this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-	
+
+	blendPixel(output, inputValue, inputColor1, inputColor2);
+}
+
+void MixBaseOperation::calculateRow(float *output, float *const *inputRows, int length)
+{
+	blendRow(output, inputRows[0], inputRows[1], inputRows[2], length);
+}
+
+void MixBaseOperation::blendRow(float *output, const float *inputValue, const float *inputColor1, const float *inputColor2, int length)
+{
+	for (int i = 0; i < length; i++) {
+		const int offset = i * COM_NUMBER_OF_CHANNELS;
+		blendPixel(&output[offset], &inputValue[offset], &inputColor1[offset], &inputColor2[offset]);
+	}
+}
+
+void MixBaseOperation::clampRow(float *output, int length)
+{
+	if (m_useClamp) {
+		for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i++) {
+			CLAMP(output[i], 0.0f, 1.0f);
+		}
+	}
+}
+
+void MixBaseOperation::blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4])
+{
 	float value = inputValue[0];
 	if (this->useValueAlphaMultiply()) {
 		value *= inputColor2[3];
@@ -107,16 +135,8 @@ MixAddOperation::MixAddOperation() : MixBaseOperation()
 	/* pass */
 }
 
-void MixAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixAddOperation::blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4])
 {
-	float inputColor1[4];
-	float inputColor2[4];
-	float inputValue[4];
-
-	this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-	this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-	this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
 	float value = inputValue[0];
 	if (this->useValueAlphaMultiply()) {
 		value *= inputColor2[3];
@@ -129,6 +149,22 @@ void MixAddOperation::executePixelSampled(float output[4], float x, float y, Pix
 	clampIfNeeded(output);
 }
 
+void MixAddOperation::blendRow(float *output, const float *inputValue, const float *inputColor1, const float *inputColor2, int length)
+{
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		float value = inputValue[i];
+		if (this->useValueAlphaMultiply()) {
+			value *= inputColor2[i + 3];
+		}
+		output[i + 0] = inputColor1[i + 0] + value * inputColor2[i + 0];
+		output[i + 1] = inputColor1[i + 1] + value * inputColor2[i + 1];
+		output[i + 2] = inputColor1[i + 2] + value * inputColor2[i + 2];
+		output[i + 3] = inputColor1[i + 3];
+	}
+
+	clampRow(output, length);
+}
+
 /* ******** Mix Blend Operation ******** */
 
 MixBlendOperation::MixBlendOperation() : MixBaseOperation()
@@ -136,16 +172,10 @@ MixBlendOperation::MixBlendOperation() : MixBaseOperation()
 	/* pass */
 }
 
-void MixBlendOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixBlendOperation::blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4])
 {
-	float inputColor1[4];
-	float inputColor2[4];
-	float inputValue[4];
 	float value;
 
-	this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-	this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-	this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
 	value = inputValue[0];
 	
 	if (this->useValueAlphaMultiply()) {
@@ -160,6 +190,23 @@ void MixBlendOperation::executePixelSampled(float output[4], float x, float y, P
 	clampIfNeeded(output);
 }
 
+void MixBlendOperation::blendRow(float *output, const float *inputValue, const float *inputColor1, const float *inputColor2, int length)
+{
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		float value = inputValue[i];
+		if (this->useValueAlphaMultiply()) {
+			value *= inputColor2[i + 3];
+		}
+		float valuem = 1.0f - value;
+		output[i + 0] = valuem * inputColor1[i + 0] + value * inputColor2[i + 0];
+		output[i + 1] = valuem * inputColor1[i + 1] + value * inputColor2[i + 1];
+		output[i + 2] = valuem * inputColor1[i + 2] + value * inputColor2[i + 2];
+		output[i + 3] = inputColor1[i + 3];
+	}
+
+	clampRow(output, length);
+}
+
 /* ******** Mix Burn Operation ******** */
 
 MixBurnOperation::MixBurnOperation() : MixBaseOperation()
@@ -167,17 +214,10 @@ MixBurnOperation::MixBurnOperation() : MixBaseOperation()
 	/* pass */
 }
 
-void MixBurnOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixBurnOperation::blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4])
 {
-	float inputColor1[4];
-	float inputColor2[4];
-	float inputValue[4];
 	float tmp;
 
-	this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-	this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-	this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
 	float value = inputValue[0];
 	if (this->useValueAlphaMultiply()) {
 		value *= inputColor2[3];
@@ -235,16 +275,8 @@ MixColorOperation::MixColorOperation() : MixBaseOperation()
 	/* pass */
 }
 
-void MixColorOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixColorOperation::blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4])
 {
-	float inputColor1[4];
-	float inputColor2[4];
-	float inputValue[4];
-
-	this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-	this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-	this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
 	float value = inputValue[0];
 	if (this->useValueAlphaMultiply()) {
 		value *= inputColor2[3];
@@ -277,16 +309,8 @@ MixDarkenOperation::MixDarkenOperation() : MixBaseOperation()
 	/* pass */
 }
 
-void MixDarkenOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixDarkenOperation::blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4])
 {
-	float inputColor1[4];
-	float inputColor2[4];
-	float inputValue[4];
-
-	this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-	this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-	this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
 	float value = inputValue[0];
 	if (this->useValueAlphaMultiply()) {
 		value *= inputColor2[3];
@@ -307,16 +331,8 @@ MixDifferenceOperation::MixDifferenceOperation() : MixBaseOperation()
 	/* pass */
 }
 
-void MixDifferenceOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixDifferenceOperation::blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4])
 {
-	float inputColor1[4];
-	float inputColor2[4];
-	float inputValue[4];
-
-	this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-	this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-	this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
 	float value = inputValue[0];
 	if (this->useValueAlphaMultiply()) {
 		value *= inputColor2[3];
@@ -337,16 +353,8 @@ MixDivideOperation::MixDivideOperation() : MixBaseOperation()
 	/* pass */
 }
 
-void MixDivideOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixDivideOperation::blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4])
 {
-	float inputColor1[4];
-	float inputColor2[4];
-	float inputValue[4];
-
-	this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-	this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-	this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
 	float value = inputValue[0];
 	if (this->useValueAlphaMultiply()) {
 		value *= inputColor2[3];
@@ -378,17 +386,10 @@ MixDodgeOperation::MixDodgeOperation() : MixBaseOperation()
 	/* pass */
 }
 
-void MixDodgeOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixDodgeOperation::blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4])
 {
-	float inputColor1[4];
-	float inputColor2[4];
-	float inputValue[4];
 	float tmp;
 
-	this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-	this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-	this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
 	float value = inputValue[0];
 	if (this->useValueAlphaMultiply()) {
 		value *= inputColor2[3];
@@ -451,26 +452,21 @@ MixGlareOperation::MixGlareOperation() : MixBaseOperation()
 	/* pass */
 }
 
-void MixGlareOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixGlareOperation::blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4])
 {
-	float inputColor1[4];
-	float inputColor2[4];
-	float inputValue[4];
 	float value;
 
-	this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-	this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-	this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
 	value = inputValue[0];
 	float mf = 2.f - 2.f * fabsf(value - 0.5f);
 
-	if (inputColor1[0] < 0.0f) inputColor1[0] = 0.0f;
-	if (inputColor1[1] < 0.0f) inputColor1[1] = 0.0f;
-	if (inputColor1[2] < 0.0f) inputColor1[2] = 0.0f;
+	float color1[3];
+	color1[0] = max(inputColor1[0], 0.0f);
+	color1[1] = max(inputColor1[1], 0.0f);
+	color1[2] = max(inputColor1[2], 0.0f);
 
-	output[0] = mf * max(inputColor1[0] + value * (inputColor2[0] - inputColor1[0]), 0.0f);
-	output[1] = mf * max(inputColor1[1] + value * (inputColor2[1] - inputColor1[1]), 0.0f);
-	output[2] = mf * max(inputColor1[2] + value * (inputColor2[2] - inputColor1[2]), 0.0f);
+	output[0] = mf * max(color1[0] + value * (inputColor2[0] - color1[0]), 0.0f);
+	output[1] = mf * max(color1[1] + value * (inputColor2[1] - color1[1]), 0.0f);
+	output[2] = mf * max(color1[2] + value * (inputColor2[2] - color1[2]), 0.0f);
 	output[3] = inputColor1[3];
 
 	clampIfNeeded(output);
@@ -483,16 +479,8 @@ MixHueOperation::MixHueOperation() : MixBaseOperation()
 	/* pass */
 }
 
-void MixHueOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixHueOperation::blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4])
 {
-	float inputColor1[4];
-	float inputColor2[4];
-	float inputValue[4];
-
-	this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-	this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-	this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
 	float value = inputValue[0];
 	if (this->useValueAlphaMultiply()) {
 		value *= inputColor2[3];
@@ -525,16 +513,8 @@ MixLightenOperation::MixLightenOperation() : MixBaseOperation()
 	/* pass */
 }
 
-void MixLightenOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixLightenOperation::blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4])
 {
-	float inputColor1[4];
-	float inputColor2[4];
-	float inputValue[4];
-
-	this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-	this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-	this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
 	float value = inputValue[0];
 	if (this->useValueAlphaMultiply()) {
 		value *= inputColor2[3];
@@ -561,16 +541,8 @@ MixLinearLightOperation::MixLinearLightOperation() : MixBaseOperation()
 	/* pass */
 }
 
-void MixLinearLightOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixLinearLightOperation::blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4])
 {
-	float inputColor1[4];
-	float inputColor2[4];
-	float inputValue[4];
-
-	this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-	this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-	this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
 	float value = inputValue[0];
 	if (this->useValueAlphaMultiply()) {
 		value *= inputColor2[3];
@@ -600,16 +572,8 @@ MixMultiplyOperation::MixMultiplyOperation() : MixBaseOperation()
 	/* pass */
 }
 
-void MixMultiplyOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixMultiplyOperation::blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4])
 {
-	float inputColor1[4];
-	float inputColor2[4];
-	float inputValue[4];
-
-	this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-	this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-	this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
 	float value = inputValue[0];
 	if (this->useValueAlphaMultiply()) {
 		value *= inputColor2[3];
@@ -623,6 +587,23 @@ void MixMultiplyOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+void MixMultiplyOperation::blendRow(float *output, const float *inputValue, const float *inputColor1, const float *inputColor2, int length)
+{
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		float value = inputValue[i];
+		if (this->useValueAlphaMultiply()) {
+			value *= inputColor2[i + 3];
+		}
+		float valuem = 1.0f - value;
+		output[i + 0] = inputColor1[i + 0] * (valuem + value * inputColor2[i + 0]);
+		output[i + 1] = inputColor1[i + 1] * (valuem + value * inputColor2[i + 1]);
+		output[i + 2] = inputColor1[i + 2] * (valuem + value * inputColor2[i + 2]);
+		output[i + 3] = inputColor1[i + 3];
+	}
+
+	clampRow(output, length);
+}
+
 /* ******** Mix Ovelray Operation ******** */
 
 MixOverlayOperation::MixOverlayOperation() : MixBaseOperation()
@@ -630,16 +611,8 @@ MixOverlayOperation::MixOverlayOperation() : MixBaseOperation()
 	/* pass */
 }
 
-void MixOverlayOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixOverlayOperation::blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4])
 {
-	float inputColor1[4];
-	float inputColor2[4];
-	float inputValue[4];
-
-	this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-	this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-	this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
 	float value = inputValue[0];
 	if (this->useValueAlphaMultiply()) {
 		value *= inputColor2[3];
@@ -677,16 +650,8 @@ MixSaturationOperation::MixSaturationOperation() : MixBaseOperation()
 	/* pass */
 }
 
-void MixSaturationOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixSaturationOperation::blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4])
 {
-	float inputColor1[4];
-	float inputColor2[4];
-	float inputValue[4];
-
-	this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-	this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-	this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
 	float value = inputValue[0];
 	if (this->useValueAlphaMultiply()) {
 		value *= inputColor2[3];
@@ -716,16 +681,8 @@ MixScreenOperation::MixScreenOperation() : MixBaseOperation()
 	/* pass */
 }
 
-void MixScreenOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixScreenOperation::blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4])
 {
-	float inputColor1[4];
-	float inputColor2[4];
-	float inputValue[4];
-
-	this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-	this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-	this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
 	float value = inputValue[0];
 	if (this->useValueAlphaMultiply()) {
 		value *= inputColor2[3];
@@ -747,16 +704,8 @@ MixSoftLightOperation::MixSoftLightOperation() : MixBaseOperation()
 	/* pass */
 }
 
-void MixSoftLightOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler) \
+void MixSoftLightOperation::blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4])
 {
-	float inputColor1[4];
-	float inputColor2[4];
-	float inputValue[4];
-
-	this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-	this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-	this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
 	float value = inputValue[0];
 	if (this->useValueAlphaMultiply()) {
 		value *= inputColor2[3];
@@ -784,16 +733,8 @@ MixSubtractOperation::MixSubtractOperation() : MixBaseOperation()
 	/* pass */
 }
 
-void MixSubtractOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixSubtractOperation::blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4])
 {
-	float inputColor1[4];
-	float inputColor2[4];
-	float inputValue[4];
-
-	this->m_inputValueOperation->readSampled(inputValue,   x, y, sampler);
-	this->m_inputColor1Operation->readSampled(inputColor1,   x, y, sampler);
-	this->m_inputColor2Operation->readSampled(inputColor2,   x, y, sampler);
-
 	float value = inputValue[0];
 	if (this->useValueAlphaMultiply()) {
 		value *= inputColor2[3];
@@ -806,6 +747,22 @@ void MixSubtractOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+void MixSubtractOperation::blendRow(float *output, const float *inputValue, const float *inputColor1, const float *inputColor2, int length)
+{
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		float value = inputValue[i];
+		if (this->useValueAlphaMultiply()) {
+			value *= inputColor2[i + 3];
+		}
+		output[i + 0] = inputColor1[i + 0] - value * inputColor2[i + 0];
+		output[i + 1] = inputColor1[i + 1] - value * inputColor2[i + 1];
+		output[i + 2] = inputColor1[i + 2] - value * inputColor2[i + 2];
+		output[i + 3] = inputColor1[i + 3];
+	}
+
+	clampRow(output, length);
+}
+
 /* ******** Mix Value Operation ******** */
 
 MixValueOperation::MixValueOperation() : MixBaseOperation()
@@ -813,16 +770,8 @@ MixValueOperation::MixValueOperation() : MixBaseOperation()
 	/* pass */
 }
 
-void MixValueOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixValueOperation::blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4])
 {
-	float inputColor1[4];
-	float inputColor2[4];
-	float inputValue[4];
-
-	this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-	this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-	this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
 	float value = inputValue[0];
 	if (this->useValueAlphaMultiply()) {
 		value *= inputColor2[3];
@@ -51,6 +51,18 @@ protected:
 		}
 	}
 	
+	void clampRow(float *output, int length);
+
+	/**
+	 * blend a single pixel from the already read inputs
+	 */
+	virtual void blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4]);
+
+	/**
+	 * blend a row of pixels, by default blendPixel is called for every pixel
+	 */
+	virtual void blendRow(float *output, const float *inputValue, const float *inputColor1, const float *inputColor2, int length);
+	
 public:
 	/**
 	 * Default constructor
@@ -61,6 +73,11 @@ public:
 	 * the inner loop of this program
 	 */
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+	/**
+	 * the inner loop of this program, a row at a time
+	 */
+	void calculateRow(float *output, float *const *inputRows, int length);
 	
 	/**
 	 * Initialize the execution
@@ -83,115 +100,119 @@ public:
 class MixAddOperation : public MixBaseOperation {
 public:
 	MixAddOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4]);
+	void blendRow(float *output, const float *inputValue, const float *inputColor1, const float *inputColor2, int length);
 };
 
 class MixBlendOperation : public MixBaseOperation {
 public:
 	MixBlendOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4]);
+	void blendRow(float *output, const float *inputValue, const float *inputColor1, const float *inputColor2, int length);
 };
 
 class MixBurnOperation : public MixBaseOperation {
 public:
 	MixBurnOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4]);
 };
 
 class MixColorOperation : public MixBaseOperation {
 public:
 	MixColorOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4]);
 };
 
 class MixDarkenOperation : public MixBaseOperation {
 public:
 	MixDarkenOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4]);
 };
 
 class MixDifferenceOperation : public MixBaseOperation {
 public:
 	MixDifferenceOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4]);
 };
 
 class MixDivideOperation : public MixBaseOperation {
 public:
 	MixDivideOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4]);
 };
 
 class MixDodgeOperation : public MixBaseOperation {
 public:
 	MixDodgeOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4]);
 };
 
 class MixGlareOperation : public MixBaseOperation {
 public:
 	MixGlareOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4]);
 };
 
 class MixHueOperation : public MixBaseOperation {
 public:
 	MixHueOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4]);
 };
 
 class MixLightenOperation : public MixBaseOperation {
 public:
 	MixLightenOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4]);
 };
 
 class MixLinearLightOperation : public MixBaseOperation {
 public:
 	MixLinearLightOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4]);
 };
 
 class MixMultiplyOperation : public MixBaseOperation {
 public:
 	MixMultiplyOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4]);
+	void blendRow(float *output, const float *inputValue, const float *inputColor1, const float *inputColor2, int length);
 };
 
 class MixOverlayOperation : public MixBaseOperation {
 public:
 	MixOverlayOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4]);
 };
 
 class MixSaturationOperation : public MixBaseOperation {
 public:
 	MixSaturationOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4]);
 };
 
 class MixScreenOperation : public MixBaseOperation {
 public:
 	MixScreenOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4]);
 };
 
 class MixSoftLightOperation : public MixBaseOperation {
 public:
 	MixSoftLightOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4]);
 };
 
 class MixSubtractOperation : public MixBaseOperation {
 public:
 	MixSubtractOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4]);
+	void blendRow(float *output, const float *inputValue, const float *inputColor1, const float *inputColor2, int length);
 };
 
 class MixValueOperation : public MixBaseOperation {
 public:
 	MixValueOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void blendPixel(float output[4], const float inputValue[4], const float inputColor1[4], const float inputColor2[4]);
 };
 
 #endif
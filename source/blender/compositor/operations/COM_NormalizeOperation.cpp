@@ -21,6 +21,9 @@
 
 #include "COM_NormalizeOperation.h"
 
+#include "BLI_task.h"
+#include "MEM_guardedalloc.h"
+
 NormalizeOperation::NormalizeOperation() : NodeOperation()
 {
 	this->addInputSocket(COM_DT_VALUE);
@@ -80,6 +83,35 @@ bool NormalizeOperation::determineDependingAreaOfInterest(rcti *input, ReadBuffe
 /* The code below assumes all data is inside range +- this, and that input buffer is single channel */
 #define BLENDER_ZMAX 10000.0f
 
+typedef struct NormalizeRows {
+	MemoryBuffer *tile;
+	/* minimum and maximum per row */
+	float *minmax;
+} NormalizeRows;
+
+static void normalize_minmax_row(void *userdata, int y)
+{
+	NormalizeRows *data = (NormalizeRows *)userdata;
+	const int width = data->tile->getWidth();
+	const int num_channels = data->tile->getNumberOfChannels();
+	const float *bc = data->tile->getBuffer() + (size_t)y * width * num_channels;
+
+	float minv = 1.0f + BLENDER_ZMAX;
+	float maxv = -1.0f - BLENDER_ZMAX;
+
+	for (int x = 0; x < width; x++, bc += num_channels) {
+		const float value = bc[0];
+		if ((value > maxv) && (value <= BLENDER_ZMAX)) {
+			maxv = value;
+		}
+		if ((value < minv) && (value >= -BLENDER_ZMAX)) {
+			minv = value;
+		}
+	}
+	data->minmax[y * 2] = minv;
+	data->minmax[y * 2 + 1] = maxv;
+}
+
 void *NormalizeOperation::initializeTileData(rcti *rect)
 {
 	lockMutex();
@@ -88,24 +120,21 @@ void *NormalizeOperation::initializeTileData(rcti *rect)
 		/* using generic two floats struct to store x: min  y: mult */
 		NodeTwoFloats *minmult = new NodeTwoFloats();
 
-		float *buffer = tile->getBuffer();
-		int p = tile->getWidth() * tile->getHeight();
-		float *bc = buffer;
+		const int height = tile->getHeight();
+		NormalizeRows rows;
+		rows.tile = tile;
+		rows.minmax = (float *)MEM_mallocN(sizeof(float) * 2 * height, __func__);
+		if (height > 0) {
+			BLI_task_parallel_range(0, height, &rows, normalize_minmax_row);
+		}
 
 		float minv = 1.0f + BLENDER_ZMAX;
 		float maxv = -1.0f - BLENDER_ZMAX;
-
-		float value;
-		while (p--) {
-			value = bc[0];
-			if ((value > maxv) && (value <= BLENDER_ZMAX)) {
-				maxv = value;
-			}
-			if ((value < minv) && (value >= -BLENDER_ZMAX)) {
-				minv = value;
-			}
-			bc += 4;
+		for (int y = 0; y < height; y++) {
+			minv = min(minv, rows.minmax[y * 2]);
+			maxv = max(maxv, rows.minmax[y * 2 + 1]);
 		}
+		MEM_freeN(rows.minmax);
 
 		minmult->x = minv;
 		/* The rare case of flat buffer  would cause a divide by 0 */
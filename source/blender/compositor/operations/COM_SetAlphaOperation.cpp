@@ -30,6 +30,7 @@ SetAlphaOperation::SetAlphaOperation() : NodeOperation()
 	
 	this->m_inputColor = NULL;
 	this->m_inputAlpha = NULL;
+	this->setPixelOperation(true);
 }
 
 void SetAlphaOperation::initExecution()
@@ -48,6 +49,17 @@ void SetAlphaOperation::executePixelSampled(float output[4], float x, float y, P
 	output[3] = alphaInput[0];
 }
 
+void SetAlphaOperation::calculateRow(float *output, float *const *inputRows, int length)
+{
+	const float *inputColor = inputRows[0];
+	const float *alphaInput = inputRows[1];
+
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		copy_v3_v3(&output[i], &inputColor[i]);
+		output[i + 3] = alphaInput[i];
+	}
+}
+
 void SetAlphaOperation::deinitExecution()
 {
 	this->m_inputColor = NULL;
@@ -25,6 +25,7 @@
 SetColorOperation::SetColorOperation() : NodeOperation()
 {
 	this->addOutputSocket(COM_DT_COLOR);
+	this->setPixelOperation(true);
 }
 
 void SetColorOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -32,6 +33,13 @@ void SetColorOperation::executePixelSampled(float output[4], float x, float y, P
 	copy_v4_v4(output, this->m_color);
 }
 
+void SetColorOperation::calculateRow(float *output, float *const * /*inputRows*/, int length)
+{
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		copy_v4_v4(&output[i], this->m_color);
+	}
+}
+
 void SetColorOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
 {
 	resolution[0] = preferredResolution[0];
@@ -25,6 +25,7 @@
 SetValueOperation::SetValueOperation() : NodeOperation()
 {
 	this->addOutputSocket(COM_DT_VALUE);
+	this->setPixelOperation(true);
 }
 
 void SetValueOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -32,6 +33,13 @@ void SetValueOperation::executePixelSampled(float output[4], float x, float y, P
 	output[0] = this->m_value;
 }
 
+void SetValueOperation::calculateRow(float *output, float *const * /*inputRows*/, int length)
+{
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		output[i] = this->m_value;
+	}
+}
+
 void SetValueOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
 {
 	resolution[0] = preferredResolution[0];
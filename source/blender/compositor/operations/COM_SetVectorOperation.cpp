@@ -26,6 +26,7 @@
 SetVectorOperation::SetVectorOperation() : NodeOperation()
 {
 	this->addOutputSocket(COM_DT_VECTOR);
+	this->setPixelOperation(true);
 }
 
 void SetVectorOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -36,6 +37,16 @@ void SetVectorOperation::executePixelSampled(float output[4], float x, float y,
 	output[3] = this->m_w;
 }
 
+void SetVectorOperation::calculateRow(float *output, float *const * /*inputRows*/, int length)
+{
+	for (int i = 0; i < length * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		output[i + 0] = this->m_x;
+		output[i + 1] = this->m_y;
+		output[i + 2] = this->m_z;
+		output[i + 3] = this->m_w;
+	}
+}
+
 void SetVectorOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
 {
 	resolution[0] = preferredResolution[0];
@@ -23,6 +23,47 @@
 #include "COM_TonemapOperation.h"
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
+#include "BLI_task.h"
+#include "MEM_guardedalloc.h"
+
+typedef struct TonemapRowStatistics {
+	float lsum;
+	float Lav;
+	float cav[3];
+	float maxl, minl;
+} TonemapRowStatistics;
+
+typedef struct TonemapRows {
+	MemoryBuffer *tile;
+	TonemapRowStatistics *rows;
+} TonemapRows;
+
+static void tonemap_statistics_row(void *userdata, int y)
+{
+	TonemapRows *data = (TonemapRows *)userdata;
+	TonemapRowStatistics *row = &data->rows[y];
+	const int width = data->tile->getWidth();
+	float *bc = data->tile->getBuffer() + (size_t)y * width * 4;
+
+	/* accumulate in locals, stores to the row would alias the buffer reads */
+	float lsum = 0.0f, Lav = 0.0f, maxl = -1e10f, minl = 1e10f;
+	float cav[3] = {0.0f, 0.0f, 0.0f};
+
+	for (int x = 0; x < width; x++, bc += 4) {
+		float L = rgb_to_luma_y(bc);
+		Lav += L;
+		add_v3_v3(cav, bc);
+		lsum += logf(MAX2(L, 0.0f) + 1e-5f);
+		maxl = (L > maxl) ? L : maxl;
+		minl = (L < minl) ? L : minl;
+	}
+
+	row->lsum = lsum;
+	row->Lav = Lav;
+	copy_v3_v3(row->cav, cav);
+	row->maxl = maxl;
+	row->minl = minl;
+}
 
 TonemapOperation::TonemapOperation() : NodeOperation()
 {
@@ -115,24 +156,30 @@ void *TonemapOperation::initializeTileData(rcti *rect)
 		MemoryBuffer *tile = (MemoryBuffer *)this->m_imageReader->initializeTileData(rect);
 		AvgLogLum *data = new AvgLogLum();
 
-		float *buffer = tile->getBuffer();
+		/* statistics per row in parallel, combined in order */
+		const int height = tile->getHeight();
+		TonemapRows rows;
+		rows.tile = tile;
+		rows.rows = (TonemapRowStatistics *)MEM_mallocN(sizeof(TonemapRowStatistics) * height, __func__);
+		if (height > 0) {
+			BLI_task_parallel_range(0, height, &rows, tonemap_statistics_row);
+		}
 
 		float lsum = 0.0f;
 		int p = tile->getWidth() * tile->getHeight();
-		float *bc = buffer;
 		float avl, maxl = -1e10f, minl = 1e10f;
 		const float sc = 1.0f / p;
 		float Lav = 0.f;
 		float cav[4] = {0.0f, 0.0f, 0.0f, 0.0f};
-		while (p--) {
-			float L = rgb_to_luma_y(bc);
-			Lav += L;
-			add_v3_v3(cav, bc);
-			lsum += logf(MAX2(L, 0.0f) + 1e-5f);
-			maxl = (L > maxl) ? L : maxl;
-			minl = (L < minl) ? L : minl;
-			bc += 4;
+		for (int y = 0; y < height; y++) {
+			const TonemapRowStatistics *row = &rows.rows[y];
+			Lav += row->Lav;
+			add_v3_v3(cav, row->cav);
+			lsum += row->lsum;
+			maxl = (row->maxl > maxl) ? row->maxl : maxl;
+			minl = (row->minl < minl) ? row->minl : minl;
 		}
+		MEM_freeN(rows.rows);
 		data->lav = Lav * sc;
 		mul_v3_v3fl(data->cav, cav, sc);
 		maxl = log((double)maxl + 1e-5); minl = log((double)minl + 1e-5); avl = lsum * sc;
@@ -23,9 +23,11 @@
 
 #include "COM_WrapOperation.h"
 
-WrapOperation::WrapOperation() : ReadBufferOperation()
+WrapOperation::WrapOperation(DataType datatype) : ReadBufferOperation(datatype)
 {
 	this->m_wrappingType = CMP_NODE_WRAP_NONE;
+	/* reads are wrapped per pixel, see executePixelSampled */
+	this->setRowOperation(false);
 }
 
 inline float WrapOperation::getWrappedOriginalXPos(float x)
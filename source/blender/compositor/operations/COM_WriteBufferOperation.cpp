@@ -25,12 +25,14 @@
 #include <stdio.h>
 #include "COM_OpenCLDevice.h"
 
-WriteBufferOperation::WriteBufferOperation() : NodeOperation()
+WriteBufferOperation::WriteBufferOperation(DataType datatype) : NodeOperation()
 {
-	this->addInputSocket(COM_DT_COLOR);
-	this->m_memoryProxy = new MemoryProxy();
+	this->addInputSocket(datatype);
+	this->m_memoryProxy = new MemoryProxy(datatype);
 	this->m_memoryProxy->setWriteBufferOperation(this);
 	this->m_memoryProxy->setExecutor(NULL);
+	this->m_useRowExecution = false;
+	this->m_resultCacheKey = COM_RESULT_CACHE_NO_KEY;
 }
 WriteBufferOperation::~WriteBufferOperation()
 {
@@ -61,8 +63,14 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int tileNumber)
 {
 	MemoryBuffer *memoryBuffer = this->m_memoryProxy->getBuffer();
 	float *buffer = memoryBuffer->getBuffer();
+	const int num_channels = memoryBuffer->getNumberOfChannels();
 	if (this->m_input->isComplex()) {
-		void *data = this->m_input->initializeTileData(rect);
+		void *data;
+		{
+			/* complex operations often calculate their whole result here */
+			COM_PROFILE_SCOPE(this->m_input, 0);
+			data = this->m_input->initializeTileData(rect);
+		}
 		int x1 = rect->xmin;
 		int y1 = rect->ymin;
 		int x2 = rect->xmax;
@@ -70,11 +78,21 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int tileNumber)
 		int x;
 		int y;
 		bool breaked = false;
+		float row[COM_ROW_LENGTH * COM_NUMBER_OF_CHANNELS];
 		for (y = y1; y < y2 && (!breaked); y++) {
-			int offset4 = (y * memoryBuffer->getWidth() + x1) * COM_NUMBER_OF_CHANNELS;
-			for (x = x1; x < x2; x++) {
-				this->m_input->read(&(buffer[offset4]), x, y, data);
-				offset4 += COM_NUMBER_OF_CHANNELS;
+			int offset = (y * memoryBuffer->getWidth() + x1) * num_channels;
+			for (x = x1; x < x2; x += COM_ROW_LENGTH) {
+				const int length = min(x2 - x, COM_ROW_LENGTH);
+				if (num_channels == COM_NUMBER_OF_CHANNELS) {
+					this->m_input->readTileRow(&(buffer[offset]), x, y, length, data);
+				}
+				else {
+					this->m_input->readTileRow(row, x, y, length, data);
+					for (int i = 0; i < length; i++) {
+						memcpy(&buffer[offset + i * num_channels], &row[i * COM_NUMBER_OF_CHANNELS], sizeof(float) * num_channels);
+					}
+				}
+				offset += length * num_channels;
 			}
 			if (isBreaked()) {
 				breaked = true;
@@ -86,6 +104,37 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int tileNumber)
 			data = NULL;
 		}
 	}
+	else if (this->m_useRowExecution) {
+		int x1 = rect->xmin;
+		int y1 = rect->ymin;
+		int x2 = rect->xmax;
+		int y2 = rect->ymax;
+
+		int x;
+		int y;
+		bool breaked = false;
+		float row[COM_ROW_LENGTH * COM_NUMBER_OF_CHANNELS];
+		for (y = y1; y < y2 && (!breaked); y++) {
+			int offset = (y * memoryBuffer->getWidth() + x1) * num_channels;
+			for (x = x1; x < x2; x += COM_ROW_LENGTH) {
+				const int length = min(x2 - x, COM_ROW_LENGTH);
+				if (num_channels == COM_NUMBER_OF_CHANNELS) {
+					this->m_input->readRow(&(buffer[offset]), x, y, length);
+				}
+				else {
+					/* rows are always read as 4 channels, compact them to the buffer layout */
+					this->m_input->readRow(row, x, y, length);
+					for (int i = 0; i < length; i++) {
+						memcpy(&buffer[offset + i * num_channels], &row[i * COM_NUMBER_OF_CHANNELS], sizeof(float) * num_channels);
+					}
+				}
+				offset += length * num_channels;
+			}
+			if (isBreaked()) {
+				breaked = true;
+			}
+		}
+	}
 	else {
 		int x1 = rect->xmin;
 		int y1 = rect->ymin;
@@ -96,10 +145,12 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int tileNumber)
 		int y;
 		bool breaked = false;
 		for (y = y1; y < y2 && (!breaked); y++) {
-			int offset4 = (y * memoryBuffer->getWidth() + x1) * COM_NUMBER_OF_CHANNELS;
+			int offset = (y * memoryBuffer->getWidth() + x1) * num_channels;
 			for (x = x1; x < x2; x++) {
-				this->m_input->readSampled(&(buffer[offset4]), x, y, COM_PS_NEAREST);
-				offset4 += COM_NUMBER_OF_CHANNELS;
+				float color[4];
+				this->m_input->readSampled(color, x, y, COM_PS_NEAREST);
+				memcpy(&buffer[offset], color, sizeof(float) * num_channels);
+				offset += num_channels;
 			}
 			if (isBreaked()) {
 				breaked = true;
@@ -126,12 +177,9 @@ void WriteBufferOperation::executeOpenCLRegion(OpenCLDevice *device, rcti *rect,
 	const unsigned int outputBufferWidth = outputBuffer->getWidth();
 	const unsigned int outputBufferHeight = outputBuffer->getHeight();
 
-	const cl_image_format imageFormat = {
-		CL_RGBA,
-		CL_FLOAT
-	};
+	const cl_image_format *imageFormat = OpenCLDevice::determineImageFormat(outputBuffer);
 
-	cl_mem clOutputBuffer = clCreateImage2D(device->getContext(), CL_MEM_WRITE_ONLY | CL_MEM_USE_HOST_PTR, &imageFormat, outputBufferWidth, outputBufferHeight, 0, outputFloatBuffer, &error);
+	cl_mem clOutputBuffer = clCreateImage2D(device->getContext(), CL_MEM_WRITE_ONLY | CL_MEM_USE_HOST_PTR, imageFormat, outputBufferWidth, outputBufferHeight, 0, outputFloatBuffer, &error);
 	if (error != CL_SUCCESS) { printf("CLERROR[%d]: %s\n", error, clewErrorString(error));  }
 	
 	// STEP 2
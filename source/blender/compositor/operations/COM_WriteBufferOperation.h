@@ -25,6 +25,7 @@
 
 #include "COM_NodeOperation.h"
 #include "COM_MemoryProxy.h"
+#include "COM_ResultCache.h"
 #include "COM_SocketReader.h"
 /**
  * @brief NodeOperation to write to a tile
@@ -34,13 +35,18 @@ class WriteBufferOperation : public NodeOperation {
 	MemoryProxy *m_memoryProxy;
 	bool m_single_value; /* single value stored in buffer */
 	NodeOperation *m_input;
+	bool m_useRowExecution; /* all operations of the execution group support executeRow */
+	ResultCacheKey m_resultCacheKey; /* key of the buffer in the ResultCache */
 public:
-	WriteBufferOperation();
+	WriteBufferOperation(DataType datatype);
 	~WriteBufferOperation();
 	MemoryProxy *getMemoryProxy() { return this->m_memoryProxy; }
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 	const bool isWriteBufferOperation() const { return true; }
 	bool isSingleValue() const { return m_single_value; }
+	void setUseRowExecution(bool useRowExecution) { this->m_useRowExecution = useRowExecution; }
+	ResultCacheKey getResultCacheKey() const { return this->m_resultCacheKey; }
+	void setResultCacheKey(ResultCacheKey key) { this->m_resultCacheKey = key; }
 	
 	void executeRegion(rcti *rect, unsigned int tileNumber);
 	void initExecution();
@@ -2213,6 +2213,9 @@ void init_userdef_do_versions(void)
 		if (U.memcachelimit <= 0) {
 			U.memcachelimit = 32;
 		}
+		if (U.diskcachelimit <= 0) {
+			U.diskcachelimit = 10;
+		}
 		if (U.frameserverport == 0) {
 			U.frameserverport = 8080;
 		}
@@ -46,6 +46,8 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_linklist.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 #include "BLI_fileops_types.h"
 
@@ -1309,32 +1311,105 @@ static void thumbnail_joblist_free(ThumbnailJob *tj)
 	BLI_freelistN(&tj->loadimages);
 }
 
-static void thumbnails_startjob(void *tjv, short *stop, short *do_update, float *UNUSED(progress))
+typedef struct ThumbnailBatch {
+	short *stop;
+	/* opening movies isn't safe to do from several threads at once */
+	ThreadMutex movie_lock;
+	ThreadMutex done_lock;
+	int num_done;
+} ThumbnailBatch;
+
+static void thumbnails_task(TaskPool *pool, void *taskdata, int UNUSED(threadid))
 {
-	ThumbnailJob *tj = tjv;
-	FileImage *limg = tj->loadimages.first;
+	ThumbnailBatch *batch = BLI_task_pool_userdata(pool);
+	FileImage *limg = taskdata;
 
-	tj->stop = stop;
-	tj->do_update = do_update;
+	if (*batch->stop == 0) {
+		ImBuf *img = NULL;
 
-	while ((*stop == 0) && (limg)) {
 		if (limg->flags & IMAGEFILE) {
-			limg->img = IMB_thumb_manage(limg->path, THB_NORMAL, THB_SOURCE_IMAGE);
+			img = IMB_thumb_manage(limg->path, THB_NORMAL, THB_SOURCE_IMAGE);
 		}
 		else if (limg->flags & (BLENDERFILE | BLENDERFILE_BACKUP)) {
-			limg->img = IMB_thumb_manage(limg->path, THB_NORMAL, THB_SOURCE_BLEND);
+			img = IMB_thumb_manage(limg->path, THB_NORMAL, THB_SOURCE_BLEND);
 		}
 		else if (limg->flags & MOVIEFILE) {
-			limg->img = IMB_thumb_manage(limg->path, THB_NORMAL, THB_SOURCE_MOVIE);
-			if (!limg->img) {
+			BLI_mutex_lock(&batch->movie_lock);
+			img = IMB_thumb_manage(limg->path, THB_NORMAL, THB_SOURCE_MOVIE);
+			BLI_mutex_unlock(&batch->movie_lock);
+
+			if (!img) {
 				/* remember that file can't be loaded via IMB_open_anim */
 				limg->flags &= ~MOVIEFILE;
 				limg->flags |= MOVIEFILE_ICON;
 			}
 		}
-		*do_update = true;
-		PIL_sleep_ms(10);
-		limg = limg->next;
+
+		/* set last, thumbnails_update() picks it up from the main thread */
+		limg->img = img;
+	}
+
+	BLI_mutex_lock(&batch->done_lock);
+	batch->num_done++;
+	BLI_mutex_unlock(&batch->done_lock);
+}
+
+static void thumbnails_startjob(void *tjv, short *stop, short *do_update, float *progress)
+{
+	ThumbnailJob *tj = tjv;
+	ThumbnailBatch batch;
+	TaskPool *pool;
+	FileImage *limg;
+	const double start_time = PIL_check_seconds_timer();
+	const int num_tasks = BLI_countlist(&tj->loadimages);
+	int num_done = 0;
+
+	tj->stop = stop;
+	tj->do_update = do_update;
+
+	if (num_tasks == 0)
+		return;
+
+	batch.stop = stop;
+	BLI_mutex_init(&batch.movie_lock);
+	BLI_mutex_init(&batch.done_lock);
+	batch.num_done = 0;
+
+	pool = BLI_task_pool_create(BLI_task_scheduler_get(), &batch);
+
+	/* files are pushed in list order, so the first ones in the browser tend to be done first */
+	for (limg = tj->loadimages.first; limg; limg = limg->next) {
+		BLI_task_pool_push(pool, thumbnails_task, limg, false, TASK_PRIORITY_LOW);
+	}
+
+	while (num_done < num_tasks) {
+		int num_done_new;
+
+		PIL_sleep_ms(50);
+
+		BLI_mutex_lock(&batch.done_lock);
+		num_done_new = batch.num_done;
+		BLI_mutex_unlock(&batch.done_lock);
+
+		/* only redraw when new thumbnails came in */
+		if (num_done_new != num_done) {
+			num_done = num_done_new;
+			*progress = (float)num_done / (float)num_tasks;
+			*do_update = true;
+		}
+	}
+
+	BLI_task_pool_work_and_wait(pool);
+	BLI_task_pool_free(pool);
+
+	BLI_mutex_end(&batch.movie_lock);
+	BLI_mutex_end(&batch.done_lock);
+
+	if (G.debug & G_DEBUG) {
+		const double time = PIL_check_seconds_timer() - start_time;
+
+		printf("Thumbnails of %d files in %.2f s (%.1f files/s)%s\n",
+		       num_tasks, time, time > 0.0 ? num_tasks / time : 0.0, *stop ? ", cancelled" : "");
 	}
 }
 
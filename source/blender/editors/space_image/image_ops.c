@@ -1512,7 +1512,12 @@ static bool save_image_doit(bContext *C, SpaceImage *sima, wmOperator *op, SaveI
 
 		if (simopts->im_format.imtype == R_IMF_IMTYPE_MULTILAYER) {
 			Scene *scene = CTX_data_scene(C);
-			RenderResult *rr = BKE_image_acquire_renderresult(scene, ima);
+			RenderResult *rr;
+
+			/* passes of lazily loaded multilayer images might not be read yet */
+			BKE_image_multilayer_ensure_passes(ima);
+
+			rr = BKE_image_acquire_renderresult(scene, ima);
 			if (rr) {
 				ok = RE_WriteRenderResult(op->reports, rr, simopts->filepath, simopts->im_format.exr_codec);
 			}
@@ -861,7 +861,7 @@ ImBuf *sequencer_ibuf_get(struct Main *bmain, Scene *scene, SpaceSeq *sseq, int
 
 	if (special_seq_update)
 		ibuf = BKE_sequencer_give_ibuf_direct(&context, cfra + frame_ofs, special_seq_update);
-	else if (!U.prefetchframes) // XXX || (G.f & G_PLAYANIM) == 0) {
+	else if (!U.prefetchframes)
 		ibuf = BKE_sequencer_give_ibuf(&context, cfra + frame_ofs, sseq->chanshown);
 	else
 		ibuf = BKE_sequencer_give_ibuf_threaded(&context, cfra + frame_ofs, sseq->chanshown);
@@ -1285,33 +1285,6 @@ void draw_image_seq(const bContext *C, Scene *scene, ARegion *ar, SpaceSeq *sseq
 		IMB_display_buffer_release(cache_handle);
 }
 
-#if 0
-void drawprefetchseqspace(Scene *scene, ARegion *UNUSED(ar), SpaceSeq *sseq)
-{
-	int rectx, recty;
-	int render_size = sseq->render_size;
-	int proxy_size = 100.0; 
-	if (render_size == 0) {
-		render_size = scene->r.size;
-	}
-	else {
-		proxy_size = render_size;
-	}
-	if (render_size < 0) {
-		return;
-	}
-
-	rectx = (render_size * scene->r.xsch) / 100;
-	recty = (render_size * scene->r.ysch) / 100;
-
-	if (sseq->mainb != SEQ_DRAW_SEQUENCE) {
-		give_ibuf_prefetch_request(
-		    rectx, recty, (scene->r.cfra), sseq->chanshown,
-		    proxy_size);
-	}
-}
-#endif
-
 /* draw backdrop of the sequencer strips view */
 static void draw_seq_backdrop(View2D *v2d)
 {
@@ -35,6 +35,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_ghash.h"
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
 
@@ -123,6 +124,8 @@ typedef struct ProxyBuildJob {
 	Scene *scene; 
 	struct Main *main;
 	ListBase queue;
+	/* movie files the queued contexts build */
+	GSet *file_list;
 	int stop;
 } ProxyJob;
 
@@ -132,6 +135,9 @@ static void proxy_freejob(void *pjv)
 
 	BLI_freelistN(&pj->queue);
 
+	if (pj->file_list)
+		BLI_gset_free(pj->file_list, MEM_freeN);
+
 	MEM_freeN(pj);
 }
 
@@ -139,13 +145,8 @@ static void proxy_freejob(void *pjv)
 static void proxy_startjob(void *pjv, short *stop, short *do_update, float *progress)
 {
 	ProxyJob *pj = pjv;
-	LinkData *link;
-
-	for (link = pj->queue.first; link; link = link->next) {
-		struct SeqIndexBuildContext *context = link->data;
 
-		BKE_sequencer_proxy_rebuild(context, stop, do_update, progress);
-	}
+	BKE_sequencer_proxy_rebuild_batch(&pj->queue, stop, do_update, progress);
 
 	if (*stop) {
 		pj->stop = 1;
@@ -160,7 +161,9 @@ static void proxy_endjob(void *pjv)
 	LinkData *link;
 
 	for (link = pj->queue.first; link; link = link->next) {
-		BKE_sequencer_proxy_rebuild_finish(link->data, pj->stop);
+		if (link->data) {
+			BKE_sequencer_proxy_rebuild_finish(link->data, pj->stop);
+		}
 	}
 
 	BKE_sequencer_free_imbuf(pj->scene, &ed->seqbase, false);
@@ -168,6 +171,44 @@ static void proxy_endjob(void *pjv)
 	WM_main_add_notifier(NC_SCENE | ND_SEQUENCER, pj->scene);
 }
 
+static void seq_proxy_build_queue(ProxyJob *pj, Editing *ed)
+{
+	struct SeqIndexBuildContext *context;
+	Sequence *seq;
+
+	if (!pj->file_list)
+		pj->file_list = BLI_gset_new(BLI_ghashutil_strhash_p, BLI_ghashutil_strcmp, "proxy rebuild files");
+
+	SEQP_BEGIN (ed, seq)
+	{
+		if ((seq->flag & SELECT)) {
+			context = BKE_sequencer_proxy_rebuild_context(pj->main, pj->scene, seq, pj->file_list);
+			if (context) {
+				BLI_addtail(&pj->queue, BLI_genericNodeN(context));
+			}
+		}
+	}
+	SEQ_END
+}
+
+/* without a window manager to run jobs, for batch builds from background mode */
+static void seq_proxy_build_blocking(const bContext *C)
+{
+	ProxyJob *pj = MEM_callocN(sizeof(ProxyJob), "proxy rebuild job");
+	short stop = false, do_update = false;
+	float progress = 0.0f;
+
+	pj->scene = CTX_data_scene(C);
+	pj->main = CTX_data_main(C);
+
+	seq_proxy_build_queue(pj, BKE_sequencer_editing_get(pj->scene, false));
+
+	G.is_break = false;
+	proxy_startjob(pj, &stop, &do_update, &progress);
+	proxy_endjob(pj);
+	proxy_freejob(pj);
+}
+
 static void seq_proxy_build_job(const bContext *C)
 {
 	wmJob *wm_job;
@@ -175,9 +216,6 @@ static void seq_proxy_build_job(const bContext *C)
 	Scene *scene = CTX_data_scene(C);
 	Editing *ed = BKE_sequencer_editing_get(scene, false);
 	ScrArea *sa = CTX_wm_area(C);
-	struct SeqIndexBuildContext *context;
-	LinkData *link;
-	Sequence *seq;
 
 	wm_job = WM_jobs_get(CTX_wm_manager(C), CTX_wm_window(C), sa, "Building Proxies",
 	                     WM_JOB_PROGRESS, WM_JOB_TYPE_SEQ_BUILD_PROXY);
@@ -195,15 +233,7 @@ static void seq_proxy_build_job(const bContext *C)
 		WM_jobs_callbacks(wm_job, proxy_startjob, NULL, NULL, proxy_endjob);
 	}
 
-	SEQP_BEGIN (ed, seq)
-	{
-		if ((seq->flag & SELECT)) {
-			context = BKE_sequencer_proxy_rebuild_context(pj->main, pj->scene, seq);
-			link = BLI_genericNodeN(context);
-			BLI_addtail(&pj->queue, link);
-		}
-	}
-	SEQ_END
+	seq_proxy_build_queue(pj, ed);
 
 	if (!WM_jobs_is_running(wm_job)) {
 		G.is_break = false;
@@ -3358,21 +3388,36 @@ void SEQUENCER_OT_view_ghost_border(wmOperatorType *ot)
 /* rebuild_proxy operator */
 static int sequencer_rebuild_proxy_exec(bContext *C, wmOperator *UNUSED(op))
 {
-	seq_proxy_build_job(C);
+	if (G.background)
+		seq_proxy_build_blocking(C);
+	else
+		seq_proxy_build_job(C);
 
 	return OPERATOR_FINISHED;
 }
 
+static int sequencer_rebuild_proxy_poll(bContext *C)
+{
+	/* background mode has no sequencer editor, the strips of the scene are used */
+	if (G.background) {
+		Scene *scene = CTX_data_scene(C);
+		return scene && BKE_sequencer_editing_get(scene, false);
+	}
+
+	return ED_operator_sequencer_active(C);
+}
+
 void SEQUENCER_OT_rebuild_proxy(wmOperatorType *ot)
 {
 	/* identifiers */
 	ot->name = "Rebuild Proxy and Timecode Indices";
 	ot->idname = "SEQUENCER_OT_rebuild_proxy";
-	ot->description = "Rebuild all selected proxies and timecode indices using the job system";
+	ot->description = "Rebuild all selected proxies and timecode indices using the job system, "
+	                  "several strips are built at the same time";
 	
 	/* api callbacks */
 	ot->exec = sequencer_rebuild_proxy_exec;
-	ot->poll = ED_operator_sequencer_active;
+	ot->poll = sequencer_rebuild_proxy_poll;
 	
 	/* flags */
 	ot->flag = OPTYPE_REGISTER;
@@ -86,6 +86,8 @@ struct anim;
 
 struct ColorManagedDisplay;
 
+struct GSet;
+
 /**
  *
  * \attention Defined in allocimbuf.c
@@ -111,6 +113,13 @@ struct ImBuf *IMB_testiffname(const char *filepath, int flags);
  */
 struct ImBuf *IMB_loadiffname(const char *filepath, int flags, char colorspace[IM_MAX_SPACE]);
 
+/**
+ *
+ * \attention Defined in readimage.c
+ */
+struct ImBuf *IMB_thumb_load_image(const char *filepath, const size_t max_thumb_size, char colorspace[IM_MAX_SPACE],
+                                   size_t *r_width, size_t *r_height);
+
 /**
  *
  * \attention Defined in allocimbuf.c
@@ -238,14 +247,19 @@ int IMB_anim_index_get_frame_index(struct anim *anim, IMB_Timecode_Type tc,
 
 struct IndexBuildContext;
 
-/* prepare context for proxies/imecodes builder */
+/* prepare context for proxies/imecodes builder, file_list holds the files other contexts build already,
+ * they are left out and the files of this context are added, returns NULL when nothing is left to build */
 struct IndexBuildContext *IMB_anim_index_rebuild_context(struct anim *anim, IMB_Timecode_Type tcs_in_use,
-                                                         IMB_Proxy_Size proxy_sizes_in_use, int quality);
+                                                         IMB_Proxy_Size proxy_sizes_in_use, int quality,
+                                                         struct GSet *file_list);
 
 /* will rebuild all used indices and proxies at once */
 void IMB_anim_index_rebuild(struct IndexBuildContext *context,
                             short *stop, short *do_update, float *progress);
 
+/* number of frames read by the rebuild and the time it took */
+void IMB_anim_index_rebuild_stats(struct IndexBuildContext *context, int *r_num_frames, double *r_time);
+
 /* finish rebuilding proxises/timecodes and free temporary contexts used */
 void IMB_anim_index_rebuild_finish(struct IndexBuildContext *context, short stop);
 
@@ -360,6 +374,20 @@ struct ImBuf *IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned
  */
 void IMB_scaleImBuf_threaded(struct ImBuf *ibuf, unsigned int newx, unsigned int newy);
 
+/* filters of IMB_scaleImBuf_filter */
+enum {
+	IMB_SCALE_FILTER_BOX = 0,  /* area average, used by IMB_scaleImBuf */
+	IMB_SCALE_FILTER_BILINEAR,
+	IMB_SCALE_FILTER_MITCHELL,
+	IMB_SCALE_FILTER_LANCZOS
+};
+
+/**
+ *
+ * \attention Defined in scaling.c
+ */
+struct ImBuf *IMB_scaleImBuf_filter(struct ImBuf *ibuf, unsigned int newx, unsigned int newy, int filter);
+
 /**
  *
  * \attention Defined in writeimage.c
@@ -39,6 +39,7 @@
  * Supposed to provide unified cache system for movie clips, sequencer and
  * other movie-related areas */
 
+struct DynStr;
 struct ImBuf;
 struct MovieCache;
 
@@ -48,6 +49,10 @@ typedef void  *(*MovieCacheGetPriorityDataFP) (void *userkey);
 typedef int    (*MovieCacheGetItemPriorityFP) (void *last_userkey, void *priority_data);
 typedef void   (*MovieCachePriorityDeleterFP) (void *priority_data);
 
+/* describe everything the frame of userkey depends on, frames with the same description are shared
+ * between sessions through the disk cache. returns false when the frame can't be described */
+typedef bool   (*MovieCacheGetDiskKeyFP) (void *userkey, void *userdata, struct DynStr *r_key);
+
 void IMB_moviecache_init(void);
 void IMB_moviecache_destruct(void);
 
@@ -56,6 +61,11 @@ void IMB_moviecache_set_getdata_callback(struct MovieCache *cache, MovieCacheGet
 void IMB_moviecache_set_priority_callback(struct MovieCache *cache, MovieCacheGetPriorityDataFP getprioritydatafp,
                                           MovieCacheGetItemPriorityFP getitempriorityfp,
                                           MovieCachePriorityDeleterFP prioritydeleterfp);
+void IMB_moviecache_set_disk_callback(struct MovieCache *cache, MovieCacheGetDiskKeyFP getdiskkeyfp, void *userdata);
+
+/* frames freed by the memory cache limiter are stored in dir, an empty dir disables the disk cache */
+void IMB_moviecache_set_disk_cache(const char *dir, size_t limit);
+bool IMB_moviecache_disk_key_file(struct DynStr *key, const char *filepath);
 
 void IMB_moviecache_put(struct MovieCache *cache, void *userkey, struct ImBuf *ibuf);
 bool IMB_moviecache_put_if_possible(struct MovieCache *cache, void *userkey, struct ImBuf *ibuf);
@@ -63,6 +73,7 @@ struct ImBuf *IMB_moviecache_get(struct MovieCache *cache, void *userkey);
 bool IMB_moviecache_has_frame(struct MovieCache *cache, void *userkey);
 void IMB_moviecache_free(struct MovieCache *cache);
 
+/* ibuf is NULL when the frame is only in the disk cache */
 void IMB_moviecache_cleanup(struct MovieCache *cache,
                             bool (cleanup_check_cb) (struct ImBuf *ibuf, void *userkey, void *userdata),
                             void *userdata);
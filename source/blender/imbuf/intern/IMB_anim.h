@@ -119,9 +119,20 @@
 
 #define MAXNUMSTREAMS       50
 
+/* most recently decoded movie frames kept per anim, limited by FFMPEG_FRAME_RING_MEMORY as well */
+#define FFMPEG_FRAME_RING_SIZE      16
+#define FFMPEG_FRAME_RING_MEMORY    (32 * 1024 * 1024)
+
 struct _AviMovie;
 struct anim_index;
 
+#ifdef WITH_FFMPEG
+typedef struct FFmpegRingFrame {
+	struct ImBuf *ibuf;
+	int64_t pts;
+} FFmpegRingFrame;
+#endif
+
 struct anim {
 	int ib_flags;
 	int curtype;
@@ -173,12 +184,26 @@ struct anim {
 	AVFrame *pFrameRGB;
 	AVFrame *pFrameDeinterlaced;
 	struct SwsContext *img_convert_ctx;
+	/* contexts converting horizontal bands of the frame in parallel, NULL when not supported */
+	struct SwsContext **img_convert_bands;
+	int img_convert_band_height;
+	int img_convert_num_bands;
 	int videoStream;
 
 	struct ImBuf *last_frame;
 	int64_t last_pts;
 	int64_t next_pts;
 	AVPacket next_packet;
+
+	/* frames decoded before the last one, scrubbing back to them doesn't need a seek */
+	FFmpegRingFrame frame_ring[FFMPEG_FRAME_RING_SIZE];
+	int frame_ring_size;
+	int frame_ring_next;
+
+	/* statistics printed when the movie is closed in debug mode */
+	int decoded_frames;
+	int ring_hits;
+	double decode_time;
 #endif
 
 #ifdef WITH_REDCODE
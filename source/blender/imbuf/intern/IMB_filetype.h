@@ -43,6 +43,10 @@ typedef struct ImFileType {
 	int (*ftype)(struct ImFileType *type, struct ImBuf *ibuf);
 	struct ImBuf *(*load)(unsigned char *mem, size_t size, int flags, char colorspace[IM_MAX_SPACE]);
 	struct ImBuf *(*load_filepath)(const char *name, int flags, char colorspace[IM_MAX_SPACE]);
+	/* optional, decodes a reduced resolution image of at least max_thumb_size,
+	 * r_width/r_height return the size of the full image */
+	struct ImBuf *(*load_filepath_thumbnail)(const char *name, const int flags, const size_t max_thumb_size,
+	                                         char colorspace[IM_MAX_SPACE], size_t *r_width, size_t *r_height);
 	int (*save)(struct ImBuf *ibuf, const char *name, int flags);
 	void (*load_tile)(struct ImBuf *ibuf, unsigned char *mem, size_t size, int tx, int ty, unsigned int *rect);
 
@@ -60,6 +64,9 @@ void imb_filetypes_exit(void);
 void imb_tile_cache_init(void);
 void imb_tile_cache_exit(void);
 
+void imb_thumb_load_init(void);
+void imb_thumb_load_exit(void);
+
 void imb_loadtile(struct ImBuf *ibuf, int tx, int ty, unsigned int *rect);
 void imb_tile_cache_tile_free(struct ImBuf *ibuf, int tx, int ty);
 
@@ -89,6 +96,8 @@ int imb_savejp2(struct ImBuf *ibuf, const char *name, int flags);
 int imb_is_a_jpeg(unsigned char *mem);
 int imb_savejpeg(struct ImBuf *ibuf, const char *name, int flags);
 struct ImBuf *imb_load_jpeg (unsigned char *buffer, size_t size, int flags, char colorspace[IM_MAX_SPACE]);
+struct ImBuf *imb_thumbnail_jpeg(const char *filepath, const int flags, const size_t max_thumb_size,
+                                 char colorspace[IM_MAX_SPACE], size_t *r_width, size_t *r_height);
 
 /* bmp */
 int imb_is_a_bmp(unsigned char *buf);
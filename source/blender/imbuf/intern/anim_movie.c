@@ -67,6 +67,10 @@
 #include "BLI_utildefines.h"
 #include "BLI_string.h"
 #include "BLI_path_util.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "PIL_time.h"
 
 #include "MEM_guardedalloc.h"
 
@@ -458,6 +462,123 @@ static ImBuf *avi_fetchibuf(struct anim *anim, int position)
 
 #ifdef WITH_FFMPEG
 
+/* rows of a band are a multiple of this, so every band starts at a chroma row */
+#define FFMPEG_CONVERT_BAND_ALIGN       16
+/* frames are not split into bands with less rows than this */
+#define FFMPEG_CONVERT_BAND_MIN_HEIGHT  64
+
+static struct SwsContext *ffmpeg_sws_context_create(struct anim *anim, int height, int flags)
+{
+	struct SwsContext *ctx;
+
+#ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
+	/* The following for color space determination */
+	int srcRange, dstRange, brightness, contrast, saturation;
+	int *table;
+	const int *inv_table;
+#endif
+
+	ctx = sws_getContext(
+	        anim->x,
+	        height,
+	        anim->pCodecCtx->pix_fmt,
+	        anim->x,
+	        height,
+	        PIX_FMT_RGBA,
+	        flags,
+	        NULL, NULL, NULL);
+
+	if (!ctx) {
+		return NULL;
+	}
+
+#ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
+	/* Try do detect if input has 0-255 YCbCR range (JFIF Jpeg MotionJpeg) */
+	if (!sws_getColorspaceDetails(ctx, (int **)&inv_table, &srcRange,
+	                              &table, &dstRange, &brightness, &contrast, &saturation))
+	{
+		srcRange = srcRange || anim->pCodecCtx->color_range == AVCOL_RANGE_JPEG;
+		inv_table = sws_getCoefficients(anim->pCodecCtx->colorspace);
+
+		if (sws_setColorspaceDetails(ctx, (int *)inv_table, srcRange,
+		                             table, dstRange, brightness, contrast, saturation))
+		{
+			fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
+		}
+	}
+	else {
+		fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
+	}
+#endif
+
+	return ctx;
+}
+
+/* planar formats without a palette, the planes of a band are found by offsetting their rows */
+static bool ffmpeg_convert_bands_supported(int pix_fmt)
+{
+	switch (pix_fmt) {
+		case PIX_FMT_YUV420P:
+		case PIX_FMT_YUVJ420P:
+		case PIX_FMT_YUV422P:
+		case PIX_FMT_YUVJ422P:
+		case PIX_FMT_YUV444P:
+		case PIX_FMT_YUVJ444P:
+			return true;
+		default:
+			return false;
+	}
+}
+
+static void ffmpeg_convert_bands_free(struct anim *anim)
+{
+	int i;
+
+	if (anim->img_convert_bands) {
+		for (i = 0; i < anim->img_convert_num_bands; i++) {
+			if (anim->img_convert_bands[i]) {
+				sws_freeContext(anim->img_convert_bands[i]);
+			}
+		}
+		MEM_freeN(anim->img_convert_bands);
+		anim->img_convert_bands = NULL;
+	}
+	anim->img_convert_num_bands = 0;
+	anim->img_convert_band_height = 0;
+}
+
+/* color conversion of a frame is done by a context per band of rows, converted in parallel */
+static void ffmpeg_convert_bands_create(struct anim *anim)
+{
+	int num_bands = MIN2(BLI_system_thread_count(), anim->y / FFMPEG_CONVERT_BAND_MIN_HEIGHT);
+	int band_height, i;
+
+	if (num_bands < 2 || !ffmpeg_convert_bands_supported(anim->pCodecCtx->pix_fmt)) {
+		return;
+	}
+
+	band_height = (anim->y + num_bands - 1) / num_bands;
+	band_height = (band_height + FFMPEG_CONVERT_BAND_ALIGN - 1) / FFMPEG_CONVERT_BAND_ALIGN * FFMPEG_CONVERT_BAND_ALIGN;
+	num_bands = (anim->y + band_height - 1) / band_height;
+
+	anim->img_convert_bands = MEM_callocN(sizeof(struct SwsContext *) * num_bands, "ffmpeg convert bands");
+	anim->img_convert_num_bands = num_bands;
+	anim->img_convert_band_height = band_height;
+
+	for (i = 0; i < num_bands; i++) {
+		const int height = MIN2(band_height, anim->y - i * band_height);
+
+		anim->img_convert_bands[i] = ffmpeg_sws_context_create(
+		        anim, height, SWS_FAST_BILINEAR | SWS_FULL_CHR_H_INT);
+
+		if (!anim->img_convert_bands[i]) {
+			/* convert whole frames instead */
+			ffmpeg_convert_bands_free(anim);
+			return;
+		}
+	}
+}
+
 static int startffmpeg(struct anim *anim)
 {
 	int i, videoStream;
@@ -470,13 +591,6 @@ static int startffmpeg(struct anim *anim)
 	double frs_den;
 	int streamcount;
 
-#ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
-	/* The following for color space determination */
-	int srcRange, dstRange, brightness, contrast, saturation;
-	int *table;
-	const int *inv_table;
-#endif
-
 	if (anim == NULL) return(-1);
 
 	streamcount = anim->streamindex;
@@ -522,6 +636,12 @@ static int startffmpeg(struct anim *anim)
 
 	pCodecCtx->workaround_bugs = 1;
 
+#ifdef FF_THREAD_FRAME
+	/* codecs without frame threading decode slices of a frame in parallel */
+	pCodecCtx->thread_count = BLI_system_thread_count();
+	pCodecCtx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+#endif
+
 	if (avcodec_open2(pCodecCtx, pCodec, NULL) < 0) {
 		avformat_close_input(&pFormatCtx);
 		return -1;
@@ -565,6 +685,13 @@ static int startffmpeg(struct anim *anim)
 	anim->next_pts = -1;
 	anim->next_packet.stream_index = -1;
 
+	anim->frame_ring_size = anim->framesize ?
+	                        MIN2(FFMPEG_FRAME_RING_SIZE, (int)(FFMPEG_FRAME_RING_MEMORY / anim->framesize)) : 0;
+	anim->frame_ring_next = 0;
+	anim->decoded_frames = 0;
+	anim->ring_hits = 0;
+	anim->decode_time = 0.0;
+
 	anim->pFrame = avcodec_alloc_frame();
 	anim->pFrameComplete = false;
 	anim->pFrameDeinterlaced = avcodec_alloc_frame();
@@ -603,16 +730,9 @@ static int startffmpeg(struct anim *anim)
 		anim->preseek = 0;
 	}
 	
-	anim->img_convert_ctx = sws_getContext(
-	        anim->x,
-	        anim->y,
-	        anim->pCodecCtx->pix_fmt,
-	        anim->x,
-	        anim->y,
-	        PIX_FMT_RGBA,
-	        SWS_FAST_BILINEAR | SWS_PRINT_INFO | SWS_FULL_CHR_H_INT,
-	        NULL, NULL, NULL);
-		
+	anim->img_convert_ctx = ffmpeg_sws_context_create(
+	        anim, anim->y, SWS_FAST_BILINEAR | SWS_PRINT_INFO | SWS_FULL_CHR_H_INT);
+
 	if (!anim->img_convert_ctx) {
 		fprintf(stderr,
 		        "Can't transform color space??? Bailing out...\n");
@@ -625,42 +745,81 @@ static int startffmpeg(struct anim *anim)
 		return -1;
 	}
 
-#ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
-	/* Try do detect if input has 0-255 YCbCR range (JFIF Jpeg MotionJpeg) */
-	if (!sws_getColorspaceDetails(anim->img_convert_ctx, (int **)&inv_table, &srcRange,
-	                              &table, &dstRange, &brightness, &contrast, &saturation))
-	{
-		srcRange = srcRange || anim->pCodecCtx->color_range == AVCOL_RANGE_JPEG;
-		inv_table = sws_getCoefficients(anim->pCodecCtx->colorspace);
+	ffmpeg_convert_bands_create(anim);
 
-		if (sws_setColorspaceDetails(anim->img_convert_ctx, (int *)inv_table, srcRange,
-		                             table, dstRange, brightness, contrast, saturation))
-		{
-			fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
-		}
+	return (0);
+}
+
+typedef struct FFmpegConvertData {
+	struct anim *anim;
+	AVFrame *input;
+	/* first row of the output, followed by the next rows at dst_stride */
+	uint8_t *dst;
+	int dst_stride;
+} FFmpegConvertData;
+
+static void ffmpeg_convert_band(void *userdata, int band)
+{
+	FFmpegConvertData *data = userdata;
+	struct anim *anim = data->anim;
+	const int y = band * anim->img_convert_band_height;
+	const int height = MIN2(anim->img_convert_band_height, anim->y - y);
+	const uint8_t *src[4];
+	uint8_t *dst[4] = {data->dst + (ptrdiff_t)y * data->dst_stride, 0, 0, 0};
+	int dst_stride[4] = {data->dst_stride, 0, 0, 0};
+	int h_shift, v_shift, i;
+
+	avcodec_get_chroma_sub_sample(anim->pCodecCtx->pix_fmt, &h_shift, &v_shift);
+
+	for (i = 0; i < 4; i++) {
+		const int plane_y = (i == 1 || i == 2) ? (y >> v_shift) : y;
+
+		src[i] = data->input->data[i] ? data->input->data[i] + (ptrdiff_t)plane_y * data->input->linesize[i] : NULL;
+	}
+
+	sws_scale(anim->img_convert_bands[band], src, data->input->linesize, 0, height, dst, dst_stride);
+}
+
+/* convert input to RGBA rows starting at dst */
+static void ffmpeg_convert(struct anim *anim, AVFrame *input, uint8_t *dst, int dst_stride)
+{
+	if (anim->img_convert_bands) {
+		FFmpegConvertData data;
+
+		data.anim = anim;
+		data.input = input;
+		data.dst = dst;
+		data.dst_stride = dst_stride;
+
+		BLI_task_parallel_range_ex(0, anim->img_convert_num_bands, &data, ffmpeg_convert_band, 1, false);
 	}
 	else {
-		fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
+		uint8_t *dst2[4] = {dst, 0, 0, 0};
+		int dstStride2[4] = {dst_stride, 0, 0, 0};
+
+		sws_scale(anim->img_convert_ctx,
+		          (const uint8_t *const *)input->data,
+		          input->linesize,
+		          0,
+		          anim->y,
+		          dst2,
+		          dstStride2);
 	}
-#endif
-		
-	return (0);
 }
 
 /* postprocess the image in anim->pFrame and do color conversion
  * and deinterlacing stuff.
  *
- * Output is anim->last_frame
+ * Output is ibuf, returns false when there was no frame to convert
  */
 
-static void ffmpeg_postprocess(struct anim *anim)
+static bool ffmpeg_postprocess(struct anim *anim, ImBuf *ibuf)
 {
 	AVFrame *input = anim->pFrame;
-	ImBuf *ibuf = anim->last_frame;
 	int filter_y = 0;
 
 	if (!anim->pFrameComplete) {
-		return;
+		return false;
 	}
 
 	/* This means the data wasnt read properly, 
@@ -670,7 +829,7 @@ static void ffmpeg_postprocess(struct anim *anim)
 	{
 		fprintf(stderr, "ffmpeg_fetchibuf: "
 		        "data not read properly...\n");
-		return;
+		return false;
 	}
 
 	av_log(anim->pFormatCtx, AV_LOG_DEBUG, 
@@ -703,19 +862,11 @@ static void ffmpeg_postprocess(struct anim *anim)
 	if (ENDIAN_ORDER == B_ENDIAN) {
 		int *dstStride   = anim->pFrameRGB->linesize;
 		uint8_t **dst     = anim->pFrameRGB->data;
-		int dstStride2[4] = { dstStride[0], 0, 0, 0 };
-		uint8_t *dst2[4]  = { dst[0], 0, 0, 0 };
 		int x, y, h, w;
 		unsigned char *bottom;
 		unsigned char *top;
 		
-		sws_scale(anim->img_convert_ctx,
-		          (const uint8_t *const *)input->data,
-		          input->linesize,
-		          0,
-		          anim->y,
-		          dst2,
-		          dstStride2);
+		ffmpeg_convert(anim, input, dst[0], dstStride[0]);
 		
 		bottom = (unsigned char *) ibuf->rect;
 		top = bottom + ibuf->x * (ibuf->y - 1) * 4;
@@ -750,22 +901,92 @@ static void ffmpeg_postprocess(struct anim *anim)
 	else {
 		int *dstStride   = anim->pFrameRGB->linesize;
 		uint8_t **dst     = anim->pFrameRGB->data;
-		int dstStride2[4] = { -dstStride[0], 0, 0, 0 };
-		uint8_t *dst2[4]  = { dst[0] + (anim->y - 1) * dstStride[0],
-			                  0, 0, 0 };
-		
-		sws_scale(anim->img_convert_ctx,
-		          (const uint8_t *const *)input->data,
-		          input->linesize,
-		          0,
-		          anim->y,
-		          dst2,
-		          dstStride2);
+
+		ffmpeg_convert(anim, input, dst[0] + (anim->y - 1) * dstStride[0], -dstStride[0]);
 	}
 
 	if (filter_y) {
 		IMB_filtery(ibuf);
 	}
+
+	return true;
+}
+
+static ImBuf *ffmpeg_frame_alloc(struct anim *anim)
+{
+	ImBuf *ibuf = IMB_allocImBuf(anim->x, anim->y, 32, IB_rect);
+	ibuf->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
+	return ibuf;
+}
+
+static void ffmpeg_frame_ring_add(struct anim *anim, ImBuf *ibuf, int64_t pts)
+{
+	FFmpegRingFrame *frame = NULL;
+	int i;
+
+	if (anim->frame_ring_size == 0) {
+		return;
+	}
+
+	for (i = 0; i < anim->frame_ring_size; i++) {
+		if (anim->frame_ring[i].ibuf && anim->frame_ring[i].pts == pts) {
+			frame = &anim->frame_ring[i];
+			break;
+		}
+	}
+
+	if (frame == NULL) {
+		frame = &anim->frame_ring[anim->frame_ring_next];
+		anim->frame_ring_next = (anim->frame_ring_next + 1) % anim->frame_ring_size;
+	}
+
+	IMB_refImBuf(ibuf);
+	if (frame->ibuf) {
+		IMB_freeImBuf(frame->ibuf);
+	}
+	frame->ibuf = ibuf;
+	frame->pts = pts;
+}
+
+/* convert the decoded frame in anim->pFrame into the frame ring */
+static void ffmpeg_frame_ring_add_decoded(struct anim *anim)
+{
+	ImBuf *ibuf = ffmpeg_frame_alloc(anim);
+
+	if (ffmpeg_postprocess(anim, ibuf)) {
+		ffmpeg_frame_ring_add(anim, ibuf, anim->next_pts);
+	}
+	IMB_freeImBuf(ibuf);
+}
+
+/* frame within half a frame duration of pts, the returned buffer is referenced */
+static ImBuf *ffmpeg_frame_ring_find(struct anim *anim, int64_t pts, double pts_duration)
+{
+	int i;
+
+	for (i = 0; i < anim->frame_ring_size; i++) {
+		FFmpegRingFrame *frame = &anim->frame_ring[i];
+
+		if (frame->ibuf && fabs((double)(frame->pts - pts)) < pts_duration * 0.5) {
+			IMB_refImBuf(frame->ibuf);
+			return frame->ibuf;
+		}
+	}
+
+	return NULL;
+}
+
+static void ffmpeg_frame_ring_free(struct anim *anim)
+{
+	int i;
+
+	for (i = 0; i < FFMPEG_FRAME_RING_SIZE; i++) {
+		if (anim->frame_ring[i].ibuf) {
+			IMB_freeImBuf(anim->frame_ring[i].ibuf);
+			anim->frame_ring[i].ibuf = NULL;
+		}
+	}
+	anim->frame_ring_next = 0;
 }
 
 /* decode one video frame also considering the packet read into next_packet */
@@ -807,6 +1028,7 @@ static int ffmpeg_decode_video_frame(struct anim *anim)
 			if (anim->pFrameComplete) {
 				anim->next_pts = av_get_pts_from_frame(
 				        anim->pFormatCtx, anim->pFrame);
+				anim->decoded_frames++;
 
 				av_log(anim->pFormatCtx,
 				       AV_LOG_DEBUG,
@@ -846,6 +1068,7 @@ static int ffmpeg_decode_video_frame(struct anim *anim)
 		if (anim->pFrameComplete) {
 			anim->next_pts = av_get_pts_from_frame(
 				anim->pFormatCtx, anim->pFrame);
+			anim->decoded_frames++;
 
 			av_log(anim->pFormatCtx,
 			       AV_LOG_DEBUG,
@@ -872,10 +1095,12 @@ static int ffmpeg_decode_video_frame(struct anim *anim)
 }
 
 static void ffmpeg_decode_video_frame_scan(
-        struct anim *anim, int64_t pts_to_search)
+        struct anim *anim, int64_t pts_to_search, double pts_duration)
 {
 	/* there seem to exist *very* silly GOP lengths out in the wild... */
 	int count = 1000;
+	/* frames decoded after this are kept, stepping back from the searched frame reuses them */
+	const int64_t pts_ring_start = pts_to_search - (int64_t)(anim->frame_ring_size * pts_duration);
 
 	av_log(anim->pFormatCtx,
 	       AV_LOG_DEBUG, 
@@ -890,6 +1115,9 @@ static void ffmpeg_decode_video_frame_scan(
 		if (!ffmpeg_decode_video_frame(anim)) {
 			break;
 		}
+		if (anim->next_pts >= pts_ring_start && anim->next_pts < pts_to_search) {
+			ffmpeg_frame_ring_add_decoded(anim);
+		}
 		count--;
 	}
 	if (count == 0) {
@@ -960,6 +1188,9 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 	AVStream *v_st;
 	int new_frame_index = 0; /* To quiet gcc barking... */
 	int old_frame_index = 0; /* To quiet gcc barking... */
+	double pts_duration;
+	double start_time;
+	ImBuf *ibuf;
 
 	if (anim == NULL) return (0);
 
@@ -975,6 +1206,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 
 	st_time = anim->pFormatCtx->start_time;
 	pts_time_base = av_q2d(v_st->time_base);
+	pts_duration = 1.0 / (pts_time_base * frame_rate);
 
 	if (tc_index) {
 		new_frame_index = IMB_indexer_get_frame_index(
@@ -1010,7 +1242,18 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 		anim->curposition = position;
 		return anim->last_frame;
 	}
-	 
+
+	/* the decoder stays at curposition, playing on from there doesn't need a seek */
+	ibuf = ffmpeg_frame_ring_find(anim, pts_to_search, pts_duration);
+	if (ibuf) {
+		av_log(anim->pFormatCtx, AV_LOG_DEBUG,
+		       "FETCH: frame ring hit\n");
+		anim->ring_hits++;
+		return ibuf;
+	}
+
+	start_time = PIL_check_seconds_timer();
+
 	if (position > anim->curposition + 1 &&
 	    anim->preseek &&
 	    !tc_index &&
@@ -1019,7 +1262,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 		av_log(anim->pFormatCtx, AV_LOG_DEBUG, 
 		       "FETCH: within preseek interval (no index)\n");
 
-		ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+		ffmpeg_decode_video_frame_scan(anim, pts_to_search, pts_duration);
 	}
 	else if (tc_index &&
 	         IMB_indexer_can_scan(tc_index, old_frame_index,
@@ -1029,7 +1272,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 		       "FETCH: within preseek interval "
 		       "(index tells us)\n");
 
-		ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+		ffmpeg_decode_video_frame_scan(anim, pts_to_search, pts_duration);
 	}
 	else if (position != anim->curposition + 1) {
 		long long pos;
@@ -1108,7 +1351,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 		/* memset(anim->pFrame, ...) ?? */
 
 		if (ret >= 0) {
-			ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+			ffmpeg_decode_video_frame_scan(anim, pts_to_search, pts_duration);
 		}
 	}
 	else if (position == 0 && anim->curposition == -1) {
@@ -1121,16 +1364,18 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 	}
 
 	IMB_freeImBuf(anim->last_frame);
-	anim->last_frame = IMB_allocImBuf(anim->x, anim->y, 32, IB_rect);
-	anim->last_frame->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
+	anim->last_frame = ffmpeg_frame_alloc(anim);
 
-	ffmpeg_postprocess(anim);
+	if (ffmpeg_postprocess(anim, anim->last_frame)) {
+		ffmpeg_frame_ring_add(anim, anim->last_frame, anim->next_pts);
+	}
 
 	anim->last_pts = anim->next_pts;
 	
 	ffmpeg_decode_video_frame(anim);
 	
 	anim->curposition = position;
+	anim->decode_time += PIL_check_seconds_timer() - start_time;
 	
 	IMB_refImBuf(anim->last_frame);
 
@@ -1142,6 +1387,15 @@ static void free_anim_ffmpeg(struct anim *anim)
 	if (anim == NULL) return;
 
 	if (anim->pCodecCtx) {
+		if ((G.debug & G_DEBUG) && anim->decode_time > 0.0) {
+			printf("%s: decoded %d frames in %.2f s (%.1f fps), %d frames reused from the frame ring\n",
+			       anim->name, anim->decoded_frames, anim->decode_time,
+			       anim->decoded_frames / anim->decode_time, anim->ring_hits);
+		}
+
+		ffmpeg_frame_ring_free(anim);
+		ffmpeg_convert_bands_free(anim);
+
 		avcodec_close(anim->pCodecCtx);
 		avformat_close_input(&anim->pFormatCtx);
 		av_free(anim->pFrameRGB);
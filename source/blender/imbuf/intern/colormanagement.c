@@ -57,6 +57,7 @@
 #include "BLI_math.h"
 #include "BLI_math_color.h"
 #include "BLI_path_util.h"
+#include "BLI_rand.h"
 #include "BLI_string.h"
 #include "BLI_threads.h"
 #include "BLI_rect.h"
@@ -70,6 +71,10 @@
 
 #include <ocio_capi.h>
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 /*********************** Global declarations *************************/
 
 #define DISPLAY_BUFFER_CHANNELS 4
@@ -102,9 +107,38 @@ static pthread_mutex_t processor_lock = BLI_MUTEX_INITIALIZER;
 typedef struct ColormanageProcessor {
 	OCIO_ConstProcessorRcPtr *processor;
 	CurveMapping *curve_mapping;
+	struct DisplayLUT *display_lut;
 	bool is_data_result;
 } ColormanageProcessor;
 
+/* baked display transform, see display_lut_acquire() */
+typedef struct DisplayLUT {
+	struct DisplayLUT *next, *prev;
+
+	/* Settings of processor for comparison. */
+	char look[MAX_COLORSPACE_NAME];
+	char view[MAX_COLORSPACE_NAME];
+	char display[MAX_COLORSPACE_NAME];
+	float exposure, gamma;
+	CurveMapping *curve_mapping;
+	int curve_mapping_timestamp;
+
+	/* DISPLAY_LUT_SIZE^3 lattice of display values, RGB padded to 4 floats,
+	 * NULL when the LUT was too far off and exact processor is to be used */
+	float *table;
+	float scale;      /* maps scene linear values to [0, 1] lattice domain */
+	float max_error;  /* measured against exact processor when baking */
+	int users;
+} DisplayLUT;
+
+static ListBase global_display_luts = {NULL, NULL};
+
+/* lock used by baked display LUT cache, separate from processor_lock
+ * since baking needs pre-cached processors */
+static pthread_mutex_t display_lut_lock = BLI_MUTEX_INITIALIZER;
+
+static void display_lut_cache_free(void);
+
 static struct global_glsl_state {
 	/* Actual processor used for GLSL baked LUTs. */
 	OCIO_ConstProcessorRcPtr *processor;
@@ -554,6 +588,9 @@ static void colormanage_free_config(void)
 	ColorSpace *colorspace;
 	ColorManagedDisplay *display;
 
+	/* baked LUTs are only valid for the configuration they were baked from */
+	display_lut_cache_free();
+
 	/* free color spaces */
 	colorspace = global_colorspaces.first;
 	while (colorspace) {
@@ -1224,6 +1261,348 @@ const char *IMB_colormanagement_get_rect_colorspace(ImBuf *ibuf)
 	return ibuf->rect_colorspace->name;
 }
 
+/*********************** Baked display transform LUT *************************/
+
+/* Display transform baked into a 3D lattice, which is interpolated
+ * tetrahedrally instead of pushing every pixel through curve mapping
+ * and OCIO processor. Lattice is addressed by fourth root of scene linear
+ * value, so it's dense near black where display transforms are steep and
+ * still covers DISPLAY_LUT_RANGE (relative to exposure) of HDR values.
+ * Pixels outside of the lattice (negative or above the range) go through
+ * the exact processor.
+ *
+ * When baking, LUT is compared against the exact processor on random
+ * samples and discarded if the error is above DISPLAY_LUT_MAX_ERROR.
+ * LUTs are cached per view settings, using the same comparison as for
+ * GLSL state, and freed together with the configuration.
+ */
+
+#define DISPLAY_LUT_SIZE 64
+#define DISPLAY_LUT_RANGE 64.0f
+#define DISPLAY_LUT_CACHE_LIMIT 4
+#define DISPLAY_LUT_ERROR_SAMPLES 4096
+#define DISPLAY_LUT_MAX_ERROR (1.0f / 255.0f)
+
+static void processor_transform_apply_threaded(float *buffer, int width, int height, int channels,
+                                               ColormanageProcessor *cm_processor, bool predivide);
+
+/* find tetrahedron of a lattice cell containing point co, given in lattice units */
+BLI_INLINE void display_lut_tetrahedron(const float *table, const float co[3],
+                                        const float *r_corner[4], float r_weight[3])
+{
+	const int stride[3] = {4, 4 * DISPLAY_LUT_SIZE, 4 * DISPLAY_LUT_SIZE * DISPLAY_LUT_SIZE};
+	float t[3];
+	int i, a, b, c;
+
+	r_corner[0] = table;
+
+	for (i = 0; i < 3; i++) {
+		int index = min_ii((int) co[i], DISPLAY_LUT_SIZE - 2);
+
+		t[i] = co[i] - (float) index;
+		r_corner[0] += index * stride[i];
+	}
+
+	/* order axes by decreasing offset inside of the cell */
+	if (t[0] >= t[1]) {
+		if (t[1] >= t[2])      { a = 0; b = 1; c = 2; }
+		else if (t[0] >= t[2]) { a = 0; b = 2; c = 1; }
+		else                   { a = 2; b = 0; c = 1; }
+	}
+	else {
+		if (t[0] >= t[2])      { a = 1; b = 0; c = 2; }
+		else if (t[1] >= t[2]) { a = 1; b = 2; c = 0; }
+		else                   { a = 2; b = 1; c = 0; }
+	}
+
+	r_corner[1] = r_corner[0] + stride[a];
+	r_corner[2] = r_corner[1] + stride[b];
+	r_corner[3] = r_corner[2] + stride[c];
+
+	r_weight[0] = t[a];
+	r_weight[1] = t[b];
+	r_weight[2] = t[c];
+}
+
+/* returns false and leaves pixel unchanged when it's outside of the lattice */
+#ifdef __SSE2__
+BLI_INLINE bool display_lut_apply_pixel(const DisplayLUT *lut, float *pixel)
+{
+	const float *corner[4];
+	float co[4], weight[3], result[4];
+	__m128 v, c0, c1, c2, c3;
+
+	v = _mm_set_ps(0.0f, pixel[2], pixel[1], pixel[0]);
+	v = _mm_mul_ps(v, _mm_set1_ps(lut->scale));
+	/* also catches NaN, which compares false */
+	if (_mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(v, _mm_setzero_ps()), _mm_cmple_ps(v, _mm_set1_ps(1.0f)))) != 0xf)
+		return false;
+	v = _mm_sqrt_ps(_mm_sqrt_ps(v));
+	_mm_storeu_ps(co, _mm_mul_ps(v, _mm_set1_ps((float) (DISPLAY_LUT_SIZE - 1))));
+
+	display_lut_tetrahedron(lut->table, co, corner, weight);
+
+	c0 = _mm_loadu_ps(corner[0]);
+	c1 = _mm_loadu_ps(corner[1]);
+	c2 = _mm_loadu_ps(corner[2]);
+	c3 = _mm_loadu_ps(corner[3]);
+
+	v = _mm_add_ps(c0, _mm_mul_ps(_mm_sub_ps(c1, c0), _mm_set1_ps(weight[0])));
+	v = _mm_add_ps(v, _mm_mul_ps(_mm_sub_ps(c2, c1), _mm_set1_ps(weight[1])));
+	v = _mm_add_ps(v, _mm_mul_ps(_mm_sub_ps(c3, c2), _mm_set1_ps(weight[2])));
+	_mm_storeu_ps(result, v);
+
+	copy_v3_v3(pixel, result);
+
+	return true;
+}
+#else
+BLI_INLINE bool display_lut_apply_pixel(const DisplayLUT *lut, float *pixel)
+{
+	const float *corner[4];
+	float co[3], weight[3];
+	int i;
+
+	for (i = 0; i < 3; i++) {
+		float value = pixel[i] * lut->scale;
+
+		if (!(value >= 0.0f && value <= 1.0f))
+			return false;
+
+		co[i] = sqrtf(sqrtf(value)) * (float) (DISPLAY_LUT_SIZE - 1);
+	}
+
+	display_lut_tetrahedron(lut->table, co, corner, weight);
+
+	for (i = 0; i < 3; i++) {
+		pixel[i] = corner[0][i] +
+		           (corner[1][i] - corner[0][i]) * weight[0] +
+		           (corner[2][i] - corner[1][i]) * weight[1] +
+		           (corner[3][i] - corner[2][i]) * weight[2];
+	}
+
+	return true;
+}
+#endif
+
+/* cm_processor is the exact processor the LUT was baked from, used for pixels outside of the lattice */
+static void display_lut_apply(const DisplayLUT *lut, ColormanageProcessor *cm_processor, float *buffer,
+                              int width, int height, int channels, bool predivide)
+{
+	float *pixel = buffer;
+	size_t i, tot = (size_t) width * height;
+
+	BLI_assert(channels >= 3);
+
+	for (i = 0; i < tot; i++, pixel += channels) {
+		if (predivide && channels == 4 && pixel[3] != 1.0f && pixel[3] != 0.0f) {
+			float alpha = pixel[3];
+
+			mul_v3_fl(pixel, 1.0f / alpha);
+			if (!display_lut_apply_pixel(lut, pixel))
+				IMB_colormanagement_processor_apply_v3(cm_processor, pixel);
+			mul_v3_fl(pixel, alpha);
+		}
+		else if (!display_lut_apply_pixel(lut, pixel)) {
+			IMB_colormanagement_processor_apply_v3(cm_processor, pixel);
+		}
+	}
+}
+
+/* biggest difference between LUT and exact processor, in clamped display values,
+ * some samples are negative or above the lattice range to cover the exact fallback too */
+static float display_lut_measure_error(const DisplayLUT *lut, ColormanageProcessor *cm_processor)
+{
+	RNG *rng = BLI_rng_new(0);
+	float *exact = MEM_mallocN(3 * DISPLAY_LUT_ERROR_SAMPLES * sizeof(float), "display LUT exact samples");
+	float *approx = MEM_mallocN(3 * DISPLAY_LUT_ERROR_SAMPLES * sizeof(float), "display LUT samples");
+	float max_error = 0.0f;
+	int i;
+
+	for (i = 0; i < 3 * DISPLAY_LUT_ERROR_SAMPLES; i++) {
+		/* fourth root in [-0.25, 1.5], up to 5 times the range */
+		float t = BLI_rng_get_float(rng) * 1.75f - 0.25f;
+		float value = t * t * t * t / lut->scale;
+
+		exact[i] = approx[i] = (t < 0.0f) ? -value : value;
+	}
+
+	IMB_colormanagement_processor_apply(cm_processor, exact, DISPLAY_LUT_ERROR_SAMPLES, 1, 3, false);
+	display_lut_apply(lut, cm_processor, approx, DISPLAY_LUT_ERROR_SAMPLES, 1, 3, false);
+
+	for (i = 0; i < 3 * DISPLAY_LUT_ERROR_SAMPLES; i++) {
+		float error = fabsf(CLAMPIS(exact[i], 0.0f, 1.0f) - CLAMPIS(approx[i], 0.0f, 1.0f));
+
+		max_error = max_ff(max_error, error);
+	}
+
+	MEM_freeN(exact);
+	MEM_freeN(approx);
+	BLI_rng_free(rng);
+
+	return max_error;
+}
+
+static DisplayLUT *display_lut_bake(const ColorManagedViewSettings *view_settings,
+                                    const ColorManagedDisplaySettings *display_settings)
+{
+	ColormanageProcessor *cm_processor;
+	DisplayLUT *lut = MEM_callocN(sizeof(DisplayLUT), "display LUT");
+	float node[DISPLAY_LUT_SIZE], *pixel;
+	int r, g, b;
+
+	BLI_strncpy(lut->look, view_settings->look, MAX_COLORSPACE_NAME);
+	BLI_strncpy(lut->view, view_settings->view_transform, MAX_COLORSPACE_NAME);
+	BLI_strncpy(lut->display, display_settings->display_device, MAX_COLORSPACE_NAME);
+	lut->exposure = view_settings->exposure;
+	lut->gamma = view_settings->gamma;
+
+	if (view_settings->flag & COLORMANAGE_VIEW_USE_CURVES) {
+		lut->curve_mapping = view_settings->curve_mapping;
+		lut->curve_mapping_timestamp = view_settings->curve_mapping->changed_timestamp;
+	}
+
+	lut->scale = powf(2.0f, view_settings->exposure) / DISPLAY_LUT_RANGE;
+
+	for (r = 0; r < DISPLAY_LUT_SIZE; r++) {
+		float t = (float) r / (DISPLAY_LUT_SIZE - 1);
+
+		node[r] = t * t * t * t / lut->scale;
+	}
+
+	lut->table = MEM_mallocN(4 * DISPLAY_LUT_SIZE * DISPLAY_LUT_SIZE * DISPLAY_LUT_SIZE * sizeof(float),
+	                         "display LUT table");
+
+	pixel = lut->table;
+	for (b = 0; b < DISPLAY_LUT_SIZE; b++) {
+		for (g = 0; g < DISPLAY_LUT_SIZE; g++) {
+			for (r = 0; r < DISPLAY_LUT_SIZE; r++, pixel += 4) {
+				pixel[0] = node[r];
+				pixel[1] = node[g];
+				pixel[2] = node[b];
+				pixel[3] = 1.0f;
+			}
+		}
+	}
+
+	cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
+
+	processor_transform_apply_threaded(lut->table, DISPLAY_LUT_SIZE, DISPLAY_LUT_SIZE * DISPLAY_LUT_SIZE, 4,
+	                                   cm_processor, false);
+
+	lut->max_error = display_lut_measure_error(lut, cm_processor);
+
+	IMB_colormanagement_processor_free(cm_processor);
+
+	if (lut->max_error > DISPLAY_LUT_MAX_ERROR) {
+		printf("Color management: baked LUT for view \"%s\" on display \"%s\" is off by %f, "
+		       "using exact display transform instead\n", lut->view, lut->display, lut->max_error);
+
+		MEM_freeN(lut->table);
+		lut->table = NULL;
+	}
+
+	return lut;
+}
+
+static bool display_lut_matches(const DisplayLUT *lut, const ColorManagedViewSettings *view_settings,
+                                const ColorManagedDisplaySettings *display_settings)
+{
+	CurveMapping *curve_mapping = NULL;
+	int curve_mapping_timestamp = 0;
+
+	if (view_settings->flag & COLORMANAGE_VIEW_USE_CURVES) {
+		curve_mapping = view_settings->curve_mapping;
+		curve_mapping_timestamp = curve_mapping->changed_timestamp;
+	}
+
+	return lut->exposure == view_settings->exposure &&
+	       lut->gamma == view_settings->gamma &&
+	       lut->curve_mapping == curve_mapping &&
+	       lut->curve_mapping_timestamp == curve_mapping_timestamp &&
+	       STREQ(lut->look, view_settings->look) &&
+	       STREQ(lut->view, view_settings->view_transform) &&
+	       STREQ(lut->display, display_settings->display_device);
+}
+
+static void display_lut_free(DisplayLUT *lut)
+{
+	if (lut->table)
+		MEM_freeN(lut->table);
+
+	MEM_freeN(lut);
+}
+
+static void display_lut_cache_free(void)
+{
+	DisplayLUT *lut;
+
+	BLI_mutex_lock(&display_lut_lock);
+
+	while ((lut = BLI_pophead(&global_display_luts))) {
+		BLI_assert(lut->users == 0);
+		display_lut_free(lut);
+	}
+
+	BLI_mutex_unlock(&display_lut_lock);
+}
+
+/* get LUT for given settings, baking it if needed. returns NULL if
+ * baked LUT isn't accurate enough, otherwise LUT is to be released
+ * with display_lut_release() */
+static DisplayLUT *display_lut_acquire(const ColorManagedViewSettings *view_settings,
+                                       const ColorManagedDisplaySettings *display_settings)
+{
+	DisplayLUT *lut, *result = NULL;
+	int tot_lut;
+
+	BLI_mutex_lock(&display_lut_lock);
+
+	for (lut = global_display_luts.first; lut; lut = lut->next) {
+		if (display_lut_matches(lut, view_settings, display_settings))
+			break;
+	}
+
+	if (lut)
+		BLI_remlink(&global_display_luts, lut);
+	else
+		lut = display_lut_bake(view_settings, display_settings);
+
+	/* keep most recently used LUT first */
+	BLI_addhead(&global_display_luts, lut);
+
+	if (lut->table) {
+		lut->users++;
+		result = lut;
+	}
+
+	/* forget least recently used LUTs which are not used by display buffer threads */
+	tot_lut = BLI_countlist(&global_display_luts);
+	lut = global_display_luts.last;
+	while (lut && tot_lut > DISPLAY_LUT_CACHE_LIMIT) {
+		DisplayLUT *lut_prev = lut->prev;
+
+		if (lut->users == 0) {
+			BLI_remlink(&global_display_luts, lut);
+			display_lut_free(lut);
+			tot_lut--;
+		}
+
+		lut = lut_prev;
+	}
+
+	BLI_mutex_unlock(&display_lut_lock);
+
+	return result;
+}
+
+static void display_lut_release(DisplayLUT *lut)
+{
+	BLI_mutex_lock(&display_lut_lock);
+	lut->users--;
+	BLI_mutex_unlock(&display_lut_lock);
+}
+
 /*********************** Threaded display buffer transform routines *************************/
 
 typedef struct DisplayBufferThread {
@@ -1418,6 +1797,11 @@ static void *do_display_buffer_apply_thread(void *handle_v)
 			 * only generate byte buffers
 			 */
 		}
+		else if (cm_processor->display_lut && channels >= 3) {
+			/* apply baked processor */
+			display_lut_apply(cm_processor->display_lut, cm_processor, linear_buffer, width, height, channels,
+			                  predivide);
+		}
 		else {
 			/* apply processor */
 			IMB_colormanagement_processor_apply(cm_processor, linear_buffer, width, height, channels,
@@ -1521,9 +1905,15 @@ static void colormanage_display_buffer_process_ex(ImBuf *ibuf, float *display_bu
 		skip_transform = is_ibuf_rect_in_display_space(ibuf, view_settings, display_settings);
 	}
 
-	if (skip_transform == false)
+	if (skip_transform == false) {
 		cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
 
+		/* baked LUT is only accurate enough for byte display buffers,
+		 * float ones might need values outside of its range */
+		if (display_buffer == NULL && (view_settings->flag & COLORMANAGE_VIEW_USE_BAKED_LUT))
+			cm_processor->display_lut = display_lut_acquire(view_settings, display_settings);
+	}
+
 	display_buffer_apply_threaded(ibuf, ibuf->rect_float, (unsigned char *) ibuf->rect,
 	                              display_buffer, display_buffer_byte, cm_processor);
 
@@ -2954,6 +3344,8 @@ void IMB_colormanagement_processor_free(ColormanageProcessor *cm_processor)
 		curvemapping_free(cm_processor->curve_mapping);
 	if (cm_processor->processor)
 		OCIO_processorRelease(cm_processor->processor);
+	if (cm_processor->display_lut)
+		display_lut_release(cm_processor->display_lut);
 
 	MEM_freeN(cm_processor);
 }
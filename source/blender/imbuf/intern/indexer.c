@@ -35,6 +35,11 @@
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_fileops.h"
+#include "BLI_ghash.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "PIL_time.h"
 
 #include "IMB_indexer.h"
 #include "IMB_anim.h"
@@ -435,6 +440,10 @@ static void get_tc_filename(struct anim *anim, IMB_Timecode_Type tc,
 
 typedef struct IndexBuildContext {
 	int anim_type;
+
+	/* frames read and the time spent building, for throughput statistics */
+	int num_frames;
+	double time;
 } IndexBuildContext;
 
 
@@ -692,6 +701,8 @@ static void free_proxy_output_ffmpeg(struct proxy_output_ctx *ctx,
 
 typedef struct FFmpegIndexBuilderContext {
 	int anim_type;
+	int num_frames;
+	double time;
 
 	AVFormatContext *iFormatCtx;
 	AVCodecContext *iCodecCtx;
@@ -718,6 +729,11 @@ typedef struct FFmpegIndexBuilderContext {
 	double pts_time_base;
 	int frameno, frameno_gapless;
 	int start_pts_set;
+
+	/* the proxies of a frame are scaled and encoded in parallel while the next frame is decoded,
+	 * from a copy of the frame because the decoder reuses its buffers */
+	TaskPool *proxy_pool;
+	AVFrame *proxy_frame;
 } FFmpegIndexBuilderContext;
 
 static IndexBuildContext *index_ffmpeg_create_context(struct anim *anim, IMB_Timecode_Type tcs_in_use,
@@ -780,6 +796,13 @@ static IndexBuildContext *index_ffmpeg_create_context(struct anim *anim, IMB_Tim
 
 	context->iCodecCtx->workaround_bugs = 1;
 
+#ifdef FF_THREAD_FRAME
+	/* frame threading delays decoded frames by several packets, timecodes need the seek
+	 * position of the packet a frame was decoded from */
+	context->iCodecCtx->thread_count = BLI_system_thread_count();
+	context->iCodecCtx->thread_type = tcs_in_use ? FF_THREAD_SLICE : (FF_THREAD_FRAME | FF_THREAD_SLICE);
+#endif
+
 	if (avcodec_open2(context->iCodecCtx, context->iCodec, NULL) < 0) {
 		avformat_close_input(&context->iFormatCtx);
 		MEM_freeN(context);
@@ -797,9 +820,18 @@ static IndexBuildContext *index_ffmpeg_create_context(struct anim *anim, IMB_Tim
 			if (!context->proxy_ctx[i]) {
 				proxy_sizes_in_use &= ~proxy_sizes[i];
 			}
+			else if (!context->proxy_frame) {
+				context->proxy_frame = avcodec_alloc_frame();
+				avpicture_alloc((AVPicture *)context->proxy_frame, context->iCodecCtx->pix_fmt,
+				                context->iCodecCtx->width, context->iCodecCtx->height);
+			}
 		}
 	}
 
+	if (context->proxy_frame) {
+		context->proxy_pool = BLI_task_pool_create(BLI_task_scheduler_get(), context);
+	}
+
 	for (i = 0; i < num_indexers; i++) {
 		if (tcs_in_use & tc_types[i]) {
 			char fname[FILE_MAX];
@@ -832,12 +864,51 @@ static void index_rebuild_ffmpeg_finish(FFmpegIndexBuilderContext *context, int
 		}
 	}
 
+	if (context->proxy_pool) {
+		BLI_task_pool_free(context->proxy_pool);
+	}
+
+	if (context->proxy_frame) {
+		avpicture_free((AVPicture *)context->proxy_frame);
+		av_free(context->proxy_frame);
+	}
+
 	avcodec_close(context->iCodecCtx);
 	avformat_close_input(&context->iFormatCtx);
 
 	MEM_freeN(context);
 }
 
+static void index_rebuild_ffmpeg_proxy_task(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+{
+	FFmpegIndexBuilderContext *context = BLI_task_pool_userdata(pool);
+
+	add_to_proxy_output_ffmpeg(taskdata, context->proxy_frame);
+}
+
+static void index_rebuild_ffmpeg_proc_proxies(FFmpegIndexBuilderContext *context, AVFrame *in_frame)
+{
+	int i;
+
+	if (!context->proxy_pool) {
+		return;
+	}
+
+	/* the proxies of the previous frame were encoded while this frame was decoded */
+	BLI_task_pool_work_and_wait(context->proxy_pool);
+
+	av_picture_copy((AVPicture *)context->proxy_frame, (const AVPicture *)in_frame,
+	                context->iCodecCtx->pix_fmt, context->iCodecCtx->width, context->iCodecCtx->height);
+
+	/* a proxy without scaling encodes the copy itself, only one size can match the input */
+	for (i = 0; i < context->num_proxy_sizes; i++) {
+		if (context->proxy_ctx[i]) {
+			BLI_task_pool_push(context->proxy_pool, index_rebuild_ffmpeg_proxy_task,
+			                   context->proxy_ctx[i], false, TASK_PRIORITY_HIGH);
+		}
+	}
+}
+
 static void index_rebuild_ffmpeg_proc_decoded_frame(
 	FFmpegIndexBuilderContext *context, 
 	AVPacket * curr_packet,
@@ -848,9 +919,8 @@ static void index_rebuild_ffmpeg_proc_decoded_frame(
 	unsigned long long s_dts = context->seek_pos_dts;
 	unsigned long long pts = av_get_pts_from_frame(context->iFormatCtx, in_frame);
 
-	for (i = 0; i < context->num_proxy_sizes; i++) {
-		add_to_proxy_output_ffmpeg(context->proxy_ctx[i], in_frame);
-	}
+	index_rebuild_ffmpeg_proc_proxies(context, in_frame);
+	context->num_frames++;
 
 	if (!context->start_pts_set) {
 		context->start_pts = pts;
@@ -969,6 +1039,10 @@ static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
 		} while (frame_finished);
 	}
 
+	if (context->proxy_pool) {
+		BLI_task_pool_work_and_wait(context->proxy_pool);
+	}
+
 	av_free(in_frame);
 
 	return 1;
@@ -983,6 +1057,8 @@ static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
 #ifdef WITH_AVI
 typedef struct FallbackIndexBuilderContext {
 	int anim_type;
+	int num_frames;
+	double time;
 
 	struct anim *anim;
 	AviMovie *proxy_ctx[IMB_PROXY_MAX_SLOT];
@@ -1138,6 +1214,8 @@ static void index_rebuild_fallback(FallbackIndexBuilderContext *context,
 
 		IMB_freeImBuf(tmp_ibuf);
 		IMB_freeImBuf(ibuf);
+
+		context->num_frames++;
 	}
 }
 
@@ -1147,11 +1225,53 @@ static void index_rebuild_fallback(FallbackIndexBuilderContext *context,
  * - public API
  * ---------------------------------------------------------------------- */
 
+/* strips of the same movie share its proxy and timecode files, each file is built by one context */
+static void index_rebuild_skip_registered(struct anim *anim, GSet *file_list,
+                                          IMB_Timecode_Type *tcs_in_use, IMB_Proxy_Size *proxy_sizes_in_use)
+{
+	char fname[FILE_MAX];
+	int i;
+
+	for (i = 0; i < IMB_PROXY_MAX_SLOT; i++) {
+		if (*proxy_sizes_in_use & proxy_sizes[i]) {
+			get_proxy_filename(anim, proxy_sizes[i], fname, false);
+
+			if (BLI_gset_haskey(file_list, fname))
+				*proxy_sizes_in_use &= ~proxy_sizes[i];
+			else
+				BLI_gset_insert(file_list, BLI_strdup(fname));
+		}
+	}
+
+#ifdef WITH_FFMPEG
+	for (i = 0; i < IMB_TC_MAX_SLOT; i++) {
+		if (*tcs_in_use & tc_types[i]) {
+			get_tc_filename(anim, tc_types[i], fname);
+
+			if (BLI_gset_haskey(file_list, fname))
+				*tcs_in_use &= ~tc_types[i];
+			else
+				BLI_gset_insert(file_list, BLI_strdup(fname));
+		}
+	}
+#else
+	(void)tcs_in_use;
+#endif
+}
+
 IndexBuildContext *IMB_anim_index_rebuild_context(struct anim *anim, IMB_Timecode_Type tcs_in_use,
-                                                  IMB_Proxy_Size proxy_sizes_in_use, int quality)
+                                                  IMB_Proxy_Size proxy_sizes_in_use, int quality,
+                                                  GSet *file_list)
 {
 	IndexBuildContext *context = NULL;
 
+	if (file_list) {
+		index_rebuild_skip_registered(anim, file_list, &tcs_in_use, &proxy_sizes_in_use);
+
+		if (!tcs_in_use && !proxy_sizes_in_use)
+			return NULL;
+	}
+
 	switch (anim->curtype) {
 #ifdef WITH_FFMPEG
 		case ANIM_FFMPEG:
@@ -1176,6 +1296,8 @@ IndexBuildContext *IMB_anim_index_rebuild_context(struct anim *anim, IMB_Timecod
 void IMB_anim_index_rebuild(struct IndexBuildContext *context,
                             short *stop, short *do_update, float *progress)
 {
+	const double start_time = PIL_check_seconds_timer();
+
 	switch (context->anim_type) {
 #ifdef WITH_FFMPEG
 		case ANIM_FFMPEG:
@@ -1189,9 +1311,17 @@ void IMB_anim_index_rebuild(struct IndexBuildContext *context,
 #endif
 	}
 
+	context->time += PIL_check_seconds_timer() - start_time;
+
 	(void)stop, (void)do_update, (void)progress;
 }
 
+void IMB_anim_index_rebuild_stats(struct IndexBuildContext *context, int *r_num_frames, double *r_time)
+{
+	*r_num_frames = context->num_frames;
+	*r_time = context->time;
+}
+
 void IMB_anim_index_rebuild_finish(IndexBuildContext *context, short stop)
 {
 	switch (context->anim_type) {
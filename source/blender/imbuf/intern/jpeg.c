@@ -37,6 +37,7 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_utildefines.h"
 #include "BLI_string.h"
 #include "BLI_fileops.h"
 
@@ -65,7 +66,8 @@ static void skip_input_data(j_decompress_ptr cinfo, long num_bytes);
 static void term_source(j_decompress_ptr cinfo);
 static void memory_source(j_decompress_ptr cinfo, unsigned char *buffer, size_t size);
 static boolean handle_app1(j_decompress_ptr cinfo);
-static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int flags);
+static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int flags, int max_size,
+                                   size_t *r_width, size_t *r_height);
 
 
 /*
@@ -82,7 +84,6 @@ static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int fla
  */
 
 static int jpeg_default_quality;
-static int ibuf_ftype;
 
 int imb_is_a_jpeg(unsigned char *mem)
 {
@@ -267,8 +268,12 @@ handle_app1(j_decompress_ptr cinfo)
 	if (length < 16) {
 		for (i = 0; i < length; i++) INPUT_BYTE(cinfo, neogeo[i], return false);
 		length = 0;
-		if (strncmp(neogeo, "NeoGeo", 6) == 0) memcpy(&ibuf_ftype, neogeo + 6, 4);
-		ibuf_ftype = BIG_LONG(ibuf_ftype);
+		if (strncmp(neogeo, "NeoGeo", 6) == 0) {
+			/* ftype is stored per decoder so files can be read from several threads */
+			int *ibuf_ftype = (int *)cinfo->client_data;
+			memcpy(ibuf_ftype, neogeo + 6, 4);
+			*ibuf_ftype = BIG_LONG(*ibuf_ftype);
+		}
 	}
 	INPUT_SYNC(cinfo);  /* do before skip_input_data */
 	if (length > 0) (*cinfo->src->skip_input_data)(cinfo, length);
@@ -276,7 +281,10 @@ handle_app1(j_decompress_ptr cinfo)
 }
 
 
-static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int flags)
+/* when max_size is non-zero the image is decoded at the smallest DCT scale (1/1 to 1/8)
+ * that still covers max_size, r_width/r_height then return the full image size */
+static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int flags, int max_size,
+                                   size_t *r_width, size_t *r_height)
 {
 	JSAMPARRAY row_pointer;
 	JSAMPLE *buffer = NULL;
@@ -286,9 +294,10 @@ static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int fla
 	uchar *rect;
 	jpeg_saved_marker_ptr marker;
 	char *str, *key, *value;
+	int ibuf_ftype = 0;
 
 	/* install own app1 handler */
-	ibuf_ftype = 0;
+	cinfo->client_data = &ibuf_ftype;
 	jpeg_set_marker_processor(cinfo, 0xe1, handle_app1);
 	cinfo->dct_method = JDCT_FLOAT;
 	jpeg_save_markers(cinfo, JPEG_COM, 0xffff);
@@ -300,8 +309,27 @@ static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int fla
 
 		if (cinfo->jpeg_color_space == JCS_YCCK) cinfo->out_color_space = JCS_CMYK;
 
+		if (r_width) *r_width = x;
+		if (r_height) *r_height = y;
+
+		if (max_size > 0) {
+			const int size = MAX2(x, y);
+
+			cinfo->scale_num = 1;
+			cinfo->scale_denom = 1;
+			while (cinfo->scale_denom < 8 && size / (int)(cinfo->scale_denom * 2) >= max_size)
+				cinfo->scale_denom *= 2;
+
+			/* quality is not an issue at thumbnail size */
+			cinfo->dct_method = JDCT_IFAST;
+			cinfo->do_fancy_upsampling = false;
+		}
+
 		jpeg_start_decompress(cinfo);
 
+		x = cinfo->output_width;
+		y = cinfo->output_height;
+
 		if (ibuf_ftype == 0) {
 			ibuf_ftype = JPG_STD;
 			if (cinfo->max_v_samp_factor == 1) {
@@ -465,11 +493,45 @@ ImBuf *imb_load_jpeg(unsigned char *buffer, size_t size, int flags, char colorsp
 	jpeg_create_decompress(cinfo);
 	memory_source(cinfo, buffer, size);
 
-	ibuf = ibJpegImageFromCinfo(cinfo, flags);
+	ibuf = ibJpegImageFromCinfo(cinfo, flags, 0, NULL, NULL);
 	
 	return(ibuf);
 }
 
+/* decode straight from the file at a reduced DCT scale, only used for thumbnails */
+struct ImBuf *imb_thumbnail_jpeg(const char *filepath, const int flags, const size_t max_thumb_size,
+                                 char colorspace[IM_MAX_SPACE], size_t *r_width, size_t *r_height)
+{
+	struct jpeg_decompress_struct _cinfo, *cinfo = &_cinfo;
+	struct my_error_mgr jerr;
+	FILE *infile;
+	ImBuf *ibuf;
+
+	if ((infile = BLI_fopen(filepath, "rb")) == NULL) {
+		return NULL;
+	}
+
+	colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_BYTE);
+
+	cinfo->err = jpeg_std_error(&jerr.pub);
+	jerr.pub.error_exit = jpeg_error;
+
+	if (setjmp(jerr.setjmp_buffer)) {
+		jpeg_destroy_decompress(cinfo);
+		fclose(infile);
+		return NULL;
+	}
+
+	jpeg_create_decompress(cinfo);
+	jpeg_stdio_src(cinfo, infile);
+
+	ibuf = ibJpegImageFromCinfo(cinfo, flags, (int)max_thumb_size, r_width, r_height);
+
+	fclose(infile);
+
+	return ibuf;
+}
+
 
 static void write_jpeg(struct jpeg_compress_struct *cinfo, struct ImBuf *ibuf)
 {
@@ -480,6 +542,7 @@ static void write_jpeg(struct jpeg_compress_struct *cinfo, struct ImBuf *ibuf)
 	char neogeo[128];
 	ImMetaData *iptr;
 	char *text;
+	int ibuf_ftype;
 
 	jpeg_start_compress(cinfo, true);
 
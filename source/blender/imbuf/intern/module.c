@@ -39,12 +39,14 @@ void IMB_init(void)
 	imb_refcounter_lock_init();
 	imb_filetypes_init();
 	imb_tile_cache_init();
+	imb_thumb_load_init();
 	colormanagement_init();
 }
 
 void IMB_exit(void)
 {
 	imb_tile_cache_exit();
+	imb_thumb_load_exit();
 	imb_filetypes_exit();
 	colormanagement_exit();
 	imb_refcounter_lock_exit();
@@ -32,6 +32,7 @@
 #undef DEBUG_MESSAGES
 
 #include <stdlib.h> /* for qsort */
+#include <stdio.h>
 #include <memory.h>
 
 #include "MEM_guardedalloc.h"
@@ -39,14 +40,30 @@
 
 #include "BLI_string.h"
 #include "BLI_utildefines.h"
+#include "BLI_dynstr.h"
+#include "BLI_fileops.h"
+#include "BLI_fileops_types.h"
 #include "BLI_ghash.h"
+#include "BLI_listbase.h"
+#include "BLI_md5.h"
 #include "BLI_mempool.h"
+#include "BLI_path_util.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
+#include "BKE_global.h"
+
 #include "IMB_moviecache.h"
 
 #include "IMB_imbuf_types.h"
 #include "IMB_imbuf.h"
+#include "IMB_allocimbuf.h"
+
+#include "IMB_colormanagement_intern.h"
+
+#ifdef WITH_LZO
+#  include "minilzo.h"
+#endif
 
 #ifdef DEBUG_MESSAGES
 #  if defined __GNUC__ || defined __sun
@@ -73,6 +90,11 @@ typedef struct MovieCache {
 	MovieCacheGetItemPriorityFP getitempriorityfp;
 	MovieCachePriorityDeleterFP prioritydeleterfp;
 
+	MovieCacheGetDiskKeyFP getdiskkeyfp;
+	void *disk_userdata;
+	/* disk cache names of the user keys, describing a frame stats its files */
+	GHash *disk_names;
+
 	struct BLI_mempool *keys_pool;
 	struct BLI_mempool *items_pool;
 	struct BLI_mempool *userkeys_pool;
@@ -95,8 +117,12 @@ typedef struct MovieCacheItem {
 	ImBuf *ibuf;
 	MEM_CacheLimiterHandleC *c_handle;
 	void *priority_data;
+	/* file name in the disk cache, empty when the buffer isn't stored on disk */
+	char disk_name[33];
 } MovieCacheItem;
 
+static bool moviecache_disk_queue_push(const char *name, ImBuf *ibuf);
+
 static unsigned int moviecache_hashhash(const void *keyv)
 {
 	MovieCacheKey *key = (MovieCacheKey *)keyv;
@@ -181,7 +207,11 @@ static void IMB_moviecache_destructor(void *p)
 
 		PRINT("%s: cache '%s' destroy item %p buffer %p\n", __func__, cache->name, item, item->ibuf);
 
-		IMB_freeImBuf(item->ibuf);
+		/* the limiter only frees buffers that don't fit in memory, keep them on disk,
+		 * this runs with the limiter locked so the buffer is written by a task */
+		if (!item->disk_name[0] || !moviecache_disk_queue_push(item->disk_name, item->ibuf)) {
+			IMB_freeImBuf(item->ibuf);
+		}
 
 		item->ibuf = NULL;
 		item->c_handle = NULL;
@@ -282,6 +312,586 @@ static bool get_item_destroyable(void *item_v)
 	return true;
 }
 
+/* ******** Disk cache ******** */
+
+#define MOVIECACHE_DISK_VERSION 1
+#define MOVIECACHE_DISK_EXT ".bmc"
+#define MOVIECACHE_DISK_LZO_OUT_LEN(size) ((size) + (size) / 16 + 64 + 3)
+/* buffers waiting to be written, more are freed without writing them */
+#define MOVIECACHE_DISK_QUEUE_MAX 8
+
+/* followed by the buffers, a buffer is stored uncompressed when its stored size equals its size */
+typedef struct MovieCacheDiskHeader {
+	char magic[4];
+	int version;
+	int endian;
+	int x, y;
+	int planes, channels;
+	int pad;
+	uint64_t rect_size, rect_stored_size;
+	uint64_t rect_float_size, rect_float_stored_size;
+	char rect_colorspace[64];
+	char float_colorspace[64];
+} MovieCacheDiskHeader;
+
+/* protects the disk cache settings and size */
+static ThreadMutex disk_lock = BLI_MUTEX_INITIALIZER;
+static char disk_dir[FILE_MAX] = "";
+static size_t disk_limit = 0;
+/* size of the files in the disk cache directory, -1 when they are not counted yet */
+static int64_t disk_size = -1;
+/* names of the files in the disk cache directory, valid when disk_size isn't -1 */
+static GSet *disk_files = NULL;
+
+/* a buffer freed from memory that waits to be written to disk */
+typedef struct MovieCacheDiskWrite {
+	struct MovieCacheDiskWrite *next, *prev;
+	char name[33];
+	ImBuf *ibuf;
+} MovieCacheDiskWrite;
+
+/* protects the write queue, the buffers are compressed and written by a task without it */
+static ThreadMutex disk_queue_lock = BLI_MUTEX_INITIALIZER;
+static ListBase disk_queue = {NULL, NULL};
+static int disk_queue_len = 0;
+static TaskPool *disk_pool = NULL;
+/* the write task is pushed or running */
+static bool disk_writing = false;
+
+static bool moviecache_disk_path(const char *name, char r_path[FILE_MAX])
+{
+	char file[64];
+	bool enabled;
+
+	BLI_mutex_lock(&disk_lock);
+	enabled = disk_dir[0] && disk_limit;
+	if (enabled) {
+		BLI_snprintf(file, sizeof(file), "%s" MOVIECACHE_DISK_EXT, name);
+		BLI_join_dirfile(r_path, FILE_MAX, disk_dir, file);
+	}
+	BLI_mutex_unlock(&disk_lock);
+
+	return enabled;
+}
+
+static bool moviecache_disk_enabled(void)
+{
+	bool enabled;
+
+	BLI_mutex_lock(&disk_lock);
+	enabled = disk_dir[0] && disk_limit;
+	BLI_mutex_unlock(&disk_lock);
+
+	return enabled;
+}
+
+static int compare_file_mtime(const void *av, const void *bv)
+{
+	const struct direntry *a = *(const struct direntry **)av;
+	const struct direntry *b = *(const struct direntry **)bv;
+
+	if (a->s.st_mtime < b->s.st_mtime)
+		return -1;
+	else if (a->s.st_mtime > b->s.st_mtime)
+		return 1;
+
+	return 0;
+}
+
+/* count the cache files and remove the least recently used ones when they don't fit in the limit,
+ * called with disk_lock held */
+static void moviecache_disk_trim(void)
+{
+	struct direntry *files;
+	struct direntry **cache_files;
+	unsigned int totfile, totcache = 0, i;
+	int64_t size = 0;
+
+	if (disk_files)
+		BLI_gset_clear(disk_files, MEM_freeN);
+	else
+		disk_files = BLI_gset_new(BLI_ghashutil_strhash_p, BLI_ghashutil_strcmp, "moviecache disk files");
+
+	totfile = BLI_dir_contents(disk_dir, &files);
+	cache_files = MEM_mallocN(sizeof(*cache_files) * MAX2(totfile, 1), "moviecache disk files");
+
+	for (i = 0; i < totfile; i++) {
+		if (BLI_testextensie(files[i].relname, MOVIECACHE_DISK_EXT)) {
+			cache_files[totcache++] = &files[i];
+			size += files[i].s.st_size;
+		}
+	}
+
+	if (size > (int64_t)disk_limit) {
+		/* remove some more, so the directory isn't listed again after every write */
+		const int64_t target = (int64_t)(disk_limit / 4 * 3);
+
+		qsort(cache_files, totcache, sizeof(*cache_files), compare_file_mtime);
+
+		for (i = 0; i < totcache && size > target; i++) {
+			if (BLI_delete(cache_files[i]->path, false, false) == 0) {
+				size -= cache_files[i]->s.st_size;
+				cache_files[i] = NULL;
+			}
+		}
+	}
+
+	for (i = 0; i < totcache; i++) {
+		if (cache_files[i]) {
+			const char *relname = cache_files[i]->relname;
+			BLI_gset_insert(disk_files, BLI_strdupn(relname, strlen(relname) - strlen(MOVIECACHE_DISK_EXT)));
+		}
+	}
+
+	disk_size = size;
+
+	MEM_freeN(cache_files);
+	BLI_free_filelist(files, totfile);
+}
+
+/* the file of name is in the disk cache directory, without looking at the directory again */
+static bool moviecache_disk_has_file(const char *name)
+{
+	bool found = false;
+
+	BLI_mutex_lock(&disk_lock);
+
+	if (disk_dir[0] && disk_limit) {
+		if (disk_size == -1)
+			moviecache_disk_trim();
+
+		found = BLI_gset_haskey(disk_files, name);
+	}
+
+	BLI_mutex_unlock(&disk_lock);
+
+	return found;
+}
+
+/* the file of name is unreadable or was removed by someone else */
+static void moviecache_disk_forget(const char *name)
+{
+	BLI_mutex_lock(&disk_lock);
+
+	if (disk_files)
+		BLI_gset_remove(disk_files, (void *)name, MEM_freeN);
+
+	BLI_mutex_unlock(&disk_lock);
+}
+
+/* returns the compressed buffer, NULL when the buffer is stored uncompressed */
+static void *moviecache_disk_compress(void *data, size_t size, uint64_t *r_stored_size)
+{
+#ifdef WITH_LZO
+	lzo_uint out_len = MOVIECACHE_DISK_LZO_OUT_LEN(size);
+	unsigned char *out = MEM_mallocN(out_len, "moviecache disk compressed");
+	void *wrkmem = MEM_mallocN(LZO1X_1_MEM_COMPRESS, "moviecache disk lzo");
+	int r;
+
+	r = lzo1x_1_compress(data, (lzo_uint)size, out, &out_len, wrkmem);
+	MEM_freeN(wrkmem);
+
+	if (r == LZO_E_OK && out_len < size) {
+		*r_stored_size = out_len;
+		return out;
+	}
+
+	MEM_freeN(out);
+#else
+	(void)data;
+#endif
+
+	*r_stored_size = size;
+	return NULL;
+}
+
+static bool moviecache_disk_read_buffer(FILE *f, void *data, uint64_t size, uint64_t stored_size)
+{
+	if (stored_size == size)
+		return fread(data, 1, size, f) == size;
+
+#ifdef WITH_LZO
+	if (stored_size < MOVIECACHE_DISK_LZO_OUT_LEN(size)) {
+		unsigned char *in = MEM_mallocN(stored_size, "moviecache disk compressed");
+		lzo_uint out_len = size;
+		bool ok;
+
+		ok = fread(in, 1, stored_size, f) == stored_size &&
+		     lzo1x_decompress_safe(in, stored_size, data, &out_len, NULL) == LZO_E_OK &&
+		     out_len == size;
+
+		MEM_freeN(in);
+		return ok;
+	}
+#endif
+
+	return false;
+}
+
+static void moviecache_disk_write(const char *name, ImBuf *ibuf)
+{
+	MovieCacheDiskHeader header;
+	char path[FILE_MAX], path_tmp[FILE_MAX];
+	void *rect_data = NULL, *float_data = NULL;
+	FILE *f;
+	bool ok;
+
+	if (!ibuf->rect && !ibuf->rect_float)
+		return;
+
+	if (!moviecache_disk_path(name, path) || moviecache_disk_has_file(name))
+		return;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "BMCD", sizeof(header.magic));
+	header.version = MOVIECACHE_DISK_VERSION;
+	header.endian = ENDIAN_ORDER;
+	header.x = ibuf->x;
+	header.y = ibuf->y;
+	header.planes = ibuf->planes;
+	header.channels = ibuf->channels;
+
+	if (ibuf->rect) {
+		header.rect_size = (uint64_t)ibuf->x * ibuf->y * sizeof(unsigned int);
+		rect_data = moviecache_disk_compress(ibuf->rect, header.rect_size, &header.rect_stored_size);
+
+		if (ibuf->rect_colorspace)
+			BLI_strncpy(header.rect_colorspace, ibuf->rect_colorspace->name, sizeof(header.rect_colorspace));
+	}
+
+	if (ibuf->rect_float) {
+		header.rect_float_size = (uint64_t)ibuf->x * ibuf->y * ibuf->channels * sizeof(float);
+		float_data = moviecache_disk_compress(ibuf->rect_float, header.rect_float_size, &header.rect_float_stored_size);
+
+		if (ibuf->float_colorspace)
+			BLI_strncpy(header.float_colorspace, ibuf->float_colorspace->name, sizeof(header.float_colorspace));
+	}
+
+	/* written under another name first, so readers never see a partial file */
+	BLI_snprintf(path_tmp, sizeof(path_tmp), "%s.tmp", path);
+
+	f = BLI_fopen(path_tmp, "wb");
+	ok = (f != NULL);
+
+	if (ok) {
+		ok = fwrite(&header, sizeof(header), 1, f) == 1;
+
+		if (ok && ibuf->rect) {
+			ok = fwrite(rect_data ? rect_data : (void *)ibuf->rect, 1, header.rect_stored_size, f) == header.rect_stored_size;
+		}
+		if (ok && ibuf->rect_float) {
+			ok = fwrite(float_data ? float_data : (void *)ibuf->rect_float, 1, header.rect_float_stored_size, f) == header.rect_float_stored_size;
+		}
+
+		ok = (fclose(f) == 0) && ok;
+		ok = ok && BLI_rename(path_tmp, path) == 0;
+
+		if (!ok)
+			BLI_delete(path_tmp, false, false);
+	}
+
+	if (rect_data)
+		MEM_freeN(rect_data);
+	if (float_data)
+		MEM_freeN(float_data);
+
+	if (ok) {
+		BLI_mutex_lock(&disk_lock);
+
+		if (disk_size != -1) {
+			disk_size += sizeof(header) + header.rect_stored_size + header.rect_float_stored_size;
+
+			if (!BLI_gset_haskey(disk_files, name))
+				BLI_gset_insert(disk_files, BLI_strdup(name));
+		}
+
+		if (disk_size == -1 || disk_size > (int64_t)disk_limit)
+			moviecache_disk_trim();
+
+		BLI_mutex_unlock(&disk_lock);
+	}
+
+	PRINT("%s: write %s %s\n", __func__, path, ok ? "done" : "failed");
+}
+
+static void moviecache_disk_write_task(TaskPool *UNUSED(pool), void *UNUSED(taskdata), int UNUSED(threadid))
+{
+	BLI_mutex_lock(&disk_queue_lock);
+
+	while (disk_queue.first) {
+		MovieCacheDiskWrite *write = disk_queue.first;
+
+		/* stays in the queue while it is written, so it can still be found */
+		BLI_mutex_unlock(&disk_queue_lock);
+		moviecache_disk_write(write->name, write->ibuf);
+		BLI_mutex_lock(&disk_queue_lock);
+
+		BLI_remlink(&disk_queue, write);
+		disk_queue_len--;
+
+		IMB_freeImBuf(write->ibuf);
+		MEM_freeN(write);
+	}
+
+	disk_writing = false;
+
+	BLI_mutex_unlock(&disk_queue_lock);
+}
+
+/* the frame of name changed, a write still waiting in the queue stores it under the old
+ * description, which is only read again when the settings are changed back */
+static void moviecache_disk_remove(const char *name)
+{
+	char path[FILE_MAX];
+
+	if (!moviecache_disk_path(name, path))
+		return;
+
+	BLI_mutex_lock(&disk_lock);
+
+	if (disk_size == -1) {
+		/* not counted yet, the next trim lists the directory again */
+		BLI_delete(path, false, false);
+	}
+	else if (BLI_gset_haskey(disk_files, name)) {
+		const size_t size = BLI_file_size(path);
+
+		if (BLI_delete(path, false, false) == 0) {
+			if (size != (size_t)-1)
+				disk_size -= size;
+
+			BLI_gset_remove(disk_files, (void *)name, MEM_freeN);
+		}
+	}
+
+	BLI_mutex_unlock(&disk_lock);
+}
+
+/* takes over ibuf and writes it to disk later, returns false when the queue is full */
+static bool moviecache_disk_queue_push(const char *name, ImBuf *ibuf)
+{
+	MovieCacheDiskWrite *write;
+
+	BLI_mutex_lock(&disk_queue_lock);
+
+	if (disk_queue_len >= MOVIECACHE_DISK_QUEUE_MAX ||
+	    BLI_findstring(&disk_queue, name, offsetof(MovieCacheDiskWrite, name)))
+	{
+		BLI_mutex_unlock(&disk_queue_lock);
+		return false;
+	}
+
+	write = MEM_callocN(sizeof(MovieCacheDiskWrite), "moviecache disk write");
+	BLI_strncpy(write->name, name, sizeof(write->name));
+	write->ibuf = ibuf;
+
+	BLI_addtail(&disk_queue, write);
+	disk_queue_len++;
+
+	if (!disk_writing) {
+		if (!disk_pool)
+			disk_pool = BLI_task_pool_create(BLI_task_scheduler_get(), NULL);
+
+		disk_writing = true;
+		BLI_task_pool_push(disk_pool, moviecache_disk_write_task, NULL, false, TASK_PRIORITY_LOW);
+	}
+
+	BLI_mutex_unlock(&disk_queue_lock);
+
+	return true;
+}
+
+/* a buffer that waits to be written, it is not on disk yet */
+static ImBuf *moviecache_disk_queue_get(const char *name)
+{
+	MovieCacheDiskWrite *write;
+	ImBuf *ibuf = NULL;
+
+	BLI_mutex_lock(&disk_queue_lock);
+
+	write = BLI_findstring(&disk_queue, name, offsetof(MovieCacheDiskWrite, name));
+	if (write) {
+		ibuf = write->ibuf;
+		IMB_refImBuf(ibuf);
+	}
+
+	BLI_mutex_unlock(&disk_queue_lock);
+
+	return ibuf;
+}
+
+static bool moviecache_disk_header_valid(const MovieCacheDiskHeader *header)
+{
+	const uint64_t num_pixels = (uint64_t)header->x * header->y;
+
+	if (memcmp(header->magic, "BMCD", sizeof(header->magic)) != 0 ||
+	    header->version != MOVIECACHE_DISK_VERSION || header->endian != ENDIAN_ORDER)
+	{
+		return false;
+	}
+
+	if (header->x <= 0 || header->y <= 0 || header->channels < 1 || header->channels > 4)
+		return false;
+
+	if (header->rect_size != 0 && header->rect_size != num_pixels * sizeof(unsigned int))
+		return false;
+
+	if (header->rect_float_size != 0 && header->rect_float_size != num_pixels * header->channels * sizeof(float))
+		return false;
+
+	return header->rect_size || header->rect_float_size;
+}
+
+static ImBuf *moviecache_disk_read(const char *name)
+{
+	MovieCacheDiskHeader header;
+	char path[FILE_MAX];
+	ImBuf *ibuf = NULL;
+	FILE *f;
+
+	if (!moviecache_disk_path(name, path))
+		return NULL;
+
+	f = BLI_fopen(path, "rb");
+	if (f == NULL)
+		return NULL;
+
+	if (fread(&header, sizeof(header), 1, f) == 1 && moviecache_disk_header_valid(&header)) {
+		bool ok = true;
+
+		ibuf = IMB_allocImBuf(header.x, header.y, header.planes, 0);
+		ibuf->channels = header.channels;
+
+		if (header.rect_size) {
+			ok = imb_addrectImBuf(ibuf) &&
+			     moviecache_disk_read_buffer(f, ibuf->rect, header.rect_size, header.rect_stored_size);
+		}
+		if (ok && header.rect_float_size) {
+			ok = imb_addrectfloatImBuf(ibuf) &&
+			     moviecache_disk_read_buffer(f, ibuf->rect_float, header.rect_float_size, header.rect_float_stored_size);
+		}
+
+		if (ok) {
+			header.rect_colorspace[sizeof(header.rect_colorspace) - 1] = '\0';
+			header.float_colorspace[sizeof(header.float_colorspace) - 1] = '\0';
+
+			if (header.rect_colorspace[0])
+				ibuf->rect_colorspace = colormanage_colorspace_get_named(header.rect_colorspace);
+			if (header.float_colorspace[0])
+				ibuf->float_colorspace = colormanage_colorspace_get_named(header.float_colorspace);
+		}
+		else {
+			IMB_freeImBuf(ibuf);
+			ibuf = NULL;
+		}
+	}
+
+	fclose(f);
+
+	/* least recently used files are removed first */
+	if (ibuf)
+		BLI_file_touch(path);
+
+	PRINT("%s: read %s %s\n", __func__, path, ibuf ? "done" : "failed");
+
+	return ibuf;
+}
+
+/* hash of the description of the frame, the description can be longer than a file name */
+static bool moviecache_disk_name(MovieCache *cache, void *userkey, char r_name[33])
+{
+	DynStr *key;
+	unsigned char digest[16];
+	bool ok;
+
+	if (!cache->getdiskkeyfp || !moviecache_disk_enabled())
+		return false;
+
+	key = BLI_dynstr_new();
+	BLI_dynstr_appendf(key, "%s %d|", cache->name, MOVIECACHE_DISK_VERSION);
+
+	ok = cache->getdiskkeyfp(userkey, cache->disk_userdata, key);
+
+	if (ok) {
+		char *key_str = BLI_dynstr_get_cstring(key);
+
+		md5_buffer(key_str, strlen(key_str), digest);
+		md5_to_hexdigest(digest, r_name);
+
+		MEM_freeN(key_str);
+	}
+
+	BLI_dynstr_free(key);
+
+	return ok;
+}
+
+/* moviecache_disk_name, remembered per user key */
+static bool moviecache_disk_name_get(MovieCache *cache, void *userkey, char r_name[33])
+{
+	const char *name;
+	void *key;
+
+	if (!cache->getdiskkeyfp || !moviecache_disk_enabled())
+		return false;
+
+	name = cache->disk_names ? BLI_ghash_lookup(cache->disk_names, userkey) : NULL;
+	if (name) {
+		BLI_strncpy(r_name, name, 33);
+		return true;
+	}
+
+	if (!moviecache_disk_name(cache, userkey, r_name))
+		return false;
+
+	if (!cache->disk_names)
+		cache->disk_names = BLI_ghash_new(cache->hashfp, cache->cmpfp, "MovieCache disk names");
+
+	key = MEM_mallocN(cache->keysize, "MovieCache disk name key");
+	memcpy(key, userkey, cache->keysize);
+	BLI_ghash_insert(cache->disk_names, key, BLI_strdup(r_name));
+
+	return true;
+}
+
+void IMB_moviecache_set_disk_cache(const char *dir, size_t limit)
+{
+	BLI_mutex_lock(&disk_lock);
+
+	if (!STREQ(dir, disk_dir)) {
+		BLI_strncpy(disk_dir, dir, sizeof(disk_dir));
+		disk_size = -1;
+
+		if (disk_files)
+			BLI_gset_clear(disk_files, MEM_freeN);
+
+		if (disk_dir[0] && !BLI_is_dir(disk_dir))
+			BLI_dir_create_recursive(disk_dir);
+	}
+
+	disk_limit = limit;
+
+	if (disk_dir[0] && disk_limit && disk_size > (int64_t)disk_limit)
+		moviecache_disk_trim();
+
+	BLI_mutex_unlock(&disk_lock);
+}
+
+/* add a file a frame is read from to its description, changing the file invalidates the frame */
+bool IMB_moviecache_disk_key_file(DynStr *key, const char *filepath)
+{
+	BLI_stat_t st;
+
+	if (BLI_stat(filepath, &st) != 0)
+		return false;
+
+	BLI_dynstr_appendf(key, "%s %lld %lld|", filepath, (long long)st.st_size, (long long)st.st_mtime);
+
+	return true;
+}
+
+/* ******** Cache ******** */
+
 void IMB_moviecache_init(void)
 {
 	limitor = new_MEM_CacheLimiter(IMB_moviecache_destructor, get_item_size);
@@ -292,8 +902,20 @@ void IMB_moviecache_init(void)
 
 void IMB_moviecache_destruct(void)
 {
+	/* finish writing the buffers freed from memory */
+	if (disk_pool) {
+		BLI_task_pool_work_and_wait(disk_pool);
+		BLI_task_pool_free(disk_pool);
+		disk_pool = NULL;
+	}
+
 	if (limitor)
 		delete_MEM_CacheLimiter(limitor);
+
+	if (disk_files) {
+		BLI_gset_free(disk_files, MEM_freeN);
+		disk_files = NULL;
+	}
 }
 
 MovieCache *IMB_moviecache_create(const char *name, int keysize, GHashHashFP hashfp, GHashCmpFP cmpfp)
@@ -335,7 +957,14 @@ void IMB_moviecache_set_priority_callback(struct MovieCache *cache, MovieCacheGe
 	cache->prioritydeleterfp = prioritydeleterfp;
 }
 
-static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, bool need_lock)
+void IMB_moviecache_set_disk_callback(MovieCache *cache, MovieCacheGetDiskKeyFP getdiskkeyfp, void *userdata)
+{
+	cache->getdiskkeyfp = getdiskkeyfp;
+	cache->disk_userdata = userdata;
+}
+
+/* disk_name is the disk cache name of the frame when it is known already */
+static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, bool need_lock, const char *disk_name)
 {
 	MovieCacheKey *key;
 	MovieCacheItem *item;
@@ -359,6 +988,11 @@ static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, boo
 	item->c_handle = NULL;
 	item->priority_data = NULL;
 
+	if (disk_name)
+		BLI_strncpy(item->disk_name, disk_name, sizeof(item->disk_name));
+	else if (!moviecache_disk_name_get(cache, userkey, item->disk_name))
+		item->disk_name[0] = '\0';
+
 	if (cache->getprioritydatafp) {
 		item->priority_data = cache->getprioritydatafp(userkey);
 	}
@@ -393,7 +1027,7 @@ static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, boo
 
 void IMB_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf)
 {
-	do_moviecache_put(cache, userkey, ibuf, true);
+	do_moviecache_put(cache, userkey, ibuf, true, NULL);
 }
 
 bool IMB_moviecache_put_if_possible(MovieCache *cache, void *userkey, ImBuf *ibuf)
@@ -408,7 +1042,7 @@ bool IMB_moviecache_put_if_possible(MovieCache *cache, void *userkey, ImBuf *ibu
 	mem_in_use = MEM_CacheLimiter_get_memory_in_use(limitor);
 
 	if (mem_in_use + elem_size <= mem_limit) {
-		do_moviecache_put(cache, userkey, ibuf, false);
+		do_moviecache_put(cache, userkey, ibuf, false, NULL);
 		result = true;
 	}
 
@@ -421,6 +1055,7 @@ ImBuf *IMB_moviecache_get(MovieCache *cache, void *userkey)
 {
 	MovieCacheKey key;
 	MovieCacheItem *item;
+	char disk_name[33];
 
 	key.cache_owner = cache;
 	key.userkey = userkey;
@@ -438,6 +1073,23 @@ ImBuf *IMB_moviecache_get(MovieCache *cache, void *userkey)
 		}
 	}
 
+	/* freed from memory, or stored by an earlier session */
+	if (moviecache_disk_name_get(cache, userkey, disk_name)) {
+		ImBuf *ibuf = moviecache_disk_queue_get(disk_name);
+
+		if (!ibuf && moviecache_disk_has_file(disk_name)) {
+			ibuf = moviecache_disk_read(disk_name);
+
+			if (!ibuf)
+				moviecache_disk_forget(disk_name);
+		}
+
+		if (ibuf) {
+			do_moviecache_put(cache, userkey, ibuf, true, disk_name);
+			return ibuf;
+		}
+	}
+
 	return NULL;
 }
 
@@ -459,6 +1111,9 @@ void IMB_moviecache_free(MovieCache *cache)
 
 	BLI_ghash_free(cache->hash, moviecache_keyfree, moviecache_valfree);
 
+	if (cache->disk_names)
+		BLI_ghash_free(cache->disk_names, MEM_freeN, MEM_freeN);
+
 	BLI_mempool_destroy(cache->keys_pool);
 	BLI_mempool_destroy(cache->items_pool);
 	BLI_mempool_destroy(cache->userkeys_pool);
@@ -493,6 +1148,25 @@ void IMB_moviecache_cleanup(MovieCache *cache, bool (cleanup_check_cb) (ImBuf *i
 	}
 
 	BLI_ghashIterator_free(iter);
+
+	/* the remembered names describe the frames before they changed, also for the frames that are
+	 * only on disk, they are checked without a buffer */
+	if (cache->disk_names) {
+		iter = BLI_ghashIterator_new(cache->disk_names);
+		while (!BLI_ghashIterator_done(iter)) {
+			void *userkey = BLI_ghashIterator_getKey(iter);
+			const char *name = BLI_ghashIterator_getValue(iter);
+
+			BLI_ghashIterator_step(iter);
+
+			if (cleanup_check_cb(NULL, userkey, userdata)) {
+				moviecache_disk_remove(name);
+				BLI_ghash_remove(cache->disk_names, userkey, MEM_freeN, MEM_freeN);
+			}
+		}
+
+		BLI_ghashIterator_free(iter);
+	}
 }
 
 /* get segments of cached frames. useful for debugging cache policies */
@@ -82,6 +82,8 @@ _CRTIMP void __cdecl _invalid_parameter_noinfo(void)
 #include <ImfChannelList.h>
 #include <ImfPixelType.h>
 #include <ImfInputFile.h>
+#include <ImfTiledInputFile.h>
+#include <ImfPreviewImage.h>
 #include <ImfOutputFile.h>
 #include <ImfCompression.h>
 #include <ImfCompressionAttribute.h>
@@ -515,6 +517,10 @@ typedef struct ExrHandle {
 
 	ListBase channels;  /* flattened out, ExrChannel */
 	ListBase layers;    /* hierarchical, pointing in end to ExrChannel */
+
+	/* file opened by IMB_exr_begin_read_lazy(), it's only open while a pass is read */
+	char lazy_filepath[FILE_MAX];
+	int64_t lazy_mtime, lazy_size;
 } ExrHandle;
 
 /* flattened out channel */
@@ -656,25 +662,39 @@ void IMB_exrtile_begin_write(void *handle, const char *filename, int mipmap, int
 }
 
 /* read from file */
+static bool imb_exr_open_input(ExrHandle *data, const char *filename)
+{
+	/* avoid crash/abort when we don't have permission to write here */
+	try {
+		data->ifile_stream = new IFileStream(filename);
+		data->ifile = new InputFile(*(data->ifile_stream));
+	}
+	catch (const std::exception &) {
+		delete data->ifile;
+		delete data->ifile_stream;
+
+		data->ifile = NULL;
+		data->ifile_stream = NULL;
+	}
+
+	return data->ifile != NULL;
+}
+
+static void imb_exr_close_input(ExrHandle *data)
+{
+	delete data->ifile;
+	delete data->ifile_stream;
+
+	data->ifile = NULL;
+	data->ifile_stream = NULL;
+}
+
 int IMB_exr_begin_read(void *handle, const char *filename, int *width, int *height)
 {
 	ExrHandle *data = (ExrHandle *)handle;
 
 	if (BLI_exists(filename) && BLI_file_size(filename) > 32) {   /* 32 is arbitrary, but zero length files crashes exr */
-		/* avoid crash/abort when we don't have permission to write here */
-		try {
-			data->ifile_stream = new IFileStream(filename);
-			data->ifile = new InputFile(*(data->ifile_stream));
-		}
-		catch (const std::exception &) {
-			delete data->ifile;
-			delete data->ifile_stream;
-
-			data->ifile = NULL;
-			data->ifile_stream = NULL;
-		}
-
-		if (data->ifile) {
+		if (imb_exr_open_input(data, filename)) {
 			Box2i dw = data->ifile->header().dataWindow();
 			data->width = *width  = dw.max.x - dw.min.x + 1;
 			data->height = *height = dw.max.y - dw.min.y + 1;
@@ -776,26 +796,34 @@ void IMB_exr_write_channels(void *handle)
 	}
 }
 
+/* check if exr was saved with previous versions of blender which flipped images */
+static bool imb_exr_is_flipped(ExrHandle *data)
+{
+	const StringAttribute *ta = data->ifile->header().findTypedAttribute <StringAttribute> ("BlenderMultiChannel");
+	return (ta && strncmp(ta->value().c_str(), "Blender V2.43", 13) == 0); /* 'previous multilayer attribute, flipped */
+}
+
+static void imb_exr_insert_read_slice(ExrHandle *data, FrameBuffer &frameBuffer, ExrChannel *echan, bool flip)
+{
+	if (flip)
+		frameBuffer.insert(echan->name, Slice(Imf::FLOAT,  (char *)echan->rect,
+		                                      echan->xstride * sizeof(float), echan->ystride * sizeof(float)));
+	else
+		frameBuffer.insert(echan->name, Slice(Imf::FLOAT,  (char *)(echan->rect + echan->xstride * (data->height - 1) * data->width),
+		                                      echan->xstride * sizeof(float), -echan->ystride * sizeof(float)));
+}
+
 void IMB_exr_read_channels(void *handle)
 {
 	ExrHandle *data = (ExrHandle *)handle;
 	FrameBuffer frameBuffer;
 	ExrChannel *echan;
-
-	/* check if exr was saved with previous versions of blender which flipped images */
-	const StringAttribute *ta = data->ifile->header().findTypedAttribute <StringAttribute> ("BlenderMultiChannel");
-	short flip = (ta && strncmp(ta->value().c_str(), "Blender V2.43", 13) == 0); /* 'previous multilayer attribute, flipped */
+	bool flip = imb_exr_is_flipped(data);
 
 	for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
 
-		if (echan->rect) {
-			if (flip)
-				frameBuffer.insert(echan->name, Slice(Imf::FLOAT,  (char *)echan->rect,
-				                                      echan->xstride * sizeof(float), echan->ystride * sizeof(float)));
-			else
-				frameBuffer.insert(echan->name, Slice(Imf::FLOAT,  (char *)(echan->rect + echan->xstride * (data->height - 1) * data->width),
-				                                      echan->xstride * sizeof(float), -echan->ystride * sizeof(float)));
-		}
+		if (echan->rect)
+			imb_exr_insert_read_slice(data, frameBuffer, echan, flip);
 		else
 			printf("warning, channel with no rect set %s\n", echan->name);
 	}
@@ -993,27 +1021,55 @@ static ExrPass *imb_exr_get_pass(ListBase *lb, char *passname)
 	return pass;
 }
 
-/* creates channels, makes a hierarchy and assigns memory to channels */
-static ExrHandle *imb_exr_begin_read_mem(InputFile *file, int width, int height)
+/* with some heuristics, try to merge the channels in buffers:
+ * gives position of every pass channel inside of pass buffer */
+static void imb_exr_pass_channel_offsets(ExrPass *pass, int offset[EXR_PASS_MAXCHAN])
 {
-	ExrLayer *lay;
-	ExrPass *pass;
-	ExrChannel *echan;
-	ExrHandle *data = (ExrHandle *)IMB_exr_get_handle();
 	int a;
-	char layname[EXR_TOT_MAXNAME], passname[EXR_TOT_MAXNAME];
 
-	data->ifile = file;
-	data->width = width;
-	data->height = height;
+	if (pass->totchan == 3 || pass->totchan == 4) {
+		char lookup[256];
 
-	const ChannelList &channels = data->ifile->header().channels();
+		memset(lookup, 0, sizeof(lookup));
 
-	for (ChannelList::ConstIterator i = channels.begin(); i != channels.end(); ++i)
-		IMB_exr_add_channel(data, NULL, i.name(), 0, 0, NULL);
+		/* we can have RGB(A), XYZ(W), UVA */
+		if (pass->chan[0]->chan_id == 'B' || pass->chan[1]->chan_id == 'B' ||  pass->chan[2]->chan_id == 'B') {
+			lookup[(unsigned int)'R'] = 0;
+			lookup[(unsigned int)'G'] = 1;
+			lookup[(unsigned int)'B'] = 2;
+			lookup[(unsigned int)'A'] = 3;
+		}
+		else if (pass->chan[0]->chan_id == 'Y' || pass->chan[1]->chan_id == 'Y' ||  pass->chan[2]->chan_id == 'Y') {
+			lookup[(unsigned int)'X'] = 0;
+			lookup[(unsigned int)'Y'] = 1;
+			lookup[(unsigned int)'Z'] = 2;
+			lookup[(unsigned int)'W'] = 3;
+		}
+		else {
+			lookup[(unsigned int)'U'] = 0;
+			lookup[(unsigned int)'V'] = 1;
+			lookup[(unsigned int)'A'] = 2;
+		}
+
+		for (a = 0; a < pass->totchan; a++)
+			offset[a] = lookup[(unsigned int)pass->chan[a]->chan_id];
+	}
+	else { /* single channel or unknown */
+		for (a = 0; a < pass->totchan; a++)
+			offset[a] = a;
+	}
+}
+
+/* build hierarchical layer list from the flattened channels, without
+ * allocating any memory for the passes yet */
+static bool imb_exr_build_layers(ExrHandle *data)
+{
+	ExrLayer *lay;
+	ExrPass *pass;
+	ExrChannel *echan;
+	int a, offset[EXR_PASS_MAXCHAN];
+	char layname[EXR_TOT_MAXNAME], passname[EXR_TOT_MAXNAME];
 
-	/* now try to sort out how to assign memory to the channels */
-	/* first build hierarchical layer list */
 	for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
 		if (imb_exr_split_channel_name(echan, layname, passname) ) {
 			ExrLayer *lay = imb_exr_get_layer(&data->layers, layname);
@@ -1027,65 +1083,65 @@ static ExrHandle *imb_exr_begin_read_mem(InputFile *file, int width, int height)
 	}
 	if (echan) {
 		printf("error, too many channels in one pass: %s\n", echan->name);
-		IMB_exr_close(data);
-		return NULL;
+		return false;
 	}
 
-	/* with some heuristics, try to merge the channels in buffers */
+	/* channel identifiers are in buffer order, so they're known before reading pixels */
 	for (lay = (ExrLayer *)data->layers.first; lay; lay = lay->next) {
 		for (pass = (ExrPass *)lay->passes.first; pass; pass = pass->next) {
-			if (pass->totchan) {
-				pass->rect = (float *)MEM_mapallocN(width * height * pass->totchan * sizeof(float), "pass rect");
-				if (pass->totchan == 1) {
-					echan = pass->chan[0];
-					echan->rect = pass->rect;
-					echan->xstride = 1;
-					echan->ystride = width;
-					pass->chan_id[0] = echan->chan_id;
-				}
-				else {
-					char lookup[256];
+			imb_exr_pass_channel_offsets(pass, offset);
 
-					memset(lookup, 0, sizeof(lookup));
+			for (a = 0; a < pass->totchan; a++)
+				pass->chan_id[offset[a]] = pass->chan[a]->chan_id;
+		}
+	}
 
-					/* we can have RGB(A), XYZ(W), UVA */
-					if (pass->totchan == 3 || pass->totchan == 4) {
-						if (pass->chan[0]->chan_id == 'B' || pass->chan[1]->chan_id == 'B' ||  pass->chan[2]->chan_id == 'B') {
-							lookup[(unsigned int)'R'] = 0;
-							lookup[(unsigned int)'G'] = 1;
-							lookup[(unsigned int)'B'] = 2;
-							lookup[(unsigned int)'A'] = 3;
-						}
-						else if (pass->chan[0]->chan_id == 'Y' || pass->chan[1]->chan_id == 'Y' ||  pass->chan[2]->chan_id == 'Y') {
-							lookup[(unsigned int)'X'] = 0;
-							lookup[(unsigned int)'Y'] = 1;
-							lookup[(unsigned int)'Z'] = 2;
-							lookup[(unsigned int)'W'] = 3;
-						}
-						else {
-							lookup[(unsigned int)'U'] = 0;
-							lookup[(unsigned int)'V'] = 1;
-							lookup[(unsigned int)'A'] = 2;
-						}
-						for (a = 0; a < pass->totchan; a++) {
-							echan = pass->chan[a];
-							echan->rect = pass->rect + lookup[(unsigned int)echan->chan_id];
-							echan->xstride = pass->totchan;
-							echan->ystride = width * pass->totchan;
-							pass->chan_id[(unsigned int)lookup[(unsigned int)echan->chan_id]] = echan->chan_id;
-						}
-					}
-					else { /* unknown */
-						for (a = 0; a < pass->totchan; a++) {
-							echan = pass->chan[a];
-							echan->rect = pass->rect + a;
-							echan->xstride = pass->totchan;
-							echan->ystride = width * pass->totchan;
-							pass->chan_id[a] = echan->chan_id;
-						}
-					}
-				}
-			}
+	return true;
+}
+
+/* assign memory to the channels of a pass */
+static void imb_exr_pass_alloc(ExrHandle *data, ExrPass *pass)
+{
+	int a, offset[EXR_PASS_MAXCHAN];
+
+	pass->rect = (float *)MEM_mapallocN(data->width * data->height * pass->totchan * sizeof(float), "pass rect");
+
+	imb_exr_pass_channel_offsets(pass, offset);
+
+	for (a = 0; a < pass->totchan; a++) {
+		ExrChannel *echan = pass->chan[a];
+
+		echan->rect = pass->rect + offset[a];
+		echan->xstride = pass->totchan;
+		echan->ystride = data->width * pass->totchan;
+	}
+}
+
+/* creates channels, makes a hierarchy and assigns memory to channels */
+static ExrHandle *imb_exr_begin_read_mem(InputFile *file, int width, int height)
+{
+	ExrLayer *lay;
+	ExrPass *pass;
+	ExrHandle *data = (ExrHandle *)IMB_exr_get_handle();
+
+	data->ifile = file;
+	data->width = width;
+	data->height = height;
+
+	const ChannelList &channels = data->ifile->header().channels();
+
+	for (ChannelList::ConstIterator i = channels.begin(); i != channels.end(); ++i)
+		IMB_exr_add_channel(data, NULL, i.name(), 0, 0, NULL);
+
+	if (!imb_exr_build_layers(data)) {
+		IMB_exr_close(data);
+		return NULL;
+	}
+
+	for (lay = (ExrLayer *)data->layers.first; lay; lay = lay->next) {
+		for (pass = (ExrPass *)lay->passes.first; pass; pass = pass->next) {
+			if (pass->totchan)
+				imb_exr_pass_alloc(data, pass);
 		}
 	}
 
@@ -1187,6 +1243,116 @@ static bool exr_is_multilayer(InputFile *file)
 	return 0;
 }
 
+/* opens multilayer file for reading without reading any pixels, layers and
+ * passes are available for IMB_exr_multilayer_convert() right away, which
+ * gives passes with NULL rect, to be read later by IMB_exr_read_pass().
+ * returns 0 for single layer files as well.
+ *
+ * the file is closed again after reading the header, the handle can live as long
+ * as the image and the file can be replaced meanwhile */
+int IMB_exr_begin_read_lazy(void *handle, const char *filename, int *width, int *height)
+{
+	ExrHandle *data = (ExrHandle *)handle;
+	BLI_stat_t st;
+
+	/* 32 is arbitrary, but zero length files crashes exr */
+	if (BLI_stat(filename, &st) != 0 || st.st_size <= 32)
+		return 0;
+
+	if (!imb_exr_open_input(data, filename))
+		return 0;
+
+	/* single layer files are read as a whole, don't build channels for them */
+	if (!exr_is_multilayer(data->ifile)) {
+		imb_exr_close_input(data);
+		return 0;
+	}
+
+	Box2i dw = data->ifile->header().dataWindow();
+	data->width = *width  = dw.max.x - dw.min.x + 1;
+	data->height = *height = dw.max.y - dw.min.y + 1;
+
+	const ChannelList &channels = data->ifile->header().channels();
+
+	for (ChannelList::ConstIterator i = channels.begin(); i != channels.end(); ++i)
+		IMB_exr_add_channel(data, NULL, i.name(), 0, 0, NULL);
+
+	imb_exr_close_input(data);
+
+	if (!imb_exr_build_layers(data))
+		return 0;
+
+	BLI_strncpy(data->lazy_filepath, filename, sizeof(data->lazy_filepath));
+	data->lazy_mtime = (int64_t)st.st_mtime;
+	data->lazy_size = (int64_t)st.st_size;
+
+	return 1;
+}
+
+/* read pixels of a single pass of a file opened with IMB_exr_begin_read_lazy(),
+ * returned buffer is owned by the caller. NULL when reading failed or the file
+ * was changed since it was opened, the passes wouldn't match the layers anymore */
+float *IMB_exr_read_pass(void *handle, const char *layname, const char *passname)
+{
+	ExrHandle *data = (ExrHandle *)handle;
+	FrameBuffer frameBuffer;
+	ExrLayer *lay;
+	ExrPass *pass = NULL;
+	BLI_stat_t st;
+	float *rect;
+	bool flip;
+	int a;
+
+	if (data->lazy_filepath[0] == '\0')
+		return NULL;
+
+	lay = (ExrLayer *)BLI_findstring(&data->layers, layname, offsetof(ExrLayer, name));
+	if (lay)
+		pass = (ExrPass *)BLI_findstring(&lay->passes, passname, offsetof(ExrPass, name));
+
+	if (pass == NULL || pass->totchan == 0)
+		return NULL;
+
+	if (BLI_stat(data->lazy_filepath, &st) != 0 ||
+	    (int64_t)st.st_mtime != data->lazy_mtime || (int64_t)st.st_size != data->lazy_size)
+	{
+		printf("OpenEXR: %s changed since it was opened, pass %s.%s is not read\n",
+		       data->lazy_filepath, layname, passname);
+		return NULL;
+	}
+
+	if (!imb_exr_open_input(data, data->lazy_filepath))
+		return NULL;
+
+	imb_exr_pass_alloc(data, pass);
+
+	flip = imb_exr_is_flipped(data);
+	for (a = 0; a < pass->totchan; a++)
+		imb_exr_insert_read_slice(data, frameBuffer, pass->chan[a], flip);
+
+	/* only channels of this pass are in the frame buffer, others are skipped by the reader */
+	try {
+		data->ifile->setFrameBuffer(frameBuffer);
+		data->ifile->readPixels(0, data->height - 1);
+	}
+	catch (const std::exception &exc) {
+		std::cerr << "OpenEXR-readPixels: ERROR: " << exc.what() << std::endl;
+
+		MEM_freeN(pass->rect);
+		pass->rect = NULL;
+	}
+
+	imb_exr_close_input(data);
+
+	rect = pass->rect;
+
+	pass->rect = NULL;
+	for (a = 0; a < pass->totchan; a++)
+		pass->chan[a]->rect = NULL;
+
+	return rect;
+}
+
 struct ImBuf *imb_load_openexr(unsigned char *mem, size_t size, int flags, char colorspace[IM_MAX_SPACE])
 {
 	struct ImBuf *ibuf = NULL;
@@ -1336,6 +1502,119 @@ struct ImBuf *imb_load_openexr(unsigned char *mem, size_t size, int flags, char
 
 }
 
+/* thumbnails come from the preview image stored in the header or from the smallest
+ * mipmap level that still covers max_thumb_size, when the file has neither NULL is
+ * returned and the caller does a full load */
+struct ImBuf *imb_load_filepath_thumbnail_openexr(const char *filepath, const int flags, const size_t max_thumb_size,
+                                                 char colorspace[IM_MAX_SPACE], size_t *r_width, size_t *r_height)
+{
+	struct ImBuf *ibuf = NULL;
+	IStream *stream = NULL;
+	InputFile *file = NULL;
+	IStream *tiled_stream = NULL;
+	TiledInputFile *tiled = NULL;
+
+	try
+	{
+		stream = new IFileStream(filepath);
+		file = new InputFile(*stream);
+
+		const Header &header = file->header();
+		Box2i dw = header.dataWindow();
+
+		*r_width = dw.max.x - dw.min.x + 1;
+		*r_height = dw.max.y - dw.min.y + 1;
+
+		/* previews are often tiny, only use them when big enough for the thumbnail */
+		if (header.hasPreviewImage() &&
+		    (size_t)std::max(header.previewImage().width(), header.previewImage().height()) >= max_thumb_size)
+		{
+			const PreviewImage &preview = header.previewImage();
+			const int width = preview.width();
+			const int height = preview.height();
+
+			ibuf = IMB_allocImBuf(width, height, 32, IB_rect);
+
+			for (int y = 0; y < height; y++) {
+				const PreviewRgba *src = preview.pixels() + (size_t)y * width;
+				/* preview is stored top to bottom */
+				unsigned char *dst = (unsigned char *)(ibuf->rect + (size_t)(height - 1 - y) * width);
+
+				for (int x = 0; x < width; x++, src++, dst += 4) {
+					dst[0] = src->r;
+					dst[1] = src->g;
+					dst[2] = src->b;
+					dst[3] = src->a;
+				}
+			}
+
+			colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_BYTE);
+		}
+		else if (header.hasTileDescription() && header.tileDescription().mode == MIPMAP_LEVELS &&
+		         exr_has_rgb(file) && !exr_is_multilayer(file))
+		{
+			FrameBuffer frameBuffer;
+			float *first;
+			int level = 0;
+
+			tiled_stream = new IFileStream(filepath);
+			tiled = new TiledInputFile(*tiled_stream);
+
+			while (level + 1 < tiled->numLevels() &&
+			       (size_t)std::max(tiled->levelWidth(level + 1), tiled->levelHeight(level + 1)) >= max_thumb_size)
+			{
+				level++;
+			}
+
+			Box2i ldw = tiled->dataWindowForLevel(level);
+			const int width = tiled->levelWidth(level);
+			const int height = tiled->levelHeight(level);
+			const int xstride = sizeof(float) * 4;
+			const int ystride = -xstride * width;
+
+			ibuf = IMB_allocImBuf(width, height, 32, 0);
+			imb_addrectfloatImBuf(ibuf);
+
+			/* same y-flipped layout as imb_load_openexr */
+			first = ibuf->rect_float - 4 * (ldw.min.x - ldw.min.y * width);
+			first += 4 * (height - 1) * width;
+
+			frameBuffer.insert(exr_rgba_channelname(file, "R"),
+			                   Slice(Imf::FLOAT,  (char *) first, xstride, ystride));
+			frameBuffer.insert(exr_rgba_channelname(file, "G"),
+			                   Slice(Imf::FLOAT,  (char *) (first + 1), xstride, ystride));
+			frameBuffer.insert(exr_rgba_channelname(file, "B"),
+			                   Slice(Imf::FLOAT,  (char *) (first + 2), xstride, ystride));
+			frameBuffer.insert(exr_rgba_channelname(file, "A"),
+			                   Slice(Imf::FLOAT,  (char *) (first + 3), xstride, ystride, 1, 1, 1.0f));
+
+			tiled->setFrameBuffer(frameBuffer);
+			tiled->readTiles(0, tiled->numXTiles(level) - 1, 0, tiled->numYTiles(level) - 1, level);
+
+			colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_FLOAT);
+
+			if (flags & IB_alphamode_detect)
+				ibuf->flags |= IB_alphamode_premul;
+		}
+
+		if (ibuf)
+			ibuf->ftype = OPENEXR;
+	}
+	catch (const std::exception &exc)
+	{
+		std::cerr << exc.what() << std::endl;
+		if (ibuf) IMB_freeImBuf(ibuf);
+		ibuf = NULL;
+	}
+
+	delete tiled;
+	delete tiled_stream;
+	delete file;
+	delete stream;
+
+	return ibuf;
+}
+
 void imb_initopenexr(void)
 {
 	int num_threads = BLI_system_thread_count();
@@ -51,12 +51,14 @@ void *IMB_exr_get_handle(void);
 void    IMB_exr_add_channel(void *handle, const char *layname, const char *passname, int xstride, int ystride, float *rect);
 
 int     IMB_exr_begin_read(void *handle, const char *filename, int *width, int *height);
+int     IMB_exr_begin_read_lazy(void *handle, const char *filename, int *width, int *height);
 int     IMB_exr_begin_write(void *handle, const char *filename, int width, int height, int compress);
 void    IMB_exrtile_begin_write(void *handle, const char *filename, int mipmap, int width, int height, int tilex, int tiley);
 
 void    IMB_exr_set_channel(void *handle, const char *layname, const char *passname, int xstride, int ystride, float *rect);
 
 void    IMB_exr_read_channels(void *handle);
+float  *IMB_exr_read_pass(void *handle, const char *layname, const char *passname);
 void    IMB_exr_write_channels(void *handle);
 void    IMB_exrtile_write_channels(void *handle, int partx, int party, int level);
 void    IMB_exrtile_clear_channels(void *handle);
@@ -44,6 +44,7 @@
 #include "BLI_string.h"
 #include "BLI_path_util.h"
 #include "BLI_fileops.h"
+#include "BLI_threads.h"
 
 #include "imbuf.h"
 #include "IMB_imbuf_types.h"
@@ -230,6 +231,77 @@ ImBuf *IMB_loadiffname(const char *filepath, int flags, char colorspace[IM_MAX_S
 	return ibuf;
 }
 
+/* thumbnails are made from several threads, full size images can be huge,
+ * so only a few of them are loaded at once */
+#define THUMB_FULL_LOADS_MAX 2
+
+static ThreadMutex thumb_load_lock = BLI_MUTEX_INITIALIZER;
+static ThreadCondition thumb_load_cond;
+static int thumb_load_num = 0;
+
+void imb_thumb_load_init(void)
+{
+	BLI_condition_init(&thumb_load_cond);
+}
+
+void imb_thumb_load_exit(void)
+{
+	BLI_condition_end(&thumb_load_cond);
+}
+
+/* load an image of at least max_thumb_size, formats which can decode at reduced
+ * resolution do so, others are loaded at full size, r_width/r_height always return
+ * the size of the original image */
+ImBuf *IMB_thumb_load_image(const char *filepath, const size_t max_thumb_size, char colorspace[IM_MAX_SPACE],
+                            size_t *r_width, size_t *r_height)
+{
+	const int flags = IB_rect | IB_metadata;
+	const int ftype = IMB_ispic_type(filepath);
+	ImFileType *type;
+	ImBuf *ibuf = NULL;
+
+	if (ftype == 0)
+		return NULL;
+
+	for (type = IMB_FILE_TYPES; type < IMB_FILE_TYPES_LAST; type++) {
+		if (type->filetype == ftype && type->load_filepath_thumbnail) {
+			char effective_colorspace[IM_MAX_SPACE] = "";
+
+			if (colorspace)
+				BLI_strncpy(effective_colorspace, colorspace, sizeof(effective_colorspace));
+
+			ibuf = type->load_filepath_thumbnail(filepath, flags, max_thumb_size, effective_colorspace,
+			                                     r_width, r_height);
+			if (ibuf) {
+				imb_handle_alpha(ibuf, flags, colorspace, effective_colorspace);
+				return ibuf;
+			}
+			break;
+		}
+	}
+
+	/* no reduced decoding for this format (or the file has no preview/mip levels) */
+	BLI_mutex_lock(&thumb_load_lock);
+	while (thumb_load_num >= THUMB_FULL_LOADS_MAX)
+		BLI_condition_wait(&thumb_load_cond, &thumb_load_lock);
+	thumb_load_num++;
+	BLI_mutex_unlock(&thumb_load_lock);
+
+	ibuf = IMB_loadiffname(filepath, flags, colorspace);
+
+	BLI_mutex_lock(&thumb_load_lock);
+	thumb_load_num--;
+	BLI_condition_notify_one(&thumb_load_cond);
+	BLI_mutex_unlock(&thumb_load_lock);
+
+	if (ibuf) {
+		*r_width = ibuf->x;
+		*r_height = ibuf->y;
+	}
+
+	return ibuf;
+}
+
 ImBuf *IMB_testiffname(const char *filepath, int flags)
 {
 	ImBuf *ibuf;
@@ -36,6 +36,7 @@
 #include "BLI_math_base.h"
 #include "BLI_math_color.h"
 #include "BLI_math_interp.h"
+#include "BLI_task.h"
 #include "MEM_guardedalloc.h"
 
 #include "imbuf.h"
@@ -47,6 +48,10 @@
 
 #include "BLI_sys_types.h" // for intptr_t support
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 /************************************************************************/
 /*								SCALING									*/
 /************************************************************************/
@@ -883,611 +888,6 @@ static bool q_scale_linear_interpolation(
 	return true;
 }
 
-static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
-{
-	const int do_rect = (ibuf->rect != NULL);
-	const int do_float = (ibuf->rect_float != NULL);
-	const size_t rect_size = ibuf->x * ibuf->y * 4;
-
-	uchar *rect, *_newrect, *newrect;
-	float *rectf, *_newrectf, *newrectf;
-	float sample, add, val[4], nval[4], valf[4], nvalf[4];
-	int x, y;
-
-	rectf = _newrectf = newrectf = NULL;
-	rect = _newrect = newrect = NULL;
-	nval[0] =  nval[1] = nval[2] = nval[3] = 0.0f;
-	nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
-
-	if (!do_rect && !do_float) return (ibuf);
-
-	if (do_rect) {
-		_newrect = MEM_mallocN(newx * ibuf->y * sizeof(uchar) * 4, "scaledownx");
-		if (_newrect == NULL) return(ibuf);
-	}
-	if (do_float) {
-		_newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaledownxf");
-		if (_newrectf == NULL) {
-			if (_newrect) MEM_freeN(_newrect);
-			return(ibuf);
-		}
-	}
-
-	add = (ibuf->x - 0.01) / newx;
-
-	if (do_rect) {
-		rect = (uchar *) ibuf->rect;
-		newrect = _newrect;
-	}
-	if (do_float) {
-		rectf = ibuf->rect_float;
-		newrectf = _newrectf;
-	}
-		
-	for (y = ibuf->y; y > 0; y--) {
-		sample = 0.0f;
-		val[0] =  val[1] = val[2] = val[3] = 0.0f;
-		valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-		for (x = newx; x > 0; x--) {
-			if (do_rect) {
-				nval[0] = -val[0] * sample;
-				nval[1] = -val[1] * sample;
-				nval[2] = -val[2] * sample;
-				nval[3] = -val[3] * sample;
-			}
-			if (do_float) {
-				nvalf[0] = -valf[0] * sample;
-				nvalf[1] = -valf[1] * sample;
-				nvalf[2] = -valf[2] * sample;
-				nvalf[3] = -valf[3] * sample;
-			}
-			
-			sample += add;
-
-			while (sample >= 1.0f) {
-				sample -= 1.0f;
-				
-				if (do_rect) {
-					nval[0] += rect[0];
-					nval[1] += rect[1];
-					nval[2] += rect[2];
-					nval[3] += rect[3];
-					rect += 4;
-				}
-				if (do_float) {
-					nvalf[0] += rectf[0];
-					nvalf[1] += rectf[1];
-					nvalf[2] += rectf[2];
-					nvalf[3] += rectf[3];
-					rectf += 4;
-				}
-			}
-			
-			if (do_rect) {
-				val[0] = rect[0]; val[1] = rect[1]; val[2] = rect[2]; val[3] = rect[3];
-				rect += 4;
-				
-				newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
-				newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
-				newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
-				newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
-				
-				newrect += 4;
-			}
-			if (do_float) {
-				
-				valf[0] = rectf[0]; valf[1] = rectf[1]; valf[2] = rectf[2]; valf[3] = rectf[3];
-				rectf += 4;
-				
-				newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-				newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-				newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-				newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-				
-				newrectf += 4;
-			}
-			
-			sample -= 1.0f;
-		}
-	}
-
-	if (do_rect) {
-		// printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-		BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug [#26502] */
-		imb_freerectImBuf(ibuf);
-		ibuf->mall |= IB_rect;
-		ibuf->rect = (unsigned int *) _newrect;
-	}
-	if (do_float) {
-		// printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-		BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug [#26502] */
-		imb_freerectfloatImBuf(ibuf);
-		ibuf->mall |= IB_rectfloat;
-		ibuf->rect_float = _newrectf;
-	}
-	(void)rect_size; /* UNUSED in release builds */
-	
-	ibuf->x = newx;
-	return(ibuf);
-}
-
-
-static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
-{
-	const int do_rect = (ibuf->rect != NULL);
-	const int do_float = (ibuf->rect_float != NULL);
-	const size_t rect_size = ibuf->x * ibuf->y * 4;
-
-	uchar *rect, *_newrect, *newrect;
-	float *rectf, *_newrectf, *newrectf;
-	float sample, add, val[4], nval[4], valf[4], nvalf[4];
-	int x, y, skipx;
-
-	rectf = _newrectf = newrectf = NULL;
-	rect = _newrect = newrect = NULL;
-	nval[0] =  nval[1] = nval[2] = nval[3] = 0.0f;
-	nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
-
-	if (!do_rect && !do_float) return (ibuf);
-
-	if (do_rect) {
-		_newrect = MEM_mallocN(newy * ibuf->x * sizeof(uchar) * 4, "scaledowny");
-		if (_newrect == NULL) return(ibuf);
-	}
-	if (do_float) {
-		_newrectf = MEM_mallocN(newy * ibuf->x * sizeof(float) * 4, "scaledownyf");
-		if (_newrectf == NULL) {
-			if (_newrect) MEM_freeN(_newrect);
-			return(ibuf);
-		}
-	}
-
-	add = (ibuf->y - 0.01) / newy;
-	skipx = 4 * ibuf->x;
-
-	for (x = skipx - 4; x >= 0; x -= 4) {
-		if (do_rect) {
-			rect = ((uchar *) ibuf->rect) + x;
-			newrect = _newrect + x;
-		}
-		if (do_float) {
-			rectf = ibuf->rect_float + x;
-			newrectf = _newrectf + x;
-		}
-		
-		sample = 0.0f;
-		val[0] =  val[1] = val[2] = val[3] = 0.0f;
-		valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-		for (y = newy; y > 0; y--) {
-			if (do_rect) {
-				nval[0] = -val[0] * sample;
-				nval[1] = -val[1] * sample;
-				nval[2] = -val[2] * sample;
-				nval[3] = -val[3] * sample;
-			}
-			if (do_float) {
-				nvalf[0] = -valf[0] * sample;
-				nvalf[1] = -valf[1] * sample;
-				nvalf[2] = -valf[2] * sample;
-				nvalf[3] = -valf[3] * sample;
-			}
-			
-			sample += add;
-
-			while (sample >= 1.0f) {
-				sample -= 1.0f;
-				
-				if (do_rect) {
-					nval[0] += rect[0];
-					nval[1] += rect[1];
-					nval[2] += rect[2];
-					nval[3] += rect[3];
-					rect += skipx;
-				}
-				if (do_float) {
-					nvalf[0] += rectf[0];
-					nvalf[1] += rectf[1];
-					nvalf[2] += rectf[2];
-					nvalf[3] += rectf[3];
-					rectf += skipx;
-				}
-			}
-
-			if (do_rect) {
-				val[0] = rect[0]; val[1] = rect[1]; val[2] = rect[2]; val[3] = rect[3];
-				rect += skipx;
-				
-				newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
-				newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
-				newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
-				newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
-				
-				newrect += skipx;
-			}
-			if (do_float) {
-				
-				valf[0] = rectf[0]; valf[1] = rectf[1]; valf[2] = rectf[2]; valf[3] = rectf[3];
-				rectf += skipx;
-				
-				newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-				newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-				newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-				newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-				
-				newrectf += skipx;
-			}
-			
-			sample -= 1.0f;
-		}
-	}
-
-	if (do_rect) {
-		// printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-		BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug [#26502] */
-		imb_freerectImBuf(ibuf);
-		ibuf->mall |= IB_rect;
-		ibuf->rect = (unsigned int *) _newrect;
-	}
-	if (do_float) {
-		// printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-		BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug [#26502] */
-		imb_freerectfloatImBuf(ibuf);
-		ibuf->mall |= IB_rectfloat;
-		ibuf->rect_float = (float *) _newrectf;
-	}
-	(void)rect_size; /* UNUSED in release builds */
-	
-	ibuf->y = newy;
-	return(ibuf);
-}
-
-
-static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
-{
-	uchar *rect, *_newrect = NULL, *newrect;
-	float *rectf, *_newrectf = NULL, *newrectf;
-	float sample, add;
-	float val_a, nval_a, diff_a;
-	float val_b, nval_b, diff_b;
-	float val_g, nval_g, diff_g;
-	float val_r, nval_r, diff_r;
-	float val_af, nval_af, diff_af;
-	float val_bf, nval_bf, diff_bf;
-	float val_gf, nval_gf, diff_gf;
-	float val_rf, nval_rf, diff_rf;
-	int x, y;
-	bool do_rect = false, do_float = false;
-
-	val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-	val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-	val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-	val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-	if (ibuf == NULL) return(NULL);
-	if (ibuf->rect == NULL && ibuf->rect_float == NULL) return (ibuf);
-
-	if (ibuf->rect) {
-		do_rect = true;
-		_newrect = MEM_mallocN(newx * ibuf->y * sizeof(int), "scaleupx");
-		if (_newrect == NULL) return(ibuf);
-	}
-	if (ibuf->rect_float) {
-		do_float = true;
-		_newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaleupxf");
-		if (_newrectf == NULL) {
-			if (_newrect) MEM_freeN(_newrect);
-			return(ibuf);
-		}
-	}
-
-	add = (ibuf->x - 1.001) / (newx - 1.0);
-
-	rect = (uchar *) ibuf->rect;
-	rectf = (float *) ibuf->rect_float;
-	newrect = _newrect;
-	newrectf = _newrectf;
-
-	for (y = ibuf->y; y > 0; y--) {
-
-		sample = 0;
-		
-		if (do_rect) {
-			val_a = rect[0];
-			nval_a = rect[4];
-			diff_a = nval_a - val_a;
-			val_a += 0.5f;
-
-			val_b = rect[1];
-			nval_b = rect[5];
-			diff_b = nval_b - val_b;
-			val_b += 0.5f;
-
-			val_g = rect[2];
-			nval_g = rect[6];
-			diff_g = nval_g - val_g;
-			val_g += 0.5f;
-
-			val_r = rect[3];
-			nval_r = rect[7];
-			diff_r = nval_r - val_r;
-			val_r += 0.5f;
-
-			rect += 8;
-		}
-		if (do_float) {
-			val_af = rectf[0];
-			nval_af = rectf[4];
-			diff_af = nval_af - val_af;
-	
-			val_bf = rectf[1];
-			nval_bf = rectf[5];
-			diff_bf = nval_bf - val_bf;
-
-			val_gf = rectf[2];
-			nval_gf = rectf[6];
-			diff_gf = nval_gf - val_gf;
-
-			val_rf = rectf[3];
-			nval_rf = rectf[7];
-			diff_rf = nval_rf - val_rf;
-
-			rectf += 8;
-		}
-		for (x = newx; x > 0; x--) {
-			if (sample >= 1.0f) {
-				sample -= 1.0f;
-
-				if (do_rect) {
-					val_a = nval_a;
-					nval_a = rect[0];
-					diff_a = nval_a - val_a;
-					val_a += 0.5f;
-
-					val_b = nval_b;
-					nval_b = rect[1];
-					diff_b = nval_b - val_b;
-					val_b += 0.5f;
-
-					val_g = nval_g;
-					nval_g = rect[2];
-					diff_g = nval_g - val_g;
-					val_g += 0.5f;
-
-					val_r = nval_r;
-					nval_r = rect[3];
-					diff_r = nval_r - val_r;
-					val_r += 0.5f;
-					rect += 4;
-				}
-				if (do_float) {
-					val_af = nval_af;
-					nval_af = rectf[0];
-					diff_af = nval_af - val_af;
-	
-					val_bf = nval_bf;
-					nval_bf = rectf[1];
-					diff_bf = nval_bf - val_bf;
-
-					val_gf = nval_gf;
-					nval_gf = rectf[2];
-					diff_gf = nval_gf - val_gf;
-
-					val_rf = nval_rf;
-					nval_rf = rectf[3];
-					diff_rf = nval_rf - val_rf;
-					rectf += 4;
-				}
-			}
-			if (do_rect) {
-				newrect[0] = val_a + sample * diff_a;
-				newrect[1] = val_b + sample * diff_b;
-				newrect[2] = val_g + sample * diff_g;
-				newrect[3] = val_r + sample * diff_r;
-				newrect += 4;
-			}
-			if (do_float) {
-				newrectf[0] = val_af + sample * diff_af;
-				newrectf[1] = val_bf + sample * diff_bf;
-				newrectf[2] = val_gf + sample * diff_gf;
-				newrectf[3] = val_rf + sample * diff_rf;
-				newrectf += 4;
-			}
-			sample += add;
-		}
-	}
-
-	if (do_rect) {
-		imb_freerectImBuf(ibuf);
-		ibuf->mall |= IB_rect;
-		ibuf->rect = (unsigned int *) _newrect;
-	}
-	if (do_float) {
-		imb_freerectfloatImBuf(ibuf);
-		ibuf->mall |= IB_rectfloat;
-		ibuf->rect_float = (float *) _newrectf;
-	}
-	
-	ibuf->x = newx;
-	return(ibuf);
-}
-
-static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
-{
-	uchar *rect, *_newrect = NULL, *newrect;
-	float *rectf, *_newrectf = NULL, *newrectf;
-	float sample, add;
-	float val_a, nval_a, diff_a;
-	float val_b, nval_b, diff_b;
-	float val_g, nval_g, diff_g;
-	float val_r, nval_r, diff_r;
-	float val_af, nval_af, diff_af;
-	float val_bf, nval_bf, diff_bf;
-	float val_gf, nval_gf, diff_gf;
-	float val_rf, nval_rf, diff_rf;
-	int x, y, skipx;
-	bool do_rect = false, do_float = false;
-
-	val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-	val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-	val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-	val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-	if (ibuf == NULL) return(NULL);
-	if (ibuf->rect == NULL && ibuf->rect_float == NULL) return (ibuf);
-
-	if (ibuf->rect) {
-		do_rect = true;
-		_newrect = MEM_mallocN(ibuf->x * newy * sizeof(int), "scaleupy");
-		if (_newrect == NULL) return(ibuf);
-	}
-	if (ibuf->rect_float) {
-		do_float = true;
-		_newrectf = MEM_mallocN(ibuf->x * newy * sizeof(float) * 4, "scaleupyf");
-		if (_newrectf == NULL) {
-			if (_newrect) MEM_freeN(_newrect);
-			return(ibuf);
-		}
-	}
-
-	add = (ibuf->y - 1.001) / (newy - 1.0);
-	skipx = 4 * ibuf->x;
-
-	rect = (uchar *) ibuf->rect;
-	rectf = (float *) ibuf->rect_float;
-	newrect = _newrect;
-	newrectf = _newrectf;
-
-	for (x = ibuf->x; x > 0; x--) {
-
-		sample = 0;
-		if (do_rect) {
-			rect = ((uchar *)ibuf->rect) + 4 * (x - 1);
-			newrect = _newrect + 4 * (x - 1);
-
-			val_a = rect[0];
-			nval_a = rect[skipx];
-			diff_a = nval_a - val_a;
-			val_a += 0.5f;
-
-			val_b = rect[1];
-			nval_b = rect[skipx + 1];
-			diff_b = nval_b - val_b;
-			val_b += 0.5f;
-
-			val_g = rect[2];
-			nval_g = rect[skipx + 2];
-			diff_g = nval_g - val_g;
-			val_g += 0.5f;
-
-			val_r = rect[3];
-			nval_r = rect[skipx + 3];
-			diff_r = nval_r - val_r;
-			val_r += 0.5f;
-
-			rect += 2 * skipx;
-		}
-		if (do_float) {
-			rectf = ibuf->rect_float + 4 * (x - 1);
-			newrectf = _newrectf + 4 * (x - 1);
-
-			val_af = rectf[0];
-			nval_af = rectf[skipx];
-			diff_af = nval_af - val_af;
-	
-			val_bf = rectf[1];
-			nval_bf = rectf[skipx + 1];
-			diff_bf = nval_bf - val_bf;
-
-			val_gf = rectf[2];
-			nval_gf = rectf[skipx + 2];
-			diff_gf = nval_gf - val_gf;
-
-			val_rf = rectf[3];
-			nval_rf = rectf[skipx + 3];
-			diff_rf = nval_rf - val_rf;
-
-			rectf += 2 * skipx;
-		}
-		
-		for (y = newy; y > 0; y--) {
-			if (sample >= 1.0f) {
-				sample -= 1.0f;
-
-				if (do_rect) {
-					val_a = nval_a;
-					nval_a = rect[0];
-					diff_a = nval_a - val_a;
-					val_a += 0.5f;
-
-					val_b = nval_b;
-					nval_b = rect[1];
-					diff_b = nval_b - val_b;
-					val_b += 0.5f;
-
-					val_g = nval_g;
-					nval_g = rect[2];
-					diff_g = nval_g - val_g;
-					val_g += 0.5f;
-
-					val_r = nval_r;
-					nval_r = rect[3];
-					diff_r = nval_r - val_r;
-					val_r += 0.5f;
-					rect += skipx;
-				}
-				if (do_float) {
-					val_af = nval_af;
-					nval_af = rectf[0];
-					diff_af = nval_af - val_af;
-	
-					val_bf = nval_bf;
-					nval_bf = rectf[1];
-					diff_bf = nval_bf - val_bf;
-
-					val_gf = nval_gf;
-					nval_gf = rectf[2];
-					diff_gf = nval_gf - val_gf;
-
-					val_rf = nval_rf;
-					nval_rf = rectf[3];
-					diff_rf = nval_rf - val_rf;
-					rectf += skipx;
-				}
-			}
-			if (do_rect) {
-				newrect[0] = val_a + sample * diff_a;
-				newrect[1] = val_b + sample * diff_b;
-				newrect[2] = val_g + sample * diff_g;
-				newrect[3] = val_r + sample * diff_r;
-				newrect += skipx;
-			}
-			if (do_float) {
-				newrectf[0] = val_af + sample * diff_af;
-				newrectf[1] = val_bf + sample * diff_bf;
-				newrectf[2] = val_gf + sample * diff_gf;
-				newrectf[3] = val_rf + sample * diff_rf;
-				newrectf += skipx;
-			}
-			sample += add;
-		}
-	}
-
-	if (do_rect) {
-		imb_freerectImBuf(ibuf);
-		ibuf->mall |= IB_rect;
-		ibuf->rect = (unsigned int *) _newrect;
-	}
-	if (do_float) {
-		imb_freerectfloatImBuf(ibuf);
-		ibuf->mall |= IB_rectfloat;
-		ibuf->rect_float = (float *) _newrectf;
-	}
-	
-	ibuf->y = newy;
-	return(ibuf);
-}
-
-
 /* no float buf needed here! */
 static void scalefast_Z_ImBuf(ImBuf *ibuf, int newx, int newy)
 {
@@ -1529,22 +929,15 @@ struct ImBuf *IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int
 	
 	if (newx == ibuf->x && newy == ibuf->y) { return ibuf; }
 
-	/* scaleup / scaledown functions below change ibuf->x and ibuf->y
-	 * so we first scale the Z-buffer (if any) */
-	scalefast_Z_ImBuf(ibuf, newx, newy);
-
 	/* try to scale common cases in a fast way */
 	/* disabled, quality loss is unacceptable, see report #18609  (ton) */
 	if (0 && q_scale_linear_interpolation(ibuf, newx, newy)) {
 		return ibuf;
 	}
 
-	if (newx && (newx < ibuf->x)) scaledownx(ibuf, newx);
-	if (newy && (newy < ibuf->y)) scaledowny(ibuf, newy);
-	if (newx && (newx > ibuf->x)) scaleupx(ibuf, newx);
-	if (newy && (newy > ibuf->y)) scaleupy(ibuf, newy);
-	
-	return(ibuf);
+	/* box filter averages the covered area when shrinking and
+	 * interpolates linearly when enlarging */
+	return IMB_scaleImBuf_filter(ibuf, newx, newy, IMB_SCALE_FILTER_BOX);
 }
 
 struct imbufRGBA {
@@ -1635,113 +1028,368 @@ struct ImBuf *IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned
 	return(ibuf);
 }
 
-/* ******** threaded scaling ******** */
+/* ******** filtered scaling ******** */
 
-typedef struct ScaleTreadInitData {
-	ImBuf *ibuf;
+/* Separable resampler: rows are filtered into a float buffer first, then the
+ * columns of that buffer are filtered into the new buffers. Weights of every
+ * output pixel are precomputed per axis, filters get widened when shrinking so
+ * all source pixels contribute. Both passes are running in parallel by rows.
+ */
 
-	unsigned int newx;
-	unsigned int newy;
+#define SCALE_FILTER_CHUNK_SIZE 16
 
-	unsigned char *byte_buffer;
-	float *float_buffer;
-} ScaleTreadInitData;
+typedef struct ScaleFilterTable {
+	/* first source pixel and number of taps of every output pixel */
+	int *start, *num;
+	int max_taps;
+	/* max_taps weights per output pixel, normalized */
+	float *weights;
+} ScaleFilterTable;
 
-typedef struct ScaleThreadData {
+static float scale_filter_support(int filter)
+{
+	switch (filter) {
+		case IMB_SCALE_FILTER_BILINEAR:
+			return 1.0f;
+		case IMB_SCALE_FILTER_MITCHELL:
+			return 2.0f;
+		case IMB_SCALE_FILTER_LANCZOS:
+			return 3.0f;
+		case IMB_SCALE_FILTER_BOX:
+		default:
+			return 0.5f;
+	}
+}
+
+static float scale_filter_value(int filter, float x)
+{
+	x = fabsf(x);
+
+	switch (filter) {
+		case IMB_SCALE_FILTER_BILINEAR:
+			return (x < 1.0f) ? 1.0f - x : 0.0f;
+		case IMB_SCALE_FILTER_MITCHELL:
+			/* B = C = 1/3 */
+			if (x < 1.0f)
+				return (7.0f * x * x * x - 12.0f * x * x + 16.0f / 3.0f) / 6.0f;
+			if (x < 2.0f)
+				return (-7.0f / 3.0f * x * x * x + 12.0f * x * x - 20.0f * x + 32.0f / 3.0f) / 6.0f;
+			return 0.0f;
+		case IMB_SCALE_FILTER_LANCZOS:
+			if (x < 1e-6f)
+				return 1.0f;
+			if (x < 3.0f)
+				return 3.0f * sinf((float)M_PI * x) * sinf((float)M_PI * x / 3.0f) / ((float)(M_PI * M_PI) * x * x);
+			return 0.0f;
+		case IMB_SCALE_FILTER_BOX:
+		default:
+			return (x < 0.5f) ? 1.0f : 0.0f;
+	}
+}
+
+static void scale_filter_table_init(ScaleFilterTable *table, int in_len, int out_len, int filter)
+{
+	const float scale = (float)in_len / out_len;
+	const float filter_scale = max_ff(scale, 1.0f);
+	const float support = scale_filter_support(filter) * filter_scale;
+	int i, j;
+
+	table->max_taps = (int)ceilf(2.0f * support) + 2;
+	table->start = MEM_mallocN(sizeof(int) * out_len, "scale filter start");
+	table->num = MEM_mallocN(sizeof(int) * out_len, "scale filter num");
+	table->weights = MEM_mallocN(sizeof(float) * out_len * table->max_taps, "scale filter weights");
+
+	for (i = 0; i < out_len; i++) {
+		/* pixel j covers [j, j + 1] */
+		const float center = (i + 0.5f) * scale;
+		const int start = max_ii((int)floorf(center - support), 0);
+		const int end = min_ii((int)ceilf(center + support), in_len);
+		float *weights = table->weights + i * table->max_taps;
+		float sum = 0.0f;
+		int first = -1, num = 0;
+
+		for (j = start; j < end; j++) {
+			float weight;
+
+			if (filter == IMB_SCALE_FILTER_BOX) {
+				/* area of the source pixel covered by the output pixel */
+				const float half = 0.5f * filter_scale;
+				weight = min_ff((float)j + 1.0f, center + half) - max_ff((float)j, center - half);
+				weight = max_ff(weight, 0.0f);
+			}
+			else {
+				weight = scale_filter_value(filter, ((float)j + 0.5f - center) / filter_scale);
+			}
+
+			/* skip zero weights at the start */
+			if (first == -1) {
+				if (weight == 0.0f)
+					continue;
+				first = j;
+			}
+
+			BLI_assert(num < table->max_taps);
+			weights[num++] = weight;
+			sum += weight;
+		}
+
+		/* and at the end */
+		while (num > 0 && weights[num - 1] == 0.0f)
+			num--;
+
+		if (num == 0 || sum == 0.0f) {
+			first = min_ii((int)center, in_len - 1);
+			weights[0] = 1.0f;
+			num = 1;
+			sum = 1.0f;
+		}
+
+		for (j = 0; j < num; j++)
+			weights[j] /= sum;
+
+		table->start[i] = first;
+		table->num[i] = num;
+	}
+}
+
+static void scale_filter_table_free(ScaleFilterTable *table)
+{
+	MEM_freeN(table->start);
+	MEM_freeN(table->num);
+	MEM_freeN(table->weights);
+}
+
+typedef struct ScaleFilterThreadData {
 	ImBuf *ibuf;
+	int newx, newy;
+	int channels;
 
-	unsigned int newx;
-	unsigned int newy;
+	ScaleFilterTable table_x, table_y;
 
-	int start_line;
-	int tot_line;
+	/* rows filtered in X direction, newx * ibuf->y pixels */
+	float *temp, *temp_float;
 
 	unsigned char *byte_buffer;
 	float *float_buffer;
-} ScaleThreadData;
+} ScaleFilterThreadData;
+
+static void scale_filter_row_byte(const ScaleFilterTable *table, const unsigned char *in, float *out, int newx)
+{
+	int x, i;
+
+	for (x = 0; x < newx; x++, out += 4) {
+		const unsigned char *pixel = in + 4 * table->start[x];
+		const float *weights = table->weights + x * table->max_taps;
+		const int num = table->num[x];
+#ifdef __SSE2__
+		const __m128i zero = _mm_setzero_si128();
+		__m128 accum = _mm_setzero_ps();
+
+		for (i = 0; i < num; i++, pixel += 4) {
+			int packed;
+			__m128 color;
+
+			memcpy(&packed, pixel, sizeof(packed));
+			color = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero));
+			accum = _mm_add_ps(accum, _mm_mul_ps(color, _mm_set1_ps(weights[i])));
+		}
+		_mm_storeu_ps(out, accum);
+#else
+		out[0] = out[1] = out[2] = out[3] = 0.0f;
+
+		for (i = 0; i < num; i++, pixel += 4) {
+			out[0] += pixel[0] * weights[i];
+			out[1] += pixel[1] * weights[i];
+			out[2] += pixel[2] * weights[i];
+			out[3] += pixel[3] * weights[i];
+		}
+#endif
+	}
+}
+
+static void scale_filter_row_float(const ScaleFilterTable *table, const float *in, float *out, int newx, int channels)
+{
+	int x, i, c;
+
+#ifdef __SSE2__
+	if (channels == 4) {
+		for (x = 0; x < newx; x++, out += 4) {
+			const float *pixel = in + 4 * table->start[x];
+			const float *weights = table->weights + x * table->max_taps;
+			__m128 accum = _mm_setzero_ps();
+
+			for (i = 0; i < table->num[x]; i++, pixel += 4)
+				accum = _mm_add_ps(accum, _mm_mul_ps(_mm_loadu_ps(pixel), _mm_set1_ps(weights[i])));
+
+			_mm_storeu_ps(out, accum);
+		}
+		return;
+	}
+#endif
 
-static void scale_thread_init(void *data_v, int start_line, int tot_line, void *init_data_v)
+	for (x = 0; x < newx; x++, out += channels) {
+		const float *pixel = in + channels * table->start[x];
+		const float *weights = table->weights + x * table->max_taps;
+
+		for (c = 0; c < channels; c++)
+			out[c] = 0.0f;
+
+		for (i = 0; i < table->num[x]; i++, pixel += channels) {
+			for (c = 0; c < channels; c++)
+				out[c] += pixel[c] * weights[i];
+		}
+	}
+}
+
+/* out = sum of the rows starting at in, weighted, rows are len floats apart */
+static void scale_filter_column(const float *in, float *out, int len, const float *weights, int num)
 {
-	ScaleThreadData *data = (ScaleThreadData *) data_v;
-	ScaleTreadInitData *init_data = (ScaleTreadInitData *) init_data_v;
+	int i, k = 0;
+
+#ifdef __SSE2__
+	for (; k + 4 <= len; k += 4) {
+		const float *row = in + k;
+		__m128 accum = _mm_setzero_ps();
 
-	data->ibuf = init_data->ibuf;
+		for (i = 0; i < num; i++, row += len)
+			accum = _mm_add_ps(accum, _mm_mul_ps(_mm_loadu_ps(row), _mm_set1_ps(weights[i])));
 
-	data->newx = init_data->newx;
-	data->newy = init_data->newy;
+		_mm_storeu_ps(out + k, accum);
+	}
+#endif
 
-	data->start_line = start_line;
-	data->tot_line = tot_line;
+	for (; k < len; k++) {
+		const float *row = in + k;
+		float accum = 0.0f;
 
-	data->byte_buffer = init_data->byte_buffer;
-	data->float_buffer = init_data->float_buffer;
+		for (i = 0; i < num; i++, row += len)
+			accum += *row * weights[i];
+
+		out[k] = accum;
+	}
 }
 
-static void *do_scale_thread(void *data_v)
+static void scale_filter_rows(void *userdata, int chunk)
 {
-	ScaleThreadData *data = (ScaleThreadData *) data_v;
+	ScaleFilterThreadData *data = userdata;
 	ImBuf *ibuf = data->ibuf;
-	int i;
-	float factor_x = (float) ibuf->x / data->newx;
-	float factor_y = (float) ibuf->y / data->newy;
-
-	for (i = 0; i < data->tot_line; i++) {
-		int y = data->start_line + i;
-		int x;
-
-		for (x = 0; x < data->newx; x++) {
-			float u = (float) x * factor_x;
-			float v = (float) y * factor_y;
-			int offset = y * data->newx + x;
-
-			if (data->byte_buffer) {
-				unsigned char *pixel = data->byte_buffer + 4 * offset;
-				BLI_bilinear_interpolation_char((unsigned char *) ibuf->rect, pixel, ibuf->x, ibuf->y, 4, u, v);
-			}
+	const int start = chunk * SCALE_FILTER_CHUNK_SIZE;
+	const int end = min_ii(start + SCALE_FILTER_CHUNK_SIZE, ibuf->y);
+	int y;
+
+	for (y = start; y < end; y++) {
+		if (data->temp) {
+			scale_filter_row_byte(&data->table_x, (unsigned char *)ibuf->rect + (size_t)y * ibuf->x * 4,
+			                      data->temp + (size_t)y * data->newx * 4, data->newx);
+		}
+		if (data->temp_float) {
+			scale_filter_row_float(&data->table_x, ibuf->rect_float + (size_t)y * ibuf->x * data->channels,
+			                       data->temp_float + (size_t)y * data->newx * data->channels,
+			                       data->newx, data->channels);
+		}
+	}
+}
 
-			if (data->float_buffer) {
-				float *pixel = data->float_buffer + ibuf->channels * offset;
-				BLI_bilinear_interpolation_fl(ibuf->rect_float, pixel, ibuf->x, ibuf->y, ibuf->channels, u, v);
-			}
+static void scale_filter_columns(void *userdata, int chunk)
+{
+	ScaleFilterThreadData *data = userdata;
+	const ScaleFilterTable *table = &data->table_y;
+	const int start = chunk * SCALE_FILTER_CHUNK_SIZE;
+	const int end = min_ii(start + SCALE_FILTER_CHUNK_SIZE, data->newy);
+	float *row = NULL;
+	int y, i;
+
+	if (data->byte_buffer)
+		row = MEM_mallocN(sizeof(float) * 4 * data->newx, "scale filter row");
+
+	for (y = start; y < end; y++) {
+		const float *weights = table->weights + y * table->max_taps;
+
+		if (data->byte_buffer) {
+			const int len = 4 * data->newx;
+			unsigned char *out = data->byte_buffer + (size_t)y * len;
+
+			scale_filter_column(data->temp + (size_t)table->start[y] * len, row, len, weights, table->num[y]);
+
+			for (i = 0; i < len; i++)
+				out[i] = (unsigned char)CLAMPIS(row[i] + 0.5f, 0.0f, 255.0f);
+		}
+		if (data->float_buffer) {
+			const int len = data->channels * data->newx;
+
+			scale_filter_column(data->temp_float + (size_t)table->start[y] * len,
+			                    data->float_buffer + (size_t)y * len, len, weights, table->num[y]);
 		}
 	}
 
-	return NULL;
+	if (row)
+		MEM_freeN(row);
 }
 
-void IMB_scaleImBuf_threaded(ImBuf *ibuf, unsigned int newx, unsigned int newy)
+/**
+ * Scale using a separable filter, see IMB_SCALE_FILTER_* for the available
+ * filters. Byte buffers are clamped, float buffers are not.
+ */
+struct ImBuf *IMB_scaleImBuf_filter(struct ImBuf *ibuf, unsigned int newx, unsigned int newy, int filter)
 {
-	ScaleTreadInitData init_data = {NULL};
+	ScaleFilterThreadData data = {NULL};
 
-	/* prepare initialization data */
-	init_data.ibuf = ibuf;
+	if (ibuf == NULL) return (NULL);
+	if (ibuf->rect == NULL && ibuf->rect_float == NULL) return (ibuf);
 
-	init_data.newx = newx;
-	init_data.newy = newy;
+	/* zero keeps the size, same as IMB_scaleImBuf */
+	if (newx == 0) newx = ibuf->x;
+	if (newy == 0) newy = ibuf->y;
 
-	if (ibuf->rect)
-		init_data.byte_buffer = MEM_mallocN(4 * newx * newy * sizeof(char), "threaded scale byte buffer");
+	if (newx == ibuf->x && newy == ibuf->y) { return ibuf; }
 
-	if (ibuf->rect_float)
-		init_data.float_buffer = MEM_mallocN(ibuf->channels * newx * newy * sizeof(float), "threaded scale float buffer");
+	scalefast_Z_ImBuf(ibuf, newx, newy);
 
-	/* actual scaling threads */
-	IMB_processor_apply_threaded(newy, sizeof(ScaleThreadData), &init_data,
-	                             scale_thread_init, do_scale_thread);
+	data.ibuf = ibuf;
+	data.newx = newx;
+	data.newy = newy;
+	data.channels = ibuf->channels;
 
-	/* alter image buffer */
-	ibuf->x = newx;
-	ibuf->y = newy;
+	scale_filter_table_init(&data.table_x, ibuf->x, newx, filter);
+	scale_filter_table_init(&data.table_y, ibuf->y, newy, filter);
+
+	if (ibuf->rect) {
+		data.temp = MEM_mallocN(sizeof(float) * 4 * newx * ibuf->y, "scale filter temp");
+		data.byte_buffer = MEM_mallocN(sizeof(unsigned char) * 4 * newx * newy, "scale filter byte buffer");
+	}
+	if (ibuf->rect_float) {
+		data.temp_float = MEM_mallocN(sizeof(float) * data.channels * newx * ibuf->y, "scale filter temp float");
+		data.float_buffer = MEM_mallocN(sizeof(float) * data.channels * newx * newy, "scale filter float buffer");
+	}
+
+	BLI_task_parallel_range_ex(0, (ibuf->y + SCALE_FILTER_CHUNK_SIZE - 1) / SCALE_FILTER_CHUNK_SIZE,
+	                           &data, scale_filter_rows, 2, false);
+	BLI_task_parallel_range_ex(0, (newy + SCALE_FILTER_CHUNK_SIZE - 1) / SCALE_FILTER_CHUNK_SIZE,
+	                           &data, scale_filter_columns, 2, false);
+
+	scale_filter_table_free(&data.table_x);
+	scale_filter_table_free(&data.table_y);
 
 	if (ibuf->rect) {
+		MEM_freeN(data.temp);
 		imb_freerectImBuf(ibuf);
 		ibuf->mall |= IB_rect;
-		ibuf->rect = (unsigned int *) init_data.byte_buffer;
+		ibuf->rect = (unsigned int *) data.byte_buffer;
 	}
-
 	if (ibuf->rect_float) {
+		MEM_freeN(data.temp_float);
 		imb_freerectfloatImBuf(ibuf);
 		ibuf->mall |= IB_rectfloat;
-		ibuf->rect_float = init_data.float_buffer;
+		ibuf->rect_float = data.float_buffer;
 	}
+
+	ibuf->x = newx;
+	ibuf->y = newy;
+
+	return ibuf;
+}
+
+void IMB_scaleImBuf_threaded(ImBuf *ibuf, unsigned int newx, unsigned int newy)
+{
+	IMB_scaleImBuf_filter(ibuf, newx, newy, IMB_SCALE_FILTER_BILINEAR);
 }
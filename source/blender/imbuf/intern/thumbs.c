@@ -331,21 +331,29 @@ ImBuf *IMB_thumb_create(const char *path, ThumbSize size, ThumbSource source, Im
 		else {
 			if (THB_SOURCE_IMAGE == source || THB_SOURCE_BLEND == source) {
 				
+				size_t width = 0, height = 0;
+
 				/* only load if we didnt give an image */
 				if (img == NULL) {
 					if (THB_SOURCE_BLEND == source) {
 						img = IMB_loadblend_thumb(path);
 					}
 					else {
-						img = IMB_loadiffname(path, IB_rect | IB_metadata, NULL);
+						img = IMB_thumb_load_image(path, tsize, NULL, &width, &height);
 					}
 				}
 
 				if (img != NULL) {
+					/* reduced resolution decoding still reports the original size */
+					if (width == 0 || height == 0) {
+						width = img->x;
+						height = img->y;
+					}
+
 					BLI_stat(path, &info);
 					BLI_snprintf(mtime, sizeof(mtime), "%ld", (long int)info.st_mtime);
-					BLI_snprintf(cwidth, sizeof(cwidth), "%d", img->x);
-					BLI_snprintf(cheight, sizeof(cheight), "%d", img->y);
+					BLI_snprintf(cwidth, sizeof(cwidth), "%d", (int)width);
+					BLI_snprintf(cheight, sizeof(cheight), "%d", (int)height);
 				}
 			}
 			else if (THB_SOURCE_MOVIE == source) {
@@ -213,7 +213,7 @@ typedef struct bNode {
 	 * and replacing all uses with per-instance data.
 	 */
 	short preview_xsize, preview_ysize;	/* reserved size of the preview rect */
-	int pad2;
+	int exec_generation;	/* runtime, number of compositor executions the node was tagged in (need_exec) */
 	struct uiBlock *block;	/* runtime during drawing */
 } bNode;
 
@@ -346,7 +346,7 @@ typedef struct bNodeTree {
 	int update;						/* update flags */
 	short is_updating;				/* flag to prevent reentrant update calls */
 	short done;						/* generic temporary flag for recursion check (DFS/BFS) */
-	int pad2;
+	int result_cache_limit;			/* memory for compositor results kept between executions, in MB */
 	
 	int nodetype DNA_DEPRECATED;	/* specific node type this tree is used for */
 
@@ -370,7 +370,7 @@ typedef struct bNodeTree {
 	 * in case multiple different editors are used and make context ambiguous.
 	 */
 	bNodeInstanceKey active_viewer_key;
-	int pad;
+	int buffer_memory_limit;		/* memory for compositor buffers before they are moved to disk, in MB, 0 is unlimited */
 	
 	/* execution data */
 	/* XXX It would be preferable to completely move this data out of the underlying node tree,
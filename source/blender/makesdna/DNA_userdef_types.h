@@ -429,6 +429,8 @@ typedef struct UserDef {
 	char renderdir[1024]; /* FILE_MAX length */
 	/* EXR cache path */
 	char render_cachedir[768];  /* 768 = FILE_MAXDIR */
+	/* sequencer and clip frame cache path */
+	char diskcachedir[768];
 	char textudir[768];
 	char pythondir[768];
 	char sounddir[768];
@@ -482,6 +484,8 @@ typedef struct UserDef {
 	short dragthreshold;
 	int memcachelimit;
 	int prefetchframes;
+	int diskcachelimit;		/* in gigabytes */
+	int pad2;
 	short frameserverport;
 	short pad_rot_angle;	/* control the rotation step of the view when PAD2, PAD4, PAD6&PAD8 is use */
 	short obcenter_dia;
@@ -1138,6 +1138,13 @@ static void rna_def_colormanage(BlenderRNA *brna)
 	RNA_def_property_ui_text(prop, "Use Curves", "Use RGB curved for pre-display transformation");
 	RNA_def_property_update(prop, NC_WINDOW, "rna_ColorManagement_update");
 
+	prop = RNA_def_property(srna, "use_baked_lut", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "flag", COLORMANAGE_VIEW_USE_BAKED_LUT);
+	RNA_def_property_ui_text(prop, "Use Baked LUT",
+	                         "Display images through a cached 3D lookup table of the view transform, "
+	                         "faster but approximate");
+	RNA_def_property_update(prop, NC_WINDOW, "rna_ColorManagement_update");
+
 	/* ** Colorspace **  */
 	srna = RNA_def_struct(brna, "ColorManagedInputColorspaceSettings", NULL);
 	RNA_def_struct_path_func(srna, "rna_ColorManagedInputColorspaceSettings_path");
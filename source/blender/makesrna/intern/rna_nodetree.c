@@ -7687,6 +7687,20 @@ static void rna_def_composite_nodetree(BlenderRNA *brna)
 	RNA_def_property_ui_text(prop, "Chunksize", "Max size of a tile (smaller values gives better distribution "
 	                                            "of multiple threads, but more overhead)");
 
+	prop = RNA_def_property(srna, "result_cache_limit", PROP_INT, PROP_NONE);
+	RNA_def_property_int_sdna(prop, NULL, "result_cache_limit");
+	RNA_def_property_range(prop, 0, INT_MAX);
+	RNA_def_property_ui_range(prop, 0, 8192, 64, -1);
+	RNA_def_property_ui_text(prop, "Cache Limit", "Memory in MB for results of unchanged nodes kept between "
+	                                              "executions while editing (0 disables the cache)");
+
+	prop = RNA_def_property(srna, "buffer_memory_limit", PROP_INT, PROP_NONE);
+	RNA_def_property_int_sdna(prop, NULL, "buffer_memory_limit");
+	RNA_def_property_range(prop, 0, INT_MAX);
+	RNA_def_property_ui_range(prop, 0, 65536, 256, -1);
+	RNA_def_property_ui_text(prop, "Memory Limit", "Memory in MB for intermediate buffers, buffers exceeding it "
+	                                               "are moved to a temporary file (0 keeps all buffers in memory)");
+
 	prop = RNA_def_property(srna, "use_opencl", PROP_BOOLEAN, PROP_NONE);
 	RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_OPENCL);
 	RNA_def_property_ui_text(prop, "OpenCL", "Enable GPU calculations");
@@ -98,6 +98,8 @@ EnumPropertyItem navigation_mode_items[] = {
 #include "MEM_guardedalloc.h"
 #include "MEM_CacheLimiterC-Api.h"
 
+#include "IMB_moviecache.h"
+
 #include "UI_interface.h"
 
 #include "CCL_api.h"
@@ -315,6 +317,11 @@ static void rna_Userdef_memcache_update(Main *UNUSED(bmain), Scene *UNUSED(scene
 	MEM_CacheLimiter_set_maximum(((size_t) U.memcachelimit) * 1024 * 1024);
 }
 
+static void rna_Userdef_diskcache_update(Main *UNUSED(bmain), Scene *UNUSED(scene), PointerRNA *UNUSED(ptr))
+{
+	IMB_moviecache_set_disk_cache(U.diskcachedir, ((size_t) U.diskcachelimit) * 1024 * 1024 * 1024);
+}
+
 static void rna_UserDef_weight_color_update(Main *bmain, Scene *scene, PointerRNA *ptr)
 {
 	Object *ob;
@@ -3898,6 +3905,12 @@ static void rna_def_userdef_system(BlenderRNA *brna)
 	RNA_def_property_ui_text(prop, "Memory Cache Limit", "Memory cache limit (in megabytes)");
 	RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
 
+	prop = RNA_def_property(srna, "disk_cache_limit", PROP_INT, PROP_NONE);
+	RNA_def_property_int_sdna(prop, NULL, "diskcachelimit");
+	RNA_def_property_range(prop, 1, 4096);
+	RNA_def_property_ui_text(prop, "Disk Cache Limit", "Disk cache limit (in gigabytes)");
+	RNA_def_property_update(prop, 0, "rna_Userdef_diskcache_update");
+
 	prop = RNA_def_property(srna, "frame_server_port", PROP_INT, PROP_NONE);
 	RNA_def_property_int_sdna(prop, NULL, "frameserverport");
 	RNA_def_property_range(prop, 0, 32727);
@@ -4376,6 +4389,13 @@ static void rna_def_userdef_filepaths(BlenderRNA *brna)
 	RNA_def_property_string_sdna(prop, NULL, "render_cachedir");
 	RNA_def_property_ui_text(prop, "Render Cache Path", "Where to cache raw render results");
 
+	prop = RNA_def_property(srna, "disk_cache_directory", PROP_STRING, PROP_DIRPATH);
+	RNA_def_property_string_sdna(prop, NULL, "diskcachedir");
+	RNA_def_property_ui_text(prop, "Disk Cache Path",
+	                         "Where to keep sequencer and clip frames that don't fit in the memory cache, "
+	                         "empty to disable the disk cache");
+	RNA_def_property_update(prop, 0, "rna_Userdef_diskcache_update");
+
 	prop = RNA_def_property(srna, "image_editor", PROP_STRING, PROP_FILEPATH);
 	RNA_def_property_string_sdna(prop, NULL, "image_editor");
 	RNA_def_property_ui_text(prop, "Image Editor", "Path to an image editor");
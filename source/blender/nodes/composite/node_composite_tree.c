@@ -110,6 +110,12 @@ static void localize(bNodeTree *UNUSED(localtree), bNodeTree *ntree)
 	bNodeSocket *sock;
 	
 	for (node = ntree->nodes.first; node; node = node->next) {
+		/* count the tags on the original node, the compositor result cache
+		 * uses it to tell executions of a changed image or render apart */
+		if (node->need_exec)
+			node->exec_generation++;
+		node->new_node->exec_generation = node->exec_generation;
+
 		/* ensure new user input gets handled ok */
 		node->need_exec = 0;
 		node->new_node->original = node;
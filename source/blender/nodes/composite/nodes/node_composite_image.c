@@ -312,6 +312,9 @@ static void cmp_node_image_update(bNodeTree *ntree, bNode *node)
 	/* avoid unnecessary updates, only changes to the image/image user data are of interest */
 	if (node->update & NODE_UPDATE_ID)
 		cmp_node_image_verify_outputs(ntree, node);
+	
+	/* image content may have changed, don't reuse cached compositor results */
+	node->need_exec = 1;
 }
 
 static void node_composit_init_image(bNodeTree *ntree, bNode *node)
@@ -139,6 +139,9 @@ typedef struct RenderResult {
 	/* for render results in Image, verify validity for sequences */
 	int framenr;
 
+	/* for lazily loaded multilayer images, file which passes without rect are read from */
+	void *exrhandle;
+
 	/* for acquire image, to indicate if it there is a combined layer */
 	int have_combined;
 
@@ -252,6 +255,8 @@ void RE_PreviewRender(struct Render *re, struct Main *bmain, struct Scene *scene
 bool RE_ReadRenderResult(struct Scene *scene, struct Scene *scenode);
 bool RE_WriteRenderResult(struct ReportList *reports, RenderResult *rr, const char *filename, int compress);
 struct RenderResult *RE_MultilayerConvert(void *exrhandle, const char *colorspace, bool predivide, int rectx, int recty);
+bool RE_MultilayerPassRead(struct RenderResult *rr, struct RenderLayer *rl, struct RenderPass *rpass,
+                           const char *colorspace, bool predivide);
 
 extern const float default_envmap_layout[];
 bool RE_WriteEnvmapResult(struct ReportList *reports, struct Scene *scene, struct EnvMap *env, const char *relpath, const char imtype, float layout[12]);
@@ -44,6 +44,7 @@ struct ListBase;
 struct Render;
 struct RenderData;
 struct RenderLayer;
+struct RenderPass;
 struct RenderResult;
 struct Scene;
 struct rcti;
@@ -58,6 +59,8 @@ struct RenderResult *render_result_new_full_sample(struct Render *re,
 	struct ListBase *lb, struct rcti *partrct, int crop, int savebuffers);
 
 struct RenderResult *render_result_new_from_exr(void *exrhandle, const char *colorspace, bool predivide, int rectx, int recty);
+bool render_result_exr_pass_read(struct RenderResult *rr, struct RenderLayer *rl, struct RenderPass *rpass,
+                                 const char *colorspace, bool predivide);
 
 /* Merge */
 
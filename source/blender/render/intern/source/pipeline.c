@@ -216,6 +216,11 @@ RenderResult *RE_MultilayerConvert(void *exrhandle, const char *colorspace, bool
 	return render_result_new_from_exr(exrhandle, colorspace, predivide, rectx, recty);
 }
 
+bool RE_MultilayerPassRead(RenderResult *rr, RenderLayer *rl, RenderPass *rpass, const char *colorspace, bool predivide)
+{
+	return render_result_exr_pass_read(rr, rl, rpass, colorspace, predivide);
+}
+
 RenderLayer *render_get_active_layer(Render *re, RenderResult *rr)
 {
 	RenderLayer *rl = BLI_findlink(&rr->layers, re->r.actlay);
@@ -2384,6 +2389,9 @@ static void do_render_seq(Render *re)
 	re->i.cfra = cfra;
 
 	if (recurs_depth == 0) {
+		/* the animation update changes strips the prefetch task may be reading */
+		BKE_sequencer_prefetch_stop();
+
 		/* otherwise sequencer animation isn't updated */
 		BKE_animsys_evaluate_all_animation(re->main, re->scene, (float)cfra); // XXX, was BKE_scene_frame_get(re->scene)
 	}
@@ -94,6 +94,8 @@ void render_result_free(RenderResult *res)
 		MEM_freeN(res->rectf);
 	if (res->text)
 		MEM_freeN(res->text);
+	if (res->exrhandle)
+		IMB_exr_close(res->exrhandle);
 	
 	MEM_freeN(res);
 }
@@ -705,13 +707,23 @@ static void ml_addpass_cb(void *UNUSED(base), void *lay, const char *str, float
 	rpass->rect = rect;
 }
 
-/* from imbuf, if a handle was returned we convert this to render result */
+static void render_result_exr_pass_to_linear(RenderPass *rpass, const char *colorspace, bool predivide)
+{
+	const char *to_colorspace = IMB_colormanagement_role_colorspace_name_get(COLOR_ROLE_SCENE_LINEAR);
+
+	if (rpass->channels >= 3) {
+		IMB_colormanagement_transform(rpass->rect, rpass->rectx, rpass->recty, rpass->channels,
+		                              colorspace, to_colorspace, predivide);
+	}
+}
+
+/* from imbuf, if a handle was returned we convert this to render result,
+ * passes of lazily opened files have no rect, see render_result_exr_pass_read() */
 RenderResult *render_result_new_from_exr(void *exrhandle, const char *colorspace, bool predivide, int rectx, int recty)
 {
 	RenderResult *rr = MEM_callocN(sizeof(RenderResult), __func__);
 	RenderLayer *rl;
 	RenderPass *rpass;
-	const char *to_colorspace = IMB_colormanagement_role_colorspace_name_get(COLOR_ROLE_SCENE_LINEAR);
 
 	rr->rectx = rectx;
 	rr->recty = recty;
@@ -726,16 +738,33 @@ RenderResult *render_result_new_from_exr(void *exrhandle, const char *colorspace
 			rpass->rectx = rectx;
 			rpass->recty = recty;
 
-			if (rpass->channels >= 3) {
-				IMB_colormanagement_transform(rpass->rect, rpass->rectx, rpass->recty, rpass->channels,
-				                              colorspace, to_colorspace, predivide);
-			}
+			if (rpass->rect)
+				render_result_exr_pass_to_linear(rpass, colorspace, predivide);
 		}
 	}
 	
 	return rr;
 }
 
+/* read pass which was left without pixels when render result was made from lazily opened file */
+bool render_result_exr_pass_read(RenderResult *rr, RenderLayer *rl, RenderPass *rpass, const char *colorspace, bool predivide)
+{
+	if (rpass->rect)
+		return true;
+
+	if (rr->exrhandle == NULL)
+		return false;
+
+	rpass->rect = IMB_exr_read_pass(rr->exrhandle, rl->name, rpass->name);
+
+	if (rpass->rect == NULL)
+		return false;
+
+	render_result_exr_pass_to_linear(rpass, colorspace, predivide);
+
+	return true;
+}
+
 /*********************************** Merge ***********************************/
 
 static void do_merge_tile(RenderResult *rr, RenderResult *rrpart, float *target, float *tile, int pixsize)
@@ -88,6 +88,7 @@
 
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
+#include "IMB_moviecache.h"
 #include "IMB_thumbs.h"
 
 #include "ED_datafiles.h"
@@ -302,6 +303,7 @@ static void wm_init_userdef(bContext *C, const bool from_memory)
 	UI_init_userdef();
 	
 	MEM_CacheLimiter_set_maximum(((size_t)U.memcachelimit) * 1024 * 1024);
+	IMB_moviecache_set_disk_cache(U.diskcachedir, ((size_t)U.diskcachelimit) * 1024 * 1024 * 1024);
 	sound_init(bmain);
 
 	/* needed so loading a file from the command line respects user-pref [#26156] */
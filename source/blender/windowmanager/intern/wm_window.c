@@ -54,6 +54,7 @@
 #include "BKE_library.h"
 #include "BKE_global.h"
 #include "BKE_main.h"
+#include "BKE_sequencer.h"
 
 
 #include "RNA_access.h"
@@ -1155,8 +1156,12 @@ void wm_window_process_events(const bContext *C)
 	hasevent |= wm_window_timer(C);
 
 	/* no event, we sleep 5 milliseconds */
-	if (hasevent == 0)
+	if (hasevent == 0) {
+		/* nothing is edited while we sleep, the sequencer can render ahead */
+		BKE_sequencer_prefetch_idle_begin();
 		PIL_sleep_ms(5);
+		BKE_sequencer_prefetch_idle_end();
+	}
 }
 
 void wm_window_process_events_nosleep(void) 
@@ -93,6 +93,7 @@
 #include "BKE_material.h"
 #include "BKE_modifier.h"
 #include "BKE_scene.h"
+#include "BKE_sequencer.h"
 #include "BKE_node.h"
 #include "BKE_report.h"
 #include "BKE_sound.h"
@@ -342,6 +343,8 @@ static int print_help(int UNUSED(argc), const char **UNUSED(argv), void *data)
 	BLI_argsPrintArgDoc(ba, "-noglsl");
 	BLI_argsPrintArgDoc(ba, "-noaudio");
 	BLI_argsPrintArgDoc(ba, "-setaudio");
+	printf("\n");
+	BLI_argsPrintArgDoc(ba, "--benchmark-sequencer-blend");
 
 	printf("\n");
 
@@ -473,6 +476,13 @@ static int debug_mode_memory(int UNUSED(argc), const char **UNUSED(argv), void *
 	return 0;
 }
 
+static int benchmark_sequencer_blend(int UNUSED(argc), const char **UNUSED(argv), void *UNUSED(data))
+{
+	BKE_sequencer_blend_effects_benchmark(1920, 1080, 20);
+	exit(0);
+	return 0;
+}
+
 static int set_debug_value(int argc, const char **argv, void *UNUSED(data))
 {
 	if (argc > 1) {
@@ -1450,6 +1460,7 @@ static void setupArguments(bContext *C, bArgs *ba, SYS_SystemHandle *syshandle)
 	BLI_argsAdd(ba, 1, NULL, "--verbose", "<verbose>\n\tSet logging verbosity level.", set_verbosity, NULL);
 
 	BLI_argsAdd(ba, 1, NULL, "--factory-startup", "\n\tSkip reading the "STRINGIFY (BLENDER_STARTUP_FILE)" in the users home directory", set_factory_startup, NULL);
+	BLI_argsAdd(ba, 1, NULL, "--benchmark-sequencer-blend", "\n\tPrint megapixels per second of the sequencer blend effects and exit", benchmark_sequencer_blend, NULL);
 
 	/* TODO, add user env vars? */
 	BLI_argsAdd(ba, 1, NULL, "--env-system-datafiles",  "\n\tSet the "STRINGIFY_ARG (BLENDER_SYSTEM_DATAFILES)" environment variable", set_env, NULL);
@@ -0,0 +1,161 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+#include <string.h>
+
+#include "COM_CompositorContext.h"
+#include "COM_NodeOperation.h"
+#include "COM_NodeOperationBuilder.h"
+
+extern "C" {
+#include "DNA_node_types.h"
+}
+
+/* not a pixel operation, so it's never fused */
+class TestInputOperation : public NodeOperation {
+public:
+	TestInputOperation()
+	{
+		this->addOutputSocket(COM_DT_COLOR);
+	}
+};
+
+class TestPixelOperation : public NodeOperation {
+public:
+	TestPixelOperation(int totinputs)
+	{
+		for (int i = 0; i < totinputs; i++)
+			this->addInputSocket(COM_DT_COLOR);
+		this->addOutputSocket(COM_DT_COLOR);
+		this->setPixelOperation(true);
+	}
+
+	void calculateRow(float *output, float *const *inputRows, int length)
+	{
+		memcpy(output, inputRows[0], sizeof(float) * COM_NUMBER_OF_CHANNELS * length);
+	}
+};
+
+class TestOutputOperation : public NodeOperation {
+public:
+	TestOutputOperation()
+	{
+		this->addInputSocket(COM_DT_COLOR);
+	}
+
+	bool isOutputOperation(bool /*rendering*/) const { return true; }
+};
+
+/* runs the passes that buffer and fuse operations on a graph built by the test */
+class TestNodeOperationBuilder : public NodeOperationBuilder {
+public:
+	TestNodeOperationBuilder(const CompositorContext *context, bNodeTree *ntree) :
+	    NodeOperationBuilder(context, ntree)
+	{}
+
+	~TestNodeOperationBuilder()
+	{
+		for (int i = 0; i < operations().size(); i++)
+			delete operations()[i];
+	}
+
+	NodeOperation *add(NodeOperation *operation)
+	{
+		unsigned int resolution[2] = {64, 64};
+		operation->setResolution(resolution);
+		addOperation(operation);
+		return operation;
+	}
+
+	void link(NodeOperation *from, NodeOperation *to, int index)
+	{
+		addLink(from->getOutputSocket(), to->getInputSocket(index));
+	}
+
+	void run_passes()
+	{
+		fuse_pixel_operations();
+		add_overlap_buffers();
+	}
+
+	template<typename T> int count(T (NodeOperation::*test)() const) const
+	{
+		int num = 0;
+		for (int i = 0; i < operations().size(); i++) {
+			if ((operations()[i]->*test)())
+				num++;
+		}
+		return num;
+	}
+};
+
+class NodeOperationBuilderTest : public ::testing::Test {
+protected:
+	bNodeTree ntree;
+	CompositorContext context;
+
+	void SetUp()
+	{
+		memset(&ntree, 0, sizeof(ntree));
+		context.setbNodeTree(&ntree);
+		context.setRendering(false);
+	}
+};
+
+/* input -> 4 pixel operations -> 2 pixel operations -> mix -> output:
+ * the shared chain is calculated once per row inside the fused operation, buffering it saves nothing */
+TEST_F(NodeOperationBuilderTest, FusedSharedChainIsNotBuffered)
+{
+	TestNodeOperationBuilder builder(&context, &ntree);
+	NodeOperation *prev = builder.add(new TestInputOperation());
+
+	for (int i = 0; i < 4; i++) {
+		NodeOperation *op = builder.add(new TestPixelOperation(1));
+		builder.link(prev, op, 0);
+		prev = op;
+	}
+
+	NodeOperation *a = builder.add(new TestPixelOperation(1));
+	NodeOperation *b = builder.add(new TestPixelOperation(1));
+	NodeOperation *mix = builder.add(new TestPixelOperation(2));
+	NodeOperation *output = builder.add(new TestOutputOperation());
+	builder.link(prev, a, 0);
+	builder.link(prev, b, 0);
+	builder.link(a, mix, 0);
+	builder.link(b, mix, 1);
+	builder.link(mix, output, 0);
+
+	builder.run_passes();
+
+	EXPECT_EQ(1, builder.count(&NodeOperation::isFusedOperation));
+	EXPECT_EQ(0, builder.count(&NodeOperation::isWriteBufferOperation));
+	EXPECT_EQ(0, builder.count(&NodeOperation::isReadBufferOperation));
+	EXPECT_EQ(3, (int)builder.operations().size());
+}
+
+/* the same chain read by two outputs can't be fused with its readers,
+ * so it's still calculated twice per pixel and gets a buffer */
+TEST_F(NodeOperationBuilderTest, SharedChainBetweenOutputsIsBuffered)
+{
+	TestNodeOperationBuilder builder(&context, &ntree);
+	NodeOperation *prev = builder.add(new TestInputOperation());
+
+	for (int i = 0; i < 4; i++) {
+		NodeOperation *op = builder.add(new TestPixelOperation(1));
+		builder.link(prev, op, 0);
+		prev = op;
+	}
+
+	for (int i = 0; i < 2; i++) {
+		NodeOperation *op = builder.add(new TestPixelOperation(1));
+		NodeOperation *output = builder.add(new TestOutputOperation());
+		builder.link(prev, op, 0);
+		builder.link(op, output, 0);
+	}
+
+	builder.run_passes();
+
+	EXPECT_EQ(1, builder.count(&NodeOperation::isFusedOperation));
+	EXPECT_EQ(1, builder.count(&NodeOperation::isWriteBufferOperation));
+	EXPECT_EQ(2, builder.count(&NodeOperation::isReadBufferOperation));
+}
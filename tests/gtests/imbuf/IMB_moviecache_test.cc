@@ -0,0 +1,119 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_dynstr.h"
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+#include "BLI_utildefines.h"
+#include "MEM_CacheLimiterC-Api.h"
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+#include "IMB_moviecache.h"
+}
+
+#define FRAME_SIZE 64
+
+static unsigned int test_key_hash(const void *key)
+{
+	return *(const int *)key;
+}
+
+static bool test_key_cmp(const void *a, const void *b)
+{
+	return *(const int *)a != *(const int *)b;
+}
+
+/* the frame depends on the setting, like a strip on its settings */
+static bool test_disk_key(void *userkey, void *userdata, DynStr *r_key)
+{
+	BLI_dynstr_appendf(r_key, "frame %d setting %d|", *(int *)userkey, *(int *)userdata);
+	return true;
+}
+
+static bool test_check_frame(ImBuf *UNUSED(ibuf), void *userkey, void *userdata)
+{
+	return *(int *)userkey == *(int *)userdata;
+}
+
+class MovieCacheDiskTest : public ::testing::Test {
+protected:
+	char dir[FILE_MAX];
+	MovieCache *cache;
+	int setting;
+
+	void SetUp()
+	{
+		IMB_init();
+		BLI_temp_dir_init(NULL);
+		BLI_join_dirfile(dir, sizeof(dir), BLI_temp_dir_session(), "moviecache_test");
+
+		/* two frames fit in memory, older ones are written to disk */
+		MEM_CacheLimiter_set_maximum(2 * FRAME_SIZE * FRAME_SIZE * 4 + 1024);
+		IMB_moviecache_set_disk_cache(dir, 64 * 1024 * 1024);
+
+		setting = 0;
+		cache = IMB_moviecache_create("test", sizeof(int), test_key_hash, test_key_cmp);
+		IMB_moviecache_set_disk_callback(cache, test_disk_key, &setting);
+	}
+
+	void TearDown()
+	{
+		IMB_moviecache_free(cache);
+		IMB_moviecache_destruct();
+		IMB_moviecache_set_disk_cache("", 0);
+		BLI_delete(dir, true, true);
+		BLI_temp_dir_session_purge();
+		IMB_exit();
+	}
+
+	/* what the frame looks like with the current setting */
+	void render(int frame)
+	{
+		ImBuf *ibuf = IMB_allocImBuf(FRAME_SIZE, FRAME_SIZE, 32, IB_rect);
+
+		for (int i = 0; i < FRAME_SIZE * FRAME_SIZE; i++)
+			ibuf->rect[i] = frame * 100 + setting;
+
+		IMB_moviecache_put(cache, &frame, ibuf);
+		IMB_freeImBuf(ibuf);
+	}
+
+	/* the value of the cached frame, -1 when it has to be rendered */
+	int cached(int frame)
+	{
+		ImBuf *ibuf = IMB_moviecache_get(cache, &frame);
+		int value = -1;
+
+		if (ibuf) {
+			value = ibuf->rect[0];
+			IMB_freeImBuf(ibuf);
+		}
+
+		return value;
+	}
+};
+
+TEST_F(MovieCacheDiskTest, ChangedFrameIsRenderedAgain)
+{
+	int frame = 1;
+
+	for (int i = 1; i <= 4; i++)
+		render(i);
+
+	/* freed from memory, read back from disk */
+	EXPECT_EQ(100, cached(1));
+
+	for (int i = 2; i <= 4; i++)
+		cached(i);
+
+	setting = 1;
+	IMB_moviecache_cleanup(cache, test_check_frame, &frame);
+	EXPECT_EQ(-1, cached(1));
+
+	render(1);
+	for (int i = 2; i <= 4; i++)
+		cached(i);
+	EXPECT_EQ(101, cached(1));
+}